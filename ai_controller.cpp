@@ -0,0 +1,331 @@
+#include "ai_controller.h"
+
+#include "control_actions.h"
+#include "pieces.h"
+
+#include <cassert>
+
+ai_controller::ai_controller(
+  game& g,
+  const chess_color color,
+  const unsigned int seed,
+  const bot_version& version
+) : m_bot(color, seed, version),
+    m_color{color},
+    m_condition{},
+    m_game{g},
+    m_is_cancelled{false},
+    m_is_quitting{false},
+    m_is_thinking{false},
+    m_mutex{},
+    m_n_cancelled{0},
+    m_n_posted{0},
+    m_n_thoughts{0},
+    m_orders{},
+    m_snapshot{},
+    m_state{get_significant_state(g)},
+    m_t_next_think{0.0},
+    m_think_interval{version.m_think_interval},
+    m_thread(&ai_controller::think, this)
+{
+  assert(m_think_interval.get() > 0.0);
+}
+
+ai_controller::~ai_controller()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_is_quitting = true;
+    m_is_cancelled = true;
+  }
+  m_condition.notify_all();
+  m_thread.join();
+}
+
+bot_version get_default_ai_bot_version() noexcept
+{
+  return bot_version{bot_type::mcts, delta_t(0.5)};
+}
+
+std::array<int, 3> get_significant_state(const game& g) noexcept
+{
+  std::array<int, 3> state{0, 0, static_cast<int>(g.get_result())};
+  for (const auto& p: g.get_pieces())
+  {
+    ++state[static_cast<int>(p.get_color())];
+  }
+  return state;
+}
+
+void ai_controller::play()
+{
+  // The AI thread holds the lock only briefly,
+  // yet the game must not even wait for that
+  std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+  if (!lock.owns_lock()) return;
+
+  if (m_is_thinking)
+  {
+    if (!m_is_cancelled && get_significant_state(m_game) != m_state)
+    {
+      m_is_cancelled = true;
+      ++m_n_cancelled;
+    }
+    return;
+  }
+
+  // Give all orders of the last thinking, or none if they are outdated.
+  // The keyboard cursor is where these actions put it
+  // only after these are processed at the next tick
+  if (!m_orders.empty())
+  {
+    if (!m_is_cancelled && get_significant_state(m_game) == m_state)
+    {
+      for (const auto& action: to_keyboard_actions(m_game, m_orders))
+      {
+        m_game.add_action(action);
+        ++m_n_posted;
+      }
+    }
+    m_orders.clear();
+    return;
+  }
+
+  if (is_over(m_game.get_result())) return;
+  if (m_game.get_time() < m_t_next_think) return;
+
+  m_state = get_significant_state(m_game);
+  m_is_cancelled = false;
+  m_is_thinking = true;
+  m_snapshot.emplace(m_game);
+  m_t_next_think = m_game.get_time() + m_think_interval;
+  lock.unlock();
+  m_condition.notify_all();
+}
+
+void test_ai_controller()
+{
+#ifndef NDEBUG
+  // get_default_ai_bot_version
+  {
+    assert(get_default_ai_bot_version().m_type == bot_type::mcts);
+  }
+  // get_significant_state
+  {
+    game g;
+    const auto before{get_significant_state(g)};
+    assert(before[static_cast<int>(chess_color::white)] == 16);
+    assert(before[static_cast<int>(chess_color::black)] == 16);
+    g.get_pieces().pop_back();
+    assert(get_significant_state(g) != before);
+  }
+  // to_keyboard_actions gives the orders as the keyboard user does
+  {
+    // The white queen at d1 attacks the black king, that is put at a4
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("a4"));
+    g.tick(delta_t(0.01));
+    assert(get_keyboard_user_player_color(g) == chess_color::white);
+    const auto orders{
+      to_scheduled_orders(
+        g,
+        {
+          macro_action{0, piece_action_type::attack, square("a4")},
+          macro_action{1, piece_action_type::move, square("f2")}
+        }
+      )
+    };
+    assert(orders.size() == 2);
+    assert(orders[0].get_piece_id() == g.get_pieces()[0].get_id());
+    const auto actions{to_keyboard_actions(g, orders)};
+    // Step, select, step and attack, for both orders
+    assert(actions.size() == 8);
+    for (const auto& a: actions) g.add_action(a);
+    g.tick(delta_t(0.01));
+    const auto& white_queen{g.get_pieces()[0]};
+    assert(!white_queen.get_actions().empty());
+    assert(white_queen.get_actions().back().get_action_type() == piece_action_type::attack);
+    const auto& white_king{g.get_pieces()[1]};
+    assert(!white_king.get_actions().empty());
+    assert(white_king.get_actions().back().get_action_type() == piece_action_type::move);
+    // A pass gives no order
+    assert(to_scheduled_orders(g, { get_pass_macro_action() }).empty());
+  }
+  // to_keyboard_actions finds the pieces by their IDs,
+  // skipping the orders of pieces that are gone
+  {
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    const auto orders{
+      to_scheduled_orders(
+        g,
+        {
+          macro_action{0, piece_action_type::move, square("d2")},
+          macro_action{1, piece_action_type::move, square("f2")}
+        }
+      )
+    };
+    // The white queen is gone, so the white king moved to the front
+    g.get_pieces().erase(std::begin(g.get_pieces()));
+    g.update_occupancy();
+    const auto actions{to_keyboard_actions(g, orders)};
+    for (const auto& a: actions) g.add_action(a);
+    g.tick(delta_t(0.01));
+    const auto& white_king{g.get_pieces()[0]};
+    assert(white_king.get_type() == piece_type::king);
+    assert(!white_king.get_actions().empty());
+    assert(white_king.get_actions().back().get_to() == square("f2"));
+  }
+  // An AI plays the pieces of its color, by posting keyboard actions
+  {
+    auto options{get_default_game_options()};
+    options.set_left_controller_type(controller_type::ai);
+    game g(options);
+    const auto color{get_ai_player_color(options)};
+    ai_controller ai(g, color, 42, bot_version{bot_type::aggressive, delta_t(0.5)});
+    assert(ai.get_color() == color);
+    assert(!ai.is_thinking());
+    ai.play();
+    ai.wait();
+    assert(!ai.is_thinking());
+    assert(ai.get_n_thoughts() == 1);
+    assert(ai.get_n_cancelled() == 0);
+    // The orders are given by the thread that ticks the game
+    assert(ai.get_n_posted() == 0);
+    ai.play();
+    assert(ai.get_n_posted() > 0);
+    g.tick(delta_t(0.01));
+    assert(count_piece_actions(g, color) > 0);
+    assert(count_piece_actions(g, get_other_color(color)) == 0);
+    // The AI only thinks once per think interval
+    ai.play();
+    ai.wait();
+    assert(ai.get_n_thoughts() == 1);
+  }
+  // An AI that is thinking while a piece is captured cancels its thinking
+  {
+    auto options{get_default_game_options()};
+    options.set_right_controller_type(controller_type::ai);
+    game g(options);
+    ai_controller ai(g, get_ai_player_color(options), 42);
+    // A search that is only done when it is cancelled
+    auto search_options{get_default_mcts_options()};
+    search_options.m_max_n_iterations = 1000000000;
+    ai.set_mcts_options(search_options);
+    while (!ai.is_thinking()) ai.play();
+    g.get_pieces().pop_back();
+    g.update_occupancy();
+    // The game only cancels when it does not need to wait for the AI thread
+    while (ai.get_n_cancelled() == 0)
+    {
+      ai.play();
+      std::this_thread::yield();
+    }
+    ai.wait();
+    assert(ai.get_n_thoughts() == 1);
+    assert(ai.get_n_cancelled() == 1);
+    // The orders of the cancelled thinking are not given
+    ai.play();
+    assert(ai.get_n_posted() == 0);
+  }
+  // An AI that is destroyed while thinking stops thinking
+  {
+    game g;
+    ai_controller ai(g, chess_color::white, 42);
+    ai.play();
+  }
+#endif // NDEBUG
+}
+
+void ai_controller::set_mcts_options(const mcts_options& options)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  assert(!m_is_thinking);
+  m_bot.set_mcts_options(options);
+}
+
+void ai_controller::think()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    m_condition.wait(lock, [this]() { return m_is_quitting || m_snapshot.has_value(); });
+    if (m_is_quitting) return;
+    const game snapshot{*m_snapshot};
+    m_snapshot.reset();
+    lock.unlock();
+
+    // The thinking, which may take long, is done without the lock
+    const auto orders{
+      to_scheduled_orders(snapshot, m_bot.choose_orders(snapshot, &m_is_cancelled))
+    };
+
+    lock.lock();
+    if (!m_is_cancelled) m_orders = orders;
+    ++m_n_thoughts;
+    m_is_thinking = false;
+    m_condition.notify_all();
+  }
+}
+
+std::vector<control_action> to_keyboard_actions(
+  const game& g,
+  const std::vector<scheduled_order>& orders
+)
+{
+  std::vector<control_action> actions;
+  game_coordinat cursor{get_keyboard_player_pos(g)};
+  const auto step_to{
+    [&actions, &cursor](const square& s)
+    {
+      const auto to{to_coordinat(s)};
+      if (is_same_square(cursor, to)) return;
+      actions.push_back(create_cursor_step_action(to - cursor));
+      cursor = to;
+    }
+  };
+  // Moving or attacking unselects all pieces,
+  // so only the first piece may be selected already
+  bool is_first_order{true};
+  for (const auto& order: orders)
+  {
+    const int index{get_index_of_piece_with_id(g, order.get_piece_id())};
+    if (index == -1) continue;
+    const auto& p{g.get_pieces()[index]};
+    step_to(p.get_current_square());
+    // Selecting a selected piece would unselect it
+    if (!is_first_order || !p.is_selected())
+    {
+      actions.push_back(create_press_select_action());
+    }
+    step_to(order.get_to());
+    actions.push_back(
+      order.get_action_type() == piece_action_type::attack
+      ? create_press_attack_action()
+      : create_press_move_action()
+    );
+    is_first_order = false;
+  }
+  return actions;
+}
+
+std::vector<scheduled_order> to_scheduled_orders(
+  const game& g,
+  const std::vector<macro_action>& actions
+)
+{
+  std::vector<scheduled_order> orders;
+  for (const auto& a: actions)
+  {
+    if (is_pass(a)) continue;
+    orders.push_back(
+      scheduled_order(g.get_pieces()[a.m_piece_index].get_id(), a.m_action_type, a.m_to)
+    );
+  }
+  return orders;
+}
+
+void ai_controller::wait()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_condition.wait(lock, [this]() { return !m_is_thinking; });
+}
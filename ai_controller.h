@@ -0,0 +1,168 @@
+#ifndef AI_CONTROLLER_H
+#define AI_CONTROLLER_H
+
+#include "bot.h"
+#include "bot_version.h"
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "control_action.h"
+#include "delta_t.h"
+#include "game.h"
+#include "macro_action.h"
+#include "scheduled_order.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/// Get the bot version the AI uses when not specified otherwise
+bot_version get_default_ai_bot_version() noexcept;
+
+/// A computer player that thinks on a thread of its own,
+/// so that the thread running the game, e.g. the window,
+/// never waits for it.
+///
+/// Every think interval, the game is copied and handed to the thread.
+/// There, a bot chooses its orders on the copy,
+/// which are kept by the IDs of the pieces, as their indices may change.
+/// The thread that ticks the game then adds the orders to the game,
+/// all at once, as the keyboard actions that give these orders:
+/// stepping the cursor to a piece, selecting it,
+/// stepping the cursor to a square and moving to or attacking it.
+/// As the AI acts like a keyboard user, the other player uses the mouse.
+///
+/// The thinking is cancelled when the game changes in a way
+/// that makes the orders outdated, i.e. when a piece is captured
+/// or the game is over, after which none of its orders are given
+class ai_controller
+{
+public:
+  /// @param g the game to play, which must outlive the AI
+  /// @param color the color of the pieces the AI plays with
+  /// @param seed the seed of the random numbers of the bot
+  /// @param version the type and think interval of the bot
+  explicit ai_controller(
+    game& g,
+    const chess_color color,
+    const unsigned int seed,
+    const bot_version& version = get_default_ai_bot_version()
+  );
+  ai_controller(const ai_controller&) = delete;
+  ai_controller& operator=(const ai_controller&) = delete;
+
+  /// Cancels the thinking and waits for the thread to finish
+  ~ai_controller();
+
+  auto get_color() const noexcept { return m_color; }
+
+  /// Get the number of times the thinking was cancelled
+  int get_n_cancelled() const noexcept { return m_n_cancelled; }
+
+  /// Get the number of control actions added to the game
+  int get_n_posted() const noexcept { return m_n_posted; }
+
+  /// Get the number of times the AI is done thinking,
+  /// including the times it was cancelled
+  int get_n_thoughts() const noexcept { return m_n_thoughts; }
+
+  /// Is the AI thinking?
+  bool is_thinking() const noexcept { return m_is_thinking; }
+
+  /// Give the orders the AI is done thinking about, if any,
+  /// let the AI start thinking, if it is time to do so,
+  /// or cancel its thinking, if the game changed too much.
+  /// Never waits for the AI thread.
+  /// Call this before each tick of the game,
+  /// from the thread that ticks the game
+  void play();
+
+  /// Set the search options of the bot, when it searches.
+  /// Only to be called when the AI is not thinking
+  void set_mcts_options(const mcts_options& options);
+
+  /// Wait until the AI is done thinking
+  void wait();
+
+private:
+
+  /// Chooses the orders, only used by the AI thread
+  bot m_bot;
+
+  chess_color m_color;
+
+  /// Wakes up the AI thread when there is something to think about,
+  /// and the waiting thread when the AI is done thinking
+  std::condition_variable m_condition;
+
+  game& m_game;
+
+  /// Is the thinking cancelled?
+  std::atomic<bool> m_is_cancelled;
+
+  /// Must the AI thread quit? Guarded by 'm_mutex'
+  bool m_is_quitting;
+
+  std::atomic<bool> m_is_thinking;
+
+  /// Guards the handing over of the game to the AI thread
+  std::mutex m_mutex;
+
+  int m_n_cancelled;
+
+  int m_n_posted;
+
+  std::atomic<int> m_n_thoughts;
+
+  /// The orders chosen by the last thinking, that are not given yet.
+  /// Guarded by 'm_mutex'
+  std::vector<scheduled_order> m_orders;
+
+  /// The copy of the game to think about, if any.
+  /// Guarded by 'm_mutex'
+  std::optional<game> m_snapshot;
+
+  /// The state of the game the AI is thinking about,
+  /// as given by 'get_significant_state'
+  std::array<int, 3> m_state;
+
+  /// The next in-game time the AI starts thinking
+  delta_t m_t_next_think;
+
+  delta_t m_think_interval;
+
+  /// The AI thread, that is started after all other members
+  std::thread m_thread;
+
+  /// Think about each game handed over, until quitting.
+  /// Runs on the AI thread
+  void think();
+};
+
+/// Get what the thinking of the AI depends on:
+/// the number of pieces per color and the result of the game.
+/// When this changes while thinking, the thinking is cancelled
+std::array<int, 3> get_significant_state(const game& g) noexcept;
+
+/// Test this class and its free functions
+void test_ai_controller();
+
+/// Get the keyboard actions that give orders to the pieces,
+/// starting from where the keyboard cursor is in the game.
+/// Orders for pieces that are gone are skipped
+std::vector<control_action> to_keyboard_actions(
+  const game& g,
+  const std::vector<scheduled_order>& orders
+);
+
+/// Get the orders of macro actions in a game,
+/// by the IDs of their pieces. Passes are skipped
+std::vector<scheduled_order> to_scheduled_orders(
+  const game& g,
+  const std::vector<macro_action>& actions
+);
+
+#endif // AI_CONTROLLER_H
@@ -0,0 +1,560 @@
+#include "alpha_beta.h"
+
+#include "evaluation_weights.h"
+#include "game.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+alpha_beta_searcher::alpha_beta_searcher(
+  const chess_position& p,
+  transposition_table& table,
+  std::atomic<bool>& stop,
+  const bool has_time_budget,
+  const std::chrono::steady_clock::time_point& deadline,
+  const std::vector<tablebase>* tablebases
+) : m_best_move{0, 0, 0},
+    m_deadline{deadline},
+    m_has_time_budget{has_time_budget},
+    m_history(13 * p.get_board_size() * p.get_board_size(), 0),
+    m_killers(2 * get_max_ply(), position_move{0, 0, 0}),
+    m_moves(get_max_ply()),
+    m_n_nodes{0},
+    m_n_tablebase_hits{0},
+    m_position{p},
+    m_root_best_move{0, 0, 0},
+    m_score{0},
+    m_stop{stop},
+    m_table{table},
+    m_tablebases{tablebases}
+{
+}
+
+int to_table_score(const int score, const int ply) noexcept
+{
+  if (score >= get_min_mate_score()) return score + ply;
+  if (score <= -get_min_mate_score()) return score - ply;
+  return score;
+}
+
+int from_table_score(const int score, const int ply) noexcept
+{
+  if (score >= get_min_mate_score()) return score - ply;
+  if (score <= -get_min_mate_score()) return score + ply;
+  return score;
+}
+
+void alpha_beta_searcher::pick_move(
+  std::vector<position_move>& moves,
+  const int index,
+  const position_move& table_move,
+  const int ply
+) const noexcept
+{
+  const int n_squares{m_position.get_board_size() * m_position.get_board_size()};
+  const auto get_order{
+    [&](const position_move& m)
+    {
+      if (m == table_move) return 1 << 30;
+      if (m.m_captured != 0)
+      {
+        const int victim{get_material_value(get_piece_type(m.m_captured))};
+        const int attacker{get_material_value(get_piece_type(m_position.get_at(m.m_from)))};
+        return (1 << 24) + (victim * 128) - attacker;
+      }
+      if (m == m_killers[2 * ply]) return 1 << 23;
+      if (m == m_killers[(2 * ply) + 1]) return 1 << 22;
+      return m_history[((m_position.get_at(m.m_from) + 6) * n_squares) + m.m_to];
+    }
+  };
+  const int n_moves{static_cast<int>(moves.size())};
+  int best_index{index};
+  int best_order{get_order(moves[index])};
+  for (int i{index + 1}; i < n_moves; ++i)
+  {
+    const int order{get_order(moves[i])};
+    if (order > best_order)
+    {
+      best_order = order;
+      best_index = i;
+    }
+  }
+  std::swap(moves[index], moves[best_index]);
+}
+
+int alpha_beta_searcher::quiesce(int alpha, const int beta, const int ply)
+{
+  if (tick()) return 0;
+  if (m_position.get_n_kings(m_position.get_color_to_move()) == 0)
+  {
+    return -get_mate_score() + ply;
+  }
+  const int stand_pat{evaluate(m_position)};
+  if (stand_pat >= beta || ply >= get_max_ply() - 1) return stand_pat;
+  alpha = std::max(alpha, stand_pat);
+
+  auto& moves{m_moves[ply]};
+  moves.clear();
+  m_position.get_moves(moves);
+  moves.erase(
+    std::remove_if(
+      std::begin(moves),
+      std::end(moves),
+      [](const position_move& m) { return m.m_captured == 0; }
+    ),
+    std::end(moves)
+  );
+  int best{stand_pat};
+  const int n_moves{static_cast<int>(moves.size())};
+  for (int i{0}; i != n_moves; ++i)
+  {
+    pick_move(moves, i, position_move{0, 0, 0}, ply);
+    const auto m{moves[i]};
+    m_position.do_move(m);
+    const int score{-quiesce(-beta, -alpha, ply + 1)};
+    m_position.undo_move(m);
+    if (m_stop) return 0;
+    if (score > best)
+    {
+      best = score;
+      if (score > alpha) alpha = score;
+      if (alpha >= beta) break;
+    }
+  }
+  return best;
+}
+
+int alpha_beta_searcher::search(const int depth, int alpha, const int beta, const int ply)
+{
+  if (depth <= 0) return quiesce(alpha, beta, ply);
+  if (tick()) return 0;
+  if (m_position.get_n_kings(m_position.get_color_to_move()) == 0)
+  {
+    return -get_mate_score() + ply;
+  }
+  if (ply >= get_max_ply() - 1) return evaluate(m_position);
+  // The root needs a move, that the tablebases do not give
+  if (m_tablebases && ply > 0)
+  {
+    if (const auto e{probe_tablebases(*m_tablebases, m_position)})
+    {
+      ++m_n_tablebase_hits;
+      return get_tablebase_score(*e, ply);
+    }
+  }
+
+  const int alpha_start{alpha};
+  const auto hash{m_position.get_hash()};
+  position_move table_move{0, 0, 0};
+  if (const auto e{m_table.probe(hash)})
+  {
+    table_move = e->m_move;
+    if (e->m_depth >= depth && ply > 0)
+    {
+      const int score{from_table_score(e->m_score, ply)};
+      if (e->m_bound == score_bound::exact) return score;
+      if (e->m_bound == score_bound::lower && score >= beta) return score;
+      if (e->m_bound == score_bound::upper && score <= alpha) return score;
+    }
+  }
+
+  auto& moves{m_moves[ply]};
+  moves.clear();
+  m_position.get_moves(moves);
+  if (moves.empty()) return 0;
+
+  int best{-2 * get_mate_score()};
+  position_move best_move{moves[0]};
+  const int n_moves{static_cast<int>(moves.size())};
+  for (int i{0}; i != n_moves; ++i)
+  {
+    pick_move(moves, i, table_move, ply);
+    // Copy the move, as deeper plies may reuse the list of moves
+    const auto m{moves[i]};
+    m_position.do_move(m);
+    const int score{-search(depth - 1, -beta, -alpha, ply + 1)};
+    m_position.undo_move(m);
+    if (m_stop) return 0;
+    if (score > best)
+    {
+      best = score;
+      best_move = m;
+      if (ply == 0) m_root_best_move = m;
+      if (score > alpha) alpha = score;
+      if (alpha >= beta)
+      {
+        if (m.m_captured == 0)
+        {
+          if (!(m == m_killers[2 * ply]))
+          {
+            m_killers[(2 * ply) + 1] = m_killers[2 * ply];
+            m_killers[2 * ply] = m;
+          }
+          const int n_squares{m_position.get_board_size() * m_position.get_board_size()};
+          m_history[((m_position.get_at(m.m_from) + 6) * n_squares) + m.m_to] += depth * depth;
+        }
+        break;
+      }
+    }
+  }
+  const score_bound bound{
+    best <= alpha_start ? score_bound::upper
+    : best >= beta ? score_bound::lower
+    : score_bound::exact
+  };
+  m_table.store(
+    hash,
+    transposition_entry{best_move, std::min(depth, 255), to_table_score(best, ply), bound}
+  );
+  return best;
+}
+
+bool alpha_beta_searcher::search_root(const int depth)
+{
+  assert(depth > 0);
+  m_root_best_move = position_move{0, 0, 0};
+  const int score{search(depth, -2 * get_mate_score(), 2 * get_mate_score(), 0)};
+  if (m_stop)
+  {
+    // Better a move of a search that was not done than none at all
+    if (!is_move(m_best_move)) m_best_move = m_root_best_move;
+    return false;
+  }
+  m_best_move = m_root_best_move;
+  m_score = score;
+  return true;
+}
+
+bool alpha_beta_searcher::tick() noexcept
+{
+  ++m_n_nodes;
+  if (m_has_time_budget
+    && (m_n_nodes % 1024) == 0
+    && std::chrono::steady_clock::now() >= m_deadline
+  )
+  {
+    m_stop = true;
+  }
+  return m_stop.load(std::memory_order_relaxed);
+}
+
+void benchmark_alpha_beta(
+  std::ostream& os,
+  const int max_depth,
+  const int n_threads
+)
+{
+  const int n_all_threads{
+    n_threads > 0 ? n_threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))
+  };
+  std::vector<int> thread_counts{1};
+  if (n_all_threads > 1) thread_counts.push_back(n_all_threads);
+  os << "position\tthreads\tdepth\tnodes\tseconds\tnodes_per_sec\tscore\tbest_move\ttime_to_depth_ms\n";
+  for (const auto t: get_all_starting_position_types())
+  {
+    const auto p{create_chess_position(t)};
+    for (const int n: thread_counts)
+    {
+      auto options{get_default_alpha_beta_options()};
+      options.m_max_depth = max_depth;
+      options.m_n_threads = n;
+      const auto r{search_position(p, options)};
+      os << to_str(t) << '\t'
+        << n << '\t'
+        << r.m_depth << '\t'
+        << r.m_n_nodes << '\t'
+        << r.m_elapsed.count() / 1.0e6 << '\t'
+        << get_nodes_per_second(r) << '\t'
+        << r.m_score << '\t'
+        << (is_move(r.m_best_move) ? to_str(p, r.m_best_move) : "none") << '\t'
+      ;
+      for (std::size_t i{0}; i != r.m_time_to_depth.size(); ++i)
+      {
+        os << (i == 0 ? "" : ",") << r.m_time_to_depth[i].count() / 1000.0;
+      }
+      os << '\n';
+    }
+  }
+}
+
+int evaluate(const chess_position& p) noexcept
+{
+  static constexpr evaluation_weights w{get_tuned_evaluation_weights()};
+  return evaluate(p, w);
+}
+
+int evaluate(const chess_position& p, const evaluation_weights& w) noexcept
+{
+  const int n{p.get_board_size()};
+  int score{0};
+  for (int x{0}; x != n; ++x)
+  {
+    for (int y{0}; y != n; ++y)
+    {
+      const int code{p.get_at((x * n) + y)};
+      if (code == 0) continue;
+      const int type{static_cast<int>(get_piece_type(code))};
+      const int centrality{(n - 1) - ((std::abs((2 * x) - (n - 1)) + std::abs((2 * y) - (n - 1))) / 2)};
+      const int value{w.m_material[type] + (w.m_centrality[type] * centrality)};
+      score += code > 0 ? value : -value;
+    }
+  }
+  return p.get_color_to_move() == chess_color::white ? score : -score;
+}
+
+std::array<int, 12> get_evaluation_features(
+  const std::vector<std::int8_t>& board,
+  const int board_size
+) noexcept
+{
+  const int n{board_size};
+  assert(static_cast<int>(board.size()) == n * n);
+  std::array<int, 12> features;
+  std::fill(std::begin(features), std::end(features), 0);
+  for (int x{0}; x != n; ++x)
+  {
+    for (int y{0}; y != n; ++y)
+    {
+      const int code{board[(x * n) + y]};
+      if (code == 0) continue;
+      const int type{static_cast<int>(get_piece_type(code))};
+      const int centrality{(n - 1) - ((std::abs((2 * x) - (n - 1)) + std::abs((2 * y) - (n - 1))) / 2)};
+      const int sign{code > 0 ? 1 : -1};
+      features[type] += sign;
+      features[6 + type] += sign * centrality;
+    }
+  }
+  return features;
+}
+
+alpha_beta_options get_default_alpha_beta_options() noexcept
+{
+  return alpha_beta_options{6, 1, nullptr, std::chrono::microseconds(0), 20};
+}
+
+double get_nodes_per_second(const alpha_beta_result& r) noexcept
+{
+  if (r.m_elapsed.count() == 0) return 0.0;
+  return static_cast<double>(r.m_n_nodes) * 1.0e6 / r.m_elapsed.count();
+}
+
+int get_tablebase_score(const tablebase_entry& e, const int ply) noexcept
+{
+  if (e.m_wdl > 0) return get_mate_score() - (ply + e.m_dtm);
+  if (e.m_wdl < 0) return -get_mate_score() + ply + e.m_dtm;
+  return 0;
+}
+
+bool is_move(const position_move& m) noexcept
+{
+  return m.m_from != m.m_to;
+}
+
+alpha_beta_result search_position(
+  const chess_position& p,
+  const alpha_beta_options& options
+)
+{
+  assert(options.m_max_depth > 0);
+  assert(options.m_n_threads > 0);
+  transposition_table table(options.m_transposition_table_log2);
+  std::atomic<bool> stop{false};
+  const bool has_time_budget{options.m_time_budget.count() > 0};
+  const auto start{std::chrono::steady_clock::now()};
+  const auto deadline{start + options.m_time_budget};
+  std::vector<std::unique_ptr<alpha_beta_searcher>> searchers;
+  for (int i{0}; i != options.m_n_threads; ++i)
+  {
+    searchers.push_back(
+      std::make_unique<alpha_beta_searcher>(p, table, stop, has_time_budget, deadline, options.m_tablebases)
+    );
+  }
+
+  alpha_beta_result result{position_move{0, 0, 0}, 0, std::chrono::microseconds(0), 0, 0, 0, {}};
+  {
+    std::vector<std::thread> threads;
+    for (int i{1}; i < options.m_n_threads; ++i)
+    {
+      threads.emplace_back(
+        [&searchers, &stop, &options, i]()
+        {
+          const int extra_depth{i % 2};
+          for (int depth{1 + extra_depth}; depth <= options.m_max_depth + extra_depth && !stop; ++depth)
+          {
+            searchers[i]->search_root(depth);
+          }
+        }
+      );
+    }
+    // The calling thread is the main searcher
+    auto& main_searcher{*searchers[0]};
+    for (int depth{1}; depth <= options.m_max_depth; ++depth)
+    {
+      if (!main_searcher.search_root(depth)) break;
+      result.m_depth = depth;
+      result.m_time_to_depth.push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+      );
+      // A forced win needs no deeper search
+      if (std::abs(main_searcher.get_score()) >= get_min_mate_score()) break;
+    }
+    stop = true;
+    for (auto& t: threads) t.join();
+    result.m_best_move = main_searcher.get_best_move();
+    result.m_score = main_searcher.get_score();
+  }
+  result.m_elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start
+  );
+  for (const auto& s: searchers)
+  {
+    result.m_n_nodes += s->get_n_nodes();
+    result.m_n_tablebase_hits += s->get_n_tablebase_hits();
+  }
+  return result;
+}
+
+void test_alpha_beta()
+{
+#ifndef NDEBUG
+  // evaluate, the standard starting position is even
+  {
+    auto p{create_chess_position(starting_position_type::standard)};
+    assert(evaluate(p) == 0);
+  }
+  // evaluate, more material is better
+  {
+    auto g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces().erase(std::begin(g.get_pieces()) + 2);
+    assert(evaluate(create_chess_position(g, chess_color::white)) > 800);
+    assert(evaluate(create_chess_position(g, chess_color::black)) < -800);
+  }
+  // evaluate, for white it is the features times the weights
+  {
+    const evaluation_weights w{{{ 1, 2, 3, 4, 5, 6 }}, {{ 7, 8, 9, 10, 11, 12 }}};
+    auto g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces().erase(std::begin(g.get_pieces()) + 2);
+    const auto p{create_chess_position(g, chess_color::white)};
+    const auto features{get_evaluation_features(p.get_board(), p.get_board_size())};
+    int score{0};
+    for (int i{0}; i != 6; ++i)
+    {
+      score += (features[i] * w.m_material[i]) + (features[6 + i] * w.m_centrality[i]);
+    }
+    assert(score == evaluate(p, w));
+    assert(-score == evaluate(create_chess_position(g, chess_color::black), w));
+    assert(features[static_cast<int>(piece_type::queen)] == 1);
+    assert(features[static_cast<int>(piece_type::king)] == 0);
+  }
+  // A search captures a king in reach
+  {
+    auto g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("a4"));
+    const auto p{create_chess_position(g, chess_color::white)};
+    const auto r{search_position(p, get_default_alpha_beta_options())};
+    assert(to_str(p, r.m_best_move) == "d1xa4");
+    assert(r.m_score >= get_min_mate_score());
+    // No deeper search is needed
+    assert(r.m_depth == 1);
+    assert(r.m_time_to_depth.size() == 1);
+  }
+  // A search finds the one move that keeps its king
+  {
+    // The black king at a4 is attacked by the white queen at d1,
+    // and black can take the queen first
+    auto g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("a4"));
+    const auto p{create_chess_position(g, chess_color::black)};
+    auto options{get_default_alpha_beta_options()};
+    options.m_max_depth = 3;
+    const auto r{search_position(p, options)};
+    assert(is_move(r.m_best_move));
+    assert(r.m_score > -get_min_mate_score());
+    assert(r.m_depth == 3);
+  }
+  // A search on one thread is deterministic
+  {
+    const auto p{create_chess_position(starting_position_type::before_scholars_mate)};
+    auto options{get_default_alpha_beta_options()};
+    options.m_max_depth = 3;
+    options.m_transposition_table_log2 = 16;
+    const auto a{search_position(p, options)};
+    const auto b{search_position(p, options)};
+    assert(a.m_best_move == b.m_best_move);
+    assert(a.m_score == b.m_score);
+    assert(a.m_n_nodes == b.m_n_nodes);
+    assert(a.m_n_nodes > 0);
+    assert(a.m_time_to_depth.size() == static_cast<std::size_t>(a.m_depth));
+    assert(std::is_sorted(std::begin(a.m_time_to_depth), std::end(a.m_time_to_depth)));
+  }
+  // Lazy SMP finds the same forced win
+  {
+    auto g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("a4"));
+    const auto p{create_chess_position(g, chess_color::white)};
+    auto options{get_default_alpha_beta_options()};
+    options.m_n_threads = 4;
+    options.m_transposition_table_log2 = 16;
+    const auto r{search_position(p, options)};
+    assert(to_str(p, r.m_best_move) == "d1xa4");
+    assert(r.m_score >= get_min_mate_score());
+  }
+  // Lazy SMP searches the full depth
+  {
+    const auto p{create_chess_position(starting_position_type::bishop_and_knight_end_game)};
+    auto options{get_default_alpha_beta_options()};
+    options.m_max_depth = 3;
+    options.m_n_threads = 3;
+    options.m_transposition_table_log2 = 16;
+    const auto r{search_position(p, options)};
+    assert(r.m_depth == 3 || std::abs(r.m_score) >= get_min_mate_score());
+    assert(is_move(r.m_best_move));
+  }
+  // A search stays within its time budget
+  {
+    const auto p{create_chess_position(starting_position_type::standard)};
+    auto options{get_default_alpha_beta_options()};
+    options.m_max_depth = 100;
+    options.m_n_threads = 2;
+    options.m_time_budget = std::chrono::milliseconds(100);
+    options.m_transposition_table_log2 = 16;
+    const auto r{search_position(p, options)};
+    assert(r.m_depth < 100);
+    assert(is_move(r.m_best_move));
+    assert(r.m_elapsed < std::chrono::milliseconds(1000));
+  }
+  // benchmark_alpha_beta
+  {
+    std::stringstream s;
+    benchmark_alpha_beta(s, 2, 2);
+    for (const auto t: get_all_starting_position_types())
+    {
+      assert(s.str().find(to_str(t)) != std::string::npos);
+    }
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    auto options{get_default_alpha_beta_options()};
+    options.m_max_depth = 2;
+    s << search_position(create_chess_position(starting_position_type::kings_only), options);
+    assert(s.str().find("nodes_per_sec") != std::string::npos);
+  }
+#endif // NDEBUG
+}
+
+std::ostream& operator<<(std::ostream& os, const alpha_beta_result& r) noexcept
+{
+  os << "depth: " << r.m_depth << '\n'
+    << "score: " << r.m_score << '\n'
+    << "nodes: " << r.m_n_nodes << '\n'
+    << "microseconds: " << r.m_elapsed.count() << '\n'
+    << "nodes_per_sec: " << get_nodes_per_second(r)
+  ;
+  return os;
+}
@@ -0,0 +1,245 @@
+#ifndef ALPHA_BETA_H
+#define ALPHA_BETA_H
+
+#include "ccfwd.h"
+#include "chess_position.h"
+#include "tablebase.h"
+#include "transposition_table.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+/// The settings of an alpha-beta search
+struct alpha_beta_options
+{
+  /// The depth after which the search stops, in plies
+  int m_max_depth;
+
+  /// The number of threads, that share a transposition table (Lazy SMP)
+  int m_n_threads;
+
+  /// The endgame tablebases to look up positions in, which must outlive
+  /// the search, where nullptr denotes none
+  const std::vector<tablebase>* m_tablebases;
+
+  /// The wall-clock time after which the search stops,
+  /// where zero denotes no limit
+  std::chrono::microseconds m_time_budget;
+
+  /// The two-log of the number of slots of the transposition table
+  int m_transposition_table_log2;
+};
+
+/// The weights of 'evaluate', in hundredths of a pawn,
+/// per piece type, in the order of 'piece_type'
+struct evaluation_weights
+{
+  /// The value of a piece
+  std::array<int, 6> m_material;
+
+  /// The value of a piece per step closer to the center
+  std::array<int, 6> m_centrality;
+};
+
+/// The outcome of an alpha-beta search
+struct alpha_beta_result
+{
+  /// The best move found,
+  /// where a move from and to the same square denotes none
+  position_move m_best_move;
+
+  /// The deepest depth searched completely
+  int m_depth;
+
+  /// The wall-clock time the search took
+  std::chrono::microseconds m_elapsed;
+
+  /// The number of positions searched by all threads
+  long long m_n_nodes;
+
+  /// The number of positions looked up in the tablebases by all threads
+  long long m_n_tablebase_hits;
+
+  /// The score for the player to move, in hundredths of a pawn.
+  /// A score beyond 'get_min_mate_score' is a forced win
+  int m_score;
+
+  /// The wall-clock time it took to search each depth completely,
+  /// starting at depth one
+  std::vector<std::chrono::microseconds> m_time_to_depth;
+};
+
+/// The search of one thread: iterative deepening of an alpha-beta
+/// (negamax) search, with a quiescence search of the captures.
+/// The moves are tried in the order of the best move of the
+/// transposition table, the captures by most valuable victim
+/// and least valuable attacker, the killer moves and the history
+class alpha_beta_searcher
+{
+public:
+  /// @param p the position to search, which is copied
+  /// @param table the transposition table shared by all threads
+  /// @param stop set to true to stop the search, as soon as possible
+  /// @param deadline the time the search stops at, if it has a time budget
+  /// @param tablebases the endgame tablebases, where nullptr denotes none
+  explicit alpha_beta_searcher(
+    const chess_position& p,
+    transposition_table& table,
+    std::atomic<bool>& stop,
+    const bool has_time_budget,
+    const std::chrono::steady_clock::time_point& deadline,
+    const std::vector<tablebase>* tablebases = nullptr
+  );
+
+  /// Get the best move of the deepest depth searched completely
+  const auto& get_best_move() const noexcept { return m_best_move; }
+
+  /// Get the number of positions searched
+  auto get_n_nodes() const noexcept { return m_n_nodes; }
+
+  /// Get the number of positions looked up in the tablebases
+  auto get_n_tablebase_hits() const noexcept { return m_n_tablebase_hits; }
+
+  /// Get the score of the deepest depth searched completely
+  auto get_score() const noexcept { return m_score; }
+
+  /// Search a position to a depth.
+  /// @return false if the search was stopped before it was done
+  bool search_root(const int depth);
+
+private:
+
+  /// The best move of the deepest depth searched completely
+  position_move m_best_move;
+
+  /// The time the search stops at, if it has a time budget
+  std::chrono::steady_clock::time_point m_deadline;
+
+  bool m_has_time_budget;
+
+  /// Per piece on the board and square moved to,
+  /// how often the move caused a cutoff, weighted by depth
+  std::vector<int> m_history;
+
+  /// Per ply, two quiet moves that caused a cutoff
+  std::vector<position_move> m_killers;
+
+  /// The moves per ply, kept to save allocations
+  std::vector<std::vector<position_move>> m_moves;
+
+  long long m_n_nodes;
+
+  long long m_n_tablebase_hits;
+
+  chess_position m_position;
+
+  /// The best move at the root of the search being done
+  position_move m_root_best_move;
+
+  int m_score;
+
+  std::atomic<bool>& m_stop;
+
+  transposition_table& m_table;
+
+  const std::vector<tablebase>* m_tablebases;
+
+  /// Put the most promising move left at the index
+  void pick_move(
+    std::vector<position_move>& moves,
+    const int index,
+    const position_move& table_move,
+    const int ply
+  ) const noexcept;
+
+  /// Search the captures only, until the position is quiet
+  int quiesce(int alpha, const int beta, const int ply);
+
+  /// Search to a depth
+  int search(const int depth, int alpha, const int beta, const int ply);
+
+  /// Count a node and check if the search must stop
+  /// @return true if the search must stop
+  bool tick() noexcept;
+};
+
+/// Benchmark the alpha-beta search on all starting positions:
+/// the nodes per second and the time to reach each depth,
+/// on one thread and on all threads.
+/// Run the game with '--benchmark-search' to see the results.
+/// Use a release build, as the debug asserts dominate the timings
+void benchmark_alpha_beta(
+  std::ostream& os,
+  const int max_depth = 5,
+  const int n_threads = 0
+);
+
+/// Evaluate a position for the player to move,
+/// in hundredths of a pawn: the difference in material,
+/// plus a bit for pieces near the center,
+/// using the weights in 'evaluation_weights.h'
+int evaluate(const chess_position& p) noexcept;
+
+/// Evaluate a position for the player to move, using other weights
+int evaluate(const chess_position& p, const evaluation_weights& w) noexcept;
+
+/// Get the score from the transposition table,
+/// where a forced win counts from the root of the search
+int from_table_score(const int score, const int ply) noexcept;
+
+/// Get the score of a position in a tablebase, at a ply in the search
+int get_tablebase_score(const tablebase_entry& e, const int ply) noexcept;
+
+/// Get the features 'evaluate' weighs, of white minus black,
+/// in the order of the weights in 'evaluation_weights':
+/// per piece type the number of pieces, then per piece type
+/// the sum of their steps closer to the center.
+/// The evaluation for white is the sum of each feature times its weight
+std::array<int, 12> get_evaluation_features(
+  const std::vector<std::int8_t>& board,
+  const int board_size
+) noexcept;
+
+/// Get the search options used when not specified otherwise
+alpha_beta_options get_default_alpha_beta_options() noexcept;
+
+/// Get the score of capturing the king right now
+constexpr int get_mate_score() noexcept { return 100000; }
+
+/// Get the deepest ply searched, including the quiescence search
+constexpr int get_max_ply() noexcept { return 128; }
+
+/// Get the lowest score of a forced win
+constexpr int get_min_mate_score() noexcept { return get_mate_score() - 1000; }
+
+/// Is the move a move at all, i.e. not from and to the same square?
+bool is_move(const position_move& m) noexcept;
+
+/// Search the best move of the player to move,
+/// by iterative deepening, on all threads asked for.
+/// The threads search the same position with a shared
+/// transposition table (Lazy SMP), where every other helper thread
+/// searches one ply deeper, so that the threads fill the table
+/// with different positions. The result is that of the first thread
+alpha_beta_result search_position(
+  const chess_position& p,
+  const alpha_beta_options& options
+);
+
+/// Test this class and its free functions
+void test_alpha_beta();
+
+/// Get the score as stored in the transposition table,
+/// where a forced win counts from the position itself
+int to_table_score(const int score, const int ply) noexcept;
+
+/// Get the nodes searched per second
+double get_nodes_per_second(const alpha_beta_result& r) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const alpha_beta_result& r) noexcept;
+
+#endif // ALPHA_BETA_H
@@ -0,0 +1,426 @@
+#include "balance_sweep.h"
+
+#include "batch_scheduler.h"
+#include "simulation_job.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<std::string> get_balance_parameter_names()
+{
+  std::vector<std::string> names{"damage", "movement_speed"};
+  for (const auto t: get_all_piece_types()) names.push_back("health_" + to_str(t));
+  return names;
+}
+
+sweep_options get_default_sweep_options()
+{
+  return sweep_options{
+    {},
+    false,
+    10,
+    get_all_starting_position_types(),
+    get_default_simulation_options()
+  };
+}
+
+std::vector<std::vector<double>> get_sweep_points(const sweep_options& options)
+{
+  const auto& dimensions{options.m_dimensions};
+  std::vector<std::vector<double>> points;
+  if (options.m_is_random)
+  {
+    assert(options.m_n_samples > 0);
+    std::mt19937 rng_engine(options.m_simulation.m_seed);
+    for (int i{0}; i != options.m_n_samples; ++i)
+    {
+      std::vector<double> point;
+      for (const auto& d: dimensions)
+      {
+        std::uniform_real_distribution<double> distribution(d.m_min, d.m_max);
+        point.push_back(distribution(rng_engine));
+      }
+      points.push_back(point);
+    }
+    return points;
+  }
+  // All combinations of the values of a grid,
+  // where the first dimension changes slowest
+  points.push_back({});
+  for (const auto& d: dimensions)
+  {
+    assert(d.m_n_values > 0);
+    std::vector<std::vector<double>> next_points;
+    for (const auto& point: points)
+    {
+      for (int i{0}; i != d.m_n_values; ++i)
+      {
+        const double f{d.m_n_values == 1 ? 0.0 : static_cast<double>(i) / (d.m_n_values - 1)};
+        auto next_point{point};
+        next_point.push_back(d.m_min + (f * (d.m_max - d.m_min)));
+        next_points.push_back(next_point);
+      }
+    }
+    points = next_points;
+  }
+  return points;
+}
+
+std::string get_sweep_usage() noexcept
+{
+  std::stringstream s;
+  s << "Usage: --sweep [option]...\n"
+    << "Play games between two bots for many balance settings,\n"
+    << "showing the win rates per setting and starting position\n"
+    << "\n"
+    << "Options:\n"
+    << "  --vary NAME=MIN:MAX:N  try N values of a balance parameter, one of:";
+  for (const auto& name: get_balance_parameter_names()) s << ' ' << name;
+  s << "\n"
+    << "  --random N             try N random settings instead of all settings\n"
+    << "  --positions A,B        the starting positions to play from, default all\n"
+    << "\n"
+    << "The number of games is per setting and starting position.\n"
+    << "All options of '--simulate' can be used as well:\n"
+    << get_simulation_usage()
+  ;
+  return s.str();
+}
+
+sweep_options parse_sweep_args(const std::vector<std::string>& args)
+{
+  auto options{get_default_sweep_options()};
+  std::vector<std::string> simulation_args;
+  if (!args.empty()) simulation_args.push_back(args[0]);
+  const int n_args{static_cast<int>(args.size())};
+  for (int i{1}; i < n_args; ++i)
+  {
+    const auto& arg{args[i]};
+    if (arg == "--sweep") continue;
+    if (arg != "--vary" && arg != "--random" && arg != "--positions")
+    {
+      simulation_args.push_back(arg);
+      continue;
+    }
+    if (i + 1 == n_args)
+    {
+      throw std::runtime_error("Missing value for argument '" + arg + "'");
+    }
+    const auto& value{args[++i]};
+    if (arg == "--vary")
+    {
+      options.m_dimensions.push_back(to_sweep_dimension(value));
+    }
+    else if (arg == "--random")
+    {
+      try { options.m_n_samples = std::stoi(value); }
+      catch (const std::logic_error&) { options.m_n_samples = 0; }
+      if (options.m_n_samples < 1)
+      {
+        throw std::runtime_error("Invalid number of random settings '" + value + "'");
+      }
+      options.m_is_random = true;
+    }
+    else
+    {
+      assert(arg == "--positions");
+      options.m_starting_positions.clear();
+      std::stringstream s(value);
+      std::string name;
+      while (std::getline(s, name, ','))
+      {
+        options.m_starting_positions.push_back(to_starting_position_type(name));
+      }
+      if (options.m_starting_positions.empty())
+      {
+        throw std::runtime_error("Invalid starting positions '" + value + "'");
+      }
+    }
+  }
+  options.m_simulation = parse_simulation_args(simulation_args);
+  return options;
+}
+
+std::vector<sweep_row> run_sweep(const sweep_options& options)
+{
+  assert(!options.m_starting_positions.empty());
+  const auto& simulation{options.m_simulation};
+  const auto points{get_sweep_points(options)};
+
+  // All games of all settings are played in one batch,
+  // so that the worker threads are kept busy until the end
+  std::vector<simulation_job> jobs;
+  for (const auto& point: points)
+  {
+    for (const auto position: options.m_starting_positions)
+    {
+      auto game_options{get_game_options(simulation)};
+      game_options.set_starting_position(position);
+      for (std::size_t i{0}; i != point.size(); ++i)
+      {
+        set_balance_parameter(game_options, options.m_dimensions[i].m_name, point[i]);
+      }
+      for (int i{0}; i != simulation.m_n_games; ++i)
+      {
+        const int index{static_cast<int>(jobs.size())};
+        jobs.push_back(
+          simulation_job{
+            game_options,
+            simulation.m_frame_time,
+            index,
+            simulation.m_seed + i,
+            get_default_bot_version(),
+            get_default_bot_version()
+          }
+        );
+      }
+    }
+  }
+  const auto batch{
+    run_batch(jobs, get_n_batch_threads(simulation), simulation.m_chunk_size)
+  };
+
+  std::vector<sweep_row> rows;
+  auto result{std::begin(batch.m_results)};
+  for (const auto& point: points)
+  {
+    for (const auto position: options.m_starting_positions)
+    {
+      sweep_row row{point, position, 0, 0, 0};
+      for (int i{0}; i != simulation.m_n_games; ++i, ++result)
+      {
+        switch (result->m_result)
+        {
+          case game_result::white_wins: ++row.m_n_white_wins; break;
+          case game_result::black_wins: ++row.m_n_black_wins; break;
+          default:
+            assert(result->m_result == game_result::draw);
+            ++row.m_n_draws;
+            break;
+        }
+      }
+      rows.push_back(row);
+    }
+  }
+  assert(result == std::end(batch.m_results));
+  return rows;
+}
+
+void set_balance_parameter(
+  game_options& options,
+  const std::string& name,
+  const double value
+)
+{
+  if (!(value > 0.0))
+  {
+    throw std::runtime_error("Balance parameter '" + name + "' must be positive");
+  }
+  if (name == "damage") return options.set_damage_per_chess_move(value);
+  if (name == "movement_speed") return options.set_movement_speed(value);
+  for (const auto t: get_all_piece_types())
+  {
+    if (name == "health_" + to_str(t)) return options.set_max_health(t, value);
+  }
+  throw std::runtime_error("Unknown balance parameter '" + name + "'");
+}
+
+void show_sweep_results(
+  const sweep_options& options,
+  const std::vector<sweep_row>& rows,
+  std::ostream& os
+)
+{
+  for (const auto& d: options.m_dimensions) os << d.m_name << '\t';
+  os << "position\tgames\twhite_wins\tblack_wins\tdraws\t"
+    << "white_win_rate\tblack_win_rate\tdraw_rate\n"
+  ;
+  for (const auto& row: rows)
+  {
+    assert(row.m_values.size() == options.m_dimensions.size());
+    for (const auto value: row.m_values) os << value << '\t';
+    const int n_games{row.m_n_white_wins + row.m_n_black_wins + row.m_n_draws};
+    assert(n_games > 0);
+    os << to_str(row.m_starting_position) << '\t'
+      << n_games << '\t'
+      << row.m_n_white_wins << '\t'
+      << row.m_n_black_wins << '\t'
+      << row.m_n_draws << '\t'
+      << static_cast<double>(row.m_n_white_wins) / n_games << '\t'
+      << static_cast<double>(row.m_n_black_wins) / n_games << '\t'
+      << static_cast<double>(row.m_n_draws) / n_games << '\n'
+    ;
+  }
+}
+
+void test_balance_sweep()
+{
+#ifndef NDEBUG
+  // set_balance_parameter
+  {
+    auto options{get_default_game_options()};
+    set_balance_parameter(options, "damage", 2.0);
+    assert(options.get_damage_per_chess_move() == 2.0);
+    set_balance_parameter(options, "movement_speed", 0.5);
+    assert(options.get_movement_speed() == 0.5);
+    set_balance_parameter(options, "health_knight", 3.0);
+    assert(options.get_max_health(piece_type::knight) == 3.0);
+    for (const auto& name: get_balance_parameter_names())
+    {
+      set_balance_parameter(options, name, 1.5);
+    }
+    assert(options.get_max_health(piece_type::knight) == 1.5);
+  }
+  // set_balance_parameter, invalid
+  {
+    auto options{get_default_game_options()};
+    for (const auto& p: std::vector<std::pair<std::string, double>>{{"nonsense", 1.0}, {"damage", 0.0}, {"damage", -1.0}})
+    {
+      bool has_thrown{false};
+      try { set_balance_parameter(options, p.first, p.second); } catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // to_sweep_dimension
+  {
+    const auto d{to_sweep_dimension("health_queen=0.5:2:4")};
+    assert(d.m_name == "health_queen");
+    assert(d.m_min == 0.5);
+    assert(d.m_max == 2.0);
+    assert(d.m_n_values == 4);
+    for (const std::string s: {"", "damage", "damage=1:2", "damage=2:1:3", "damage=1:2:0", "nonsense=1:2:3", "damage=0:1:2"})
+    {
+      bool has_thrown{false};
+      try { to_sweep_dimension(s); } catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // get_sweep_points, no dimensions gives the default balance only
+  {
+    const auto points{get_sweep_points(get_default_sweep_options())};
+    assert(points.size() == 1);
+    assert(points[0].empty());
+  }
+  // get_sweep_points, grid
+  {
+    auto options{get_default_sweep_options()};
+    options.m_dimensions.push_back(to_sweep_dimension("damage=1:3:3"));
+    options.m_dimensions.push_back(to_sweep_dimension("movement_speed=0.5:1:2"));
+    const auto points{get_sweep_points(options)};
+    assert(points.size() == 6);
+    assert(points.front() == std::vector<double>({1.0, 0.5}));
+    assert(points[1] == std::vector<double>({1.0, 1.0}));
+    assert(points.back() == std::vector<double>({3.0, 1.0}));
+  }
+  // get_sweep_points, random
+  {
+    auto options{get_default_sweep_options()};
+    options.m_dimensions.push_back(to_sweep_dimension("damage=1:3:3"));
+    options.m_is_random = true;
+    options.m_n_samples = 20;
+    const auto points{get_sweep_points(options)};
+    assert(points.size() == 20);
+    for (const auto& p: points) assert(p[0] >= 1.0 && p[0] <= 3.0);
+    assert(get_sweep_points(options) == points);
+  }
+  // parse_sweep_args
+  {
+    const auto options{
+      parse_sweep_args(
+        {
+          "game", "--sweep", "--vary", "damage=0.5:2:4", "--games", "3",
+          "--positions", "standard,kings_only", "--random", "5", "--threads", "2"
+        }
+      )
+    };
+    assert(options.m_dimensions.size() == 1);
+    assert(options.m_is_random);
+    assert(options.m_n_samples == 5);
+    assert(options.m_starting_positions.size() == 2);
+    assert(options.m_starting_positions[1] == starting_position_type::kings_only);
+    assert(options.m_simulation.m_n_games == 3);
+    assert(options.m_simulation.m_n_threads == 2);
+  }
+  // parse_sweep_args, invalid
+  {
+    const std::vector<std::vector<std::string>> invalids{
+      {"game", "--sweep", "--vary"},
+      {"game", "--sweep", "--vary", "damage"},
+      {"game", "--sweep", "--random", "0"},
+      {"game", "--sweep", "--positions", "nonsense"},
+      {"game", "--sweep", "--games", "0"}
+    };
+    for (const auto& args: invalids)
+    {
+      bool has_thrown{false};
+      try { parse_sweep_args(args); } catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // get_sweep_usage
+  {
+    assert(get_sweep_usage().find("health_queen") != std::string::npos);
+  }
+  // run_sweep
+  {
+    auto options{get_default_sweep_options()};
+    options.m_dimensions.push_back(to_sweep_dimension("damage=0.5:2:2"));
+    options.m_starting_positions = {starting_position_type::kings_only, starting_position_type::standard};
+    options.m_simulation.m_max_game_time = delta_t(1.0);
+    options.m_simulation.m_n_games = 2;
+    options.m_simulation.m_n_threads = 2;
+    const auto rows{run_sweep(options)};
+    assert(rows.size() == 4);
+    assert(rows[0].m_values == std::vector<double>({0.5}));
+    assert(rows[0].m_starting_position == starting_position_type::kings_only);
+    assert(rows[1].m_starting_position == starting_position_type::standard);
+    assert(rows[3].m_values == std::vector<double>({2.0}));
+    for (const auto& row: rows)
+    {
+      assert(row.m_n_white_wins + row.m_n_black_wins + row.m_n_draws == 2);
+    }
+    std::stringstream s;
+    show_sweep_results(options, rows, s);
+    assert(s.str().find("damage\tposition") != std::string::npos);
+    assert(s.str().find("kings_only") != std::string::npos);
+  }
+  // Stronger pieces survive longer
+  {
+    auto options{get_default_game_options()};
+    options.set_max_health(piece_type::king, 2.0);
+    const game g(options);
+    for (const auto& p: g.get_pieces())
+    {
+      if (p.get_type() == piece_type::king) assert(p.get_health() == 2.0);
+    }
+  }
+#endif // NDEBUG
+}
+
+sweep_dimension to_sweep_dimension(const std::string& s)
+{
+  const auto equals{s.find('=')};
+  if (equals == std::string::npos) throw std::runtime_error("Invalid dimension '" + s + "'");
+  sweep_dimension d{s.substr(0, equals), 0.0, 0.0, 0};
+  std::stringstream stream(s.substr(equals + 1));
+  char colon_1{' '};
+  char colon_2{' '};
+  stream >> d.m_min >> colon_1 >> d.m_max >> colon_2 >> d.m_n_values;
+  const auto names{get_balance_parameter_names()};
+  if (!stream
+    || colon_1 != ':'
+    || colon_2 != ':'
+    || !(d.m_min > 0.0)
+    || d.m_max < d.m_min
+    || d.m_n_values < 1
+    || std::find(std::begin(names), std::end(names), d.m_name) == std::end(names)
+  )
+  {
+    throw std::runtime_error("Invalid dimension '" + s + "'");
+  }
+  return d;
+}
@@ -0,0 +1,119 @@
+#ifndef BALANCE_SWEEP_H
+#define BALANCE_SWEEP_H
+
+#include "ccfwd.h"
+#include "game_options.h"
+#include "simulation.h"
+#include "starting_position_type.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// A balance parameter to vary, with the values to try
+struct sweep_dimension
+{
+  /// The name of the parameter
+  /// @see use 'get_balance_parameter_names' for all names
+  std::string m_name;
+
+  /// The lowest value
+  double m_min;
+
+  /// The highest value
+  double m_max;
+
+  /// The number of values in a grid search,
+  /// spread evenly from the lowest to the highest value
+  int m_n_values;
+};
+
+/// The settings of a search for the balance parameters,
+/// that plays games between two bots for each combination of values
+struct sweep_options
+{
+  /// The balance parameters to vary
+  std::vector<sweep_dimension> m_dimensions;
+
+  /// Try random values instead of all values of a grid?
+  bool m_is_random;
+
+  /// The number of random combinations of values to try
+  int m_n_samples;
+
+  /// The starting positions to play each combination of values from
+  std::vector<starting_position_type> m_starting_positions;
+
+  /// The settings of the games played per combination of values
+  /// and starting position. Its starting position is ignored
+  simulation_options m_simulation;
+};
+
+/// The results of the games played for one combination of values
+/// from one starting position
+struct sweep_row
+{
+  /// The value per balance parameter,
+  /// in the same order as the dimensions of the sweep
+  std::vector<double> m_values;
+
+  starting_position_type m_starting_position;
+
+  int m_n_white_wins;
+  int m_n_black_wins;
+  int m_n_draws;
+};
+
+/// Get the names of all balance parameters:
+/// 'damage', 'movement_speed' and 'health_[piece type]', e.g. 'health_queen'
+std::vector<std::string> get_balance_parameter_names();
+
+/// Get the sweep options used when not specified otherwise,
+/// which play from all starting positions with the default balance
+sweep_options get_default_sweep_options();
+
+/// Get the combinations of values to try,
+/// one value per dimension per combination
+std::vector<std::vector<double>> get_sweep_points(const sweep_options& options);
+
+/// Get the help text of the command-line arguments of a sweep
+std::string get_sweep_usage() noexcept;
+
+/// Get the sweep options from the command-line arguments,
+/// e.g. '--sweep --vary damage=0.5:2:4 --vary health_queen=1:3:3 --games 20'.
+/// All arguments of '--simulate' can be used as well.
+/// Will throw if the arguments are invalid
+/// @param args the command-line arguments, the first being the program name
+sweep_options parse_sweep_args(const std::vector<std::string>& args);
+
+/// Play games between two bots for all combinations of values,
+/// from all starting positions, spread over worker threads.
+/// Each combination of values plays the same seeds,
+/// so that differences are due to the balance, not to chance
+std::vector<sweep_row> run_sweep(const sweep_options& options);
+
+/// Set a balance parameter by its name.
+/// Will throw if there is no such parameter or if the value is not positive
+void set_balance_parameter(
+  game_options& options,
+  const std::string& name,
+  const double value
+);
+
+/// Show the win rates per combination of values and starting position,
+/// as a tab-separated table
+void show_sweep_results(
+  const sweep_options& options,
+  const std::vector<sweep_row>& rows,
+  std::ostream& os
+);
+
+/// Test this class and its free functions
+void test_balance_sweep();
+
+/// Get the dimension from its text, e.g. 'damage=0.5:2:4'
+/// being the name, lowest value, highest value and number of values.
+/// Will throw if the text is not a dimension
+sweep_dimension to_sweep_dimension(const std::string& s);
+
+#endif // BALANCE_SWEEP_H
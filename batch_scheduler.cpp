@@ -0,0 +1,310 @@
+#include "batch_scheduler.h"
+
+#include "work_stealing_queue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <thread>
+
+int get_n_batch_threads(const simulation_options& options) noexcept
+{
+  assert(options.m_n_threads >= 0);
+  if (options.m_n_threads > 0) return options.m_n_threads;
+  // Can be zero if the number of cores is unknown
+  const int n_cores{static_cast<int>(std::thread::hardware_concurrency())};
+  return std::max(1, n_cores);
+}
+
+long long get_n_ticks(const batch_result& r) noexcept
+{
+  long long n_ticks{0};
+  for (const auto& s: r.m_worker_stats) n_ticks += s.m_n_ticks;
+  return n_ticks;
+}
+
+batch_result run_batch(const simulation_options& options)
+{
+  return run_batch(
+    create_simulation_jobs(options),
+    get_n_batch_threads(options),
+    options.m_chunk_size
+  );
+}
+
+batch_result run_batch(
+  const std::vector<simulation_job>& jobs,
+  const int n_threads,
+  const int chunk_size,
+  const batch_result_callback& on_result
+)
+{
+  assert(n_threads > 0);
+  assert(chunk_size > 0);
+  const int n_games{static_cast<int>(jobs.size())};
+
+  // Deal the games out to the workers
+  std::vector<work_stealing_queue<batch_task>> queues(n_threads);
+  for (int i{0}; i != n_games; ++i)
+  {
+    queues[i % n_threads].push_bottom(batch_task{i, nullptr});
+  }
+
+  std::atomic<int> n_games_left{n_games};
+  std::vector<batch_worker_stats> stats(n_threads);
+  const auto start{std::chrono::steady_clock::now()};
+  {
+    // The calling thread is worker zero
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads - 1);
+    for (int i{1}; i < n_threads; ++i)
+    {
+      threads.emplace_back(
+        run_batch_worker,
+        i,
+        std::cref(jobs),
+        chunk_size,
+        std::cref(on_result),
+        std::ref(queues),
+        std::ref(n_games_left),
+        std::ref(stats[i])
+      );
+    }
+    run_batch_worker(0, jobs, chunk_size, on_result, queues, n_games_left, stats[0]);
+    for (auto& t: threads) t.join();
+  }
+  const double wall_time{
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+  };
+
+  // Only now the workers are done, their results are collected
+  std::vector<std::pair<int, simulation_result>> indexed_results;
+  indexed_results.reserve(n_games);
+  for (const auto& s: stats)
+  {
+    std::copy(
+      std::begin(s.m_results),
+      std::end(s.m_results),
+      std::back_inserter(indexed_results)
+    );
+  }
+  std::sort(
+    std::begin(indexed_results),
+    std::end(indexed_results),
+    [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; }
+  );
+  assert(n_games_left == 0);
+  assert(static_cast<int>(indexed_results.size()) == n_games);
+  std::vector<simulation_result> results;
+  results.reserve(n_games);
+  for (const auto& p: indexed_results) results.push_back(p.second);
+  return batch_result{results, stats, wall_time};
+}
+
+void run_batch_worker(
+  const int worker_index,
+  const std::vector<simulation_job>& jobs,
+  const int chunk_size,
+  const batch_result_callback& on_result,
+  std::vector<work_stealing_queue<batch_task>>& queues,
+  std::atomic<int>& n_games_left,
+  batch_worker_stats& stats
+)
+{
+  const int n_workers{static_cast<int>(queues.size())};
+  assert(worker_index >= 0);
+  assert(worker_index < n_workers);
+  auto& own_queue{queues[worker_index]};
+  std::mt19937 rng_engine(worker_index);
+  std::uniform_int_distribution<int> victim_distribution(0, n_workers - 1);
+
+  while (n_games_left.load(std::memory_order_acquire) > 0)
+  {
+    std::optional<batch_task> task{own_queue.pop_bottom()};
+    if (!task && n_workers > 1)
+    {
+      // Start at a random other worker,
+      // so that the thieves do not all try the same worker first
+      const int first_victim{victim_distribution(rng_engine)};
+      for (int i{0}; i != n_workers && !task; ++i)
+      {
+        const int victim{(first_victim + i) % n_workers};
+        if (victim == worker_index) continue;
+        task = queues[victim].steal_top();
+      }
+      if (task) ++stats.m_n_steals;
+    }
+    if (!task)
+    {
+      // The games left are being played by other workers.
+      // Only the worker that plays a game puts it back in a queue,
+      // so no game is left to this worker, which stops
+      return;
+    }
+
+    const auto start{std::chrono::steady_clock::now()};
+    if (!task->m_simulation)
+    {
+      const auto& job{jobs[task->m_index]};
+      task->m_simulation = std::make_unique<simulation>(
+        job.m_game_options,
+        job.m_frame_time,
+        job.m_seed,
+        job.m_white_bot,
+        job.m_black_bot
+      );
+    }
+    const int n_ticks_before{task->m_simulation->get_n_ticks()};
+    const bool is_over{task->m_simulation->run(chunk_size)};
+    stats.m_n_ticks += task->m_simulation->get_n_ticks() - n_ticks_before;
+    ++stats.m_n_chunks;
+    if (is_over)
+    {
+      stats.m_results.emplace_back(task->m_index, task->m_simulation->get_result());
+      if (on_result) on_result(task->m_index, stats.m_results.back().second);
+      ++stats.m_n_games;
+      // Free the game on the thread that played it last
+      task->m_simulation.reset();
+      n_games_left.fetch_sub(1, std::memory_order_release);
+    }
+    else
+    {
+      own_queue.push_bottom(std::move(*task));
+    }
+    stats.m_busy_time += std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start
+    ).count();
+  }
+}
+
+void test_batch_scheduler()
+{
+#ifndef NDEBUG
+  // get_n_batch_threads
+  {
+    auto options{get_default_simulation_options()};
+    options.m_n_threads = 3;
+    assert(get_n_batch_threads(options) == 3);
+    options.m_n_threads = 0;
+    assert(get_n_batch_threads(options) >= 1);
+  }
+  // run_batch gives the same results as playing the games one by one,
+  // whatever the number of threads and the chunk size
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(2.0);
+    options.m_n_games = 5;
+    options.m_seed = 11;
+    std::vector<simulation_result> expected;
+    for (int i{0}; i != options.m_n_games; ++i)
+    {
+      expected.push_back(run_simulation(options, options.m_seed + i));
+    }
+    for (const int n_threads: {1, 4})
+    {
+      options.m_n_threads = n_threads;
+      options.m_chunk_size = 16;
+      const auto r{run_batch(options)};
+      assert(static_cast<int>(r.m_results.size()) == options.m_n_games);
+      assert(static_cast<int>(r.m_worker_stats.size()) == n_threads);
+      int n_games{0};
+      long long n_ticks{0};
+      for (int i{0}; i != options.m_n_games; ++i)
+      {
+        assert(r.m_results[i].m_result == expected[i].m_result);
+        assert(r.m_results[i].m_n_ticks == expected[i].m_n_ticks);
+        assert(r.m_results[i].m_time == expected[i].m_time);
+        n_ticks += expected[i].m_n_ticks;
+      }
+      for (const auto& s: r.m_worker_stats) n_games += s.m_n_games;
+      assert(n_games == options.m_n_games);
+      assert(get_n_ticks(r) == n_ticks);
+    }
+  }
+  // The callback is called once per game
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(1.0);
+    options.m_n_games = 4;
+    std::mutex mutex;
+    std::vector<int> indices;
+    const auto r{
+      run_batch(
+        create_simulation_jobs(options),
+        2,
+        options.m_chunk_size,
+        [&mutex, &indices](const int index, const simulation_result& result)
+        {
+          assert(is_over(result.m_result));
+          const std::lock_guard<std::mutex> lock(mutex);
+          indices.push_back(index);
+        }
+      )
+    };
+    std::sort(std::begin(indices), std::end(indices));
+    assert(indices == std::vector<int>({0, 1, 2, 3}));
+  }
+  // More threads than games
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(1.0);
+    options.m_n_games = 1;
+    options.m_n_threads = 3;
+    const auto r{run_batch(options)};
+    assert(r.m_results.size() == 1);
+    assert(is_over(r.m_results[0].m_result));
+  }
+  // A worker stops when there is nothing to play or steal,
+  // even if other workers are still playing games
+  {
+    std::vector<work_stealing_queue<batch_task>> queues(2);
+    std::atomic<int> n_games_left{1};
+    batch_worker_stats stats;
+    run_batch_worker(1, {}, 16, {}, queues, n_games_left, stats);
+    assert(stats.m_n_chunks == 0);
+    assert(n_games_left == 1);
+  }
+  // operator<<
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(1.0);
+    options.m_n_threads = 2;
+    std::stringstream s;
+    s << run_batch(options);
+    assert(s.str().find("games_per_sec") != std::string::npos);
+    assert(s.str().find("worker 1") != std::string::npos);
+  }
+#endif // NDEBUG
+}
+
+std::ostream& operator<<(std::ostream& os, const batch_result& r) noexcept
+{
+  const long long n_ticks{get_n_ticks(r)};
+  const int n_games{static_cast<int>(r.m_results.size())};
+  const double secs{r.m_wall_time};
+  os << "threads: " << r.m_worker_stats.size() << '\n'
+    << "ticks: " << n_ticks << '\n'
+    << "seconds: " << secs << '\n'
+    << "games_per_sec: " << (secs > 0.0 ? n_games / secs : 0.0) << '\n'
+    << "ticks_per_sec: " << (secs > 0.0 ? n_ticks / secs : 0.0) << '\n'
+  ;
+  const int n_workers{static_cast<int>(r.m_worker_stats.size())};
+  for (int i{0}; i != n_workers; ++i)
+  {
+    const auto& s{r.m_worker_stats[i]};
+    os << "worker " << i << ": "
+      << "games: " << s.m_n_games << ", "
+      << "chunks: " << s.m_n_chunks << ", "
+      << "steals: " << s.m_n_steals << ", "
+      << "ticks: " << s.m_n_ticks << ", "
+      << "busy: " << (secs > 0.0 ? 100.0 * s.m_busy_time / secs : 0.0) << "%\n"
+    ;
+  }
+  return os;
+}
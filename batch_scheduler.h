@@ -0,0 +1,122 @@
+#ifndef BATCH_SCHEDULER_H
+#define BATCH_SCHEDULER_H
+
+#include "ccfwd.h"
+#include "simulation.h"
+#include "simulation_job.h"
+
+#include <atomic>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// A game of a batch, played a chunk of ticks at a time
+/// by whichever worker thread takes it
+struct batch_task
+{
+  /// The index of the job in the batch
+  int m_index;
+
+  /// The game, created by the first worker that plays it,
+  /// so that its memory is allocated by that worker's thread
+  std::unique_ptr<simulation> m_simulation;
+};
+
+/// What one worker thread did in a batch.
+/// Each worker only writes to its own statistics,
+/// which are on their own cache line,
+/// so that the workers need no lock and do not slow each other down
+struct alignas(64) batch_worker_stats
+{
+  /// The time spent playing games, in seconds
+  double m_busy_time{0.0};
+
+  /// The number of chunks of ticks played
+  int m_n_chunks{0};
+
+  /// The number of games finished
+  int m_n_games{0};
+
+  /// The number of tasks taken from other workers
+  int m_n_steals{0};
+
+  /// The number of ticks played
+  long long m_n_ticks{0};
+
+  /// The results of the games finished, with the index of each game
+  std::vector<std::pair<int, simulation_result>> m_results;
+};
+
+/// The result of playing a batch of games
+struct batch_result
+{
+  /// The result of each game, in the order of the games
+  std::vector<simulation_result> m_results;
+
+  /// What each worker did
+  std::vector<batch_worker_stats> m_worker_stats;
+
+  /// The time it took to play all games, in seconds
+  double m_wall_time;
+};
+
+/// A function that is called with the index and result of each game
+/// as soon as it is finished.
+/// It is called by the worker threads, possibly at the same time,
+/// so it must be thread-safe
+using batch_result_callback = std::function<void(const int, const simulation_result&)>;
+
+/// Get the number of worker threads to play a batch on
+int get_n_batch_threads(const simulation_options& options) noexcept;
+
+/// Get the total number of ticks played in a batch
+long long get_n_ticks(const batch_result& r) noexcept;
+
+/// Play all games between two bots, as fast as possible,
+/// spread over worker threads.
+/// Each worker has its own queue of games,
+/// of which it plays the game it touched last a chunk of ticks at a time.
+/// A worker without games steals the oldest game of another worker,
+/// starting at a random other worker.
+/// A worker that finds nothing to steal stops, as the games left
+/// are being played by other workers and a game cannot be split.
+/// The results are the same as playing the games one after the other
+/// @see use 'run_simulation' to play one game
+batch_result run_batch(const simulation_options& options);
+
+/// Play the games of the jobs, as fast as possible,
+/// spread over worker threads
+/// @param n_threads the number of worker threads, at least one
+/// @param chunk_size the number of ticks a game is advanced by at a time
+/// @param on_result called when a game is finished, if set
+/// @see use 'run_batch' on simulation options to play a simulation
+batch_result run_batch(
+  const std::vector<simulation_job>& jobs,
+  const int n_threads,
+  const int chunk_size,
+  const batch_result_callback& on_result = {}
+);
+
+/// Play tasks until all games of the batch are finished
+/// or the games left are being played by other workers
+/// @param worker_index the index of the worker and of its own queue
+/// @param chunk_size the number of ticks a game is advanced by at a time
+void run_batch_worker(
+  const int worker_index,
+  const std::vector<simulation_job>& jobs,
+  const int chunk_size,
+  const batch_result_callback& on_result,
+  std::vector<work_stealing_queue<batch_task>>& queues,
+  std::atomic<int>& n_games_left,
+  batch_worker_stats& stats
+);
+
+/// Test this class and its free functions
+void test_batch_scheduler();
+
+/// Show the speed of the batch and how busy each worker was
+std::ostream& operator<<(std::ostream& os, const batch_result& r) noexcept;
+
+#endif // BATCH_SCHEDULER_H
@@ -0,0 +1,90 @@
+#include "benchmark.h"
+
+#include "game.h"
+#include "square.h"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+void benchmark_ticks(std::ostream& os, const int n_ticks)
+{
+  assert(n_ticks > 0);
+  os << "board_size\tfree_movement\tn_pieces\tus_per_tick\tticks_per_sec\n";
+  for (const bool free_movement: { false, true })
+  {
+    for (const int board_size: { 8, 16, 32 })
+    {
+      auto options{get_default_game_options()};
+      options.set_board_size(board_size);
+      options.set_free_movement(free_movement);
+      game g(options);
+      const int n_pieces{static_cast<int>(g.get_pieces().size())};
+      std::chrono::steady_clock::duration t{0};
+      for (int i{0}; i != n_ticks; ++i)
+      {
+        // Giving orders is not part of a tick
+        if (i % 10 == 0) order_idle_pieces_forward(g);
+        clear_piece_messages(g);
+        const auto start{std::chrono::steady_clock::now()};
+        g.tick(delta_t(0.1));
+        t += std::chrono::steady_clock::now() - start;
+      }
+      const double us_per_tick{
+        std::chrono::duration<double, std::micro>(t).count() / n_ticks
+      };
+      os << board_size << '\t'
+        << free_movement << '\t'
+        << n_pieces << '\t'
+        << us_per_tick << '\t'
+        << (1000000.0 / us_per_tick) << '\n'
+      ;
+    }
+  }
+}
+
+void order_idle_pieces_forward(game& g)
+{
+  auto& pieces{g.get_pieces()};
+  for (auto& p: pieces)
+  {
+    if (has_actions(p)) continue;
+    const auto moves{get_possible_moves(pieces, g.get_occupancy(), p)};
+    if (moves.empty()) continue;
+    const auto& to{moves.back()};
+    const auto action_type{
+      is_piece_at(g, to) ? piece_action_type::attack : piece_action_type::move
+    };
+    p.add_action(
+      piece_action(
+        p.get_player(),
+        p.get_type(),
+        action_type,
+        p.get_current_square(),
+        to
+      )
+    );
+  }
+}
+
+void test_benchmark()
+{
+#ifndef NDEBUG
+  // order_idle_pieces_forward
+  {
+    game g;
+    assert(is_idle(g));
+    order_idle_pieces_forward(g);
+    assert(!is_idle(g));
+  }
+  // order_idle_pieces_forward, on a large board
+  {
+    auto options{get_default_game_options()};
+    options.set_board_size(16);
+    game g(options);
+    order_idle_pieces_forward(g);
+    for (int i{0}; i != 100; ++i) g.tick(delta_t(0.1));
+    assert(get_time(g) > delta_t(9.0));
+  }
+#endif // NDEBUG
+}
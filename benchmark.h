@@ -0,0 +1,23 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "ccfwd.h"
+
+#include <iosfwd>
+
+/// Measure how long a game tick takes on the different board sizes,
+/// with and without free movement,
+/// for a large-army match in which all pieces keep moving and attacking.
+/// Run the game with '--benchmark' to see the results.
+/// Use a release build, as the debug asserts dominate the timings
+void benchmark_ticks(std::ostream& os, const int n_ticks = 1000);
+
+/// Let all idle pieces of a game move to, or attack,
+/// the furthest square they can go to,
+/// as is done by the benchmark
+void order_idle_pieces_forward(game& g);
+
+/// Test the benchmark functions
+void test_benchmark();
+
+#endif // BENCHMARK_H
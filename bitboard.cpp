@@ -0,0 +1,195 @@
+#include "bitboard.h"
+
+#include "square.h"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+/// Get the index of the bit that denotes a square
+std::size_t to_index(const square& s) noexcept
+{
+  const int index{(s.get_x() * get_max_board_size()) + s.get_y()};
+  assert(index >= 0);
+  assert(index < get_max_board_size() * get_max_board_size());
+  return static_cast<std::size_t>(index);
+}
+
+bitboard::bitboard()
+  : m_bits{}
+{
+
+}
+
+int count_squares(const bitboard& b) noexcept
+{
+  return static_cast<int>(b.get_bits().count());
+}
+
+bool have_common_squares(const bitboard& a, const bitboard& b) noexcept
+{
+  return (a.get_bits() & b.get_bits()).any();
+}
+
+bool is_empty(const bitboard& b) noexcept
+{
+  return b.get_bits().none();
+}
+
+bool bitboard::is_set(const square& s) const noexcept
+{
+  return m_bits.test(to_index(s));
+}
+
+void bitboard::reset(const square& s) noexcept
+{
+  m_bits.reset(to_index(s));
+}
+
+void bitboard::set(const square& s) noexcept
+{
+  m_bits.set(to_index(s));
+}
+
+void test_bitboard()
+{
+#ifndef NDEBUG
+  // An empty bitboard has no squares
+  {
+    const bitboard b;
+    assert(is_empty(b));
+    assert(count_squares(b) == 0);
+    assert(!b.is_set(square("a1")));
+    assert(!b.is_set(square("h8")));
+  }
+  // bitboard::set and bitboard::reset
+  {
+    bitboard b;
+    b.set(square("e4"));
+    assert(b.is_set(square("e4")));
+    assert(!b.is_set(square("e5")));
+    assert(count_squares(b) == 1);
+    b.set(square("h8"));
+    assert(count_squares(b) == 2);
+    b.reset(square("e4"));
+    assert(!b.is_set(square("e4")));
+    assert(count_squares(b) == 1);
+  }
+  // A bitboard can hold the squares of the largest board
+  {
+    bitboard b;
+    b.set(square("af32"));
+    b.set(square("p16"));
+    assert(b.is_set(square("af32")));
+    assert(!b.is_set(square("ae32")));
+    assert(count_squares(b) == 2);
+    assert(to_squares(b).back() == square(31, 31));
+  }
+  // have_common_squares
+  {
+    bitboard a;
+    a.set(square("a1"));
+    bitboard b;
+    b.set(square("a2"));
+    assert(!have_common_squares(a, b));
+    b.set(square("a1"));
+    assert(have_common_squares(a, b));
+  }
+  // operator| and operator&
+  {
+    bitboard a;
+    a.set(square("a1"));
+    a.set(square("b1"));
+    bitboard b;
+    b.set(square("b1"));
+    b.set(square("c1"));
+    assert(count_squares(a | b) == 3);
+    assert(count_squares(a & b) == 1);
+    assert((a & b).is_set(square("b1")));
+  }
+  // to_squares
+  {
+    bitboard b;
+    b.set(square("a1"));
+    b.set(square("h8"));
+    const auto squares{to_squares(b)};
+    assert(squares.size() == 2);
+    assert(squares[0] == square("a1"));
+    assert(squares[1] == square("h8"));
+  }
+  // operator==
+  {
+    bitboard a;
+    bitboard b;
+    assert(a == b);
+    a.set(square("d4"));
+    assert(a != b);
+  }
+  // operator<<
+  {
+    bitboard b;
+    b.set(square("d4"));
+    std::stringstream s;
+    s << b;
+    assert(!s.str().empty());
+  }
+#endif // NDEBUG
+}
+
+std::vector<square> to_squares(const bitboard& b)
+{
+  std::vector<square> squares;
+  squares.reserve(count_squares(b));
+  const auto& bits{b.get_bits()};
+  const int n_bits{static_cast<int>(bits.size())};
+  for (int index{0}; index != n_bits; ++index)
+  {
+    if (!bits.test(index)) continue;
+    squares.push_back(
+      square(index / get_max_board_size(), index % get_max_board_size())
+    );
+  }
+  return squares;
+}
+
+bool operator==(const bitboard& lhs, const bitboard& rhs) noexcept
+{
+  return lhs.get_bits() == rhs.get_bits();
+}
+
+bool operator!=(const bitboard& lhs, const bitboard& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+bitboard& bitboard::operator|=(const bitboard& rhs) noexcept
+{
+  m_bits |= rhs.m_bits;
+  return *this;
+}
+
+bitboard& bitboard::operator&=(const bitboard& rhs) noexcept
+{
+  m_bits &= rhs.m_bits;
+  return *this;
+}
+
+bitboard operator|(const bitboard& lhs, const bitboard& rhs) noexcept
+{
+  bitboard b{lhs};
+  b |= rhs;
+  return b;
+}
+
+bitboard operator&(const bitboard& lhs, const bitboard& rhs) noexcept
+{
+  bitboard b{lhs};
+  b &= rhs;
+  return b;
+}
+
+std::ostream& operator<<(std::ostream& os, const bitboard& b) noexcept
+{
+  os << to_squares(b);
+  return os;
+}
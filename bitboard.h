@@ -0,0 +1,63 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "ccfwd.h"
+
+#include "square.h"
+
+#include <bitset>
+#include <iosfwd>
+#include <vector>
+
+/// A set of squares, with one bit per square,
+/// which can hold the squares of the largest board
+class bitboard
+{
+public:
+  /// Create an empty bitboard
+  bitboard();
+
+  /// Get the raw bits, where bit 'x * 32 + y' is the square at (x, y)
+  const auto& get_bits() const noexcept { return m_bits; }
+
+  /// Is the square in the set?
+  bool is_set(const square& s) const noexcept;
+
+  /// Remove a square from the set
+  void reset(const square& s) noexcept;
+
+  /// Add a square to the set
+  void set(const square& s) noexcept;
+
+  bitboard& operator|=(const bitboard& rhs) noexcept;
+  bitboard& operator&=(const bitboard& rhs) noexcept;
+
+private:
+
+  /// The bits, where bit 'x * 32 + y' is the square at (x, y)
+  std::bitset<get_max_board_size() * get_max_board_size()> m_bits;
+};
+
+/// Count the number of squares in the set
+int count_squares(const bitboard& b) noexcept;
+
+/// Do the bitboards have at least one square in common?
+bool have_common_squares(const bitboard& a, const bitboard& b) noexcept;
+
+/// Is the set empty?
+bool is_empty(const bitboard& b) noexcept;
+
+/// Test this class and its free functions
+void test_bitboard();
+
+/// Collect all the squares in the set
+std::vector<square> to_squares(const bitboard& b);
+
+bool operator==(const bitboard& lhs, const bitboard& rhs) noexcept;
+bool operator!=(const bitboard& lhs, const bitboard& rhs) noexcept;
+bitboard operator|(const bitboard& lhs, const bitboard& rhs) noexcept;
+bitboard operator&(const bitboard& lhs, const bitboard& rhs) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const bitboard& b) noexcept;
+
+#endif // BITBOARD_H
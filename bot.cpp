@@ -0,0 +1,367 @@
+#include "bot.h"
+
+#include "game.h"
+#include "mcts.h"
+#include "opening_book.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <sstream>
+
+bot::bot(
+  const chess_color color,
+  const unsigned int seed,
+  const delta_t& think_interval
+) : m_color{color},
+    m_mcts_options{get_default_mcts_options()},
+    m_n_orders{0},
+    m_opening_book{nullptr},
+    m_rng_engine(seed),
+    m_search{},
+    m_think_interval{think_interval},
+    m_t_next_think{0.0},
+    m_type{bot_type::aggressive}
+{
+  assert(m_think_interval.get() > 0.0);
+}
+
+bot::bot(
+  const chess_color color,
+  const unsigned int seed,
+  const bot_version& version
+) : bot(color, seed, version.m_think_interval)
+{
+  m_type = version.m_type;
+}
+
+std::vector<macro_action> bot::choose_orders(
+  const game& g,
+  const std::atomic<bool>* stop
+)
+{
+  if (const auto order{choose_opening_book_order(g)}) return { *order };
+  std::vector<macro_action> orders;
+  // The index of the piece ordered by the search, if any
+  int searched_index{-1};
+  if (m_type == bot_type::mcts)
+  {
+    // The search assumes the other pieces act as an aggressive bot,
+    // as it does in its rollouts
+    mcts_searcher s(g, m_color, m_mcts_options, m_rng_engine(), stop);
+    const auto r{s.search()};
+    if (!is_pass(r.m_action))
+    {
+      orders.push_back(r.m_action);
+      searched_index = r.m_action.m_piece_index;
+    }
+  }
+  const auto idle_orders{choose_idle_orders(g, searched_index)};
+  orders.insert(std::end(orders), std::begin(idle_orders), std::end(idle_orders));
+  return orders;
+}
+
+std::vector<macro_action> bot::choose_idle_orders(
+  const game& g,
+  const int searched_index
+)
+{
+  std::vector<macro_action> orders;
+  const int n_pieces{static_cast<int>(g.get_pieces().size())};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    const auto& p{g.get_pieces()[i]};
+    if (p.get_color() != m_color) continue;
+    if (has_actions(p) || i == searched_index) continue;
+    const auto moves{get_possible_moves(g.get_pieces(), g.get_occupancy(), p)};
+    if (moves.empty()) continue;
+    const auto is_occupied{
+      [&g](const auto& s) { return g.get_occupancy().get_index(s) != -1; }
+    };
+    if (m_type == bot_type::random)
+    {
+      std::uniform_int_distribution<int> d(0, static_cast<int>(moves.size()) - 1);
+      const auto& s{moves[d(m_rng_engine)]};
+      orders.push_back(
+        macro_action{
+          i,
+          is_occupied(s) ? piece_action_type::attack : piece_action_type::move,
+          s
+        }
+      );
+      continue;
+    }
+    // Attack an enemy in reach, if any
+    auto there{std::find_if(std::begin(moves), std::end(moves), is_occupied)};
+    if (m_type == bot_type::greedy && there != std::end(moves))
+    {
+      // Attack the most valuable enemy in reach
+      const auto get_value{
+        [&g, is_occupied](const auto& s)
+        {
+          if (!is_occupied(s)) return 0;
+          const auto& target{g.get_pieces()[g.get_occupancy().get_index(s)]};
+          return get_material_value(target.get_type());
+        }
+      };
+      there = std::max_element(
+        std::begin(moves),
+        std::end(moves),
+        [get_value](const auto& lhs, const auto& rhs) { return get_value(lhs) < get_value(rhs); }
+      );
+    }
+    if (there != std::end(moves))
+    {
+      orders.push_back(macro_action{i, piece_action_type::attack, *there});
+      continue;
+    }
+    std::uniform_int_distribution<int> d(0, static_cast<int>(moves.size()) - 1);
+    orders.push_back(macro_action{i, piece_action_type::move, moves[d(m_rng_engine)]});
+  }
+  return orders;
+}
+
+std::optional<macro_action> bot::choose_opening_book_order(const game& g)
+{
+  if (!m_opening_book) return {};
+  const auto p{create_chess_position(g, m_color)};
+  const auto moves{m_opening_book->probe(p)};
+  if (moves.empty()) return {};
+  const auto& m{choose_opening_book_move(moves, m_rng_engine)};
+  const int index{get_index_of_piece_at(g, get_square(p, m.m_from))};
+  if (index == -1) return {};
+  const auto& piece{g.get_pieces()[index]};
+  if (piece.get_color() != m_color || has_actions(piece)) return {};
+  const square to{get_square(p, m.m_to)};
+  const auto targets{get_possible_moves(g.get_pieces(), g.get_occupancy(), piece)};
+  if (std::find(std::begin(targets), std::end(targets), to) == std::end(targets)) return {};
+  return macro_action{
+    index,
+    get_index_of_piece_at(g, to) == -1 ? piece_action_type::move : piece_action_type::attack,
+    to
+  };
+}
+
+void bot::continue_search(game& g)
+{
+  assert(m_search);
+  if (!m_search->search_slice()) return;
+
+  // The search started some ticks ago, so its piece may have been
+  // captured or ordered meanwhile, or have another index by now
+  const auto action{m_search->get_result().m_action};
+  int searched_index{-1};
+  if (!is_pass(action))
+  {
+    const auto& searched_piece{m_search->get_game().get_pieces()[action.m_piece_index]};
+    searched_index = get_index_of_piece_with_id(g, searched_piece.get_id());
+    if (searched_index != -1 && !has_actions(g.get_pieces()[searched_index]))
+    {
+      do_macro_action(g, macro_action{searched_index, action.m_action_type, action.m_to});
+      ++m_n_orders;
+    }
+  }
+  m_search.reset();
+  for (const auto& order: choose_idle_orders(g, searched_index))
+  {
+    do_macro_action(g, order);
+    ++m_n_orders;
+  }
+}
+
+void bot::give_orders(game& g)
+{
+  for (const auto& order: choose_orders(g))
+  {
+    do_macro_action(g, order);
+    ++m_n_orders;
+  }
+}
+
+void bot::play(game& g)
+{
+  if (m_search)
+  {
+    continue_search(g);
+    return;
+  }
+  if (g.get_time() < m_t_next_think) return;
+  m_t_next_think = g.get_time() + m_think_interval;
+  if (const auto order{choose_opening_book_order(g)})
+  {
+    do_macro_action(g, *order);
+    ++m_n_orders;
+    return;
+  }
+  if (m_type == bot_type::mcts && is_sliced(m_mcts_options))
+  {
+    m_search = std::make_unique<mcts_searcher>(g, m_color, m_mcts_options, m_rng_engine());
+    continue_search(g);
+    return;
+  }
+  give_orders(g);
+}
+
+void test_bot()
+{
+#ifndef NDEBUG
+  // Constructor
+  {
+    const bot b(chess_color::white, 42);
+    assert(b.get_color() == chess_color::white);
+    assert(b.get_n_orders() == 0);
+  }
+  // A bot gives orders to its own pieces only
+  {
+    game g;
+    bot b(chess_color::white, 42);
+    b.play(g);
+    assert(b.get_n_orders() > 0);
+    assert(count_piece_actions(g, chess_color::white) > 0);
+    assert(count_piece_actions(g, chess_color::black) == 0);
+  }
+  // A bot chooses orders without giving these
+  {
+    const game g;
+    bot b(chess_color::white, 42);
+    const auto orders{b.choose_orders(g)};
+    assert(!orders.empty());
+    assert(b.get_n_orders() == 0);
+    assert(count_piece_actions(g, chess_color::white) == 0);
+    for (const auto& order: orders)
+    {
+      assert(g.get_pieces()[order.m_piece_index].get_color() == chess_color::white);
+    }
+  }
+  // A bot that searches does so a slice per tick
+  {
+    game g;
+    bot b(chess_color::white, 42, bot_version{bot_type::mcts, delta_t(0.5)});
+    auto options{b.get_mcts_options()};
+    options.m_max_n_iterations = 12;
+    options.m_slice_n_iterations = 5;
+    b.set_mcts_options(options);
+    b.play(g);
+    assert(b.is_searching());
+    assert(b.get_n_orders() == 0);
+    g.tick(delta_t(0.01));
+    b.play(g);
+    assert(b.is_searching());
+    g.tick(delta_t(0.01));
+    b.play(g);
+    assert(!b.is_searching());
+    assert(b.get_n_orders() > 0);
+    assert(count_piece_actions(g, chess_color::white) > 0);
+    assert(count_piece_actions(g, chess_color::black) == 0);
+  }
+  // A bot that searches all at once gives its orders directly
+  {
+    game g;
+    bot b(chess_color::white, 42, bot_version{bot_type::mcts, delta_t(0.5)});
+    auto options{b.get_mcts_options()};
+    options.m_max_n_iterations = 12;
+    options.m_slice_n_iterations = 0;
+    b.set_mcts_options(options);
+    b.play(g);
+    assert(!b.is_searching());
+    assert(b.get_n_orders() > 0);
+  }
+  // A bot only gives orders once per think interval
+  {
+    game g;
+    bot b(chess_color::white, 42, delta_t(1.0));
+    b.play(g);
+    const int n_orders{b.get_n_orders()};
+    g.tick(delta_t(0.5));
+    b.play(g);
+    assert(b.get_n_orders() == n_orders);
+  }
+  // A bot of a version
+  {
+    const bot b(chess_color::black, 42, bot_version{bot_type::greedy, delta_t(0.25)});
+    assert(b.get_color() == chess_color::black);
+    assert(b.get_type() == bot_type::greedy);
+    assert(bot(chess_color::black, 42).get_type() == bot_type::aggressive);
+  }
+  // A greedy bot attacks the most valuable enemy in reach
+  {
+    // The white queen at d1 can attack the black queen at d8
+    // and the black king, that is put at a4
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    auto& black_king{g.get_pieces()[3]};
+    assert(black_king.get_type() == piece_type::king);
+    assert(black_king.get_color() == chess_color::black);
+    black_king.set_current_square(square("a4"));
+    g.tick(delta_t(0.01));
+    bot b(chess_color::white, 42, bot_version{bot_type::greedy, delta_t(0.5)});
+    b.play(g);
+    const auto& white_queen{g.get_pieces()[0]};
+    assert(white_queen.get_type() == piece_type::queen);
+    assert(!white_queen.get_actions().empty());
+    assert(white_queen.get_actions().back().get_action_type() == piece_action_type::attack);
+    assert(white_queen.get_actions().back().get_to() == square("a4"));
+  }
+  // Bots of all types can play a game
+  {
+    for (const auto t: get_all_bot_types())
+    {
+      game g;
+      bot white(chess_color::white, 1, bot_version{t, delta_t(0.5)});
+      bot black(chess_color::black, 2, bot_version{t, delta_t(0.5)});
+      for (int i{0}; i != 100; ++i)
+      {
+        white.play(g);
+        black.play(g);
+        g.tick(delta_t(0.1));
+      }
+      assert(white.get_n_orders() > 0);
+      assert(black.get_n_orders() > 0);
+    }
+  }
+  // Bots with the same seed play the same game
+  {
+    game g1;
+    game g2;
+    bot b1(chess_color::white, 123);
+    bot b2(chess_color::white, 123);
+    for (int i{0}; i != 50; ++i)
+    {
+      b1.play(g1);
+      b2.play(g2);
+      g1.tick(delta_t(0.1));
+      g2.tick(delta_t(0.1));
+    }
+    assert(b1.get_n_orders() == b2.get_n_orders());
+    for (int i{0}; i != static_cast<int>(g1.get_pieces().size()); ++i)
+    {
+      assert(g1.get_pieces()[i].get_current_square() == g2.get_pieces()[i].get_current_square());
+    }
+  }
+  // A bot with an opening book gives the move of the book only
+  {
+    const std::string filename{"test_bot_opening_book.ccob"};
+    std::istringstream pgn("1. e4 e5 *\n");
+    save_opening_book(compile_opening_book(pgn, opening_book_options{2, 1}), filename);
+    const opening_book book(filename);
+    game g;
+    bot white(chess_color::white, 42, bot_version{bot_type::mcts, delta_t(0.5)});
+    white.set_opening_book(&book);
+    assert(white.get_opening_book() == &book);
+    const auto orders{white.choose_orders(g)};
+    assert(orders.size() == 1);
+    assert(orders[0].m_piece_index == get_index_of_piece_at(g, square("e2")));
+    assert(orders[0].m_action_type == piece_action_type::move);
+    assert(orders[0].m_to == square("e4"));
+    white.play(g);
+    assert(white.get_n_orders() == 1);
+    assert(!white.is_searching());
+    assert(has_actions(g.get_pieces()[get_index_of_piece_at(g, square("e2"))]));
+    // Black is not to move in a position of the book
+    bot black(chess_color::black, 42);
+    black.set_opening_book(&book);
+    black.play(g);
+    assert(black.get_n_orders() > 1);
+    std::remove(filename.c_str());
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,141 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include "bot_type.h"
+#include "bot_version.h"
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "delta_t.h"
+#include "macro_action.h"
+#include "mcts.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+/// A computer player, that plays by giving orders directly to its pieces.
+///
+/// Every now and then, the bot gives each of its idle pieces an order,
+/// in the way of its type, e.g. to attack an enemy piece,
+/// if one is in reach, or else to move to a random square it can go to.
+/// The bot is reproducible: with the same seed,
+/// it gives the same orders in the same game.
+/// For a bot that searches, this is because it searches
+/// a fixed number of iterations on one thread.
+///
+/// A bot that searches does so a slice at a time, as set in its options:
+/// a bounded number of iterations or wall-clock time per tick,
+/// continuing at the next tick, and giving its orders when done.
+/// This way, many games with bots can share a few threads,
+/// with each tick taking about as long
+///
+/// A bot with an opening book gives the move of the book instead,
+/// without searching, as long as the position is in the book.
+/// Then it gives that one order only, as in turn-based chess
+class bot
+{
+public:
+  /// @param color the color of the pieces the bot plays with
+  /// @param seed the seed of the random numbers of the bot
+  /// @param think_interval the in-game time between giving orders
+  explicit bot(
+    const chess_color color,
+    const unsigned int seed,
+    const delta_t& think_interval = delta_t(0.5)
+  );
+
+  /// @param color the color of the pieces the bot plays with
+  /// @param seed the seed of the random numbers of the bot
+  /// @param version the type and think interval of the bot
+  explicit bot(
+    const chess_color color,
+    const unsigned int seed,
+    const bot_version& version
+  );
+
+  /// Choose an order for each idle piece, without giving these.
+  /// The orders are chosen from the game as it is now,
+  /// so these are given to the pieces with the same indices.
+  /// @param stop if not null, a search stops as soon as this becomes true
+  std::vector<macro_action> choose_orders(
+    const game& g,
+    const std::atomic<bool>* stop = nullptr
+  );
+
+  auto get_color() const noexcept { return m_color; }
+
+  /// Get the options of the search of a bot that searches
+  const auto& get_mcts_options() const noexcept { return m_mcts_options; }
+
+  /// Get the number of orders given
+  auto get_n_orders() const noexcept { return m_n_orders; }
+
+  /// Get the opening book, which is nullptr if there is none
+  auto get_opening_book() const noexcept { return m_opening_book; }
+
+  /// Get the way the bot chooses its orders
+  auto get_type() const noexcept { return m_type; }
+
+  /// Is the bot searching, i.e. does it continue a search at the next tick?
+  bool is_searching() const noexcept { return static_cast<bool>(m_search); }
+
+  /// Let the bot give orders, if it is time to do so,
+  /// or search a slice further, if it is searching.
+  /// Call this before each tick of the game
+  void play(game& g);
+
+  /// Set the options of the search of a bot that searches
+  void set_mcts_options(const mcts_options& options) noexcept { m_mcts_options = options; }
+
+  /// Set the opening book, which must outlive the bot,
+  /// where nullptr denotes none
+  void set_opening_book(const opening_book* book) noexcept { m_opening_book = book; }
+
+private:
+
+  chess_color m_color;
+
+  mcts_options m_mcts_options;
+
+  /// The number of orders given
+  int m_n_orders;
+
+  const opening_book* m_opening_book;
+
+  std::mt19937 m_rng_engine;
+
+  /// The search that continues at the next tick, if any
+  std::unique_ptr<mcts_searcher> m_search;
+
+  delta_t m_think_interval;
+
+  /// The next in-game time the bot gives orders
+  delta_t m_t_next_think;
+
+  bot_type m_type;
+
+  /// Choose an order for each idle piece, apart from the piece
+  /// with an index, which is ordered by a search
+  std::vector<macro_action> choose_idle_orders(
+    const game& g,
+    const int searched_index
+  );
+
+  /// Choose the order of the move in the opening book, if any.
+  /// There is none if the position is not in the book,
+  /// or the piece cannot do that move right now
+  std::optional<macro_action> choose_opening_book_order(const game& g);
+
+  /// Search a slice further, giving the orders when done
+  void continue_search(game& g);
+
+  /// Give an order to each idle piece
+  void give_orders(game& g);
+};
+
+/// Test this class and its free functions
+void test_bot();
+
+#endif // BOT_H
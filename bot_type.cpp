@@ -0,0 +1,75 @@
+#include "bot_type.h"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<bot_type> get_all_bot_types() noexcept
+{
+  return
+  {
+    bot_type::aggressive,
+    bot_type::greedy,
+    bot_type::mcts,
+    bot_type::random
+  };
+}
+
+void test_bot_type()
+{
+#ifndef NDEBUG
+  // to_str
+  {
+    assert(to_str(bot_type::aggressive) == "aggressive");
+    assert(to_str(bot_type::greedy) == "greedy");
+    assert(to_str(bot_type::mcts) == "mcts");
+    assert(to_str(bot_type::random) == "random");
+  }
+  // to_bot_type
+  {
+    for (const auto t: get_all_bot_types())
+    {
+      assert(to_bot_type(to_str(t)) == t);
+    }
+    bool has_thrown{false};
+    try { to_bot_type("nonsense"); } catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    s << bot_type::greedy;
+    assert(s.str() == "greedy");
+  }
+#endif // NDEBUG
+}
+
+bot_type to_bot_type(const std::string& s)
+{
+  for (const auto t: get_all_bot_types())
+  {
+    if (to_str(t) == s) return t;
+  }
+  throw std::runtime_error("Unknown bot type '" + s + "'");
+}
+
+std::string to_str(const bot_type t) noexcept
+{
+  switch (t)
+  {
+    case bot_type::aggressive: return "aggressive";
+    case bot_type::greedy: return "greedy";
+    case bot_type::mcts: return "mcts";
+    default:
+    case bot_type::random:
+      assert(t == bot_type::random);
+      return "random";
+  }
+}
+
+std::ostream& operator<<(std::ostream& os, const bot_type t) noexcept
+{
+  os << to_str(t);
+  return os;
+}
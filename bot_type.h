@@ -0,0 +1,39 @@
+#ifndef BOT_TYPE_H
+#define BOT_TYPE_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// The way a bot chooses the orders of its idle pieces
+enum class bot_type
+{
+  /// Attack the first enemy in reach, else move to a random square
+  aggressive,
+
+  /// Attack the most valuable enemy in reach, else move to a random square
+  greedy,
+
+  /// Give the order found best by a Monte Carlo tree search,
+  /// then act as an aggressive bot for the other idle pieces
+  mcts,
+
+  /// Move to or attack a random square in reach
+  random
+};
+
+/// Get all the bot types
+std::vector<bot_type> get_all_bot_types() noexcept;
+
+/// Test this class and its free functions
+void test_bot_type();
+
+/// Get the bot type from its name, as shown by 'to_str'.
+/// Will throw if there is no such bot type
+bot_type to_bot_type(const std::string& s);
+
+std::string to_str(const bot_type t) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const bot_type t) noexcept;
+
+#endif // BOT_TYPE_H
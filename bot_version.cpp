@@ -0,0 +1,92 @@
+#include "bot_version.h"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+bot_version get_default_bot_version() noexcept
+{
+  return bot_version{bot_type::aggressive, delta_t(0.5)};
+}
+
+void test_bot_version()
+{
+#ifndef NDEBUG
+  // The default is the bot that the simulations always used
+  {
+    const auto v{get_default_bot_version()};
+    assert(v.m_type == bot_type::aggressive);
+    assert(v.m_think_interval == delta_t(0.5));
+  }
+  // to_str
+  {
+    assert(to_str(bot_version{bot_type::greedy, delta_t(0.25)}) == "greedy:0.25");
+  }
+  // to_bot_version
+  {
+    const bot_version v{bot_type::random, delta_t(0.1)};
+    assert(to_bot_version(to_str(v)) == v);
+    assert(to_bot_version("greedy:2") == bot_version({bot_type::greedy, delta_t(2.0)}));
+    assert(to_bot_version("greedy:2") != v);
+  }
+  // to_bot_version, invalid
+  {
+    for (const std::string s: {"", "greedy", "greedy:", "nonsense:1", "greedy:0", "greedy:-1", "greedy:x"})
+    {
+      bool has_thrown{false};
+      try { to_bot_version(s); } catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    s << get_default_bot_version();
+    assert(s.str() == "aggressive:0.5");
+  }
+#endif // NDEBUG
+}
+
+bot_version to_bot_version(const std::string& s)
+{
+  const auto colon{s.find(':')};
+  if (colon == std::string::npos) throw std::runtime_error("Invalid bot version '" + s + "'");
+  const auto type{to_bot_type(s.substr(0, colon))};
+  double think_interval{0.0};
+  try
+  {
+    think_interval = std::stod(s.substr(colon + 1));
+  }
+  catch (const std::logic_error&)
+  {
+    // Thrown by std::stod
+  }
+  if (!(think_interval > 0.0)) throw std::runtime_error("Invalid bot version '" + s + "'");
+  return bot_version{type, delta_t(think_interval)};
+}
+
+std::string to_str(const bot_version& v)
+{
+  std::stringstream s;
+  s << v.m_type << ':' << v.m_think_interval.get();
+  return s.str();
+}
+
+bool operator==(const bot_version& lhs, const bot_version& rhs) noexcept
+{
+  return lhs.m_type == rhs.m_type
+    && lhs.m_think_interval == rhs.m_think_interval
+  ;
+}
+
+bool operator!=(const bot_version& lhs, const bot_version& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+std::ostream& operator<<(std::ostream& os, const bot_version& v) noexcept
+{
+  os << to_str(v);
+  return os;
+}
@@ -0,0 +1,41 @@
+#ifndef BOT_VERSION_H
+#define BOT_VERSION_H
+
+#include "bot_type.h"
+#include "ccfwd.h"
+#include "delta_t.h"
+
+#include <iosfwd>
+#include <string>
+
+/// A version of a bot, i.e. everything that determines how a bot plays
+/// apart from its random numbers
+struct bot_version
+{
+  /// The way the bot chooses its orders
+  bot_type m_type;
+
+  /// The in-game time between giving orders
+  delta_t m_think_interval;
+};
+
+/// Get the bot version used when not specified otherwise
+bot_version get_default_bot_version() noexcept;
+
+/// Test this class and its free functions
+void test_bot_version();
+
+/// Get the bot version from its name, as shown by 'to_str'.
+/// Will throw if the name is not a bot version
+bot_version to_bot_version(const std::string& s);
+
+/// Get the name of the bot version, e.g. 'greedy:0.5',
+/// being the type and the think interval
+std::string to_str(const bot_version& v);
+
+bool operator==(const bot_version& lhs, const bot_version& rhs) noexcept;
+bool operator!=(const bot_version& lhs, const bot_version& rhs) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const bot_version& v) noexcept;
+
+#endif // BOT_VERSION_H
@@ -2,10 +2,17 @@
 #define CCFWD_H
 
 /// Conquer Chess forward declarations
+class ai_controller;
+class alpha_beta_searcher;
+class bitboard;
+class bot;
 class chess_move;
+class chess_position;
+class collision_grid;
 class control_actions;
 class control_action;
 class delta_t;
+class flow_field;
 class game_coordinat;
 class game;
 class game_options;
@@ -14,7 +21,12 @@ class game_resources;
 class game_view;
 class game_view_layout;
 class id;
+class influence_map;
+class latency_histogram;
+class latency_tracker;
 class layout;
+class mapped_file;
+class mcts_searcher;
 class menu_view;
 class menu_view_layout;
 class options_view;
@@ -23,12 +35,28 @@ class piece_action;
 class piece;
 class replay;
 class replayer;
+class route_planner;
+class scheduled_order;
 class screen_coordinat;
 class screen_rect;
+class selection;
+class simulation;
 class square;
 class message;
+class nnue_accumulator;
+class nnue_network;
+class occupancy_grid;
+class opening_book;
 class sound_effects;
+template <class T> class spsc_queue;
+class tablebase;
+class tcp_listener;
+class tcp_socket;
 class textures;
+class timing_wheel;
+class transposition_table;
+class visibility;
 class volume;
+template <class T> class work_stealing_queue;
 
 #endif // CCFWD_H
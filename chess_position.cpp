@@ -0,0 +1,477 @@
+#include "chess_position.h"
+
+#include "game.h"
+#include "pieces.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <tuple>
+
+chess_position::chess_position(
+  const std::vector<piece>& pieces,
+  const chess_color color_to_move,
+  const int board_size
+) : m_board(board_size * board_size, 0),
+    m_board_size{board_size},
+    m_color_to_move{color_to_move},
+    m_hash{0},
+    m_n_kings{0, 0},
+    m_white_pawn_dx{1}
+{
+  assert(board_size > 0);
+  assert(board_size <= get_max_board_size());
+  for (const auto& p: pieces)
+  {
+    const int code{
+      (static_cast<int>(p.get_type()) + 1) * (p.get_color() == chess_color::white ? 1 : -1)
+    };
+    const int index{get_square_index(*this, p.get_current_square())};
+    assert(m_board[index] == 0);
+    m_board[index] = static_cast<std::int8_t>(code);
+    if (p.get_type() == piece_type::king) ++m_n_kings[static_cast<int>(p.get_color())];
+    if (p.get_type() == piece_type::pawn)
+    {
+      // The pawns of white move the other way than those of black
+      const bool is_lhs{p.get_player() == side::lhs};
+      const bool is_white{p.get_color() == chess_color::white};
+      m_white_pawn_dx = is_lhs == is_white ? 1 : -1;
+    }
+  }
+  m_hash = calc_hash(*this);
+}
+
+chess_position::chess_position(
+  const std::vector<std::int8_t>& board,
+  const chess_color color_to_move,
+  const int board_size
+) : m_board(board),
+    m_board_size{board_size},
+    m_color_to_move{color_to_move},
+    m_hash{0},
+    m_n_kings{0, 0},
+    m_white_pawn_dx{1}
+{
+  assert(board_size > 0);
+  assert(board_size <= get_max_board_size());
+  assert(static_cast<int>(m_board.size()) == board_size * board_size);
+  for (const int code: m_board)
+  {
+    if (code == 0 || get_piece_type(code) != piece_type::king) continue;
+    ++m_n_kings[static_cast<int>(get_piece_color(code))];
+  }
+  m_hash = calc_hash(*this);
+}
+
+void chess_position::add_pawn_moves(std::vector<position_move>& moves, const int from) const
+{
+  const int code{m_board[from]};
+  const int dx{code > 0 ? m_white_pawn_dx : -m_white_pawn_dx};
+  const int x{from / m_board_size};
+  const int y{from % m_board_size};
+
+  // Attack diagonally forward
+  for (const int dy: {-1, 1})
+  {
+    const int new_x{x + dx};
+    const int new_y{y + dy};
+    if (!is_valid_square_xy(new_x, new_y, m_board_size)) continue;
+    const int to{(new_x * m_board_size) + new_y};
+    if (m_board[to] != 0 && (m_board[to] > 0) != (code > 0))
+    {
+      moves.push_back(position_move{static_cast<std::int16_t>(from), static_cast<std::int16_t>(to), m_board[to]});
+    }
+  }
+  // Move forward until a piece
+  for (int new_x{x + dx}; new_x >= 0 && new_x < m_board_size; new_x += dx)
+  {
+    const int to{(new_x * m_board_size) + y};
+    if (m_board[to] != 0) break;
+    moves.push_back(position_move{static_cast<std::int16_t>(from), static_cast<std::int16_t>(to), 0});
+  }
+}
+
+void chess_position::add_ray_moves(
+  std::vector<position_move>& moves,
+  const int from,
+  const std::vector<std::pair<int, int>>& deltas,
+  const int max_n_steps
+) const
+{
+  const bool is_white{m_board[from] > 0};
+  const int x{from / m_board_size};
+  const int y{from % m_board_size};
+  for (const auto& d: deltas)
+  {
+    for (int step{1}; step <= max_n_steps; ++step)
+    {
+      const int new_x{x + (d.first * step)};
+      const int new_y{y + (d.second * step)};
+      if (!is_valid_square_xy(new_x, new_y, m_board_size)) break;
+      const int to{(new_x * m_board_size) + new_y};
+      const int there{m_board[to]};
+      if (there != 0 && (there > 0) == is_white) break;
+      moves.push_back(
+        position_move{static_cast<std::int16_t>(from), static_cast<std::int16_t>(to), static_cast<std::int8_t>(there)}
+      );
+    }
+  }
+}
+
+std::uint64_t calc_hash(const chess_position& p) noexcept
+{
+  std::uint64_t hash{0};
+  const int n_squares{p.get_board_size() * p.get_board_size()};
+  for (int i{0}; i != n_squares; ++i)
+  {
+    const int code{p.get_at(i)};
+    if (code == 0) continue;
+    hash ^= get_zobrist_key(get_piece_color(code), get_piece_type(code), i);
+  }
+  if (p.get_color_to_move() == chess_color::black) hash ^= get_zobrist_black_to_move_key();
+  return hash;
+}
+
+chess_position create_chess_position(const game& g, const chess_color color_to_move)
+{
+  return chess_position(g.get_pieces(), color_to_move, get_board_size(g.get_options()));
+}
+
+chess_position create_chess_position(const starting_position_type t)
+{
+  return create_chess_position(get_game_with_starting_position(t), chess_color::white);
+}
+
+void chess_position::do_move(const position_move& m) noexcept
+{
+  const int code{m_board[m.m_from]};
+  assert(code != 0);
+  assert(m_board[m.m_to] == m.m_captured);
+  const chess_color color{get_piece_color(code)};
+  const piece_type type{get_piece_type(code)};
+  m_hash ^= get_zobrist_key(color, type, m.m_from);
+  m_hash ^= get_zobrist_key(color, type, m.m_to);
+  if (m.m_captured != 0)
+  {
+    const auto captured_type{get_piece_type(m.m_captured)};
+    m_hash ^= get_zobrist_key(get_piece_color(m.m_captured), captured_type, m.m_to);
+    if (captured_type == piece_type::king) --m_n_kings[static_cast<int>(get_piece_color(m.m_captured))];
+  }
+  m_hash ^= get_zobrist_black_to_move_key();
+  m_board[m.m_to] = m_board[m.m_from];
+  m_board[m.m_from] = 0;
+  m_color_to_move = get_other_color(m_color_to_move);
+}
+
+void chess_position::get_moves(std::vector<position_move>& moves) const
+{
+  static const std::vector<std::pair<int, int>> straight{{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+  static const std::vector<std::pair<int, int>> diagonal{{1, -1}, {1, 1}, {-1, 1}, {-1, -1}};
+  static const std::vector<std::pair<int, int>> all{
+    {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
+  };
+  static const std::vector<std::pair<int, int>> knight{
+    {1, -2}, {2, -1}, {2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}
+  };
+  const bool is_white{m_color_to_move == chess_color::white};
+  const int n_squares{m_board_size * m_board_size};
+  for (int i{0}; i != n_squares; ++i)
+  {
+    const int code{m_board[i]};
+    if (code == 0 || (code > 0) != is_white) continue;
+    switch (get_piece_type(code))
+    {
+      case piece_type::bishop: add_ray_moves(moves, i, diagonal, m_board_size); break;
+      case piece_type::king: add_ray_moves(moves, i, all, 1); break;
+      // As in the game, a knight can jump up to three times in a row
+      case piece_type::knight: add_ray_moves(moves, i, knight, 3); break;
+      case piece_type::pawn: add_pawn_moves(moves, i); break;
+      case piece_type::queen: add_ray_moves(moves, i, all, m_board_size); break;
+      default:
+      case piece_type::rook:
+        assert(get_piece_type(code) == piece_type::rook);
+        add_ray_moves(moves, i, straight, m_board_size);
+        break;
+    }
+  }
+}
+
+chess_color get_piece_color(const int code) noexcept
+{
+  assert(code != 0);
+  return code > 0 ? chess_color::white : chess_color::black;
+}
+
+piece_type get_piece_type(const int code) noexcept
+{
+  assert(code != 0);
+  return static_cast<piece_type>(std::abs(code) - 1);
+}
+
+game_result get_result(const chess_position& p) noexcept
+{
+  const bool has_white_king{p.get_n_kings(chess_color::white) > 0};
+  const bool has_black_king{p.get_n_kings(chess_color::black) > 0};
+  if (has_white_king && has_black_king) return game_result::undecided;
+  if (has_white_king) return game_result::white_wins;
+  if (has_black_king) return game_result::black_wins;
+  return game_result::draw;
+}
+
+square get_square(const chess_position& p, const int index)
+{
+  return square(index / p.get_board_size(), index % p.get_board_size());
+}
+
+int get_square_index(const chess_position& p, const square& s) noexcept
+{
+  return (s.get_x() * p.get_board_size()) + s.get_y();
+}
+
+const std::vector<std::uint64_t>& get_zobrist_keys() noexcept
+{
+  static const std::vector<std::uint64_t> keys{
+    []()
+    {
+      const int n_squares{get_max_board_size() * get_max_board_size()};
+      std::vector<std::uint64_t> v(2 * 6 * n_squares + 1);
+      std::mt19937_64 rng_engine(20220731);
+      for (auto& k: v) k = rng_engine();
+      return v;
+    }()
+  };
+  return keys;
+}
+
+std::uint64_t get_zobrist_key(
+  const chess_color color,
+  const piece_type type,
+  const int square_index
+) noexcept
+{
+  const int n_squares{get_max_board_size() * get_max_board_size()};
+  assert(square_index >= 0 && square_index < n_squares);
+  const int index{
+    (((static_cast<int>(color) * 6) + static_cast<int>(type)) * n_squares) + square_index
+  };
+  return get_zobrist_keys()[index];
+}
+
+std::uint64_t get_zobrist_black_to_move_key() noexcept
+{
+  return get_zobrist_keys().back();
+}
+
+void test_chess_position()
+{
+#ifndef NDEBUG
+  // A position from a board is the same as from the pieces
+  {
+    const auto p{create_chess_position(starting_position_type::queen_end_game)};
+    std::vector<std::int8_t> board;
+    for (int i{0}; i != p.get_board_size() * p.get_board_size(); ++i)
+    {
+      board.push_back(p.get_at(i));
+    }
+    const chess_position q(board, chess_color::white, p.get_board_size());
+    assert(q.get_hash() == p.get_hash());
+    assert(q.get_n_kings(chess_color::white) == 1);
+    assert(q.get_n_kings(chess_color::black) == 1);
+    std::vector<position_move> p_moves;
+    std::vector<position_move> q_moves;
+    p.get_moves(p_moves);
+    q.get_moves(q_moves);
+    assert(p_moves == q_moves);
+  }
+  // The pieces of the standard starting position
+  {
+    const auto p{create_chess_position(starting_position_type::standard)};
+    assert(p.get_board_size() == 8);
+    assert(p.get_color_to_move() == chess_color::white);
+    assert(p.get_n_kings(chess_color::white) == 1);
+    assert(p.get_n_kings(chess_color::black) == 1);
+    assert(get_result(p) == game_result::undecided);
+    const int e1{get_square_index(p, square("e1"))};
+    assert(get_piece_type(p.get_at(e1)) == piece_type::king);
+    assert(get_piece_color(p.get_at(e1)) == chess_color::white);
+    assert(p.get_at(get_square_index(p, square("e4"))) == 0);
+    assert(get_square(p, e1) == square("e1"));
+  }
+  // The moves are those of 'get_possible_moves', for all starting positions
+  {
+    for (const auto t: get_all_starting_position_types())
+    {
+      const auto g{get_game_with_starting_position(t)};
+      for (const auto color: get_all_chess_colors())
+      {
+        const auto p{create_chess_position(g, color)};
+        std::vector<position_move> moves;
+        p.get_moves(moves);
+        std::vector<std::pair<square, square>> actual;
+        for (const auto& m: moves)
+        {
+          actual.push_back(std::make_pair(get_square(p, m.m_from), get_square(p, m.m_to)));
+        }
+        std::vector<std::pair<square, square>> expected;
+        for (const auto& piece: g.get_pieces())
+        {
+          if (piece.get_color() != color) continue;
+          for (const auto& s: get_possible_moves(g.get_pieces(), piece))
+          {
+            expected.push_back(std::make_pair(piece.get_current_square(), s));
+          }
+        }
+        const auto less{
+          [](const auto& lhs, const auto& rhs)
+          {
+            return std::make_tuple(lhs.first.get_x(), lhs.first.get_y(), lhs.second.get_x(), lhs.second.get_y())
+              < std::make_tuple(rhs.first.get_x(), rhs.first.get_y(), rhs.second.get_x(), rhs.second.get_y());
+          }
+        };
+        std::sort(std::begin(actual), std::end(actual), less);
+        std::sort(std::begin(expected), std::end(expected), less);
+        assert(actual == expected);
+      }
+    }
+  }
+  // Doing and undoing moves keeps the hash up to date
+  {
+    auto p{create_chess_position(starting_position_type::standard)};
+    const auto start_hash{p.get_hash()};
+    assert(start_hash == calc_hash(p));
+    std::mt19937 rng_engine(42);
+    std::vector<position_move> done;
+    for (int i{0}; i != 40 && get_result(p) == game_result::undecided; ++i)
+    {
+      std::vector<position_move> moves;
+      p.get_moves(moves);
+      if (moves.empty()) break;
+      std::uniform_int_distribution<int> d(0, static_cast<int>(moves.size()) - 1);
+      const auto m{moves[d(rng_engine)]};
+      p.do_move(m);
+      done.push_back(m);
+      assert(p.get_hash() == calc_hash(p));
+    }
+    assert(!done.empty());
+    while (!done.empty())
+    {
+      p.undo_move(done.back());
+      done.pop_back();
+      assert(p.get_hash() == calc_hash(p));
+    }
+    assert(p.get_hash() == start_hash);
+    assert(p.get_color_to_move() == chess_color::white);
+  }
+  // The same position by another move order has the same hash
+  {
+    auto a{create_chess_position(starting_position_type::standard)};
+    auto b{a};
+    const auto move{
+      [](chess_position& p, const std::string& from, const std::string& to)
+      {
+        p.do_move(
+          position_move{
+            static_cast<std::int16_t>(get_square_index(p, square(from))),
+            static_cast<std::int16_t>(get_square_index(p, square(to))),
+            0
+          }
+        );
+      }
+    };
+    move(a, "b1", "c3");
+    move(a, "b8", "c6");
+    move(a, "g1", "f3");
+    move(b, "g1", "f3");
+    move(b, "b8", "c6");
+    move(b, "b1", "c3");
+    assert(a.get_hash() == b.get_hash());
+    move(a, "c6", "b8");
+    assert(a.get_hash() != b.get_hash());
+  }
+  // Capturing the king wins
+  {
+    auto g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("a4"));
+    auto p{create_chess_position(g, chess_color::white)};
+    const position_move m{
+      static_cast<std::int16_t>(get_square_index(p, square("d1"))),
+      static_cast<std::int16_t>(get_square_index(p, square("a4"))),
+      p.get_at(get_square_index(p, square("a4")))
+    };
+    assert(get_piece_type(m.m_captured) == piece_type::king);
+    assert(to_str(p, m) == "d1xa4");
+    p.do_move(m);
+    assert(get_result(p) == game_result::white_wins);
+    p.undo_move(m);
+    assert(get_result(p) == game_result::undecided);
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    s << create_chess_position(starting_position_type::standard);
+    assert(!s.str().empty());
+  }
+#endif // NDEBUG
+}
+
+std::string to_str(const chess_position& p, const position_move& m)
+{
+  return to_str(get_square(p, m.m_from))
+    + (m.m_captured == 0 ? "" : "x")
+    + to_str(get_square(p, m.m_to))
+  ;
+}
+
+void chess_position::undo_move(const position_move& m) noexcept
+{
+  const int code{m_board[m.m_to]};
+  assert(code != 0);
+  assert(m_board[m.m_from] == 0);
+  const chess_color color{get_piece_color(code)};
+  const piece_type type{get_piece_type(code)};
+  m_hash ^= get_zobrist_key(color, type, m.m_to);
+  m_hash ^= get_zobrist_key(color, type, m.m_from);
+  if (m.m_captured != 0)
+  {
+    const auto captured_type{get_piece_type(m.m_captured)};
+    m_hash ^= get_zobrist_key(get_piece_color(m.m_captured), captured_type, m.m_to);
+    if (captured_type == piece_type::king) ++m_n_kings[static_cast<int>(get_piece_color(m.m_captured))];
+  }
+  m_hash ^= get_zobrist_black_to_move_key();
+  m_board[m.m_from] = m_board[m.m_to];
+  m_board[m.m_to] = m.m_captured;
+  m_color_to_move = get_other_color(m_color_to_move);
+}
+
+bool operator==(const position_move& lhs, const position_move& rhs) noexcept
+{
+  return lhs.m_from == rhs.m_from
+    && lhs.m_to == rhs.m_to
+    && lhs.m_captured == rhs.m_captured
+  ;
+}
+
+std::ostream& operator<<(std::ostream& os, const chess_position& p) noexcept
+{
+  // As the board is shown in the game, with x going down
+  for (int x{0}; x != p.get_board_size(); ++x)
+  {
+    for (int y{0}; y != p.get_board_size(); ++y)
+    {
+      const int code{p.get_at((x * p.get_board_size()) + y)};
+      if (code == 0)
+      {
+        os << '.';
+        continue;
+      }
+      const char c{"bknpqr"[static_cast<int>(get_piece_type(code))]};
+      os << static_cast<char>(code > 0 ? std::toupper(c) : c);
+    }
+    os << '\n';
+  }
+  os << to_str(p.get_color_to_move()) << " to move";
+  return os;
+}
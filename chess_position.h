@@ -0,0 +1,169 @@
+#ifndef CHESS_POSITION_H
+#define CHESS_POSITION_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "game_result.h"
+#include "piece_type.h"
+#include "square.h"
+#include "starting_position_type.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// A move in a chess position, from one square to another,
+/// where the squares are indices on the board
+struct position_move
+{
+  /// The index of the square moved from
+  std::int16_t m_from;
+
+  /// The index of the square moved to
+  std::int16_t m_to;
+
+  /// The piece captured, as stored on the board, where zero denotes none
+  std::int8_t m_captured;
+};
+
+/// A position of the pieces on the board, with the player to move,
+/// as in turn-based chess.
+///
+/// The pieces move as in the game, as given by 'get_possible_moves',
+/// yet one piece at a time, instantly, and a piece moved to an enemy
+/// captures it. A player whose king is captured has lost.
+/// The position has a Zobrist hash, that is updated with each move
+class chess_position
+{
+public:
+  /// @param pieces the pieces, of which only type, color, square and
+  ///   the side of the pawns of white are used
+  /// @param color_to_move the color of the player to move
+  /// @param board_size the number of squares along one side of the board
+  explicit chess_position(
+    const std::vector<piece>& pieces,
+    const chess_color color_to_move,
+    const int board_size = get_default_board_size()
+  );
+
+  /// @param board the piece per square index, as returned by 'get_at'.
+  ///   Pawns of white move along the increasing x axis
+  /// @param color_to_move the color of the player to move
+  /// @param board_size the number of squares along one side of the board
+  explicit chess_position(
+    const std::vector<std::int8_t>& board,
+    const chess_color color_to_move,
+    const int board_size
+  );
+
+  /// Do a move, which must be one of 'get_moves'
+  void do_move(const position_move& m) noexcept;
+
+  /// Get the piece on the square with an index, as stored on the board:
+  /// zero if empty, else one more than the piece type,
+  /// negative for a black piece
+  auto get_at(const int index) const noexcept { return m_board[index]; }
+
+  /// Get the pieces per square index, as returned by 'get_at'
+  const auto& get_board() const noexcept { return m_board; }
+
+  auto get_board_size() const noexcept { return m_board_size; }
+
+  auto get_color_to_move() const noexcept { return m_color_to_move; }
+
+  /// Get the Zobrist hash of the position
+  auto get_hash() const noexcept { return m_hash; }
+
+  /// Get all moves of the player to move, appended to 'moves'
+  void get_moves(std::vector<position_move>& moves) const;
+
+  /// Count the number of kings of a player, usually one
+  int get_n_kings(const chess_color c) const noexcept { return m_n_kings[static_cast<int>(c)]; }
+
+  /// Undo the last move done
+  void undo_move(const position_move& m) noexcept;
+
+private:
+
+  /// The pieces, as returned by 'get_at', per square index
+  std::vector<std::int8_t> m_board;
+
+  int m_board_size;
+
+  chess_color m_color_to_move;
+
+  std::uint64_t m_hash;
+
+  /// The number of kings per color
+  int m_n_kings[2];
+
+  /// The direction pawns of white move in along the x axis, 1 or -1
+  int m_white_pawn_dx;
+
+  /// Append the moves of a piece that moves along rays,
+  /// for at most a number of steps.
+  /// It passes enemy pieces, capturing any of these,
+  /// but stops before a piece of its own color
+  void add_ray_moves(
+    std::vector<position_move>& moves,
+    const int from,
+    const std::vector<std::pair<int, int>>& deltas,
+    const int max_n_steps
+  ) const;
+
+  /// Append the moves of a pawn
+  void add_pawn_moves(std::vector<position_move>& moves, const int from) const;
+};
+
+/// Calculate the Zobrist hash of a position from scratch
+std::uint64_t calc_hash(const chess_position& p) noexcept;
+
+/// Create the position of the pieces of a game, with a player to move
+chess_position create_chess_position(const game& g, const chess_color color_to_move);
+
+/// Create the position of a starting position, with white to move
+chess_position create_chess_position(const starting_position_type t);
+
+/// Get the color of a piece as stored on the board
+chess_color get_piece_color(const int code) noexcept;
+
+/// Get the type of a piece as stored on the board
+piece_type get_piece_type(const int code) noexcept;
+
+/// Get the result: one player wins if the other has no king left
+game_result get_result(const chess_position& p) noexcept;
+
+/// Get the square of a square index of a position
+square get_square(const chess_position& p, const int index);
+
+/// Get the square index of a square of a position
+int get_square_index(const chess_position& p, const square& s) noexcept;
+
+/// Get the Zobrist key of a piece on a square,
+/// which are the same for all positions
+std::uint64_t get_zobrist_key(
+  const chess_color color,
+  const piece_type type,
+  const int square_index
+) noexcept;
+
+/// Get all Zobrist keys: one per color, piece type and square
+/// of the largest board, followed by the key of black to move.
+/// These are random, yet the same in each run
+const std::vector<std::uint64_t>& get_zobrist_keys() noexcept;
+
+/// Get the Zobrist key that is added when black is to move
+std::uint64_t get_zobrist_black_to_move_key() noexcept;
+
+/// Test this class and its free functions
+void test_chess_position();
+
+/// Get the move as text, e.g. 'd1xa4' or 'e2e4'
+std::string to_str(const chess_position& p, const position_move& m);
+
+bool operator==(const position_move& lhs, const position_move& rhs) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const chess_position& p) noexcept;
+
+#endif // CHESS_POSITION_H
@@ -0,0 +1,181 @@
+#include "collision_grid.h"
+
+#include "piece.h"
+
+#include <algorithm>
+#include <cassert>
+
+collision_grid::collision_grid(const int board_size)
+  : m_board_size{board_size},
+    m_cells(board_size * board_size)
+{
+  assert(m_board_size > 0);
+  assert(m_board_size <= get_max_board_size());
+}
+
+int count_bodies(const collision_grid& g) noexcept
+{
+  int n{0};
+  const int board_size{g.get_board_size()};
+  for (int x{0}; x != board_size; ++x)
+  {
+    for (int y{0}; y != board_size; ++y)
+    {
+      n += static_cast<int>(g.get_indices(x, y).size());
+    }
+  }
+  return n;
+}
+
+std::vector<int>& collision_grid::get_cell(const game_coordinat& c) noexcept
+{
+  const square s(c);
+  assert(is_valid_square_xy(s.get_x(), s.get_y(), m_board_size));
+  return m_cells[(s.get_x() * m_board_size) + s.get_y()];
+}
+
+const std::vector<int>& collision_grid::get_indices(const int x, const int y) const noexcept
+{
+  assert(is_valid_square_xy(x, y, m_board_size));
+  return m_cells[(x * m_board_size) + y];
+}
+
+bool has_body(const piece& p) noexcept
+{
+  if (p.get_type() != piece_type::knight) return true;
+  return p.get_actions().empty()
+    || p.get_actions()[0].get_action_type() != piece_action_type::move
+  ;
+}
+
+bool is_blocked(
+  const collision_grid& grid,
+  const std::vector<piece>& pieces,
+  const piece& p,
+  const game_coordinat& from,
+  const game_coordinat& to
+)
+{
+  if (!has_body(p)) return false;
+  const square s(to);
+  for (int dx{-1}; dx != 2; ++dx)
+  {
+    for (int dy{-1}; dy != 2; ++dy)
+    {
+      const int x{s.get_x() + dx};
+      const int y{s.get_y() + dy};
+      if (!is_valid_square_xy(x, y, grid.get_board_size())) continue;
+      for (const int index: grid.get_indices(x, y))
+      {
+        const auto& other{pieces[index]};
+        if (other.get_id() == p.get_id()) continue;
+        if (!has_body(other)) continue;
+        const auto there{other.get_coordinat()};
+        const double distance{calc_distance(to, there)};
+        if (distance >= get_body_separation()) continue;
+        if (distance < calc_distance(from, there)) return true;
+      }
+    }
+  }
+  return false;
+}
+
+void collision_grid::move(
+  const int index,
+  const game_coordinat& from,
+  const game_coordinat& to
+)
+{
+  if (square(from) == square(to)) return;
+  auto& cell_from{get_cell(from)};
+  const auto there{std::find(std::begin(cell_from), std::end(cell_from), index)};
+  assert(there != std::end(cell_from));
+  cell_from.erase(there);
+  get_cell(to).push_back(index);
+}
+
+void collision_grid::update(const std::vector<piece>& pieces)
+{
+  // Keep the memory of the cells
+  for (auto& cell: m_cells) cell.clear();
+  const int n_pieces{static_cast<int>(pieces.size())};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    get_cell(pieces[i].get_coordinat()).push_back(i);
+  }
+}
+
+void test_collision_grid()
+{
+#ifndef NDEBUG
+  // An empty grid has no bodies
+  {
+    const collision_grid g;
+    assert(g.get_board_size() == 8);
+    assert(count_bodies(g) == 0);
+  }
+  // collision_grid::update puts each piece in the cell of its center
+  {
+    const std::vector<piece> pieces{
+      piece(chess_color::white, piece_type::rook, square("e4"), side::lhs),
+      piece(chess_color::black, piece_type::rook, square("e6"), side::rhs)
+    };
+    collision_grid g;
+    g.update(pieces);
+    assert(count_bodies(g) == 2);
+    assert(g.get_indices(3, 4).size() == 1);
+    assert(g.get_indices(3, 4)[0] == 0);
+    assert(g.get_indices(5, 4)[0] == 1);
+  }
+  // collision_grid::move only does something when changing cell
+  {
+    const std::vector<piece> pieces{
+      piece(chess_color::white, piece_type::rook, square("e4"), side::lhs)
+    };
+    collision_grid g;
+    g.update(pieces);
+    g.move(0, game_coordinat(3.5, 4.5), game_coordinat(3.9, 4.5));
+    assert(g.get_indices(3, 4).size() == 1);
+    g.move(0, game_coordinat(3.9, 4.5), game_coordinat(4.1, 4.5));
+    assert(g.get_indices(3, 4).empty());
+    assert(g.get_indices(4, 4).size() == 1);
+    assert(count_bodies(g) == 1);
+  }
+  // collision_grid on a large board
+  {
+    const std::vector<piece> pieces{
+      piece(chess_color::white, piece_type::rook, square("af32"), side::lhs)
+    };
+    collision_grid g(32);
+    g.update(pieces);
+    assert(g.get_indices(31, 31).size() == 1);
+  }
+  // has_body, a jumping knight has no body
+  {
+    auto knight{get_test_white_knight()};
+    assert(has_body(knight));
+    knight.add_action(
+      piece_action(
+        side::lhs, piece_type::knight, piece_action_type::move, square("c3"), square("d5")
+      )
+    );
+    assert(!has_body(knight));
+  }
+  // is_blocked, a piece cannot get too close to another
+  {
+    const std::vector<piece> pieces{
+      piece(chess_color::white, piece_type::rook, square("e4"), side::lhs),
+      piece(chess_color::black, piece_type::rook, square("e6"), side::rhs)
+    };
+    collision_grid g;
+    g.update(pieces);
+    const auto& p{pieces[0]};
+    assert(!is_blocked(g, pieces, p, game_coordinat(3.5, 4.5), game_coordinat(4.5, 4.5)));
+    assert(is_blocked(g, pieces, p, game_coordinat(4.5, 4.5), game_coordinat(4.7, 4.5)));
+    // Moving away is fine, even when too close already
+    assert(!is_blocked(g, pieces, p, game_coordinat(4.75, 4.5), game_coordinat(4.7, 4.5)));
+    // Passing by at a distance is fine
+    assert(!is_blocked(g, pieces, p, game_coordinat(4.5, 3.5), game_coordinat(5.5, 3.5)));
+  }
+#endif // NDEBUG
+}
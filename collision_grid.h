@@ -0,0 +1,81 @@
+#ifndef COLLISION_GRID_H
+#define COLLISION_GRID_H
+
+#include "ccfwd.h"
+#include "game_coordinat.h"
+#include "square.h"
+
+#include <vector>
+
+/// The minimum distance between the centers of two pieces
+/// when moving freely, i.e. the diameter of the body of a piece
+constexpr double get_body_separation() { return 0.9; }
+
+/// The broadphase to find the pieces that may bump into each other
+/// when moving freely, without checking all pairs of pieces.
+/// This is a uniform grid of cells of one square each,
+/// in which each piece is in the cell its center is in.
+/// As the cells are bigger than the body separation,
+/// only the pieces in the cell of a coordinat
+/// and the eight cells around it need to be checked.
+/// The pieces are denoted by their index in the collection of pieces
+class collision_grid
+{
+public:
+  /// Create an empty grid
+  explicit collision_grid(const int board_size = get_default_board_size());
+
+  /// Get the number of cells along one side of the board
+  int get_board_size() const noexcept { return m_board_size; }
+
+  /// Get the indices of the pieces in the cell at (x, y)
+  const std::vector<int>& get_indices(const int x, const int y) const noexcept;
+
+  /// Let the piece with the index move from one coordinat to another,
+  /// which only does something if the piece changes cell
+  void move(
+    const int index,
+    const game_coordinat& from,
+    const game_coordinat& to
+  );
+
+  /// Rebuild the grid from scratch,
+  /// which is needed after pieces have been removed
+  void update(const std::vector<piece>& pieces);
+
+private:
+
+  int m_board_size;
+
+  /// The indices of the pieces in each cell,
+  /// where 'x * board_size + y' is the cell at (x, y)
+  std::vector<std::vector<int>> m_cells;
+
+  /// Get the cell a coordinat is in
+  std::vector<int>& get_cell(const game_coordinat& c) noexcept;
+};
+
+/// Count the number of pieces in the grid
+int count_bodies(const collision_grid& g) noexcept;
+
+/// Does a piece take up space on the board?
+/// A knight that is jumping does not,
+/// as it flies over the other pieces
+bool has_body(const piece& p) noexcept;
+
+/// Would moving the piece from one coordinat to another
+/// bump into another piece?
+/// A piece bumps into another if it would get closer than the body separation,
+/// so that a piece that is too close already can still move away
+bool is_blocked(
+  const collision_grid& grid,
+  const std::vector<piece>& pieces,
+  const piece& p,
+  const game_coordinat& from,
+  const game_coordinat& to
+);
+
+/// Test this class and its free functions
+void test_collision_grid();
+
+#endif // COLLISION_GRID_H
@@ -6,17 +6,41 @@
 
 control_action::control_action(
   const control_action_type type,
-  const game_coordinat& coordinat
-) : m_coordinat{coordinat}, m_type{type}
+  const game_coordinat& coordinat,
+  const int control_group
+) : control_action(type, coordinat, control_group, std::chrono::steady_clock::now())
 {
 
 }
 
+control_action::control_action(
+  const control_action_type type,
+  const game_coordinat& coordinat,
+  const int control_group,
+  const std::chrono::steady_clock::time_point& timestamp
+) : m_coordinat{coordinat},
+    m_control_group{control_group},
+    m_timestamp{timestamp},
+    m_type{type}
+{
+  assert(m_control_group >= 0);
+}
+
+control_action create_cursor_step_action(const game_coordinat& offset)
+{
+  return control_action(control_action_type::cursor_step, offset);
+}
+
 control_action create_mouse_move_action(const game_coordinat& coordinat)
 {
   return control_action(control_action_type::mouse_move, coordinat);
 }
 
+control_action create_press_assign_group_action(const int control_group)
+{
+  return control_action(control_action_type::press_assign_group, game_coordinat(), control_group);
+}
+
 control_action create_press_attack_action()
 {
   return control_action(control_action_type::press_attack, game_coordinat());
@@ -24,12 +48,12 @@ control_action create_press_attack_action()
 
 control_action create_press_down_action()
 {
-  return control_action(control_action_type::press_down, game_coordinat());
+  return control_action(control_action_type::press_down, game_coordinat(0.0, 1.0));
 }
 
 control_action create_press_left_action()
 {
-  return control_action(control_action_type::press_left, game_coordinat());
+  return control_action(control_action_type::press_left, game_coordinat(-1.0, 0.0));
 }
 
 control_action create_press_lmb_action(const game_coordinat& coordinat)
@@ -42,9 +66,14 @@ control_action create_press_move_action()
   return control_action(control_action_type::press_move, game_coordinat());
 }
 
+control_action create_press_recall_group_action(const int control_group)
+{
+  return control_action(control_action_type::press_recall_group, game_coordinat(), control_group);
+}
+
 control_action create_press_right_action()
 {
-  return control_action(control_action_type::press_right, game_coordinat());
+  return control_action(control_action_type::press_right, game_coordinat(1.0, 0.0));
 }
 
 control_action create_press_rmb_action(const game_coordinat& coordinat)
@@ -59,7 +88,42 @@ control_action create_press_select_action()
 
 control_action create_press_up_action()
 {
-  return control_action(control_action_type::press_up, game_coordinat());
+  return control_action(control_action_type::press_up, game_coordinat(0.0, -1.0));
+}
+
+control_action create_release_lmb_action(const game_coordinat& coordinat)
+{
+  return control_action(control_action_type::lmb_up, coordinat);
+}
+
+controller_type get_controller_type(const control_action_type t) noexcept
+{
+  switch (t)
+  {
+    case control_action_type::lmb_down:
+    case control_action_type::lmb_up:
+    case control_action_type::mouse_move:
+    case control_action_type::rmb_down:
+      return controller_type::mouse;
+    default:
+      return controller_type::keyboard;
+  }
+}
+
+game_coordinat get_cursor_offset(const control_action& a) noexcept
+{
+  if (!is_cursor_step(a.get_type())) return game_coordinat(0.0, 0.0);
+  return a.get_coordinat();
+}
+
+bool is_cursor_step(const control_action_type t) noexcept
+{
+  return t == control_action_type::cursor_step
+    || t == control_action_type::press_down
+    || t == control_action_type::press_left
+    || t == control_action_type::press_right
+    || t == control_action_type::press_up
+  ;
 }
 
 void test_control_action()
@@ -76,6 +140,83 @@ void test_control_action()
     assert(create_press_rmb_action(game_coordinat()).get_type() == control_action_type::rmb_down);
     assert(create_press_select_action().get_type() == control_action_type::press_select);
     assert(create_press_up_action().get_type() == control_action_type::press_up);
+    assert(create_release_lmb_action(game_coordinat()).get_type() == control_action_type::lmb_up);
+    assert(create_press_assign_group_action(1).get_type() == control_action_type::press_assign_group);
+    assert(create_press_recall_group_action(1).get_type() == control_action_type::press_recall_group);
+    assert(create_press_recall_group_action(3).get_control_group() == 3);
+    assert(create_cursor_step_action(game_coordinat()).get_type() == control_action_type::cursor_step);
+  }
+  // get_controller_type
+  {
+    assert(get_controller_type(control_action_type::mouse_move) == controller_type::mouse);
+    assert(get_controller_type(control_action_type::lmb_up) == controller_type::mouse);
+    assert(get_controller_type(control_action_type::press_up) == controller_type::keyboard);
+    assert(get_controller_type(control_action_type::press_recall_group) == controller_type::keyboard);
+  }
+  // get_cursor_offset
+  {
+    assert(get_cursor_offset(create_press_up_action()) == game_coordinat(0.0, -1.0));
+    assert(get_cursor_offset(create_press_right_action()) == game_coordinat(1.0, 0.0));
+    assert(get_cursor_offset(create_cursor_step_action(game_coordinat(2.0, 3.0))) == game_coordinat(2.0, 3.0));
+    assert(get_cursor_offset(create_press_select_action()) == game_coordinat(0.0, 0.0));
+  }
+  // is_cursor_step
+  {
+    assert(is_cursor_step(control_action_type::press_left));
+    assert(is_cursor_step(control_action_type::cursor_step));
+    assert(!is_cursor_step(control_action_type::press_select));
+    assert(!is_cursor_step(control_action_type::mouse_move));
+  }
+  // Actions are timestamped in the order they are created
+  {
+    const auto first{create_press_up_action()};
+    const auto second{create_press_up_action()};
+    assert(first.get_timestamp() <= second.get_timestamp());
+  }
+  // An action can be created with the time it was done
+  {
+    const auto first{create_press_up_action()};
+    const control_action merged(
+      first.get_type(),
+      game_coordinat(0.0, -2.0),
+      0,
+      first.get_timestamp()
+    );
+    assert(merged.get_timestamp() == first.get_timestamp());
+    assert(get_cursor_offset(merged) == game_coordinat(0.0, -2.0));
+  }
+  // to_str
+  {
+    assert(to_str(control_action_type::press_attack) == "press_attack");
+    assert(to_str(control_action_type::cursor_step) == "cursor_step");
+    for (int i{0}; i != get_n_control_action_types(); ++i)
+    {
+      assert(!to_str(static_cast<control_action_type>(i)).empty());
+    }
   }
 #endif // DEBUG
 }
+
+std::string to_str(const control_action_type t) noexcept
+{
+  switch (t)
+  {
+    case control_action_type::press_attack: return "press_attack";
+    case control_action_type::press_down: return "press_down";
+    case control_action_type::press_left: return "press_left";
+    case control_action_type::press_move: return "press_move";
+    case control_action_type::press_right: return "press_right";
+    case control_action_type::press_select: return "press_select";
+    case control_action_type::press_up: return "press_up";
+    case control_action_type::lmb_down: return "lmb_down";
+    case control_action_type::rmb_down: return "rmb_down";
+    case control_action_type::mouse_move: return "mouse_move";
+    case control_action_type::lmb_up: return "lmb_up";
+    case control_action_type::press_assign_group: return "press_assign_group";
+    case control_action_type::press_recall_group: return "press_recall_group";
+    case control_action_type::cursor_step:
+    default:
+      assert(t == control_action_type::cursor_step);
+      return "cursor_step";
+  }
+}
@@ -4,36 +4,88 @@
 #include "ccfwd.h"
 
 #include "control_action_type.h"
+#include "controller_type.h"
 #include "game_coordinat.h"
 
+#include <chrono>
+#include <string>
+
 /// An action
 class control_action
 {
 public:
-  explicit control_action(const control_action_type type, const game_coordinat& coordinat);
+  explicit control_action(
+    const control_action_type type,
+    const game_coordinat& coordinat,
+    const int control_group = 0
+  );
+
+  /// Create an action that was done at a certain time,
+  /// e.g. actions merged into one, which was done when the first one was
+  explicit control_action(
+    const control_action_type type,
+    const game_coordinat& coordinat,
+    const int control_group,
+    const std::chrono::steady_clock::time_point& timestamp
+  );
+
   auto& get_coordinat() const noexcept { return m_coordinat; }
+
+  /// The control group to assign or recall
+  auto get_control_group() const noexcept { return m_control_group; }
+
+  /// When the action was created, i.e. when the user did it
+  const auto& get_timestamp() const noexcept { return m_timestamp; }
+
   auto get_type() const noexcept { return m_type; }
 
 private:
   /// Must be a game_coordinat (not a square),
-  /// as the mouse has actions
+  /// as the mouse has actions.
+  /// For a step of the keyboard cursor, this is the offset
   game_coordinat m_coordinat;
+
+  /// The control group, for assigning or recalling one
+  int m_control_group;
+
+  std::chrono::steady_clock::time_point m_timestamp;
+
   control_action_type m_type;
 };
 
+/// Create a step of the keyboard cursor by an offset,
+/// which is what the arrow keys presses are merged into
+control_action create_cursor_step_action(const game_coordinat& offset);
+
 control_action create_mouse_move_action(const game_coordinat& coordinat);
+control_action create_press_assign_group_action(const int control_group);
 control_action create_press_attack_action();
 control_action create_press_down_action();
 control_action create_press_left_action();
 control_action create_press_lmb_action(const game_coordinat& coordinat);
 control_action create_press_move_action();
+control_action create_press_recall_group_action(const int control_group);
 control_action create_press_right_action();
 control_action create_press_rmb_action(const game_coordinat& coordinat);
 control_action create_press_select_action();
 control_action create_press_up_action();
+control_action create_release_lmb_action(const game_coordinat& coordinat);
+
+/// Get the controller that does an action
+controller_type get_controller_type(const control_action_type t) noexcept;
+
+/// Get the offset the keyboard cursor is moved by,
+/// which is zero for actions that do not move the keyboard cursor
+game_coordinat get_cursor_offset(const control_action& a) noexcept;
+
+/// Does the action move the keyboard cursor?
+bool is_cursor_step(const control_action_type t) noexcept;
 
 /// Test the 'control_action' class and its free functions
 void test_control_action();
 
+/// Convert to string
+std::string to_str(const control_action_type t) noexcept;
+
 #endif // CONTROL_ACTION_H
 
@@ -14,7 +14,18 @@ enum class control_action_type
   press_up,
   lmb_down,
   rmb_down,
-  mouse_move
+  mouse_move,
+  lmb_up,
+  press_assign_group,
+  press_recall_group,
+  cursor_step
 };
 
+/// The number of control action types,
+/// i.e. the size of a table with an entry per control action type
+constexpr int get_n_control_action_types()
+{
+  return static_cast<int>(control_action_type::cursor_step) + 1;
+}
+
 #endif // ACTION_TYPE_H
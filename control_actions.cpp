@@ -3,22 +3,68 @@
 #include "game.h"
 #include "square.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <thread>
 
 control_actions::control_actions()
+  : m_queues{},
+    m_inbox(get_inbox_capacity()),
+    m_is_lmb_down{false},
+    m_lmb_down_pos{}
 {
 
 }
 
-void control_actions::add(const control_action& action)
+void control_actions::add(const control_action& action, const chess_color player)
 {
-  m_control_actions.push_back(action);
+  auto& queue{m_queues[static_cast<int>(player)]};
+  if (!queue.empty())
+  {
+    auto& last{queue.back()};
+    // Only the last position of the mouse matters
+    if (action.get_type() == control_action_type::mouse_move
+      && last.get_type() == control_action_type::mouse_move)
+    {
+      last = control_action(
+        last.get_type(),
+        action.get_coordinat(),
+        last.get_control_group(),
+        last.get_timestamp()
+      );
+      return;
+    }
+    // Cursor steps loop around the board, so can be added up
+    if (is_cursor_step(action.get_type()) && is_cursor_step(last.get_type()))
+    {
+      const game_coordinat offset{
+        get_cursor_offset(last) + get_cursor_offset(action)
+      };
+      if (offset == game_coordinat(0.0, 0.0))
+      {
+        queue.pop_back();
+        return;
+      }
+      last = control_action(
+        last.get_type(),
+        offset,
+        last.get_control_group(),
+        last.get_timestamp()
+      );
+      return;
+    }
+  }
+  queue.push_back(action);
 }
 
 int count_control_actions(const control_actions& a)
 {
-  return static_cast<int>(a.get_actions().size());
+  return static_cast<int>(
+    a.get_queue(chess_color::black).size()
+    + a.get_queue(chess_color::white).size()
+  );
 }
 
 void control_actions::do_select(
@@ -35,21 +81,22 @@ void control_actions::do_select(
   // 4|No                   |Selected unit    |NA
   // 5|No                   |Unselected unit  |Select unit
   // 6|No                   |Empty square     |Nothing
-  if (has_selected_pieces(g, player_color))
+  if (g.get_selection().count(player_color) != 0)
   {
     if (is_piece_at(g, coordinat)) {
 
-      auto& piece{get_closest_piece_to(g, coordinat)};
+      const int index{get_index_of_closest_piece_to(g, coordinat)};
+      const auto& piece{g.get_pieces()[index]};
       if (piece.get_color() == player_color)
       {
         if (piece.is_selected())
         {
-          unselect(piece); // 1
+          unselect_piece(g, index); // 1
         }
         else
         {
           unselect_all_pieces(g, player_color);
-          select(piece); // 2
+          select_piece(g, index); // 2
         }
       }
     }
@@ -61,17 +108,18 @@ void control_actions::do_select(
   else
   {
     if (is_piece_at(g, coordinat)) {
-      auto& piece{get_closest_piece_to(g, coordinat)};
+      const int index{get_index_of_closest_piece_to(g, coordinat)};
+      const auto& piece{g.get_pieces()[index]};
       if (piece.get_color() == player_color)
       {
         if (piece.is_selected())
         {
           assert(!"Should never happen, as there are no selected pieces at all");
-          unselect(piece); // 4
+          unselect_piece(g, index); // 4
         }
         else
         {
-          select(piece); // 5
+          select_piece(g, index); // 5
         }
       }
     }
@@ -96,21 +144,22 @@ void control_actions::do_select(
   // 4|No                   |Selected unit    |NA
   // 5|No                   |Unselected unit  |Select unit
   // 6|No                   |Empty square     |Nothing
-  if (has_selected_pieces(g, player_color))
+  if (g.get_selection().count(player_color) != 0)
   {
     if (is_piece_at(g, coordinat)) {
 
-      auto& piece{get_piece_at(g, coordinat)};
+      const int index{get_index_of_piece_at(g, coordinat)};
+      const auto& piece{g.get_pieces()[index]};
       if (piece.get_color() == player_color)
       {
         if (piece.is_selected())
         {
-          unselect(piece); // 1
+          unselect_piece(g, index); // 1
         }
         else
         {
           unselect_all_pieces(g, player_color);
-          select(piece); // 2
+          select_piece(g, index); // 2
         }
       }
     }
@@ -122,17 +171,18 @@ void control_actions::do_select(
   else
   {
     if (is_piece_at(g, coordinat)) {
-      auto& piece{get_piece_at(g, coordinat)};
+      const int index{get_index_of_piece_at(g, coordinat)};
+      const auto& piece{g.get_pieces()[index]};
       if (piece.get_color() == player_color)
       {
         if (piece.is_selected())
         {
           assert(!"Should never happen, as there are no selected pieces at all");
-          unselect(piece); // 4
+          unselect_piece(g, index); // 4
         }
         else
         {
-          select(piece); // 5
+          select_piece(g, index); // 5
         }
       }
     }
@@ -143,84 +193,175 @@ void control_actions::do_select(
   }
 }
 
+const std::array<control_actions::handler, get_n_control_action_types()>&
+control_actions::get_handlers() noexcept
+{
+  // Each handler is put at the index of its control_action_type,
+  // so the table does not depend on the order of the types
+  static const auto handlers{
+    []()
+    {
+      std::array<handler, get_n_control_action_types()> h{};
+      const auto set{
+        [&h](const control_action_type t, const handler f)
+        {
+          h[static_cast<int>(t)] = f;
+        }
+      };
+      set(control_action_type::press_attack, &control_actions::process_press_attack);
+      set(control_action_type::press_down, &control_actions::process_cursor_step);
+      set(control_action_type::press_left, &control_actions::process_cursor_step);
+      set(control_action_type::press_move, &control_actions::process_press_move);
+      set(control_action_type::press_right, &control_actions::process_cursor_step);
+      set(control_action_type::press_select, &control_actions::process_press_select);
+      set(control_action_type::press_up, &control_actions::process_cursor_step);
+      set(control_action_type::lmb_down, &control_actions::process_lmb_down);
+      set(control_action_type::rmb_down, &control_actions::process_rmb_down);
+      set(control_action_type::mouse_move, &control_actions::process_mouse_move);
+      set(control_action_type::lmb_up, &control_actions::process_lmb_up);
+      set(control_action_type::press_assign_group, &control_actions::process_assign_group);
+      set(control_action_type::press_recall_group, &control_actions::process_recall_group);
+      set(control_action_type::cursor_step, &control_actions::process_cursor_step);
+      // A control_action_type without a handler would crash at dispatch
+      assert(std::none_of(std::begin(h), std::end(h), [](const handler f) { return f == nullptr; }));
+      return h;
+    }()
+  };
+  return handlers;
+}
+
+bool control_actions::post(const control_action& action)
+{
+  return m_inbox.try_push(action);
+}
+
 void control_actions::process(game& g)
 {
+  m_inbox.drain(
+    [this, &g](const control_action& action)
+    {
+      add(action, get_player_color(g, action));
+    }
+  );
   process_control_actions(g);
 }
 
+void control_actions::process_assign_group(game& g, const control_action& action)
+{
+  assign_control_group(
+    g,
+    action.get_control_group(),
+    get_keyboard_user_player_color(get_options(g))
+  );
+}
+
 void control_actions::process_control_actions(game& g)
 {
-  for (const auto& action: m_control_actions)
+  const auto& handlers{get_handlers()};
+  const auto& black_queue{m_queues[static_cast<int>(chess_color::black)]};
+  const auto& white_queue{m_queues[static_cast<int>(chess_color::white)]};
+
+  // Merge the queues in the order the actions were done
+  auto black_action{std::begin(black_queue)};
+  auto white_action{std::begin(white_queue)};
+  while (black_action != std::end(black_queue)
+    || white_action != std::end(white_queue))
   {
-    if (action.get_type() == control_action_type::press_attack)
-    {
+    const bool is_black_next{
+      white_action == std::end(white_queue)
+      || (black_action != std::end(black_queue)
+        && black_action->get_timestamp() <= white_action->get_timestamp()
+      )
+    };
+    const auto& action{is_black_next ? *black_action++ : *white_action++};
+    g.get_latency().start_processing(action);
+    (this->*handlers[static_cast<int>(action.get_type())])(g, action);
+    g.get_latency().end_processing();
+  }
+  for (auto& queue: m_queues) queue.clear();
+}
 
-      start_attack(
-        g,
-        get_keyboard_player_pos(g),
-        get_keyboard_user_player_color(get_options(g))
-      );
-    }
-    else if (action.get_type() == control_action_type::press_down)
-    {
-      auto& pos{get_keyboard_player_pos(g)};
-      pos = get_below(pos);
-    }
-    else if (action.get_type() == control_action_type::press_left)
-    {
-      auto& pos{get_keyboard_player_pos(g)};
-      pos = get_left(pos);
-    }
-    else if (action.get_type() == control_action_type::press_move)
-    {
+void control_actions::process_cursor_step(game& g, const control_action& action)
+{
+  auto& pos{get_keyboard_player_pos(g)};
+  pos = get_stepped(pos, get_cursor_offset(action), get_board_size(get_options(g)));
+}
 
-      start_move_unit(
-        g,
-        get_keyboard_player_pos(g),
-        get_keyboard_user_player_color(get_options(g))
-      );
-    }
-    else if (action.get_type() == control_action_type::press_right)
-    {
-      auto& pos{get_keyboard_player_pos(g)};
-      pos = get_right(pos);
-    }
-    else if (action.get_type() == control_action_type::press_select)
-    {
-      do_select(
-        g,
-        get_keyboard_player_pos(g),
-        get_keyboard_user_player_color(get_options(g))
-      );
-    }
-    else if (action.get_type() == control_action_type::press_up)
-    {
-      auto& pos{get_keyboard_player_pos(g)};
-      pos = get_above(pos);
-    }
-    else if (action.get_type() == control_action_type::mouse_move)
-    {
-      auto& pos{get_mouse_player_pos(g)};
-      pos = action.get_coordinat();
-    }
-    else if (action.get_type() == control_action_type::lmb_down)
-    {
-      do_select(
-        g,
-        action.get_coordinat(),
-        get_mouse_user_player_color(get_options(g))
-      );
-    }
-    else if (action.get_type() == control_action_type::rmb_down)
-    {
-      start_move_unit(
-        g,
-        action.get_coordinat(),
-        get_mouse_user_player_color(get_options(g))
-      );
-    }
+void control_actions::process_lmb_down(game& g, const control_action& action)
+{
+  do_select(
+    g,
+    action.get_coordinat(),
+    get_mouse_user_player_color(get_options(g))
+  );
+  m_is_lmb_down = true;
+  m_lmb_down_pos = action.get_coordinat();
+}
+
+void control_actions::process_lmb_up(game& g, const control_action& action)
+{
+  // Dragging over more than one square selects all pieces in the box
+  if (m_is_lmb_down && !is_same_square(m_lmb_down_pos, action.get_coordinat()))
+  {
+    select_pieces_in_box(
+      g,
+      m_lmb_down_pos,
+      action.get_coordinat(),
+      get_mouse_user_player_color(get_options(g))
+    );
   }
-  m_control_actions = std::vector<control_action>();
+  m_is_lmb_down = false;
+}
+
+void control_actions::process_mouse_move(game& g, const control_action& action)
+{
+  auto& pos{get_mouse_player_pos(g)};
+  pos = action.get_coordinat();
+}
+
+void control_actions::process_press_attack(game& g, const control_action&)
+{
+  start_attack(
+    g,
+    get_keyboard_player_pos(g),
+    get_keyboard_user_player_color(get_options(g))
+  );
+}
+
+void control_actions::process_press_move(game& g, const control_action&)
+{
+  start_move_unit(
+    g,
+    get_keyboard_player_pos(g),
+    get_keyboard_user_player_color(get_options(g))
+  );
+}
+
+void control_actions::process_press_select(game& g, const control_action&)
+{
+  do_select(
+    g,
+    get_keyboard_player_pos(g),
+    get_keyboard_user_player_color(get_options(g))
+  );
+}
+
+void control_actions::process_recall_group(game& g, const control_action& action)
+{
+  recall_control_group(
+    g,
+    action.get_control_group(),
+    get_keyboard_user_player_color(get_options(g))
+  );
+}
+
+void control_actions::process_rmb_down(game& g, const control_action& action)
+{
+  start_move_unit(
+    g,
+    action.get_coordinat(),
+    get_mouse_user_player_color(get_options(g))
+  );
 }
 
 void control_actions::start_attack(
@@ -229,30 +370,17 @@ void control_actions::start_attack(
   const chess_color player_color
 )
 {
-  if (count_selected_units(g, player_color) == 0) return;
+  // Validate the order once for all selected pieces
+  if (!is_on_board(g, coordinat)) return;
+  const auto indices{g.get_selection().get_indices(player_color)};
+  if (indices.empty()) return;
+  const square to(coordinat);
 
-  for (auto& p: g.get_pieces())
+  for (const int index: indices)
   {
-    if (p.is_selected() && p.get_color() == player_color)
-    {
-      const auto& from{p.get_current_square()};
-      const auto& to{square(coordinat)};
-      if (from != to)
-      {
-        // No shift, so all current actions are void
-        clear_actions(p);
-
-        p.add_action(
-          piece_action(
-            p.get_player(),
-            p.get_type(),
-            piece_action_type::attack,
-            square(from),
-            square(to)
-          )
-        );
-      }
-    }
+    assert(g.get_pieces()[index].is_selected());
+    assert(g.get_pieces()[index].get_color() == player_color);
+    give_order(g, index, piece_action_type::attack, to);
   }
   unselect_all_pieces(g, player_color);
 }
@@ -263,49 +391,65 @@ void control_actions::start_move_unit(
   const chess_color player_color
 )
 {
-  if (count_selected_units(g, player_color) == 0) return;
+  // Validate the order once for all selected pieces
+  if (!is_on_board(g, coordinat)) return;
+  const auto indices{g.get_selection().get_indices(player_color)};
+  if (indices.empty()) return;
+  const square to(coordinat);
 
-  for (auto& p: g.get_pieces())
+  for (const int index: indices)
   {
-    if (p.is_selected() && p.get_color() == player_color)
-    {
-
-      const auto& from{p.get_current_square()};
-      const auto& to{square(coordinat)};
-      if (from != to)
-      {
-        // No shift, so all current actions are void
-        clear_actions(p);
-        const auto action{
-          piece_action(
-            p.get_player(),
-            p.get_type(),
-            piece_action_type::move,
-            square(from),
-            square(to)
-          )
-        };
-        p.add_action(action);
-      }
-    }
+    assert(g.get_pieces()[index].is_selected());
+    assert(g.get_pieces()[index].get_color() == player_color);
+    give_order(g, index, piece_action_type::move, to);
   }
   unselect_all_pieces(g, player_color);
 }
 
+chess_color get_player_color(const game& g, const control_action& action)
+{
+  if (get_controller_type(action.get_type()) == controller_type::mouse)
+  {
+    return get_mouse_user_player_color(get_options(g));
+  }
+  return get_keyboard_user_player_color(get_options(g));
+}
+
+game_coordinat get_stepped(
+  const game_coordinat& coordinat,
+  const game_coordinat& offset,
+  const int board_size
+) noexcept
+{
+  const double n{static_cast<double>(board_size)};
+  double x{std::fmod(coordinat.get_x() + offset.get_x(), n)};
+  double y{std::fmod(coordinat.get_y() + offset.get_y(), n)};
+  if (x < 0.0) x += n;
+  if (y < 0.0) y += n;
+  return game_coordinat(x, y);
+}
+
+bool is_same_square(const game_coordinat& a, const game_coordinat& b) noexcept
+{
+  return std::floor(a.get_x()) == std::floor(b.get_x())
+    && std::floor(a.get_y()) == std::floor(b.get_y())
+  ;
+}
+
 void test_control_actions()
 {
 #ifndef NDEBUG
   // Empty on construction
   {
     const control_actions c;
-    assert(c.get_actions().empty());
+    assert(count_control_actions(c) == 0);
   }
   // Move up does something
   {
     game g;
     const game_coordinat before{get_keyboard_player_pos(g)};
     control_actions c;
-    c.add(create_press_up_action());
+    c.add(create_press_up_action(), chess_color::white);
     c.process(g);
     const game_coordinat after{get_keyboard_player_pos(g)};
     assert(before != after);
@@ -315,7 +459,7 @@ void test_control_actions()
     game g;
     const game_coordinat before{get_keyboard_player_pos(g)};
     control_actions c;
-    c.add(create_press_right_action());
+    c.add(create_press_right_action(), chess_color::white);
     c.process(g);
     const game_coordinat after{get_keyboard_player_pos(g)};
     assert(before != after);
@@ -325,7 +469,7 @@ void test_control_actions()
     game g;
     const game_coordinat before{get_keyboard_player_pos(g)};
     control_actions c;
-    c.add(create_press_down_action());
+    c.add(create_press_down_action(), chess_color::white);
     c.process(g);
     const game_coordinat after{get_keyboard_player_pos(g)};
     assert(before != after);
@@ -335,10 +479,238 @@ void test_control_actions()
     game g;
     const game_coordinat before{get_keyboard_player_pos(g)};
     control_actions c;
-    c.add(create_press_left_action());
+    c.add(create_press_left_action(), chess_color::white);
     c.process(g);
     const game_coordinat after{get_keyboard_player_pos(g)};
     assert(before != after);
   }
+  // is_same_square
+  {
+    assert(is_same_square(game_coordinat(0.1, 0.1), game_coordinat(0.9, 0.9)));
+    assert(!is_same_square(game_coordinat(0.9, 0.9), game_coordinat(1.1, 0.9)));
+    assert(!is_same_square(game_coordinat(-0.1, 0.5), game_coordinat(0.1, 0.5)));
+  }
+  // Dragging the mouse selects all pieces in the box
+  {
+    game g;
+    const auto color{get_mouse_user_player_color(get_options(g))};
+    assert(color == chess_color::black);
+    g.add_action(create_press_lmb_action(game_coordinat(6.1, 0.1)));
+    g.add_action(create_release_lmb_action(game_coordinat(7.9, 3.9)));
+    g.tick(delta_t(0.0));
+    assert(count_selected_units(g, color) == 8);
+    assert(g.get_selection().count(color) == 8);
+    assert(count_selected_units(g, chess_color::white) == 0);
+  }
+  // A click without dragging selects one piece
+  {
+    game g;
+    const auto color{get_mouse_user_player_color(get_options(g))};
+    g.add_action(create_press_lmb_action(game_coordinat(6.4, 0.4)));
+    g.add_action(create_release_lmb_action(game_coordinat(6.6, 0.6)));
+    g.tick(delta_t(0.0));
+    assert(count_selected_units(g, color) == 1);
+  }
+  // An order is given to all selected pieces at once
+  {
+    game g;
+    const auto color{get_mouse_user_player_color(get_options(g))};
+    g.add_action(create_press_lmb_action(game_coordinat(6.1, 0.1)));
+    g.add_action(create_release_lmb_action(game_coordinat(7.9, 3.9)));
+    g.add_action(create_press_rmb_action(game_coordinat(4.5, 2.5)));
+    g.tick(delta_t(0.0));
+    assert(count_selected_units(g, color) == 0);
+    assert(g.get_selection().count(color) == 0);
+    // The c7 pawn and the b8 knight at least
+    int n_ordered{0};
+    for (const auto& p: g.get_pieces()) if (has_actions(p)) ++n_ordered;
+    assert(n_ordered >= 2);
+    assert(has_actions(get_piece_at(g, square("c7"))));
+    assert(has_actions(get_piece_at(g, square("b8"))));
+  }
+  // An order beyond the board is ignored, keeping the selection
+  {
+    game g;
+    const auto color{get_mouse_user_player_color(get_options(g))};
+    g.add_action(create_press_lmb_action(game_coordinat(6.4, 0.4)));
+    g.add_action(create_press_rmb_action(game_coordinat(-1.5, 2.5)));
+    g.tick(delta_t(0.0));
+    assert(count_selected_units(g, color) == 1);
+    assert(is_idle(g));
+  }
+  // Control groups can be assigned and recalled
+  {
+    game g;
+    const auto color{get_keyboard_user_player_color(get_options(g))};
+    do_select_for_keyboard_player(g, square("e2"));
+    g.add_action(create_press_assign_group_action(1));
+    g.tick(delta_t(0.0));
+    assert(g.get_selection().get_group(1, color).size() == 1);
+    // Unselect by selecting an empty square
+    set_keyboard_player_pos(g, square("e4"));
+    g.add_action(create_press_select_action());
+    g.tick(delta_t(0.0));
+    assert(count_selected_units(g, color) == 0);
+    g.add_action(create_press_recall_group_action(1));
+    g.tick(delta_t(0.0));
+    assert(count_selected_units(g, color) == 1);
+    assert(get_piece_at(g, square("e2")).is_selected());
+    // An empty group selects nothing
+    g.add_action(create_press_recall_group_action(2));
+    g.tick(delta_t(0.0));
+    assert(count_selected_units(g, color) == 0);
+  }
+  // Mouse moves are merged, only the last one is kept
+  {
+    control_actions c;
+    for (int i{0}; i != 100; ++i)
+    {
+      c.add(create_mouse_move_action(game_coordinat(0.01 * i, 1.0)), chess_color::black);
+    }
+    assert(count_control_actions(c) == 1);
+    assert(c.get_queue(chess_color::black).back().get_coordinat() == game_coordinat(0.99, 1.0));
+    game g;
+    c.process(g);
+    assert(get_mouse_player_pos(g) == game_coordinat(0.99, 1.0));
+    assert(count_control_actions(c) == 0);
+  }
+  // Mouse moves are not merged over a click
+  {
+    control_actions c;
+    c.add(create_mouse_move_action(game_coordinat(1.0, 1.0)), chess_color::black);
+    c.add(create_press_lmb_action(game_coordinat(1.0, 1.0)), chess_color::black);
+    c.add(create_mouse_move_action(game_coordinat(2.0, 2.0)), chess_color::black);
+    assert(count_control_actions(c) == 3);
+  }
+  // Cursor steps are merged, opposite steps cancel out
+  {
+    control_actions c;
+    c.add(create_press_up_action(), chess_color::white);
+    c.add(create_press_up_action(), chess_color::white);
+    c.add(create_press_right_action(), chess_color::white);
+    assert(count_control_actions(c) == 1);
+    assert(get_cursor_offset(c.get_queue(chess_color::white).back()) == game_coordinat(1.0, -2.0));
+    c.add(create_press_down_action(), chess_color::white);
+    c.add(create_press_down_action(), chess_color::white);
+    c.add(create_press_left_action(), chess_color::white);
+    assert(count_control_actions(c) == 0);
+  }
+  // Merged cursor steps move the cursor as far as the separate steps
+  {
+    game g;
+    const int board_size{get_board_size(get_options(g))};
+    game_coordinat expected{get_keyboard_player_pos(g)};
+    for (int i{0}; i != 11; ++i)
+    {
+      g.add_action(create_press_left_action());
+      expected = get_left(expected, board_size);
+    }
+    g.add_action(create_press_up_action());
+    expected = get_above(expected, board_size);
+    assert(count_control_actions(g) == 1);
+    g.tick(delta_t(0.0));
+    assert(get_keyboard_player_pos(g) == expected);
+  }
+  // Cursor steps are not merged over other keys
+  {
+    game g;
+    const auto color{get_keyboard_user_player_color(get_options(g))};
+    set_keyboard_player_pos(g, square("e1"));
+    g.add_action(create_press_up_action());
+    g.add_action(create_press_select_action());
+    g.add_action(create_press_down_action());
+    assert(count_control_actions(g) == 3);
+    g.tick(delta_t(0.0));
+    assert(count_selected_units(g, color) == 1);
+    assert(square(get_keyboard_player_pos(g)) == square("e1"));
+  }
+  // Each player has its own queue
+  {
+    game g;
+    const auto up{create_press_up_action()};
+    const auto move{create_mouse_move_action(game_coordinat(1.0, 1.0))};
+    assert(get_player_color(g, up) == get_keyboard_user_player_color(get_options(g)));
+    assert(get_player_color(g, move) == get_mouse_user_player_color(get_options(g)));
+    control_actions c;
+    c.add(up, get_player_color(g, up));
+    c.add(move, get_player_color(g, move));
+    c.add(create_press_lmb_action(game_coordinat(1.0, 1.0)), get_player_color(g, move));
+    assert(c.get_queue(get_player_color(g, up)).size() == 1);
+    assert(c.get_queue(get_player_color(g, move)).size() == 2);
+  }
+  // Steps of one player are not merged with the steps of the other
+  {
+    control_actions c;
+    c.add(create_press_up_action(), chess_color::white);
+    c.add(create_press_down_action(), chess_color::black);
+    assert(count_control_actions(c) == 2);
+  }
+  // A merged action keeps the type and timestamp of the first action
+  {
+    control_actions c;
+    const auto first_step{create_press_left_action()};
+    c.add(first_step, chess_color::white);
+    c.add(create_press_up_action(), chess_color::white);
+    const auto& step{c.get_queue(chess_color::white).back()};
+    assert(step.get_type() == control_action_type::press_left);
+    assert(step.get_timestamp() == first_step.get_timestamp());
+    assert(get_cursor_offset(step) == game_coordinat(-1.0, -1.0));
+
+    const auto first_move{create_mouse_move_action(game_coordinat(1.0, 1.0))};
+    c.add(first_move, chess_color::black);
+    c.add(create_mouse_move_action(game_coordinat(2.0, 3.0)), chess_color::black);
+    const auto& move{c.get_queue(chess_color::black).back()};
+    assert(move.get_timestamp() == first_move.get_timestamp());
+    assert(move.get_coordinat() == game_coordinat(2.0, 3.0));
+  }
+  // get_stepped loops around the board
+  {
+    assert(get_stepped(game_coordinat(0.5, 0.5), game_coordinat(-1.0, 0.0), 8) == game_coordinat(7.5, 0.5));
+    assert(get_stepped(game_coordinat(7.5, 7.5), game_coordinat(0.0, 1.0), 8) == game_coordinat(7.5, 0.5));
+    assert(get_stepped(game_coordinat(3.5, 3.5), game_coordinat(-17.0, 16.0), 8) == game_coordinat(2.5, 3.5));
+  }
+  // Posted actions are processed at the next tick
+  {
+    control_actions c;
+    assert(c.post(create_mouse_move_action(game_coordinat(1.5, 2.5))));
+    assert(count_control_actions(c) == 0);
+    game g;
+    c.process(g);
+    assert(get_mouse_player_pos(g) == game_coordinat(1.5, 2.5));
+  }
+  // A full inbox drops actions
+  {
+    control_actions c;
+    for (int i{0}; i != get_inbox_capacity(); ++i)
+    {
+      assert(c.post(create_press_select_action()));
+    }
+    assert(!c.post(create_press_select_action()));
+  }
+  // Actions can be posted by another thread while the game runs
+  {
+    game g;
+    const game_coordinat before{get_keyboard_player_pos(g)};
+    const int n_steps{1000};
+    std::thread producer(
+      [&g, n_steps]()
+      {
+        for (int i{0}; i != n_steps; ++i)
+        {
+          while (!g.post_action(create_press_right_action()))
+          {
+            std::this_thread::yield();
+          }
+        }
+      }
+    );
+    // Tick while the other thread posts
+    for (int i{0}; i != 100; ++i) g.tick(delta_t(0.0));
+    producer.join();
+    g.tick(delta_t(0.0));
+    assert(g.get_actions().get_inbox_size() == 0);
+    const int board_size{get_board_size(get_options(g))};
+    assert(get_keyboard_player_pos(g) == get_stepped(before, game_coordinat(n_steps, 0.0), board_size));
+  }
 #endif // NDEBUG
 }
@@ -5,9 +5,12 @@
 
 #include "chess_color.h"
 #include "control_action.h"
+#include "controller_type.h"
 #include "piece_action.h"
 #include "message.h"
+#include "spsc_queue.h"
 
+#include <array>
 #include <vector>
 
 /// The actions in a game, with two types:
@@ -19,22 +22,75 @@
 /// The control_actions processes user actions
 /// and passes the into the pieces it concerns, as 'piece_actions'.
 /// There, the pieces take over.
+///
+/// Each player has its own queue of control actions.
+/// Redundant actions are merged when added,
+/// so that the number of actions per tick does not grow with
+/// how fast the mouse moves or how often the arrow keys repeat:
+///  * a mouse move after a mouse move moves to the last position
+///  * a cursor step after a cursor step is merged into one step,
+///    which is dropped when the steps cancel each other out
+/// A merged action keeps the type and the timestamp of the first action,
+/// so that it is processed in the order, and measured from the time,
+/// the user started it
+///
+/// Actions done on another thread than the one running the game,
+/// e.g. by an input, bot or network thread, are posted in the inbox.
+/// The inbox is emptied into the queues at the start of processing,
+/// i.e. at a tick boundary
 class control_actions
 {
 public:
   control_actions();
 
-  /// Add a new user actions
-  void add(const control_action& action);
+  /// Add a new user action to the queue of the player that did it
+  void add(const control_action& action, const chess_color player);
 
-  const auto& get_actions() const noexcept { return m_control_actions; }
+  /// Get the actions to be processed for a player
+  const auto& get_queue(const chess_color player) const noexcept
+  {
+    return m_queues[static_cast<int>(player)];
+  }
+
+  /// Get the number of actions posted, yet not processed.
+  /// When called while another thread posts actions,
+  /// this is a snapshot that may be outdated directly
+  int get_inbox_size() const noexcept { return static_cast<int>(m_inbox.get_size()); }
+
+  /// Get where the left mouse button went down,
+  /// i.e. the first corner of the selection box
+  const auto& get_lmb_down_pos() const noexcept { return m_lmb_down_pos; }
+
+  /// Is the left mouse button down, i.e. is a selection box being dragged?
+  bool is_lmb_down() const noexcept { return m_is_lmb_down; }
+
+  /// Post a user action from another thread.
+  /// Only one thread may post actions to the same control_actions.
+  /// Never waits, so the posting thread is never slowed down
+  /// by the thread running the game
+  /// @return false if the inbox is full, in which case the action is dropped
+  bool post(const control_action& action);
 
   /// Process all actions and apply these on the game
   void process(game& g);
 
 private:
 
-  std::vector<control_action> m_control_actions;
+  /// A function that processes one type of control action
+  using handler = void (control_actions::*)(game&, const control_action&);
+
+  /// The actions to be processed, per player, indexed by chess color.
+  /// The queues are cleared after processing, keeping their memory
+  std::array<std::vector<control_action>, 2> m_queues;
+
+  /// The actions posted from another thread, not processed yet
+  spsc_queue<control_action> m_inbox;
+
+  /// Is the left mouse button down?
+  bool m_is_lmb_down;
+
+  /// Where the left mouse button went down
+  game_coordinat m_lmb_down_pos;
 
   /// Process a left-mouse-button, hence a game_coordinat as a coordinat
   void do_select(
@@ -50,7 +106,21 @@ private:
     const chess_color player_color
   );
 
+  /// Get the function that processes each type of control action,
+  /// indexed by control action type
+  static const std::array<handler, get_n_control_action_types()>& get_handlers() noexcept;
+
+  void process_assign_group(game& g, const control_action& action);
   void process_control_actions(game& g);
+  void process_cursor_step(game& g, const control_action& action);
+  void process_lmb_down(game& g, const control_action& action);
+  void process_lmb_up(game& g, const control_action& action);
+  void process_mouse_move(game& g, const control_action& action);
+  void process_press_attack(game& g, const control_action& action);
+  void process_press_move(game& g, const control_action& action);
+  void process_press_select(game& g, const control_action& action);
+  void process_recall_group(game& g, const control_action& action);
+  void process_rmb_down(game& g, const control_action& action);
 
   /// Process an A or right-mouse-button down
   void start_attack(
@@ -68,12 +138,32 @@ private:
 };
 
 /// Count the total number of control actions to be done by the game,
-/// which should be zero after each tick
+/// which should be zero after each tick.
+/// Actions posted, yet not processed, are not counted
 int count_control_actions(const control_actions& a);
 
+/// The maximum number of actions posted between two ticks
+constexpr int get_inbox_capacity() { return 1024; }
+
 /// Count the total number of piece actions to be done by the game
 int count_piece_actions(const control_actions& a);
 
+/// Get the color of the player that does an action,
+/// i.e. the one using the controller that gives the action
+chess_color get_player_color(const game& g, const control_action& action);
+
+/// Get the coordinat after moving by an offset,
+/// looping around the edges of the board, like the keyboard cursor does
+game_coordinat get_stepped(
+  const game_coordinat& coordinat,
+  const game_coordinat& offset,
+  const int board_size
+) noexcept;
+
+/// Are the coordinats on the same square?
+/// Coordinats beyond the board are on a square beyond the board
+bool is_same_square(const game_coordinat& a, const game_coordinat& b) noexcept;
+
 /// Test this class and its free functions
 void test_control_actions();
 
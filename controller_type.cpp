@@ -6,9 +6,10 @@
 
 controller_type get_next(const controller_type t) noexcept
 {
-  if (t == controller_type::mouse) return controller_type::keyboard;
-  assert(t == controller_type::keyboard);
-  return controller_type::mouse;
+  if (t == controller_type::keyboard) return controller_type::mouse;
+  if (t == controller_type::mouse) return controller_type::ai;
+  assert(t == controller_type::ai);
+  return controller_type::keyboard;
 }
 
 void test_controller_type()
@@ -18,12 +19,19 @@ void test_controller_type()
   {
     assert(to_str(controller_type::mouse) == "mouse");
     assert(to_str(controller_type::keyboard) == "keyboard");
+    assert(to_str(controller_type::ai) == "ai");
   }
   // get_next
   {
-    assert(get_next(controller_type::mouse) == controller_type::keyboard);
+    assert(get_next(controller_type::mouse) == controller_type::ai);
+    assert(get_next(controller_type::ai) == controller_type::keyboard);
     assert(get_next(controller_type::keyboard) == controller_type::mouse);
-
+  }
+  // uses_keyboard_actions
+  {
+    assert(uses_keyboard_actions(controller_type::keyboard));
+    assert(!uses_keyboard_actions(controller_type::mouse));
+    assert(uses_keyboard_actions(controller_type::ai));
   }
   // operator<<
   {
@@ -37,10 +45,16 @@ void test_controller_type()
 std::string to_str(const controller_type t) noexcept
 {
   if (t == controller_type::mouse) return "mouse";
+  if (t == controller_type::ai) return "ai";
   assert(t == controller_type::keyboard);
   return "keyboard";
 }
 
+bool uses_keyboard_actions(const controller_type t) noexcept
+{
+  return t != controller_type::mouse;
+}
+
 std::ostream& operator<<(std::ostream& os, const controller_type t) noexcept
 {
   os << to_str(t);
@@ -8,13 +8,21 @@
 enum class controller_type
 {
   keyboard,
-  mouse
+  mouse,
+
+  /// A computer player, that thinks on another thread
+  /// and gives the same actions as a keyboard user does
+  ai
 };
 
 /// Get the next controller type,
 /// i.e. when the player presses right
 controller_type get_next(const controller_type t) noexcept;
 
+/// Does a player with this controller give keyboard actions?
+/// This is true for the keyboard and for the AI
+bool uses_keyboard_actions(const controller_type t) noexcept;
+
 /// Test this class and its free functions
 void test_controller_type();
 
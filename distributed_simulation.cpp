@@ -0,0 +1,327 @@
+#include "distributed_simulation.h"
+
+#include "tcp_listener.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <poll.h>
+
+void hand_out_jobs(
+  coordinated_worker& w,
+  std::deque<int>& todo,
+  const std::vector<simulation_job>& jobs,
+  const int max_n_jobs_per_worker,
+  const std::chrono::milliseconds job_timeout
+)
+{
+  if (w.m_jobs.empty() && !todo.empty())
+  {
+    w.m_deadline = std::chrono::steady_clock::now() + job_timeout;
+  }
+  while (static_cast<int>(w.m_jobs.size()) < max_n_jobs_per_worker
+    && !todo.empty()
+    && w.m_socket.is_open()
+  )
+  {
+    const int index{todo.front()};
+    todo.pop_front();
+    // If sending fails, the job is handed out again
+    // when the lost worker is removed
+    w.m_jobs.push_back(index);
+    w.m_socket.send_line(to_str(jobs[index]));
+  }
+}
+
+distributed_result run_coordinator(
+  const std::vector<simulation_job>& jobs,
+  tcp_listener& listener,
+  const int max_n_jobs_per_worker,
+  const std::chrono::milliseconds job_timeout
+)
+{
+  assert(max_n_jobs_per_worker > 0);
+  assert(job_timeout.count() > 0);
+  const int n_jobs{static_cast<int>(jobs.size())};
+  const auto start{std::chrono::steady_clock::now()};
+  std::deque<int> todo;
+  for (int i{0}; i != n_jobs; ++i) todo.push_back(i);
+  std::vector<std::optional<simulation_result>> results(n_jobs);
+  int n_results{0};
+  int n_redispatched{0};
+  int n_workers{0};
+  int n_timed_out{0};
+  std::vector<coordinated_worker> workers;
+
+  while (n_results != n_jobs)
+  {
+    // Wait for a worker to connect or to send something,
+    // or until the first deadline of a worker passes
+    std::vector<pollfd> fds;
+    fds.push_back(pollfd{listener.get_fd(), POLLIN, 0});
+    for (const auto& w: workers) fds.push_back(pollfd{w.m_socket.get_fd(), POLLIN, 0});
+    auto wait_until{std::chrono::steady_clock::now() + job_timeout};
+    for (const auto& w: workers)
+    {
+      if (!w.m_jobs.empty()) wait_until = std::min(wait_until, w.m_deadline);
+    }
+    const auto timeout{
+      std::chrono::ceil<std::chrono::milliseconds>(
+        wait_until - std::chrono::steady_clock::now()
+      )
+    };
+    if (poll(fds.data(), fds.size(), std::max(0, static_cast<int>(timeout.count()))) == -1)
+    {
+      continue;
+    }
+
+    const int n_workers_before{static_cast<int>(workers.size())};
+    for (int i{0}; i != n_workers_before; ++i)
+    {
+      if (fds[i + 1].revents == 0) continue;
+      auto& w{workers[i]};
+      if (!w.m_socket.receive()) continue;
+      while (const auto line{w.m_socket.pop_line()})
+      {
+        try
+        {
+          const auto [index, result]{to_indexed_result(*line)};
+          const auto job{std::find(std::begin(w.m_jobs), std::end(w.m_jobs), index)};
+          if (job == std::end(w.m_jobs)) throw std::runtime_error("Unknown job");
+          w.m_jobs.erase(job);
+          w.m_deadline = std::chrono::steady_clock::now() + job_timeout;
+          if (!results[index])
+          {
+            results[index] = result;
+            ++n_results;
+          }
+        }
+        catch (const std::runtime_error&)
+        {
+          // A worker that does not follow the protocol is lost
+          w.m_socket.close();
+          break;
+        }
+      }
+    }
+    if (fds[0].revents != 0)
+    {
+      workers.push_back(coordinated_worker{{}, listener.accept(), {}});
+      ++n_workers;
+    }
+
+    // A worker that has not sent a result in time is lost
+    const auto now{std::chrono::steady_clock::now()};
+    for (auto& w: workers)
+    {
+      if (!w.m_socket.is_open() || w.m_jobs.empty() || now < w.m_deadline) continue;
+      w.m_socket.close();
+      ++n_timed_out;
+    }
+
+    // The unfinished jobs of lost workers are done first by the others
+    for (const auto& w: workers)
+    {
+      if (w.m_socket.is_open()) continue;
+      std::for_each(
+        std::rbegin(w.m_jobs),
+        std::rend(w.m_jobs),
+        [&todo](const int index) { todo.push_front(index); }
+      );
+      n_redispatched += w.m_jobs.size();
+    }
+    workers.erase(
+      std::remove_if(
+        std::begin(workers),
+        std::end(workers),
+        [](const auto& w) { return !w.m_socket.is_open(); }
+      ),
+      std::end(workers)
+    );
+    for (auto& w: workers)
+    {
+      hand_out_jobs(w, todo, jobs, max_n_jobs_per_worker, job_timeout);
+    }
+  }
+
+  for (auto& w: workers) w.m_socket.send_line("quit");
+
+  std::vector<simulation_result> all_results;
+  all_results.reserve(n_jobs);
+  for (const auto& r: results) all_results.push_back(r.value());
+  return distributed_result{
+    all_results,
+    n_redispatched,
+    n_workers,
+    n_timed_out,
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+  };
+}
+
+int run_worker(const std::string& host, const int port)
+{
+  tcp_socket s(host, port);
+  int n_games{0};
+  while (const auto line{s.read_line()})
+  {
+    if (*line == "quit") break;
+    const auto job{to_simulation_job(*line)};
+    if (!s.send_line(to_result_message(job.m_index, play(job)))) break;
+    ++n_games;
+  }
+  return n_games;
+}
+
+std::pair<int, simulation_result> to_indexed_result(const std::string& s)
+{
+  std::stringstream stream(s);
+  std::string word;
+  int index{0};
+  std::string result;
+  int n_ticks{0};
+  std::string time;
+  stream >> word >> index >> result >> n_ticks >> time;
+  if (!stream || word != "result" || index < 0)
+  {
+    throw std::runtime_error("Invalid result '" + s + "'");
+  }
+  return std::make_pair(
+    index,
+    simulation_result{to_game_result(result), n_ticks, delta_t(std::stod(time))}
+  );
+}
+
+std::string to_result_message(const int index, const simulation_result& r)
+{
+  std::stringstream s;
+  s << "result " << index << ' ' << to_str(r.m_result) << ' '
+    << r.m_n_ticks << ' ' << to_exact_str(r.m_time.get())
+  ;
+  return s.str();
+}
+
+void test_distributed_simulation()
+{
+#ifndef NDEBUG
+  // A result survives being sent as text
+  {
+    const simulation_result r{game_result::black_wins, 123, delta_t(0.1 + 0.2)};
+    const auto [index, result]{to_indexed_result(to_result_message(7, r))};
+    assert(index == 7);
+    assert(result.m_result == r.m_result);
+    assert(result.m_n_ticks == r.m_n_ticks);
+    assert(result.m_time == r.m_time);
+  }
+  // Invalid results
+  {
+    for (const std::string s: {"", "result 1", "result -1 draw 1 1", "job 1 draw 1 1", "result 1 nonsense 1 1"})
+    {
+      bool has_thrown{false};
+      try { to_indexed_result(s); } catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // Workers play all jobs, also when a worker is lost
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(1.0);
+    options.m_n_games = 6;
+    const auto jobs{create_simulation_jobs(options)};
+    auto listener{std::make_unique<tcp_listener>(0)};
+    const int port{listener->get_port()};
+
+    // The first worker to connect quits after receiving its first job
+    tcp_socket lost_worker("localhost", port);
+    std::thread lost_worker_thread(
+      [&lost_worker]()
+      {
+        assert(lost_worker.read_line());
+        lost_worker.close();
+      }
+    );
+    int n_games_a{0};
+    int n_games_b{0};
+    std::thread worker_a([&n_games_a, port]() { n_games_a = run_worker("localhost", port); });
+    std::thread worker_b([&n_games_b, port]() { n_games_b = run_worker("localhost", port); });
+    const auto r{run_coordinator(jobs, *listener)};
+    // A worker that connected after all jobs were done is refused
+    listener.reset();
+    lost_worker_thread.join();
+    worker_a.join();
+    worker_b.join();
+
+    assert(r.m_n_workers >= 2);
+    assert(r.m_n_redispatched >= 1);
+    assert(n_games_a + n_games_b == options.m_n_games);
+    assert(static_cast<int>(r.m_results.size()) == options.m_n_games);
+    for (int i{0}; i != options.m_n_games; ++i)
+    {
+      const auto expected{play(jobs[i])};
+      assert(r.m_results[i].m_result == expected.m_result);
+      assert(r.m_results[i].m_n_ticks == expected.m_n_ticks);
+      assert(r.m_results[i].m_time == expected.m_time);
+    }
+    std::stringstream s;
+    s << r;
+    assert(s.str().find("redispatched") != std::string::npos);
+  }
+  // A worker that never sends a result is lost after the job timeout,
+  // after which its jobs are played by the others
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(1.0);
+    options.m_n_games = 3;
+    const auto jobs{create_simulation_jobs(options)};
+    auto listener{std::make_unique<tcp_listener>(0)};
+    const int port{listener->get_port()};
+
+    // The first worker to connect reads its jobs, but stalls,
+    // until the coordinator closes the connection
+    tcp_socket stalled_worker("localhost", port);
+    std::thread stalled_worker_thread(
+      [&stalled_worker]() { while (stalled_worker.read_line()) {} }
+    );
+    int n_games{0};
+    std::thread worker([&n_games, port]() { n_games = run_worker("localhost", port); });
+    const auto r{run_coordinator(jobs, *listener, 2, std::chrono::milliseconds(100))};
+    listener.reset();
+    stalled_worker_thread.join();
+    worker.join();
+
+    assert(r.m_n_timed_out == 1);
+    assert(r.m_n_redispatched == 2);
+    assert(n_games == options.m_n_games);
+    for (int i{0}; i != options.m_n_games; ++i)
+    {
+      assert(r.m_results[i].m_n_ticks == play(jobs[i]).m_n_ticks);
+    }
+    std::stringstream s;
+    s << r;
+    assert(s.str().find("timed_out: 1") != std::string::npos);
+  }
+#endif // NDEBUG
+}
+
+std::ostream& operator<<(std::ostream& os, const distributed_result& r) noexcept
+{
+  long long n_ticks{0};
+  for (const auto& g: r.m_results) n_ticks += g.m_n_ticks;
+  const int n_games{static_cast<int>(r.m_results.size())};
+  const double secs{r.m_wall_time};
+  os << "workers: " << r.m_n_workers << '\n'
+    << "redispatched: " << r.m_n_redispatched << '\n'
+    << "timed_out: " << r.m_n_timed_out << '\n'
+    << "ticks: " << n_ticks << '\n'
+    << "seconds: " << secs << '\n'
+    << "games_per_sec: " << (secs > 0.0 ? n_games / secs : 0.0) << '\n'
+    << "ticks_per_sec: " << (secs > 0.0 ? n_ticks / secs : 0.0) << '\n'
+  ;
+  return os;
+}
@@ -0,0 +1,105 @@
+#ifndef DISTRIBUTED_SIMULATION_H
+#define DISTRIBUTED_SIMULATION_H
+
+#include "ccfwd.h"
+#include "simulation.h"
+#include "simulation_job.h"
+#include "tcp_socket.h"
+
+#include <chrono>
+#include <deque>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// The result of a simulation of which the games
+/// are played by worker processes
+struct distributed_result
+{
+  /// The result of each game, in the order of the games
+  std::vector<simulation_result> m_results;
+
+  /// The number of jobs handed out again,
+  /// because the worker they were handed out to was lost
+  int m_n_redispatched;
+
+  /// The number of workers that connected
+  int m_n_workers;
+
+  /// The number of workers that were lost
+  /// because they did not send a result in time
+  int m_n_timed_out;
+
+  /// The time it took to play all games, in seconds
+  double m_wall_time;
+};
+
+/// A worker process, as seen by the coordinator
+struct coordinated_worker
+{
+  /// The indices of the jobs handed out, of which the result is not in yet
+  std::vector<int> m_jobs;
+
+  tcp_socket m_socket;
+
+  /// When the worker has jobs, the time its next result must be in by
+  std::chrono::steady_clock::time_point m_deadline;
+};
+
+/// Hand out the jobs to the worker processes that connect,
+/// until the results of all jobs are in,
+/// after which the workers are told to quit.
+/// A worker gets a few jobs at a time, so that it does not
+/// need to wait for the next job after sending a result.
+/// When a worker is lost, the jobs it did not finish
+/// are handed out again to the other workers.
+/// A worker that has jobs, yet sends no result within the job timeout,
+/// e.g. because it hangs or its connection silently dropped,
+/// counts as lost.
+/// Waits for a worker to connect if there is none
+/// @param max_n_jobs_per_worker the maximum number of jobs a worker has at a time
+/// @param job_timeout the time a worker has to play a job and send its result
+distributed_result run_coordinator(
+  const std::vector<simulation_job>& jobs,
+  tcp_listener& listener,
+  const int max_n_jobs_per_worker = 2,
+  const std::chrono::milliseconds job_timeout = std::chrono::minutes(10)
+);
+
+/// Hand out jobs to a worker, until it has as many as it can have,
+/// or until there are no jobs left.
+/// A worker that had no jobs has until the job timeout from now
+/// to send its first result
+void hand_out_jobs(
+  coordinated_worker& w,
+  std::deque<int>& todo,
+  const std::vector<simulation_job>& jobs,
+  const int max_n_jobs_per_worker,
+  const std::chrono::milliseconds job_timeout
+);
+
+/// Be a worker process: connect to a coordinator,
+/// play the jobs it hands out and send back the results,
+/// until the coordinator is done or lost.
+/// Will throw if the coordinator cannot be reached.
+/// @return the number of games played
+int run_worker(const std::string& host, const int port);
+
+/// Test this class and its free functions
+void test_distributed_simulation();
+
+/// Get the index and result of a game from its line of text,
+/// as shown by 'to_result_message'.
+/// Will throw if the line is not a result
+std::pair<int, simulation_result> to_indexed_result(const std::string& s);
+
+/// Get the result of a game as one line of text, e.g.
+/// 'result 3 white_wins 1234 20.5666',
+/// being the index, result, number of ticks and in-game time
+std::string to_result_message(const int index, const simulation_result& r);
+
+/// Show the speed of the simulation and how many jobs were handed out again
+std::ostream& operator<<(std::ostream& os, const distributed_result& r) noexcept;
+
+#endif // DISTRIBUTED_SIMULATION_H
@@ -0,0 +1,188 @@
+#include "elo_rating.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+std::vector<double> calc_elos(
+  const int n_players,
+  const std::vector<rated_game>& games
+)
+{
+  assert(n_players > 0);
+
+  // The total score per player, and the number of games per pair of players,
+  // starting with the one extra draw per pair
+  std::vector<double> scores(n_players, 0.5 * (n_players - 1));
+  std::vector<std::vector<double>> n_games(
+    n_players,
+    std::vector<double>(n_players, 1.0)
+  );
+  for (const auto& g: games)
+  {
+    assert(g.m_white >= 0 && g.m_white < n_players);
+    assert(g.m_black >= 0 && g.m_black < n_players);
+    assert(g.m_white != g.m_black);
+    scores[g.m_white] += g.m_white_score;
+    scores[g.m_black] += 1.0 - g.m_white_score;
+    n_games[g.m_white][g.m_black] += 1.0;
+    n_games[g.m_black][g.m_white] += 1.0;
+  }
+
+  // The strength per player, found by the minorization-maximization
+  // algorithm of Hunter, 2004, 'MM algorithms for generalized
+  // Bradley-Terry models', which converges for any start
+  std::vector<double> strengths(n_players, 1.0);
+  for (int iteration{0}; iteration != 10000; ++iteration)
+  {
+    double max_change{0.0};
+    for (int i{0}; i != n_players; ++i)
+    {
+      double sum{0.0};
+      for (int j{0}; j != n_players; ++j)
+      {
+        if (i == j) continue;
+        sum += n_games[i][j] / (strengths[i] + strengths[j]);
+      }
+      const double strength{sum > 0.0 ? scores[i] / sum : 1.0};
+      max_change = std::max(max_change, std::abs(std::log(strength / strengths[i])));
+      strengths[i] = strength;
+    }
+    if (max_change < 1.0e-10) break;
+  }
+
+  std::vector<double> elos;
+  elos.reserve(n_players);
+  for (const auto s: strengths) elos.push_back(400.0 * std::log10(s));
+  const double mean{std::accumulate(std::begin(elos), std::end(elos), 0.0) / n_players};
+  for (auto& e: elos) e -= mean;
+  return elos;
+}
+
+std::vector<elo_rating> calc_elo_ratings(
+  const int n_players,
+  const std::vector<rated_game>& games,
+  const int n_resamples,
+  const unsigned int seed
+)
+{
+  assert(n_resamples > 0);
+  const auto elos{calc_elos(n_players, games)};
+
+  // The ratings per player, one per resample
+  std::vector<std::vector<double>> resampled_elos(n_players);
+  std::mt19937 rng_engine(seed);
+  std::vector<rated_game> resampled_games(games.size());
+  for (int i{0}; i != n_resamples; ++i)
+  {
+    if (!games.empty())
+    {
+      std::uniform_int_distribution<std::size_t> d(0, games.size() - 1);
+      for (auto& g: resampled_games) g = games[d(rng_engine)];
+    }
+    const auto e{calc_elos(n_players, resampled_games)};
+    for (int j{0}; j != n_players; ++j) resampled_elos[j].push_back(e[j]);
+  }
+
+  std::vector<elo_rating> ratings;
+  ratings.reserve(n_players);
+  for (int i{0}; i != n_players; ++i)
+  {
+    auto& v{resampled_elos[i]};
+    std::sort(std::begin(v), std::end(v));
+    const int low{static_cast<int>(0.025 * (n_resamples - 1))};
+    const int high{static_cast<int>(std::ceil(0.975 * (n_resamples - 1)))};
+    ratings.push_back(elo_rating{elos[i], v[low], v[high]});
+  }
+  return ratings;
+}
+
+double get_expected_score(const double elo_difference) noexcept
+{
+  return 1.0 / (1.0 + std::pow(10.0, -elo_difference / 400.0));
+}
+
+void test_elo_rating()
+{
+#ifndef NDEBUG
+  // get_expected_score
+  {
+    assert(get_expected_score(0.0) == 0.5);
+    assert(std::abs(get_expected_score(400.0) - (10.0 / 11.0)) < 1.0e-12);
+    assert(std::abs(get_expected_score(100.0) + get_expected_score(-100.0) - 1.0) < 1.0e-12);
+  }
+  // Without games, all players are equal
+  {
+    const auto elos{calc_elos(3, {})};
+    assert(elos.size() == 3);
+    for (const auto e: elos) assert(std::abs(e) < 1.0e-9);
+  }
+  // Equal scores give equal ratings
+  {
+    const std::vector<rated_game> games{{0, 1, 1.0}, {1, 0, 1.0}, {0, 1, 0.5}};
+    const auto elos{calc_elos(2, games)};
+    assert(std::abs(elos[0] - elos[1]) < 1.0e-6);
+  }
+  // The ratings predict the scores
+  {
+    // Player 0 scores 75% against player 1
+    std::vector<rated_game> games;
+    for (int i{0}; i != 300; ++i) games.push_back({0, 1, 1.0});
+    for (int i{0}; i != 100; ++i) games.push_back({1, 0, 1.0});
+    const auto elos{calc_elos(2, games)};
+    assert(elos[0] > elos[1]);
+    assert(std::abs(elos[0] + elos[1]) < 1.0e-6);
+    // The one extra draw moves the score only a tiny bit from 75%
+    assert(std::abs(get_expected_score(elos[0] - elos[1]) - 0.75) < 0.01);
+  }
+  // A player that wins all games gets a finite rating
+  {
+    const std::vector<rated_game> games{{0, 1, 1.0}, {1, 0, 0.0}, {0, 2, 1.0}, {1, 2, 0.5}};
+    const auto elos{calc_elos(3, games)};
+    assert(std::isfinite(elos[0]));
+    assert(elos[0] > elos[1]);
+    assert(elos[0] > elos[2]);
+  }
+  // Ratings are transitive
+  {
+    std::vector<rated_game> games;
+    for (int i{0}; i != 20; ++i)
+    {
+      games.push_back({0, 1, 1.0});
+      games.push_back({1, 2, 1.0});
+      games.push_back({2, 0, 0.0});
+    }
+    const auto elos{calc_elos(3, games)};
+    assert(elos[0] > elos[1]);
+    assert(elos[1] > elos[2]);
+  }
+  // The confidence interval contains the rating and shrinks with more games
+  {
+    std::vector<rated_game> few_games;
+    for (int i{0}; i != 10; ++i) few_games.push_back({0, 1, i < 7 ? 1.0 : 0.0});
+    std::vector<rated_game> many_games;
+    for (int i{0}; i != 10; ++i) std::copy(std::begin(few_games), std::end(few_games), std::back_inserter(many_games));
+    const auto few{calc_elo_ratings(2, few_games)};
+    const auto many{calc_elo_ratings(2, many_games)};
+    for (const auto& r: few) assert(r.m_low <= r.m_elo && r.m_elo <= r.m_high);
+    for (const auto& r: many) assert(r.m_low <= r.m_elo && r.m_elo <= r.m_high);
+    assert(many[0].m_high - many[0].m_low < few[0].m_high - few[0].m_low);
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    s << elo_rating{12.3, -4.5, 30.1};
+    assert(!s.str().empty());
+  }
+#endif // NDEBUG
+}
+
+std::ostream& operator<<(std::ostream& os, const elo_rating& r) noexcept
+{
+  os << r.m_elo << " [" << r.m_low << ", " << r.m_high << "]";
+  return os;
+}
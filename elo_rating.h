@@ -0,0 +1,69 @@
+#ifndef ELO_RATING_H
+#define ELO_RATING_H
+
+#include <iosfwd>
+#include <vector>
+
+/// A game between two players, as used to rate the players
+struct rated_game
+{
+  /// The index of the player that played white
+  int m_white;
+
+  /// The index of the player that played black
+  int m_black;
+
+  /// The score of white: 1.0 for a win, 0.5 for a draw, 0.0 for a loss
+  double m_white_score;
+};
+
+/// The Elo rating of a player, with its 95% confidence interval
+struct elo_rating
+{
+  double m_elo;
+
+  /// The lower bound of the 95% confidence interval
+  double m_low;
+
+  /// The upper bound of the 95% confidence interval
+  double m_high;
+};
+
+/// Calculate the Elo rating of each player from the games played,
+/// where the average player has a rating of zero.
+/// The ratings are the maximum likelihood estimate of the Bradley-Terry model,
+/// in which a draw counts as half a win for both players.
+/// Each pair of players is assumed to have drawn one extra game,
+/// so that a player that won or lost all its games
+/// still gets a finite rating
+/// @param n_players the number of players, at least one
+std::vector<double> calc_elos(
+  const int n_players,
+  const std::vector<rated_game>& games
+);
+
+/// Calculate the Elo rating of each player from the games played,
+/// with a confidence interval found by bootstrapping:
+/// calculating the ratings again for games drawn at random,
+/// with replacement, from the games played
+/// @param n_players the number of players, at least one
+/// @param n_resamples the number of times the games are drawn at random
+/// @param seed the seed of the random numbers
+/// @see use 'calc_elos' for the ratings only
+std::vector<elo_rating> calc_elo_ratings(
+  const int n_players,
+  const std::vector<rated_game>& games,
+  const int n_resamples = 200,
+  const unsigned int seed = 42
+);
+
+/// Get the expected score of a player against another,
+/// from the difference in their Elo ratings
+double get_expected_score(const double elo_difference) noexcept;
+
+/// Test this class and its free functions
+void test_elo_rating();
+
+std::ostream& operator<<(std::ostream& os, const elo_rating& r) noexcept;
+
+#endif // ELO_RATING_H
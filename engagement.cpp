@@ -0,0 +1,487 @@
+#include "engagement.h"
+
+#include "game.h"
+#include "piece.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <string>
+
+delta_t get_time_to_kill(
+  const game& g,
+  const piece& target,
+  const int n_attackers
+)
+{
+  assert(n_attackers > 0);
+  const double damage_per_time{
+    g.get_options().get_damage_per_chess_move() * static_cast<double>(n_attackers)
+  };
+  assert(damage_per_time > 0.0);
+  return delta_t(std::max(0.0, target.get_health()) / damage_per_time);
+}
+
+delta_t get_time_to_leave(
+  const game& g,
+  const piece& p
+)
+{
+  assert(has_actions(p));
+  assert(p.get_actions()[0].get_action_type() == piece_action_type::move);
+  const double speed{g.get_options().get_movement_speed()};
+  assert(speed > 0.0);
+  return delta_t(std::max(0.0, 0.5 - p.get_current_action_time().get()) / speed);
+}
+
+engagement_outcome predict_engagement(
+  const game& g,
+  const int index,
+  const delta_t& dt
+)
+{
+  assert(index >= 0);
+  assert(index < static_cast<int>(g.get_pieces().size()));
+  for (const auto& outcome: predict_engagements(g, dt))
+  {
+    if (outcome.m_index == index) return outcome;
+  }
+  return engagement_outcome{index, false, false, -1, g.get_time()};
+}
+
+std::vector<engagement_outcome> predict_engagements(
+  const game& g,
+  const delta_t& dt
+)
+{
+  assert(dt.get() > 0.0);
+  const auto& pieces{g.get_pieces()};
+  const int n_pieces{static_cast<int>(pieces.size())};
+
+  // Which piece is where, by index in the game, as a tick of the game starts with
+  const int board_size{get_board_size(g.get_options())};
+  const auto to_index{
+    [board_size](const square& s) { return (s.get_x() * board_size) + s.get_y(); }
+  };
+  std::vector<int> occupancy(board_size * board_size, -1);
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    occupancy[to_index(pieces[i].get_current_square())] = i;
+  }
+
+  // The pieces that attack an enemy, and the enemies these attack,
+  // by index in the game
+  std::vector<bool> is_in_fight(n_pieces, false);
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    const auto& p{pieces[i]};
+    if (!has_actions(p)) continue;
+    const auto& action{p.get_actions()[0]};
+    if (action.get_action_type() != piece_action_type::attack) continue;
+    const int target{occupancy[to_index(action.get_to())]};
+    if (target == -1 || pieces[target].get_color() == p.get_color()) continue;
+    is_in_fight[i] = true;
+    is_in_fight[target] = true;
+  }
+
+  // What matters of a piece in the fight
+  struct fighter
+  {
+    int m_index;
+    chess_color m_color;
+    double m_health;
+    square m_square;
+    bool m_is_attacking;
+    bool m_is_moving;
+    bool m_is_removed;
+    square m_to;
+    delta_t m_progress;
+  };
+  std::vector<fighter> fighters;
+  std::vector<engagement_outcome> outcomes;
+  // Per index in the game, the index of the fighter, if any
+  std::vector<int> fighter_indices(n_pieces, -1);
+  const bool do_free_movement{g.get_options().do_free_movement()};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    if (!is_in_fight[i]) continue;
+    const auto& p{pieces[i]};
+    const bool is_attacking{
+      has_actions(p)
+      && p.get_actions()[0].get_action_type() == piece_action_type::attack
+    };
+    const bool is_moving{
+      has_actions(p)
+      && p.get_actions()[0].get_action_type() == piece_action_type::move
+      && p.get_actions()[0].get_to() != p.get_current_square()
+    };
+    fighter_indices[i] = static_cast<int>(fighters.size());
+    fighters.push_back(
+      fighter{
+        i,
+        p.get_color(),
+        p.get_health(),
+        p.get_current_square(),
+        is_attacking,
+        is_moving,
+        false,
+        has_actions(p) ? p.get_actions()[0].get_to() : p.get_current_square(),
+        p.get_current_action_time()
+      }
+    );
+    outcomes.push_back(engagement_outcome{i, false, false, -1, g.get_time()});
+  }
+  if (fighters.empty()) return outcomes;
+
+  const auto move_to{
+    [&occupancy, &to_index](fighter& f, const square& s)
+    {
+      if (occupancy[to_index(f.m_square)] == f.m_index)
+      {
+        occupancy[to_index(f.m_square)] = -1;
+      }
+      f.m_square = s;
+      occupancy[to_index(s)] = f.m_index;
+    }
+  };
+  const auto has_actions_at{
+    [&](const int index)
+    {
+      const int fighter_index{fighter_indices[index]};
+      if (fighter_index == -1) return has_actions(pieces[index]);
+      return fighters[fighter_index].m_is_attacking
+        || fighters[fighter_index].m_is_moving;
+    }
+  };
+
+  // The same arithmetic as 'tick_attack' and 'tick_move'
+  const double damage{g.get_options().get_damage_per_chess_move() * dt.get()};
+  const delta_t move_dt{dt * delta_t(g.get_options().get_movement_speed())};
+  delta_t t{g.get_time()};
+  const auto is_fighting{
+    [&fighters]()
+    {
+      return std::any_of(
+        std::begin(fighters),
+        std::end(fighters),
+        [](const auto& f) { return !f.m_is_removed && f.m_is_attacking; }
+      );
+    }
+  };
+  // A piece that is killed earlier in the tick still gets away,
+  // yet is removed at the end of the tick
+  const auto escape{
+    [&move_to, &t](fighter& f, engagement_outcome& outcome)
+    {
+      move_to(f, f.m_to);
+      f.m_is_moving = false;
+      if (outcome.m_is_killed) return;
+      outcome.m_is_escaped = true;
+      outcome.m_t = t;
+    }
+  };
+  while (is_fighting())
+  {
+    t += dt;
+    bool is_death{false};
+    // As in a tick of the game, a piece that is killed
+    // still acts until the end of the tick
+    for (auto& f: fighters)
+    {
+      if (f.m_is_removed) continue;
+      auto& outcome{outcomes[fighter_indices[f.m_index]]};
+      if (f.m_is_attacking)
+      {
+        const int index{occupancy[to_index(f.m_to)]};
+        // The other pieces stay where they are
+        assert(index == -1 || fighter_indices[index] != -1);
+        if (index == -1 || fighters[fighter_indices[index]].m_color == f.m_color)
+        {
+          f.m_is_attacking = false;
+          continue;
+        }
+        auto& target{fighters[fighter_indices[index]]};
+        target.m_health -= damage;
+        if (target.m_health <= 0.0)
+        {
+          auto& target_outcome{outcomes[fighter_indices[index]]};
+          if (!target_outcome.m_is_killed)
+          {
+            target_outcome.m_is_killed = true;
+            target_outcome.m_killer_index = f.m_index;
+            target_outcome.m_t = t;
+          }
+          move_to(f, f.m_to); // Capture
+          f.m_is_attacking = false;
+          is_death = true;
+        }
+      }
+      else if (f.m_is_moving)
+      {
+        const delta_t progress_before{f.m_progress};
+        f.m_progress = f.m_progress + move_dt;
+        const double progress{f.m_progress.get()};
+        const bool is_to_occupied{occupancy[to_index(f.m_to)] != -1};
+        if (progress >= 1.0)
+        {
+          // Cannot be done without getting halfway first
+          f.m_is_moving = false;
+        }
+        else if (do_free_movement && pieces[f.m_index].get_type() != piece_type::knight)
+        {
+          if (progress < 0.5) continue;
+          if (!is_to_occupied)
+          {
+            escape(f, outcome);
+            continue;
+          }
+          // Wait for a piece that is leaving,
+          // yet do not wait for a piece that stays
+          f.m_progress = progress_before;
+          if (!has_actions_at(occupancy[to_index(f.m_to)])) f.m_is_moving = false;
+        }
+        else if (is_to_occupied)
+        {
+          // Goes back
+          f.m_is_moving = false;
+        }
+        else if (progress >= 0.5)
+        {
+          escape(f, outcome);
+        }
+      }
+    }
+    if (!is_death) continue;
+
+    // Remove the killed pieces, as the game does at the end of a tick
+    for (auto& f: fighters)
+    {
+      if (!f.m_is_removed && f.m_health <= 0.0) f.m_is_removed = true;
+    }
+    std::fill(std::begin(occupancy), std::end(occupancy), -1);
+    for (int i{0}; i != n_pieces; ++i)
+    {
+      const int fighter_index{fighter_indices[i]};
+      if (fighter_index == -1)
+      {
+        occupancy[to_index(pieces[i].get_current_square())] = i;
+      }
+      else if (!fighters[fighter_index].m_is_removed)
+      {
+        occupancy[to_index(fighters[fighter_index].m_square)] = i;
+      }
+    }
+  }
+  // The survivors are done fighting when the fight is over
+  for (auto& outcome: outcomes)
+  {
+    if (!outcome.m_is_killed && !outcome.m_is_escaped) outcome.m_t = t;
+  }
+  return outcomes;
+}
+
+void test_engagement()
+{
+#ifndef NDEBUG
+  // Give a piece an action from where it is now
+  const auto order{
+    [](game& g, const int index, const piece_action_type type, const std::string& to)
+    {
+      auto& p{g.get_pieces()[index]};
+      p.add_action(
+        piece_action(p.get_player(), p.get_type(), type, p.get_current_square(), square(to))
+      );
+    }
+  };
+  // Tick the game, checking that each piece is killed or escapes
+  // in the tick predicted, and not before
+  const auto check_exact{
+    [](const game& start, const delta_t& dt)
+    {
+      const auto outcomes{predict_engagements(start, dt)};
+      delta_t t_end{start.get_time()};
+      for (const auto& outcome: outcomes)
+      {
+        if (t_end < outcome.m_t) t_end = outcome.m_t;
+      }
+      game g{start};
+      while (g.get_time() < t_end + delta_t(1.0))
+      {
+        g.tick(dt);
+        for (const auto& outcome: outcomes)
+        {
+          const auto& before{start.get_pieces()[outcome.m_index]};
+          const int index{get_index_of_piece_with_id(g, before.get_id())};
+          const bool is_killed_now{index == -1};
+          assert(is_killed_now == (outcome.m_is_killed && !(g.get_time() < outcome.m_t)));
+          if (is_killed_now) continue;
+          const auto& p{g.get_pieces()[index]};
+          const bool is_escaped_now{
+            p.get_current_square() != before.get_current_square()
+            && p.get_kill_count() == before.get_kill_count()
+          };
+          assert(is_escaped_now == (outcome.m_is_escaped && !(g.get_time() < outcome.m_t)));
+        }
+      }
+      for (const auto& outcome: outcomes)
+      {
+        if (!outcome.m_is_killed) continue;
+        const auto& killer{start.get_pieces()[outcome.m_killer_index]};
+        const int index{get_index_of_piece_with_id(g, killer.get_id())};
+        if (index == -1) continue;
+        assert(g.get_pieces()[index].get_kill_count() > killer.get_kill_count());
+      }
+    }
+  };
+  // get_time_to_kill
+  {
+    const game g{get_game_with_starting_position(starting_position_type::kings_only)};
+    const auto& king{g.get_pieces()[0]};
+    const double damage{g.get_options().get_damage_per_chess_move()};
+    assert(get_time_to_kill(g, king, 1).get() == king.get_health() / damage);
+    assert(get_time_to_kill(g, king, 2).get() == king.get_health() / (2.0 * damage));
+  }
+  // get_time_to_leave
+  {
+    game g{get_game_with_starting_position(starting_position_type::kings_only)};
+    order(g, 0, piece_action_type::move, "e2");
+    const double speed{g.get_options().get_movement_speed()};
+    assert(get_time_to_leave(g, g.get_pieces()[0]).get() == 0.5 / speed);
+  }
+  // Nothing happens without attacks
+  {
+    const game g;
+    assert(predict_engagements(g, delta_t(0.01)).empty());
+    const auto outcome{predict_engagement(g, 0, delta_t(0.01))};
+    assert(outcome.m_index == 0);
+    assert(!outcome.m_is_killed);
+    assert(!outcome.m_is_escaped);
+    assert(outcome.m_killer_index == -1);
+  }
+  // queen_end_game: 0 is the white queen at d1, 1 the white king at e1,
+  // 2 the black queen at d8, 3 the black king at e8
+  // A queen kills an idle king
+  {
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("a4"));
+    order(g, 0, piece_action_type::attack, "a4");
+    const delta_t dt(0.01);
+    const auto outcomes{predict_engagements(g, dt)};
+    assert(outcomes.size() == 2);
+    assert(outcomes[0].m_index == 0);
+    assert(!outcomes[0].m_is_killed);
+    assert(outcomes[1].m_index == 3);
+    assert(outcomes[1].m_is_killed);
+    assert(outcomes[1].m_killer_index == 0);
+    // With short ticks, the king dies about when expected
+    const double t_expected{get_time_to_kill(g, g.get_pieces()[3], 1).get()};
+    assert(std::abs(outcomes[1].m_t.get() - t_expected) <= dt.get() + 0.000001);
+    assert(predict_engagement(g, 3, dt).m_is_killed);
+    check_exact(g, dt);
+    check_exact(g, delta_t(0.1));
+    check_exact(g, delta_t(0.3));
+  }
+  // Two attackers kill faster than one
+  {
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("d2"));
+    order(g, 0, piece_action_type::attack, "d2");
+    order(g, 1, piece_action_type::attack, "d2");
+    const auto one{
+      predict_engagement(get_game_with_starting_position(starting_position_type::queen_end_game), 3, delta_t(0.01))
+    };
+    assert(!one.m_is_killed);
+    const auto outcome{predict_engagement(g, 3, delta_t(0.01))};
+    assert(outcome.m_is_killed);
+    assert(outcome.m_killer_index == 0 || outcome.m_killer_index == 1);
+    check_exact(g, delta_t(0.01));
+    check_exact(g, delta_t(0.07));
+  }
+  // Two pieces attacking each other
+  {
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[2].set_current_square(square("d4"));
+    order(g, 0, piece_action_type::attack, "d4");
+    order(g, 2, piece_action_type::attack, "d1");
+    const auto outcomes{predict_engagements(g, delta_t(0.01))};
+    assert(outcomes.size() == 2);
+    // The piece that ticks first strikes first
+    assert(!outcomes[0].m_is_killed);
+    assert(outcomes[1].m_is_killed);
+    check_exact(g, delta_t(0.01));
+    check_exact(g, delta_t(0.5));
+  }
+  // A piece that moves away escapes
+  {
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("a4"));
+    order(g, 0, piece_action_type::attack, "a4");
+    order(g, 3, piece_action_type::move, "a5");
+    const auto outcome{predict_engagement(g, 3, delta_t(0.01))};
+    assert(!outcome.m_is_killed);
+    assert(outcome.m_is_escaped);
+    check_exact(g, delta_t(0.01));
+    check_exact(g, delta_t(0.25));
+  }
+  // A piece that moves away too late is killed
+  {
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("a4"));
+    g.get_pieces()[3].receive_damage(0.9);
+    order(g, 0, piece_action_type::attack, "a4");
+    order(g, 3, piece_action_type::move, "a5");
+    const auto outcome{predict_engagement(g, 3, delta_t(0.01))};
+    assert(outcome.m_is_killed);
+    assert(!outcome.m_is_escaped);
+    check_exact(g, delta_t(0.01));
+  }
+  // A piece cannot escape to an occupied square
+  {
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    g.get_pieces()[3].set_current_square(square("d2"));
+    order(g, 0, piece_action_type::attack, "d2");
+    order(g, 3, piece_action_type::move, "e1");
+    const auto outcome{predict_engagement(g, 3, delta_t(0.01))};
+    assert(outcome.m_is_killed);
+    check_exact(g, delta_t(0.01));
+  }
+  // With free movement, a piece escapes the same way
+  {
+    auto options{get_default_game_options()};
+    options.set_starting_position(starting_position_type::queen_end_game);
+    options.set_free_movement(true);
+    game g(options);
+    g.get_pieces()[3].set_current_square(square("a4"));
+    order(g, 0, piece_action_type::attack, "a4");
+    order(g, 3, piece_action_type::move, "a5");
+    const auto outcome{predict_engagement(g, 3, delta_t(0.01))};
+    assert(outcome.m_is_escaped);
+    check_exact(g, delta_t(0.01));
+  }
+  // A bigger fight, at different tick lengths
+  {
+    game g{get_game_with_starting_position(starting_position_type::standard)};
+    const auto index_at{[&g](const std::string& s) { return get_index_of_piece_at(g, square(s)); }};
+    g.get_pieces()[index_at("e7")].set_current_square(square("e3"));
+    g.update_occupancy();
+    g.get_pieces()[index_at("g8")].set_current_square(square("f3"));
+    g.tick(delta_t(0.01));
+    order(g, index_at("d2"), piece_action_type::attack, "e3");
+    order(g, index_at("f2"), piece_action_type::attack, "e3");
+    order(g, index_at("e2"), piece_action_type::attack, "f3");
+    order(g, index_at("g2"), piece_action_type::attack, "f3");
+    order(g, index_at("e3"), piece_action_type::attack, "d2");
+    order(g, index_at("f3"), piece_action_type::move, "h4");
+    const auto outcomes{predict_engagements(g, delta_t(0.01))};
+    assert(outcomes.size() == 6);
+    for (const auto& outcome: outcomes)
+    {
+      assert(!(outcome.m_is_killed && outcome.m_is_escaped));
+    }
+    for (const double dt: { 0.01, 0.03, 0.1, 0.17 })
+    {
+      check_exact(g, delta_t(dt));
+    }
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,83 @@
+#ifndef ENGAGEMENT_H
+#define ENGAGEMENT_H
+
+#include "ccfwd.h"
+#include "delta_t.h"
+
+#include <vector>
+
+/// What happens to a piece in an engagement,
+/// as predicted by 'predict_engagements'
+struct engagement_outcome
+{
+  /// The index of the piece in the game
+  int m_index;
+
+  /// Is the piece killed?
+  bool m_is_killed;
+
+  /// Does the piece escape, by moving away from its attackers?
+  bool m_is_escaped;
+
+  /// The index of the piece that kills it, or -1 if it is not killed
+  int m_killer_index;
+
+  /// The in-game time at the end of the tick in which the piece
+  /// is killed or escapes, else the time at which the engagement is over
+  delta_t m_t;
+};
+
+/// Get the time it takes attackers to kill a piece,
+/// when all these attack it all the time.
+/// This is the exact time when ticking with infinitely short ticks:
+/// ticking with ticks of 'dt', the piece dies at most 'dt' later
+delta_t get_time_to_kill(
+  const game& g,
+  const piece& target,
+  const int n_attackers
+);
+
+/// Get the time it takes a moving piece to leave its square,
+/// i.e. to get halfway its move, after which it cannot be attacked there.
+/// This is the exact time when ticking with infinitely short ticks:
+/// ticking with ticks of 'dt', the piece leaves at most 'dt' later
+delta_t get_time_to_leave(
+  const game& g,
+  const piece& p
+);
+
+/// Predict what happens to a piece, if ticking the game with ticks of 'dt'.
+/// A piece that is not attacking or attacked is not killed, nor escapes
+engagement_outcome predict_engagement(
+  const game& g,
+  const int index,
+  const delta_t& dt
+);
+
+/// Predict what happens to the pieces that are attacking
+/// and the pieces these attack, if ticking the game with ticks of 'dt'.
+///
+/// Instead of ticking the game, the fight is played out on the health
+/// and move progress of these pieces only, using the same arithmetic,
+/// in the same order as the game does, so that the prediction
+/// is exact: the pieces die and escape in the same tick as in the game.
+/// This costs microseconds, instead of a copy of the game and a tick
+/// of all its pieces for each tick of the fight.
+///
+/// The prediction assumes that no orders are given,
+/// that pieces do nothing after their current action,
+/// and that the pieces that are not in the fight stay where they are.
+/// Without free movement, a piece that moves away escapes
+/// when it gets halfway, unless its target square gets occupied.
+/// With free movement, bumping into pieces on the way is not foreseen.
+///
+/// @return the outcomes of the pieces in the fight, in the order of the pieces
+std::vector<engagement_outcome> predict_engagements(
+  const game& g,
+  const delta_t& dt
+);
+
+/// Test this class and its free functions
+void test_engagement();
+
+#endif // ENGAGEMENT_H
@@ -0,0 +1,19 @@
+#ifndef EVALUATION_WEIGHTS_H
+#define EVALUATION_WEIGHTS_H
+
+// Written by 'save_evaluation_weights', e.g. by running the game
+// with '--tune', after which a rebuild of the game uses these
+
+#include "alpha_beta.h"
+
+/// Get the weights 'evaluate' uses, in hundredths of a pawn,
+/// per piece type: bishop, king, knight, pawn, queen, rook
+constexpr evaluation_weights get_tuned_evaluation_weights() noexcept
+{
+  return evaluation_weights{
+    {{ 300, 0, 300, 100, 900, 500 }},
+    {{ 2, 0, 2, 2, 2, 2 }}
+  };
+}
+
+#endif // EVALUATION_WEIGHTS_H
@@ -0,0 +1,240 @@
+#include "flow_field.h"
+
+#include "occupancy_grid.h"
+#include "piece.h"
+#include "pieces.h"
+
+#include <algorithm>
+#include <cassert>
+
+std::vector<flow_ray> get_flow_rays(
+  const piece_type type,
+  const int board_size
+)
+{
+  const int n{board_size - 1};
+  switch (type)
+  {
+    case piece_type::bishop:
+      return { {1, -1, n}, {1, 1, n}, {-1, 1, n}, {-1, -1, n} };
+    case piece_type::king:
+      return {
+        {0, -1, 1}, {1, -1, 1}, {1, 0, 1}, {1, 1, 1},
+        {0, 1, 1}, {-1, 1, 1}, {-1, 0, 1}, {-1, -1, 1}
+      };
+    case piece_type::knight:
+      // A knight makes up to three jumps in the same direction
+      return {
+        {1, -2, 3}, {2, -1, 3}, {2, 1, 3}, {1, 2, 3},
+        {-1, 2, 3}, {-2, 1, 3}, {-2, -1, 3}, {-1, -2, 3}
+      };
+    case piece_type::queen:
+      return {
+        {0, -1, n}, {1, -1, n}, {1, 0, n}, {1, 1, n},
+        {0, 1, n}, {-1, 1, n}, {-1, 0, n}, {-1, -1, n}
+      };
+    case piece_type::rook:
+      return { {0, -1, n}, {1, 0, n}, {0, 1, n}, {-1, 0, n} };
+    case piece_type::pawn:
+    default:
+      // A pawn cannot go back the way it came
+      assert(!"Should not get here");
+      return {};
+  }
+}
+
+flow_field::flow_field(
+  const piece_type type,
+  const square& target,
+  const occupancy_grid& occupancy
+) : m_board_size{occupancy.get_board_size()},
+    m_distances(m_board_size * m_board_size, -1),
+    m_next(m_board_size * m_board_size, -1),
+    m_piece_type{type},
+    m_rays{get_flow_rays(type, m_board_size)},
+    m_target{target}
+{
+  assert(type != piece_type::pawn);
+  assert(is_valid_square_xy(target.get_x(), target.get_y(), m_board_size));
+
+  const int target_index{(target.get_x() * m_board_size) + target.get_y()};
+  m_distances[target_index] = 0;
+  m_todo.push_back(target_index);
+}
+
+void flow_field::expand(const occupancy_grid& occupancy)
+{
+  while (!m_todo.empty()) expand_next(occupancy);
+}
+
+void flow_field::expand_next(const occupancy_grid& occupancy)
+{
+  assert(!m_todo.empty());
+  assert(occupancy.get_board_size() == m_board_size);
+  // All moves are reversible, so searching from the target
+  // gives the moves towards it from any square.
+  // Occupied squares can be reached, yet cannot be moved through:
+  // these are the squares the pieces start from
+  const int index{m_todo.front()};
+  m_todo.pop_front();
+  const int x{index / m_board_size};
+  const int y{index % m_board_size};
+  for (const auto& r: m_rays)
+  {
+    for (int distance{1}; distance <= r.m_max_distance; ++distance)
+    {
+      const int new_x{x + (r.m_dx * distance)};
+      const int new_y{y + (r.m_dy * distance)};
+      if (!is_valid_square_xy(new_x, new_y, m_board_size)) break;
+      const int new_index{(new_x * m_board_size) + new_y};
+      const bool is_occupied{occupancy.get_index(new_x, new_y) != -1};
+      if (m_distances[new_index] == -1)
+      {
+        m_distances[new_index] = m_distances[index] + 1;
+        m_next[new_index] = index;
+        if (!is_occupied) m_todo.push_back(new_index);
+      }
+      if (is_occupied) break;
+    }
+  }
+}
+
+void flow_field::expand_to(const square& s, const occupancy_grid& occupancy)
+{
+  while (get_distance(s) == -1 && !m_todo.empty()) expand_next(occupancy);
+}
+
+int flow_field::get_distance(const square& s) const noexcept
+{
+  assert(is_valid_square_xy(s.get_x(), s.get_y(), m_board_size));
+  return m_distances[(s.get_x() * m_board_size) + s.get_y()];
+}
+
+square flow_field::get_next(const square& s) const noexcept
+{
+  assert(get_distance(s) > 0);
+  const int next{m_next[(s.get_x() * m_board_size) + s.get_y()]};
+  assert(next != -1);
+  return square(next / m_board_size, next % m_board_size);
+}
+
+std::vector<square> get_route(const flow_field& f, const square& from)
+{
+  std::vector<square> route;
+  if (f.get_distance(from) <= 0) return route;
+  route.reserve(f.get_distance(from));
+  square here{from};
+  while (here != f.get_target())
+  {
+    here = f.get_next(here);
+    route.push_back(here);
+  }
+  assert(static_cast<int>(route.size()) == f.get_distance(from));
+  return route;
+}
+
+void test_flow_field()
+{
+#ifndef NDEBUG
+  // A rook on an empty board
+  {
+    const occupancy_grid g;
+    flow_field f(piece_type::rook, square("a1"), g);
+    f.expand(g);
+    assert(f.get_piece_type() == piece_type::rook);
+    assert(f.get_target() == square("a1"));
+    assert(f.get_distance(square("a1")) == 0);
+    assert(f.get_distance(square("a8")) == 1);
+    assert(f.get_distance(square("h1")) == 1);
+    assert(f.get_distance(square("h8")) == 2);
+    const auto next{f.get_next(square("h8"))};
+    assert(next == square("a8") || next == square("h1"));
+    assert(get_route(f, square("a1")).empty());
+  }
+  // A knight needs three jumps to go one square sideways
+  {
+    const occupancy_grid g;
+    flow_field f(piece_type::knight, square("b1"), g);
+    f.expand(g);
+    assert(f.get_distance(square("a1")) == 3);
+    assert(f.get_distance(square("c3")) == 1);
+    const auto route{get_route(f, square("a1"))};
+    assert(route.size() == 3);
+    assert(route.back() == square("b1"));
+  }
+  // A knight reaches in one order the squares it can move to
+  {
+    const std::vector<piece> pieces{
+      piece(chess_color::white, piece_type::knight, square("b1"), side::lhs)
+    };
+    occupancy_grid g;
+    g.update(pieces);
+    flow_field f(piece_type::knight, square("b1"), g);
+    f.expand(g);
+    const auto moves{get_possible_knight_moves(pieces, g, pieces[0])};
+    for (int x{0}; x != g.get_board_size(); ++x)
+    {
+      for (int y{0}; y != g.get_board_size(); ++y)
+      {
+        const square s(x, y);
+        const bool is_move{std::find(std::begin(moves), std::end(moves), s) != std::end(moves)};
+        assert(is_move == (f.get_distance(s) == 1));
+      }
+    }
+    assert(f.get_distance(square("d5")) == 1);
+  }
+  // A rook moves around a piece in the way
+  {
+    occupancy_grid g;
+    g.set(square("a1"), 0); // The rook itself
+    g.set(square("a2"), 1);
+    flow_field f(piece_type::rook, square("a3"), g);
+    f.expand(g);
+    assert(f.get_distance(square("a1")) == 3);
+    const auto route{get_route(f, square("a1"))};
+    assert(route.size() == 3);
+    assert(route.back() == square("a3"));
+    // The route does not go through the occupied square
+    for (const auto& s: route) assert(s != square("a2"));
+  }
+  // A bishop cannot reach a square of the other color
+  {
+    const occupancy_grid g;
+    flow_field f(piece_type::bishop, square("a1"), g);
+    f.expand(g);
+    assert(f.get_distance(square("a2")) == -1);
+    assert(get_route(f, square("a2")).empty());
+    assert(f.get_distance(square("h8")) == 1);
+  }
+  // A king takes a step at a time
+  {
+    const occupancy_grid g;
+    flow_field f(piece_type::king, square("e1"), g);
+    f.expand(g);
+    assert(f.get_distance(square("e8")) == 7);
+    assert(f.get_distance(square("h4")) == 3);
+  }
+  // The search only goes as far as needed
+  {
+    const occupancy_grid g;
+    flow_field f(piece_type::king, square("e1"), g);
+    f.expand_to(square("e2"), g);
+    assert(f.get_distance(square("e2")) == 1);
+    assert(f.get_distance(square("e8")) == -1);
+    assert(!f.is_complete());
+    f.expand_to(square("e8"), g);
+    assert(f.get_distance(square("e8")) == 7);
+    f.expand(g);
+    assert(f.is_complete());
+  }
+  // A queen on a large board
+  {
+    const occupancy_grid g(32);
+    flow_field f(piece_type::queen, square("af32"), g);
+    f.expand(g);
+    assert(f.get_board_size() == 32);
+    assert(f.get_distance(square("a1")) == 1);
+    assert(f.get_distance(square("b1")) == 2);
+  }
+#endif // NDEBUG
+}
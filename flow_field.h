@@ -0,0 +1,114 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include "ccfwd.h"
+#include "piece_type.h"
+#include "square.h"
+
+#include <deque>
+#include <vector>
+
+/// A direction a piece can move in,
+/// with the maximum number of steps in that direction
+struct flow_ray
+{
+  int m_dx;
+  int m_dy;
+  int m_max_distance;
+};
+
+/// For each square, how a piece can get to a target,
+/// moving around the pieces in the way.
+/// The field is calculated by a breadth-first search from the target,
+/// which only goes as far as needed for the squares asked for,
+/// after which the route from any of the squares found can be followed
+/// without searching again.
+/// Only pieces that can move back the way they came,
+/// i.e. all pieces but pawns, can use a flow field
+class flow_field
+{
+public:
+  /// Start a flow field towards a target,
+  /// for the occupied squares of a grid
+  explicit flow_field(
+    const piece_type type,
+    const square& target,
+    const occupancy_grid& occupancy
+  );
+
+  /// Continue the search until all squares that can reach the target are found
+  /// @param occupancy the same occupied squares as the flow field was started with
+  void expand(const occupancy_grid& occupancy);
+
+  /// Continue the search until the square is found,
+  /// or until it is known the square cannot reach the target
+  /// @param occupancy the same occupied squares as the flow field was started with
+  void expand_to(const square& s, const occupancy_grid& occupancy);
+
+  /// Get the number of squares along one side of the board
+  int get_board_size() const noexcept { return m_board_size; }
+
+  /// Get the number of moves needed to get from a square to the target,
+  /// which is -1 if the target cannot be reached,
+  /// or if the square has not been found yet
+  /// @see use 'expand_to' to find a square
+  int get_distance(const square& s) const noexcept;
+
+  /// Get the square to move to next from a square,
+  /// to get closer to the target.
+  /// @see use 'get_distance' first, to see if the target can be reached
+  square get_next(const square& s) const noexcept;
+
+  /// The type of piece the field is calculated for
+  piece_type get_piece_type() const noexcept { return m_piece_type; }
+
+  /// Is the search done, i.e. are all squares that can reach the target found?
+  bool is_complete() const noexcept { return m_todo.empty(); }
+
+  /// The square the field leads to
+  const auto& get_target() const noexcept { return m_target; }
+
+private:
+
+  int m_board_size;
+
+  /// The number of moves to the target per square,
+  /// -1 if unreachable or not found yet,
+  /// where 'x * board_size + y' is the square at (x, y)
+  std::vector<int> m_distances;
+
+  /// The index of the next square per square, -1 if there is none,
+  /// where 'x * board_size + y' is the square at (x, y)
+  std::vector<int> m_next;
+
+  piece_type m_piece_type;
+
+  /// The directions the piece can move in
+  std::vector<flow_ray> m_rays;
+
+  square m_target;
+
+  /// The indices of the squares found, yet not searched from
+  std::deque<int> m_todo;
+
+  /// Search from the next square found
+  void expand_next(const occupancy_grid& occupancy);
+};
+
+/// Get the directions a piece can move in
+std::vector<flow_ray> get_flow_rays(
+  const piece_type type,
+  const int board_size
+);
+
+/// Get the route from a square to the target of the flow field,
+/// as the squares to move to, ending at the target.
+/// The route is empty if the target cannot be reached,
+/// if the square has not been found yet,
+/// or if the piece is at the target already
+std::vector<square> get_route(const flow_field& f, const square& from);
+
+/// Test this class and its free functions
+void test_flow_field();
+
+#endif // FLOW_FIELD_H
@@ -14,22 +14,72 @@
 game::game(
   const game_options& options
 )
-  : m_control_actions{},
-    m_layout{options.get_screen_size(), options.get_margin_width()},
+  : m_bodies{options.get_board_size()},
+    m_control_actions{},
+    m_idle_orders{},
+    m_latency{options.do_measure_latency()},
+    m_layout{
+      options.get_screen_size(),
+      options.get_margin_width(),
+      options.get_board_size()
+    },
+    m_n_black_kings{0},
+    m_n_white_kings{0},
+    m_occupancy{options.get_board_size()},
     m_player_1_pos{0.5, 4.5},
-    m_player_2_pos{7.5, 4.5},
+    m_player_2_pos{options.get_board_size() - 0.5, 4.5},
     m_options{options},
     m_pieces{get_starting_pieces(options)},
     m_replayer{options.get_replayer()},
-    m_t{0.0}
+    m_result{game_result::undecided},
+    m_route_planner{},
+    m_selection{},
+    m_t{0.0},
+    m_t_last_progress{0.0},
+    m_timing_wheel{},
+    m_visibility{options.get_board_size()}
 {
-
+  m_occupancy.update(m_pieces);
+  if (m_options.do_free_movement()) m_bodies.update(m_pieces);
+  m_selection.update(m_pieces);
+  for (const auto& p: m_pieces)
+  {
+    if (p.get_type() != piece_type::king) continue;
+    if (p.get_color() == chess_color::white) ++m_n_white_kings;
+    else ++m_n_black_kings;
+  }
+  m_visibility.update(m_pieces);
 }
 
 void game::add_action(const control_action a)
 {
   // These will be processed in 'tick'
-  m_control_actions.add(a);
+  m_control_actions.add(a, get_player_color(*this, a));
+}
+
+bool game::post_action(const control_action a)
+{
+  return m_control_actions.post(a);
+}
+
+void game::schedule_order(const delta_t& when, const scheduled_order& order)
+{
+  m_timing_wheel.add(when, order);
+}
+
+void game::schedule_order_when_idle(const scheduled_order& order)
+{
+  if (get_index_of_piece_with_id(*this, order.get_piece_id()) == -1) return;
+  m_idle_orders[order.get_piece_id().get()].push_back(order);
+}
+
+void assign_control_group(
+  game& g,
+  const int group,
+  const chess_color player
+)
+{
+  g.get_selection().assign_group(group, player, g.get_pieces());
 }
 
 bool can_player_select_piece_at_cursor_pos(
@@ -69,6 +119,16 @@ int count_piece_actions(const game& g)
   ;
 }
 
+int count_scheduled_orders(const game& g) noexcept
+{
+  int n{g.get_timing_wheel().get_n_orders()};
+  for (const auto& p: g.get_idle_orders())
+  {
+    n += static_cast<int>(p.second.size());
+  }
+  return n;
+}
+
 int count_piece_actions(
   const game& g,
   const chess_color player
@@ -98,7 +158,11 @@ void game::do_move(const chess_move& m)
   {
     piece& piece{get_piece_that_moves(*this, m)};
     assert(!m.get_to().empty());
+    const int index{static_cast<int>(&piece - &m_pieces[0])};
+    m_occupancy.reset(piece.get_current_square());
     piece.set_current_square(m.get_to()[0]);
+    m_occupancy.set(piece.get_current_square(), index);
+    m_t_last_progress = m_t;
   }
   else
   {
@@ -167,6 +231,41 @@ void do_start_attack_keyboard_player_piece(game& g, const square& s)
   //assert(count_control_actions(g) == 0);
 }
 
+void give_order(
+  game& g,
+  const int index,
+  const piece_action_type type,
+  const square& to
+)
+{
+  auto& p{g.get_pieces()[index]};
+  const square from{p.get_current_square()};
+  if (from == to) return;
+
+  // No shift, so all current actions are void
+  clear_actions(p);
+  g.get_latency().on_piece_action();
+  if (type == piece_action_type::move)
+  {
+    // Move around the pieces in the way, if possible.
+    // Pieces of the same type share the flow field towards the target
+    const auto route{get_route(g, p.get_type(), from, to)};
+    if (!route.empty())
+    {
+      add_route(p, from, route);
+      return;
+    }
+  }
+  p.add_action(piece_action(p.get_player(), p.get_type(), type, from, to));
+}
+
+void give_order(game& g, const scheduled_order& order)
+{
+  const int index{get_index_of_piece_with_id(g, order.get_piece_id())};
+  if (index == -1) return;
+  give_order(g, index, order.get_action_type(), order.get_to());
+}
+
 std::vector<piece> find_pieces(
   const game& g,
   const piece_type type,
@@ -245,31 +344,109 @@ int get_index_of_closest_piece_to(
   const game_coordinat& coordinat
 )
 {
-  const std::vector<double> distances{
-    calc_distances(g.get_pieces(), coordinat)
+  const auto& pieces{g.get_pieces()};
+  const auto& grid{g.get_occupancy()};
+  const int board_size{grid.get_board_size()};
+  const int center_x{
+    std::clamp(static_cast<int>(std::floor(coordinat.get_x())), 0, board_size - 1)
+  };
+  const int center_y{
+    std::clamp(static_cast<int>(std::floor(coordinat.get_y())), 0, board_size - 1)
+  };
+  // Search the squares around the coordinat, ring by ring.
+  // A piece in ring 'r' is at least 'r - 0.5' away,
+  // so the search stops when no piece in a ring can be closer
+  int best_index{-1};
+  double best_distance{0.0};
+  for (int r{0}; r != board_size; ++r)
+  {
+    if (best_index != -1 && r - 0.5 > best_distance) break;
+    for (int x{center_x - r}; x <= center_x + r; ++x)
+    {
+      for (int y{center_y - r}; y <= center_y + r; ++y)
+      {
+        // Only the squares on the ring itself
+        if (std::abs(x - center_x) != r && std::abs(y - center_y) != r) continue;
+        if (!is_valid_square_xy(x, y, board_size)) continue;
+        const int index{grid.get_index(x, y)};
+        if (index == -1) continue;
+        const double distance{
+          calc_distance(coordinat, to_coordinat(pieces[index].get_current_square()))
+        };
+        // Of equally distant pieces, the first one is picked
+        if (best_index == -1
+          || distance < best_distance
+          || (distance == best_distance && index < best_index)
+        )
+        {
+          best_index = index;
+          best_distance = distance;
+        }
+      }
+    }
+  }
+  assert(best_index != -1);
+  return best_index;
+}
+
+int get_index_of_piece_with_id(
+  const game& g,
+  const id& i
+)
+{
+  const auto& pieces{g.get_pieces()};
+  const auto there{
+    std::find_if(
+      std::begin(pieces),
+      std::end(pieces),
+      [i](const auto& p) { return p.get_id() == i; }
+    )
   };
-  const auto iter = std::min_element(std::begin(distances), std::end(distances));
-  const auto index = std::distance(std::begin(distances), iter);
+  if (there == std::end(pieces)) return -1;
+  return static_cast<int>(std::distance(std::begin(pieces), there));
+}
+
+int get_index_of_piece_at(
+  const game& g,
+  const square& s
+)
+{
+  const int index{g.get_occupancy().get_index(s)};
+  // A piece moved outside of a tick must be followed by 'update_occupancy'
+  assert(
+    index == -1
+    || (index < static_cast<int>(g.get_pieces().size())
+      && g.get_pieces()[index].get_current_square() == s
+    )
+  );
+  assert(
+    index != -1
+    || std::none_of(
+      std::begin(g.get_pieces()),
+      std::end(g.get_pieces()),
+      [s](const auto& p) { return p.get_current_square() == s; }
+    )
+  );
   return index;
 }
 
 game_coordinat& game::get_keyboard_player_pos()
 {
-  if (get_left_player_controller(m_options) == controller_type::keyboard)
+  if (uses_keyboard_actions(get_left_player_controller(m_options)))
   {
     return m_player_1_pos;
   }
-  assert(get_right_player_controller(m_options) == controller_type::keyboard);
+  assert(uses_keyboard_actions(get_right_player_controller(m_options)));
   return m_player_2_pos;
 }
 
 game_coordinat get_keyboard_player_pos(const game& g)
 {
-  if (get_left_player_controller(g.get_options()) == controller_type::keyboard)
+  if (uses_keyboard_actions(get_left_player_controller(g.get_options())))
   {
     return get_player_pos(g, side::lhs);
   }
-  assert(get_right_player_controller(g.get_options()) == controller_type::keyboard);
+  assert(uses_keyboard_actions(get_right_player_controller(g.get_options())));
   return get_player_pos(g, side::rhs);
 }
 
@@ -418,12 +595,34 @@ std::vector<square> get_possible_moves(
 {
   const auto selected_pieces{get_selected_pieces(g, player)};
   if (selected_pieces.empty()) return {};
-  assert(selected_pieces.size() == 1);
-  const auto& selected_piece{selected_pieces[0]};
-  return get_possible_moves(
-    get_pieces(g),
-    selected_piece
-  );
+  if (selected_pieces.size() == 1)
+  {
+    return get_possible_moves(
+      get_pieces(g),
+      g.get_occupancy(),
+      selected_pieces[0]
+    );
+  }
+  // Each square only once
+  bitboard moves;
+  for (const auto& p: selected_pieces)
+  {
+    for (const auto& s: get_possible_moves(get_pieces(g), g.get_occupancy(), p))
+    {
+      moves.set(s);
+    }
+  }
+  return to_squares(moves);
+}
+
+std::vector<square> get_route(
+  game& g,
+  const piece_type type,
+  const square& from,
+  const square& to
+)
+{
+  return get_route(g.get_route_planner(), type, from, to, g.get_occupancy());
 }
 
 std::vector<piece> get_selected_pieces(
@@ -468,13 +667,19 @@ std::vector<message> collect_messages(const game& g) noexcept
 
 const piece& get_piece_at(const game& g, const square& coordinat)
 {
-  return get_piece_at(g.get_pieces(), coordinat);
+  assert(is_piece_at(g, coordinat));
+  return g.get_pieces()[get_index_of_piece_at(g, coordinat)];
 }
 
 piece& get_piece_at(game& g, const square& coordinat)
 {
   assert(is_piece_at(g, coordinat));
-  return get_piece_at(g.get_pieces(), coordinat);
+  return g.get_pieces()[get_index_of_piece_at(g, coordinat)];
+}
+
+game_result get_result(const game& g) noexcept
+{
+  return g.get_result();
 }
 
 const delta_t& get_time(const game& g) noexcept
@@ -482,6 +687,21 @@ const delta_t& get_time(const game& g) noexcept
   return g.get_time();
 }
 
+std::vector<piece> get_visible_pieces(const game& g, const chess_color player)
+{
+  std::vector<piece> pieces;
+  std::copy_if(
+    std::begin(g.get_pieces()),
+    std::end(g.get_pieces()),
+    std::back_inserter(pieces),
+    [&g, player](const auto& p)
+    {
+      return p.get_color() == player || is_visible(g, p.get_current_square(), player);
+    }
+  );
+  return pieces;
+}
+
 bool has_selected_pieces(const game& g, const chess_color player)
 {
   return !get_selected_pieces(g, player).empty();
@@ -492,19 +712,57 @@ bool is_idle(const game& g) noexcept
   return count_piece_actions(g) == 0;
 }
 
+bool is_over(const game& g) noexcept
+{
+  return is_over(g.get_result());
+}
+
 bool is_piece_at(
   const game& g,
   const game_coordinat& coordinat,
   const double distance
 ) {
-  return is_piece_at(g.get_pieces(), coordinat, distance);
+  // Only the squares around the coordinat need to be checked
+  const auto& grid{g.get_occupancy()};
+  const int board_size{grid.get_board_size()};
+  const int min_x{std::max(0, static_cast<int>(std::floor(coordinat.get_x() - distance)))};
+  const int max_x{std::min(board_size - 1, static_cast<int>(std::floor(coordinat.get_x() + distance)))};
+  const int min_y{std::max(0, static_cast<int>(std::floor(coordinat.get_y() - distance)))};
+  const int max_y{std::min(board_size - 1, static_cast<int>(std::floor(coordinat.get_y() + distance)))};
+  for (int x{min_x}; x <= max_x; ++x)
+  {
+    for (int y{min_y}; y <= max_y; ++y)
+    {
+      if (grid.get_index(x, y) == -1) continue;
+      if (calc_distance(coordinat, to_coordinat(square(x, y))) < distance) return true;
+    }
+  }
+  return false;
 }
 
 bool is_piece_at(
   const game& g,
   const square& coordinat
 ) {
-  return is_piece_at(g.get_pieces(), coordinat);
+  return get_index_of_piece_at(g, coordinat) != -1;
+}
+
+bool is_visible(
+  const game& g,
+  const square& s,
+  const chess_color player
+)
+{
+  if (!g.get_options().do_fog_of_war()) return true;
+  return g.get_visibility().get_visible_squares(player).is_set(s);
+}
+
+bool is_on_board(const game& g, const game_coordinat& c) noexcept
+{
+  const double board_size{static_cast<double>(get_board_size(g.get_options()))};
+  return c.get_x() >= 0.0 && c.get_x() < board_size
+    && c.get_y() >= 0.0 && c.get_y() < board_size
+  ;
 }
 
 bool piece_with_id_is_at(
@@ -517,14 +775,75 @@ bool piece_with_id_is_at(
   return get_piece_at(g, s).get_id() == i;
 }
 
+void recall_control_group(
+  game& g,
+  const int group,
+  const chess_color player
+)
+{
+  unselect_all_pieces(g, player);
+  std::vector<int> ids;
+  for (const auto& i: g.get_selection().get_group(group, player)) ids.push_back(i.get());
+  if (ids.empty()) return;
+  std::sort(std::begin(ids), std::end(ids));
+  const int n_pieces{static_cast<int>(g.get_pieces().size())};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    const auto& p{g.get_pieces()[i]};
+    if (p.get_color() != player) continue;
+    if (std::binary_search(std::begin(ids), std::end(ids), p.get_id().get()))
+    {
+      select_piece(g, i);
+    }
+  }
+}
+
+void select_piece(game& g, const int index)
+{
+  auto& p{g.get_pieces()[index]};
+  select(p);
+  g.get_selection().select(index, p.get_color());
+}
+
+void select_pieces_in_box(
+  game& g,
+  const game_coordinat& from,
+  const game_coordinat& to,
+  const chess_color player
+)
+{
+  unselect_all_pieces(g, player);
+  const int board_size{get_board_size(g.get_options())};
+  const auto to_index = [board_size](const double z)
+  {
+    return std::clamp(static_cast<int>(std::floor(z)), 0, board_size - 1);
+  };
+  const int min_x{to_index(std::min(from.get_x(), to.get_x()))};
+  const int max_x{to_index(std::max(from.get_x(), to.get_x()))};
+  const int min_y{to_index(std::min(from.get_y(), to.get_y()))};
+  const int max_y{to_index(std::max(from.get_y(), to.get_y()))};
+  const auto& grid{g.get_occupancy()};
+  for (int x{min_x}; x <= max_x; ++x)
+  {
+    for (int y{min_y}; y <= max_y; ++y)
+    {
+      const int index{grid.get_index(x, y)};
+      if (index == -1) continue;
+      if (g.get_pieces()[index].get_color() != player) continue;
+      select_piece(g, index);
+    }
+  }
+}
+
 void set_keyboard_player_pos(
   game& g,
   const square& s
 )
 {
   const auto current_pos{get_keyboard_player_pos(g)};
-  const int n_right{(s.get_x() - square(current_pos).get_x() + 8) % 8};
-  const int n_down{(s.get_y() - square(current_pos).get_y() + 8) % 8};
+  const int board_size{get_board_size(g.get_options())};
+  const int n_right{(s.get_x() - square(current_pos).get_x() + board_size) % board_size};
+  const int n_down{(s.get_y() - square(current_pos).get_y() + board_size) % board_size};
   for (int i{0}; i!=n_right; ++i)
   {
     g.add_action(create_press_right_action());
@@ -537,32 +856,142 @@ void set_keyboard_player_pos(
   assert(count_control_actions(g) == 0);
 }
 
-void game::tick(const delta_t& dt)
+game_result game::tick(const delta_t& dt)
 {
+  // The pieces may have been moved around outside of a tick
+  m_occupancy.update(m_pieces);
+  const bool do_free_movement{m_options.do_free_movement()};
+  if (do_free_movement) m_bodies.update(m_pieces);
+  m_selection.update(m_pieces);
+
   // Let the replayer do its move
   m_replayer.do_move(*this);
 
   // Convert control_actions to piece_actions instantaneous
   m_control_actions.process(*this);
 
+  // Give the scheduled orders that are due,
+  // without looking at the orders that are not
+  std::vector<scheduled_order> due_orders;
+  m_timing_wheel.advance(m_t, due_orders);
+  for (const auto& order: due_orders) give_order(*this, order);
+  due_orders.clear();
+
   assert(count_dead_pieces(m_pieces) == 0);
 
   // Do those piece_actions
-  for (auto& p: m_pieces) p.tick(dt, *this);
+  bool is_progress{false};
+  const int n_pieces{static_cast<int>(m_pieces.size())};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    auto& p{m_pieces[i]};
+    // An idle piece does nothing
+    if (!has_actions(p)) continue;
+    is_progress = true;
+    const square before{p.get_current_square()};
+    const game_coordinat body_before{do_free_movement ? p.get_coordinat() : game_coordinat()};
+    p.tick(dt, *this);
+    // Let the pieces that tick later bump into this piece where it is now
+    if (do_free_movement) m_bodies.move(i, body_before, p.get_coordinat());
+    // Let the pieces that tick later see the square this piece entered
+    if (p.get_current_square() != before)
+    {
+      if (m_occupancy.get_index(before) == i) m_occupancy.reset(before);
+      m_occupancy.set(p.get_current_square(), i);
+    }
+  }
+  // An idle piece gets the first of its idle orders,
+  // the others wait until it is idle again,
+  // as giving an order cancels the order before it
+  if (!m_idle_orders.empty())
+  {
+    for (const auto& p: m_pieces)
+    {
+      if (has_actions(p) || is_dead(p)) continue;
+      const auto there{m_idle_orders.find(p.get_id().get())};
+      if (there == std::end(m_idle_orders)) continue;
+      auto& orders{there->second};
+      due_orders.push_back(orders.front());
+      orders.erase(std::begin(orders));
+      if (orders.empty()) m_idle_orders.erase(there);
+    }
+  }
+  // Give these after all pieces have moved,
+  // so that all pieces see the same board
+  for (const auto& order: due_orders) give_order(*this, order);
 
-  // Remove dead pieces
+  // Remove dead pieces, keeping track of the kings that fall
   m_pieces.erase(
     std::remove_if(
       std::begin(m_pieces),
       std::end(m_pieces),
-      [](const auto& p) { return is_dead(p); }
+      [this](const auto& p)
+      {
+        if (!is_dead(p)) return false;
+        if (!m_idle_orders.empty()) m_idle_orders.erase(p.get_id().get());
+        if (p.get_type() == piece_type::king)
+        {
+          if (p.get_color() == chess_color::white) --m_n_white_kings;
+          else --m_n_black_kings;
+        }
+        return true;
+      }
     ),
     std::end(m_pieces)
   );
   assert(count_dead_pieces(m_pieces) == 0);
+  if (static_cast<int>(m_pieces.size()) != n_pieces)
+  {
+    m_occupancy.update(m_pieces);
+    if (do_free_movement) m_bodies.update(m_pieces);
+    m_selection.update(m_pieces);
+  }
 
   // Keep track of the time
   m_t += dt;
+  if (is_progress) m_t_last_progress = m_t;
+
+  // Only the pieces that moved, or can see those, are updated
+  if (m_options.do_fog_of_war()) m_visibility.update(m_pieces);
+
+  update_result();
+  return m_result;
+}
+
+void game::update_occupancy()
+{
+  m_occupancy.update(m_pieces);
+}
+
+void game::update_result() noexcept
+{
+  // Once decided, a result never changes
+  if (is_over(m_result)) return;
+
+  assert(m_n_white_kings >= 0);
+  assert(m_n_black_kings >= 0);
+  if (m_n_white_kings == 0 && m_n_black_kings == 0)
+  {
+    m_result = game_result::draw;
+  }
+  else if (m_n_white_kings == 0)
+  {
+    m_result = game_result::black_wins;
+  }
+  else if (m_n_black_kings == 0)
+  {
+    m_result = game_result::white_wins;
+  }
+  else if (!(m_t < m_options.get_max_game_time()))
+  {
+    // Timeout
+    m_result = game_result::draw;
+  }
+  else if (!(m_t - m_t_last_progress < m_options.get_max_idle_time()))
+  {
+    // No piece did anything for too long
+    m_result = game_result::draw;
+  }
 }
 
 void unselect_all_pieces(
@@ -570,7 +999,19 @@ void unselect_all_pieces(
   const chess_color color
 )
 {
-  return unselect_all_pieces(g.get_pieces(), color);
+  auto& pieces{g.get_pieces()};
+  for (const int index: g.get_selection().get_indices(color))
+  {
+    pieces[index].set_selected(false);
+  }
+  g.get_selection().unselect_all(color);
+}
+
+void unselect_piece(game& g, const int index)
+{
+  auto& p{g.get_pieces()[index]};
+  unselect(p);
+  g.get_selection().unselect(index, p.get_color());
 }
 
 void tick_until_idle(game& g)
@@ -2,13 +2,23 @@
 #define GAME_H
 
 #include "ccfwd.h"
+#include "collision_grid.h"
 #include "control_actions.h"
 #include "game_coordinat.h"
 #include "game_options.h"
+#include "game_result.h"
 #include "game_view_layout.h"
+#include "latency_tracker.h"
 #include "pieces.h"
 #include "message.h"
+#include "occupancy_grid.h"
 #include "replayer.h"
+#include "route_planner.h"
+#include "scheduled_order.h"
+#include "selection.h"
+#include "timing_wheel.h"
+#include "visibility.h"
+#include <unordered_map>
 #include <vector>
 
 /// Contains the game logic.
@@ -23,18 +33,36 @@ public:
   /// Add an action. These will be processed in 'tick'
   void add_action(const control_action a);
 
+  /// Post an action from another thread than the one calling 'tick'.
+  /// These will be processed in the next 'tick'.
+  /// Only one thread may post actions to the same game
+  /// @return false if too many actions are posted, in which case
+  ///   the action is dropped
+  bool post_action(const control_action a);
+
   /// Do a chess move instantaneously
   void do_move(const chess_move& m);
 
   /// Get the game actions
   const auto& get_actions() const noexcept { return m_control_actions; }
 
+  /// Get the broadphase to find the pieces that may bump into each other,
+  /// which is only kept up to date when the pieces move freely
+  const auto& get_bodies() const noexcept { return m_bodies; }
+
   /// Get the game actions
   auto& get_actions() noexcept { return m_control_actions; }
 
-  /// Get the position of the player that uses the keyboard
+  /// Get the position of the player that uses the keyboard, or the AI
   game_coordinat& get_keyboard_player_pos();
 
+  /// Get the time measured from user input until its effect is displayed,
+  /// which is only measured if enabled in the game options
+  const auto& get_latency() const noexcept { return m_latency; }
+
+  /// Get the time measured from user input until its effect is displayed
+  auto& get_latency() noexcept { return m_latency; }
+
   /// Get the layout of the screen
   const auto& get_layout() const noexcept { return m_layout; }
 
@@ -47,6 +75,12 @@ public:
   /// Get the player position
   const game_coordinat& get_player_pos(const side player) const noexcept;
 
+  /// Get which piece is at which square,
+  /// which is up to date after each tick.
+  /// Pieces moved outside of a tick are only picked up at the next tick
+  /// or by 'update_occupancy'
+  const auto& get_occupancy() const noexcept { return m_occupancy; }
+
   /// Get the game options
   auto& get_options() noexcept { return m_options; }
 
@@ -59,19 +93,83 @@ public:
   /// Get all the pieces
   const auto& get_pieces() const noexcept { return m_pieces; }
 
+  /// Get the route planner, which keeps the flow fields
+  /// for as long as no square is entered or left
+  auto& get_route_planner() noexcept { return m_route_planner; }
+
+  /// Get the result of the game, which is 'undecided' while the game is on
+  auto get_result() const noexcept { return m_result; }
+
+  /// Get which pieces are selected,
+  /// which is up to date after each tick.
+  /// Pieces (un)selected outside of a tick are only picked up at the next tick
+  const auto& get_selection() const noexcept { return m_selection; }
+
+  /// Get which pieces are selected
+  auto& get_selection() noexcept { return m_selection; }
+
+  /// Get the orders to be given when a piece becomes idle,
+  /// per piece ID value
+  const auto& get_idle_orders() const noexcept { return m_idle_orders; }
+
   /// Get the in-game time
   const auto& get_time() const noexcept { return m_t; }
 
+  /// Get the orders to be given at a later time
+  const auto& get_timing_wheel() const noexcept { return m_timing_wheel; }
+
+  /// Get what the players can see when playing with fog-of-war
+  const auto& get_visibility() const noexcept { return m_visibility; }
+
+  /// Give an order at a later in-game time,
+  /// which is given at the first tick that starts at or after that time
+  void schedule_order(const delta_t& when, const scheduled_order& order);
+
+  /// Give an order when its piece has nothing left to do.
+  /// If the piece is idle already, the order is given at the next tick.
+  /// The orders of one piece are given one after the other,
+  /// each when the piece is done with the order before it
+  void schedule_order_when_idle(const scheduled_order& order);
+
   /// Go to the next frame
-  void tick(const delta_t& dt = delta_t(1.0));
+  /// @return the result of the game after this frame,
+  ///   which is 'undecided' while the game is on
+  game_result tick(const delta_t& dt = delta_t(1.0));
+
+  /// Make the occupancy grid match the pieces,
+  /// after these were moved or removed outside of a tick, e.g. in a test
+  void update_occupancy();
 
 private:
 
+  /// Which piece is in which cell, when the pieces move freely.
+  /// Rebuilt at the start of each tick and when pieces are removed,
+  /// and updated when a piece enters another cell during a tick
+  collision_grid m_bodies;
+
   control_actions m_control_actions;
 
+  /// The orders to be given when a piece becomes idle,
+  /// per piece ID value
+  std::unordered_map<int, std::vector<scheduled_order>> m_idle_orders;
+
+  /// The time from user input until its effect is displayed
+  latency_tracker m_latency;
+
   /// The layout of the screen, e.g. the top-left of the sidebar
   game_view_layout m_layout;
 
+  /// The number of black kings still alive
+  int m_n_black_kings;
+
+  /// The number of white kings still alive
+  int m_n_white_kings;
+
+  /// Which piece is at which square.
+  /// Rebuilt at the start of each tick and when pieces are removed,
+  /// and updated when a piece enters a square during a tick
+  occupancy_grid m_occupancy;
+
   /// The in-game coordinat of the keyboard user
   game_coordinat m_player_1_pos;
 
@@ -87,12 +185,43 @@ private:
   /// Replay a match. Can be an empty match
   replayer m_replayer;
 
+  /// The result of the game, which is 'undecided' while the game is on
+  game_result m_result;
+
+  /// Plans the routes of the pieces around the pieces in the way
+  route_planner m_route_planner;
+
+  /// Which pieces are selected.
+  /// Rebuilt at the start of each tick and when pieces are removed,
+  /// and updated when pieces are (un)selected during a tick
+  selection m_selection;
+
   /// The time
   delta_t m_t;
 
+  /// The last time a piece was doing something
+  delta_t m_t_last_progress;
+
+  /// The orders to be given at a later time
+  timing_wheel m_timing_wheel;
+
+  /// What the players can see, only updated when playing with fog-of-war
+  visibility m_visibility;
+
+  /// Update the result from the king counts and the time,
+  /// which is cheap, as these are kept track of in 'tick'
+  void update_result() noexcept;
+
   friend void test_game();
 };
 
+/// Store the selected pieces of a player as a control group
+void assign_control_group(
+  game& g,
+  const int group,
+  const chess_color player
+);
+
 /// Can the player select a piece at the current mouse position?
 bool can_player_select_piece_at_cursor_pos(
   const game& g,
@@ -113,6 +242,10 @@ int count_control_actions(const game& g);
 /// Count the total number of actions to be done by pieces of both players
 int count_piece_actions(const game& g);
 
+/// Count the number of orders to be given later,
+/// either at a time or when a piece becomes idle
+int count_scheduled_orders(const game& g) noexcept;
+
 /// Count the total number of actions to be done by pieces of a player
 int count_piece_actions(
   const game& g,
@@ -172,6 +305,20 @@ bool do_show_selected(const game& g) noexcept;
 /// 'do_select_for_keyboard_player' and 'do_start_attack_keyboard_player_piece'
 void do_start_attack_keyboard_player_piece(game& g, const square& s);
 
+/// Let the piece with the index stop what it is doing
+/// and start moving to or attacking a square.
+/// A move goes around the pieces in the way, if possible
+void give_order(
+  game& g,
+  const int index,
+  const piece_action_type type,
+  const square& to
+);
+
+/// Give a scheduled order now,
+/// which is ignored if its piece is gone
+void give_order(game& g, const scheduled_order& order);
+
 /// Find zero, one or more chess pieces of the specified type and color
 std::vector<piece> find_pieces(
   const game& g,
@@ -201,6 +348,20 @@ game get_game_with_starting_position(starting_position_type t) noexcept;
 /// Will throw if there is no piece there
 id get_id(const game& g, const square& s);
 
+/// Get the index of the piece at a square,
+/// which is -1 if there is no piece there
+int get_index_of_piece_at(
+  const game& g,
+  const square& s
+);
+
+/// Get the index of the piece with an ID,
+/// which is -1 if there is no such piece (anymore)
+int get_index_of_piece_with_id(
+  const game& g,
+  const id& i
+);
+
 /// Get the index of the piece that is closest to the coordinat
 int get_index_of_closest_piece_to(
   const game& g,
@@ -269,13 +430,25 @@ chess_color get_player_color(
 /// Get the side of a player
 side get_player_side(const game& g, const chess_color& color) noexcept;
 
-/// Get the possible moves for a player's selected pieces
+/// Get the possible moves for a player's selected pieces,
+/// i.e. the squares at least one of these can move to.
 /// Will be empty if no pieces are selected
 std::vector<square> get_possible_moves(
   const game& g,
   const side player
 );
 
+/// Get the route of a piece from a square to a target,
+/// around the pieces in the way,
+/// as the squares to move to, ending at the target.
+/// The route is empty if there is none, or for a pawn
+std::vector<square> get_route(
+  game& g,
+  const piece_type type,
+  const square& from,
+  const square& to
+);
+
 /// Get all the selected pieces
 /// @param g a game
 /// @param player the color of the player, which is white for player 1
@@ -303,9 +476,17 @@ const std::vector<piece>& get_pieces(const game& g) noexcept;
 /// Get the player position
 const game_coordinat& get_player_pos(const game& g, const side player) noexcept;
 
+/// Get the result of the game, which is 'undecided' while the game is on
+game_result get_result(const game& g) noexcept;
+
 /// Get the time in the game
 const delta_t& get_time(const game& g) noexcept;
 
+/// Get the pieces a player can see: its own pieces,
+/// and the enemy pieces on the squares it can see.
+/// Without fog-of-war, these are all pieces
+std::vector<piece> get_visible_pieces(const game& g, const chess_color player);
+
 /// See if there is at least 1 piece selected
 /// @param g a game
 /// @param player the color of the player, which is white for player 1
@@ -315,6 +496,9 @@ bool has_selected_pieces(const game& g, const chess_color player);
 /// Are all pieces idle?
 bool is_idle(const game& g) noexcept;
 
+/// Is the game over, i.e. has a king fallen, or is it a draw?
+bool is_over(const game& g) noexcept;
+
 /// Determine if there is a piece at the coordinat
 bool is_piece_at(
   const game& g,
@@ -328,6 +512,38 @@ bool is_piece_at(
   const square& coordinat
 );
 
+/// Can the player see the square?
+/// Without fog-of-war, all squares are visible
+bool is_visible(
+  const game& g,
+  const square& s,
+  const chess_color player
+);
+
+/// Select the pieces of a control group that are still there,
+/// instead of the pieces selected now
+void recall_control_group(
+  game& g,
+  const int group,
+  const chess_color player
+);
+
+/// Select the piece with the index, keeping the selection up to date
+void select_piece(game& g, const int index);
+
+/// Select the pieces of a player on the squares in the box
+/// between two corners, instead of the pieces selected now.
+/// Only the squares in the box are visited
+void select_pieces_in_box(
+  game& g,
+  const game_coordinat& from,
+  const game_coordinat& to,
+  const chess_color player
+);
+
+/// Is the coordinat on the board?
+bool is_on_board(const game& g, const game_coordinat& c) noexcept;
+
 /// See if there is a piece with a certain ID at a certain square
 bool piece_with_id_is_at(
   game& g,
@@ -347,10 +563,14 @@ void tick_until_idle(game& g);
 /// Toggle the color of the active player
 void toggle_left_player_color(game& g);
 
-/// Unselect all pieces of a certain color
+/// Unselect all pieces of a certain color,
+/// visiting only the pieces that are selected
 void unselect_all_pieces(
   game& g,
   const chess_color color
 );
 
+/// Unselect the piece with the index, keeping the selection up to date
+void unselect_piece(game& g, const int index);
+
 #endif // GAME_H
@@ -1,32 +1,58 @@
 # Files
 HEADERS += \
+    $$PWD/ai_controller.h \
+    $$PWD/alpha_beta.h \
+    $$PWD/balance_sweep.h \
+    $$PWD/batch_scheduler.h \
+    $$PWD/benchmark.h \
+    $$PWD/bitboard.h \
+    $$PWD/bot.h \
+    $$PWD/bot_type.h \
+    $$PWD/bot_version.h \
     $$PWD/castling_type.h \
     $$PWD/ccfwd.h \
     $$PWD/chess_color.h \
     $$PWD/chess_move.h \
+    $$PWD/chess_position.h \
+    $$PWD/collision_grid.h \
     $$PWD/control_action.h \
     $$PWD/control_action_type.h \
     $$PWD/control_actions.h \
     $$PWD/controller_type.h \
     $$PWD/delta_t.h \
+    $$PWD/elo_rating.h \
+    $$PWD/engagement.h \
+    $$PWD/evaluation_weights.h \
+    $$PWD/flow_field.h \
     $$PWD/fps_clock.h \
     $$PWD/game.h \
     $$PWD/game_coordinat.h \
     $$PWD/game_log.h \
     $$PWD/game_options.h \
     $$PWD/game_rect.h \
+    $$PWD/game_result.h \
     $$PWD/game_resources.h \
     $$PWD/game_speed.h \
     $$PWD/game_view_layout.h \
     $$PWD/helper.h \
     $$PWD/id.h \
+    $$PWD/influence_map.h \
+    $$PWD/latency_histogram.h \
+    $$PWD/latency_tracker.h \
+    $$PWD/macro_action.h \
+    $$PWD/mapped_file.h \
+    $$PWD/mcts.h \
     $$PWD/layout.h \
     $$PWD/menu_view_item.h \
     $$PWD/menu_view_layout.h \
     $$PWD/message.h \
     $$PWD/message_type.h \
+    $$PWD/nnue.h \
+    $$PWD/occupancy_grid.h \
+    $$PWD/opening_book.h \
     $$PWD/options_view_item.h \
     $$PWD/options_view_layout.h \
+    $$PWD/pgn.h \
     $$PWD/piece.h \
     $$PWD/piece_action.h \
     $$PWD/piece_action_type.h \
@@ -34,44 +60,82 @@ HEADERS += \
     $$PWD/pieces.h \
     $$PWD/replay.h \
     $$PWD/replayer.h \
+    $$PWD/route_planner.h \
+    $$PWD/scheduled_order.h \
     $$PWD/screen_coordinat.h \
     $$PWD/screen_rect.h \
+    $$PWD/selection.h \
     $$PWD/side.h \
+    $$PWD/simulation.h \
+    $$PWD/simulation_job.h \
     $$PWD/sound_effects.h \
+    $$PWD/spsc_queue.h \
     $$PWD/square.h \
     $$PWD/starting_position_type.h \
+    $$PWD/tablebase.h \
     $$PWD/test_game.h \
+    $$PWD/texel_tuner.h \
     $$PWD/textures.h \
-    $$PWD/volume.h
+    $$PWD/timing_wheel.h \
+    $$PWD/tournament.h \
+    $$PWD/transposition_table.h \
+    $$PWD/visibility.h \
+    $$PWD/volume.h \
+    $$PWD/work_stealing_queue.h
 
 
 SOURCES += \
+    $$PWD/ai_controller.cpp \
+    $$PWD/alpha_beta.cpp \
+    $$PWD/balance_sweep.cpp \
+    $$PWD/batch_scheduler.cpp \
+    $$PWD/benchmark.cpp \
+    $$PWD/bitboard.cpp \
+    $$PWD/bot.cpp \
+    $$PWD/bot_type.cpp \
+    $$PWD/bot_version.cpp \
     $$PWD/castling_type.cpp \
     $$PWD/chess_color.cpp \
     $$PWD/chess_move.cpp \
+    $$PWD/chess_position.cpp \
+    $$PWD/collision_grid.cpp \
     $$PWD/control_action.cpp \
     $$PWD/control_action_type.cpp \
     $$PWD/control_actions.cpp \
     $$PWD/controller_type.cpp \
     $$PWD/delta_t.cpp \
+    $$PWD/elo_rating.cpp \
+    $$PWD/engagement.cpp \
+    $$PWD/flow_field.cpp \
     $$PWD/fps_clock.cpp \
     $$PWD/game.cpp \
     $$PWD/game_coordinat.cpp \
     $$PWD/game_log.cpp \
     $$PWD/game_options.cpp \
     $$PWD/game_rect.cpp \
+    $$PWD/game_result.cpp \
     $$PWD/game_resources.cpp \
     $$PWD/game_speed.cpp \
     $$PWD/game_view_layout.cpp \
     $$PWD/helper.cpp \
     $$PWD/id.cpp \
+    $$PWD/influence_map.cpp \
+    $$PWD/latency_histogram.cpp \
+    $$PWD/latency_tracker.cpp \
+    $$PWD/macro_action.cpp \
+    $$PWD/mapped_file.cpp \
+    $$PWD/mcts.cpp \
     $$PWD/layout.cpp \
     $$PWD/menu_view_item.cpp \
     $$PWD/menu_view_layout.cpp \
     $$PWD/message.cpp \
     $$PWD/message_type.cpp \
+    $$PWD/nnue.cpp \
+    $$PWD/occupancy_grid.cpp \
+    $$PWD/opening_book.cpp \
     $$PWD/options_view_item.cpp \
     $$PWD/options_view_layout.cpp \
+    $$PWD/pgn.cpp \
     $$PWD/piece.cpp \
     $$PWD/piece_action.cpp \
     $$PWD/piece_action_type.cpp \
@@ -79,16 +143,42 @@ SOURCES += \
     $$PWD/pieces.cpp \
     $$PWD/replay.cpp \
     $$PWD/replayer.cpp \
+    $$PWD/route_planner.cpp \
+    $$PWD/scheduled_order.cpp \
     $$PWD/screen_coordinat.cpp \
     $$PWD/screen_rect.cpp \
+    $$PWD/selection.cpp \
     $$PWD/side.cpp \
+    $$PWD/simulation.cpp \
+    $$PWD/simulation_job.cpp \
     $$PWD/sound_effects.cpp \
+    $$PWD/spsc_queue.cpp \
     $$PWD/square.cpp \
     $$PWD/starting_position_type.cpp \
+    $$PWD/tablebase.cpp \
     $$PWD/test_game.cpp \
     $$PWD/test_game_scenarios.cpp \
+    $$PWD/texel_tuner.cpp \
     $$PWD/textures.cpp \
-    $$PWD/volume.cpp
+    $$PWD/timing_wheel.cpp \
+    $$PWD/tournament.cpp \
+    $$PWD/transposition_table.cpp \
+    $$PWD/visibility.cpp \
+    $$PWD/volume.cpp \
+    $$PWD/work_stealing_queue.cpp
+
+# Distributed simulations use POSIX sockets
+unix {
+  HEADERS += \
+      $$PWD/distributed_simulation.h \
+      $$PWD/tcp_listener.h \
+      $$PWD/tcp_socket.h
+
+  SOURCES += \
+      $$PWD/distributed_simulation.cpp \
+      $$PWD/tcp_listener.cpp \
+      $$PWD/tcp_socket.cpp
+}
 
 RESOURCES += \
     $$PWD/game_resources.qrc
@@ -23,6 +23,10 @@ QMAKE_CXXFLAGS += -Wall -Wextra -Wshadow -Wnon-virtual-dtor -pedantic
 CONFIG += debug_and_release
 CONFIG(release, debug|release) {
   DEFINES += NDEBUG
+
+  # The neural evaluator uses AVX2 or AVX-512, if the CPU the game runs on
+  # has these, without a -march flag.
+  # Run the game with '--benchmark-nnue' to see which is used
 }
 CONFIG(debug, debug|release) {
   # High warning levels
@@ -41,51 +41,66 @@ game_coordinat center_on_center(const game_coordinat& coordinat)
   );
 }
 
-game_coordinat get_above(const game_coordinat& coordinat) noexcept
+game_coordinat get_above(
+  const game_coordinat& coordinat,
+  const int board_size
+) noexcept
 {
   game_coordinat pos{coordinat + game_coordinat(0.0, -1.0)};
   if (pos.get_y() < 0.0)
   {
-    pos += game_coordinat(0.0, 8.0);
+    pos += game_coordinat(0.0, board_size);
   }
   return pos;
 }
 
-game_coordinat get_below(const game_coordinat& coordinat) noexcept
+game_coordinat get_below(
+  const game_coordinat& coordinat,
+  const int board_size
+) noexcept
 {
   game_coordinat pos{coordinat + game_coordinat(0.0, 1.0)};
-  if (pos.get_y() > 8.0)
+  if (pos.get_y() > board_size)
   {
-    pos += game_coordinat(0.0, -8.0);
+    pos += game_coordinat(0.0, -board_size);
   }
   return pos;
 }
 
-game_coordinat get_left(const game_coordinat& coordinat) noexcept
+game_coordinat get_left(
+  const game_coordinat& coordinat,
+  const int board_size
+) noexcept
 {
   game_coordinat pos{coordinat + game_coordinat(-1.0, 0.0)};
   if (pos.get_x() < 0.0)
   {
-    pos += game_coordinat(8.0, 0.0);
+    pos += game_coordinat(board_size, 0.0);
   }
   return pos;
 }
 
-game_coordinat get_right(const game_coordinat& coordinat) noexcept
+game_coordinat get_right(
+  const game_coordinat& coordinat,
+  const int board_size
+) noexcept
 {
   game_coordinat pos{coordinat + game_coordinat(1.0, 0.0)};
-  if (pos.get_x() > 8.0)
+  if (pos.get_x() > board_size)
   {
-    pos += game_coordinat(-8.0, 0.0);
+    pos += game_coordinat(-board_size, 0.0);
   }
   return pos;
 }
 
-game_coordinat get_rotated_coordinat(const game_coordinat& coordinat) noexcept
+game_coordinat get_rotated_coordinat(
+  const game_coordinat& coordinat,
+  const int board_size
+) noexcept
 {
   return game_coordinat(
-    8.0 - coordinat.get_x(),
-    8.0 - coordinat.get_y()
+    board_size - coordinat.get_x(),
+    board_size - coordinat.get_y()
   );
 }
 
@@ -172,17 +187,27 @@ void test_game_coordinat()
     const auto right{get_right(c)};
     assert(right.get_x() < c.get_x());
   }
+  // get_right loops later on a larger board
+  {
+    const game_coordinat c(7.5, 3.5);
+    assert(get_right(c, 16).get_x() > c.get_x());
+    assert(get_right(game_coordinat(15.5, 3.5), 16).get_x() < 1.0);
+  }
   // get_rotated_coordinat
   {
     const game_coordinat c(1.5, 2.5);
     const auto rotated{get_rotated_coordinat(c)};
     assert(is_close(rotated.get_x(), 6.5, 0.1));
     assert(is_close(rotated.get_y(), 5.5, 0.1));
+    const auto rotated_16{get_rotated_coordinat(c, 16)};
+    assert(is_close(rotated_16.get_x(), 14.5, 0.1));
+    assert(is_close(rotated_16.get_y(), 13.5, 0.1));
   }
   // to_notation
   {
     assert(to_notation(game_coordinat(0.5, 0.5)) == "a1");
     assert(to_notation(game_coordinat(9.5, 9.5)) == "--");
+    assert(to_notation(game_coordinat(9.5, 9.5), 16) == "j10");
   }
   // operator ==
   {
@@ -244,12 +269,15 @@ void test_game_coordinat()
   #endif // NDEBUG
 }
 
-std::string to_notation(const game_coordinat& g)
+std::string to_notation(
+  const game_coordinat& g,
+  const int board_size
+)
 {
   if (g.get_x() >= 0.0
-    && g.get_x() < 8.0
+    && g.get_x() < board_size
     && g.get_y() >= 0.0
-    && g.get_y() < 8.0
+    && g.get_y() < board_size
   )
   {
     return to_str(square(g));
@@ -5,6 +5,7 @@
 
 #include "ccfwd.h"
 #include "side.h"
+#include "square.h"
 
 /// Coordinat on the board
 /// @see use screen_coordinat for a coordinat on the screen
@@ -43,24 +44,40 @@ double calc_distance(const game_coordinat& lhs, const game_coordinat& rhs) noexc
 double calc_length(const game_coordinat& coordinat) noexcept;
 
 /// Get the game coordinat one square above this one,
-/// i.e. when the player presses up
-game_coordinat get_above(const game_coordinat& coordinat) noexcept;
+/// i.e. when the player presses up.
+/// Moving beyond the edge of the board continues at the other edge
+game_coordinat get_above(
+  const game_coordinat& coordinat,
+  const int board_size = get_default_board_size()
+) noexcept;
 
 /// Get the game coordinat one square below this one,
 /// i.e. when the player presses down
-game_coordinat get_below(const game_coordinat& coordinat) noexcept;
+game_coordinat get_below(
+  const game_coordinat& coordinat,
+  const int board_size = get_default_board_size()
+) noexcept;
 
 /// Get the game coordinat one square left of this one,
 /// i.e. when the player presses left
-game_coordinat get_left(const game_coordinat& coordinat) noexcept;
+game_coordinat get_left(
+  const game_coordinat& coordinat,
+  const int board_size = get_default_board_size()
+) noexcept;
 
 /// Get the game coordinat one square right of this one,
 /// i.e. when the player presses right
-game_coordinat get_right(const game_coordinat& coordinat) noexcept;
+game_coordinat get_right(
+  const game_coordinat& coordinat,
+  const int board_size = get_default_board_size()
+) noexcept;
 
 /// Rotate the coordinat,
 /// i.e. turn the board 180 degrees
-game_coordinat get_rotated_coordinat(const game_coordinat& coordinat) noexcept;
+game_coordinat get_rotated_coordinat(
+  const game_coordinat& coordinat,
+  const int board_size = get_default_board_size()
+) noexcept;
 
 /// Is the 'to' coordinat forward,
 /// i.e. at a rank forward,
@@ -77,8 +94,11 @@ bool is_forward(
 void test_game_coordinat();
 
 /// Convert to coordinat to chess notation, e.g. 'e2'
-/// For invalid coordinats, returns '--'
-std::string to_notation(const game_coordinat& g);
+/// For coordinats beyond the board, returns '--'
+std::string to_notation(
+  const game_coordinat& g,
+  const int board_size = get_default_board_size()
+);
 
 /// center a coordinat on the center of a square,
 /// i.e. at coorddinat (x.5, y.5)
@@ -3,20 +3,31 @@
 #include "game_view_layout.h"
 #include "pieces.h"
 #include <cassert>
+#include <limits>
 
 game_options::game_options(
   const screen_coordinat& screen_size,
   const starting_position_type starting_position,
   const game_speed speed,
   const int margin_width
-) : m_click_distance{0.5},
+) : m_board_size{get_default_board_size()},
+    m_click_distance{0.5},
+    m_damage_per_chess_move{1.0},
+    m_fog_of_war{false},
+    m_free_movement{false},
     m_game_speed{speed},
     m_left_controller_type{controller_type::keyboard},
     m_left_player_color{chess_color::white},
     m_margin_width{margin_width},
+    m_max_game_time{std::numeric_limits<double>::infinity()},
+    m_max_healths{get_default_max_healths()},
+    m_max_idle_time{std::numeric_limits<double>::infinity()},
+    m_measure_latency{false},
+    m_movement_speed{1.0},
     m_replayer(replay("")),
     m_right_controller_type{controller_type::mouse},
     m_screen_size{screen_size},
+    m_show_threats{false},
     m_starting_position{starting_position},
     m_music_volume{0}
 {
@@ -27,11 +38,41 @@ game_options::game_options(
   assert(::get_keyboard_user_player_color(*this) != ::get_mouse_user_player_color(*this));
 }
 
+double game_options::get_max_health(const piece_type type) const
+{
+  assert(m_max_healths.count(type));
+  return m_max_healths.at(type);
+}
+
+void game_options::set_damage_per_chess_move(const double damage) noexcept
+{
+  assert(damage > 0.0);
+  m_damage_per_chess_move = damage;
+}
+
 bool do_show_selected(const game_options& options) noexcept
 {
   return options.do_show_selected();
 }
 
+int get_board_size(const game_options& options) noexcept
+{
+  return options.get_board_size();
+}
+
+std::map<piece_type, double> get_default_max_healths()
+{
+  std::map<piece_type, double> m;
+  for (const auto t: get_all_piece_types()) m[t] = get_max_health(t);
+  return m;
+}
+
+chess_color get_ai_player_color(const game_options& options) noexcept
+{
+  assert(has_ai_player(options));
+  return get_keyboard_user_player_color(options);
+}
+
 game_options get_default_game_options()
 {
   return game_options(
@@ -44,11 +85,11 @@ game_options get_default_game_options()
 
 chess_color get_keyboard_user_player_color(const game_options& options)
 {
-  if (options.get_left_controller_type() == controller_type::keyboard)
+  if (uses_keyboard_actions(options.get_left_controller_type()))
   {
     return get_left_player_color(options);
   }
-  assert(options.get_right_controller_type() == controller_type::keyboard);
+  assert(uses_keyboard_actions(options.get_right_controller_type()));
   return get_right_player_color(options);
 }
 
@@ -112,6 +153,13 @@ controller_type get_right_player_controller(const game_options& options) noexcep
   return options.get_right_controller_type();
 }
 
+void game_options::set_board_size(const int board_size) noexcept
+{
+  assert(board_size >= get_default_board_size());
+  assert(board_size <= get_max_board_size());
+  m_board_size = board_size;
+}
+
 void game_options::set_left_player_color(const chess_color c) noexcept
 {
   m_left_player_color = c;
@@ -120,18 +168,50 @@ void game_options::set_left_player_color(const chess_color c) noexcept
 void game_options::set_left_controller_type(const controller_type t) noexcept
 {
   m_left_controller_type = t;
-  if (m_right_controller_type == t)
+  if (t != controller_type::mouse)
+  {
+    m_right_controller_type = controller_type::mouse;
+  }
+  else if (m_right_controller_type == controller_type::mouse)
   {
-    m_right_controller_type = get_next(m_right_controller_type);
+    m_right_controller_type = controller_type::keyboard;
   }
 }
 
+void game_options::set_max_game_time(const delta_t& t) noexcept
+{
+  assert(t.get() > 0.0);
+  m_max_game_time = t;
+}
+
+void game_options::set_max_health(const piece_type type, const double max_health) noexcept
+{
+  assert(max_health > 0.0);
+  m_max_healths[type] = max_health;
+}
+
+void game_options::set_max_idle_time(const delta_t& t) noexcept
+{
+  assert(t.get() > 0.0);
+  m_max_idle_time = t;
+}
+
+void game_options::set_movement_speed(const double speed) noexcept
+{
+  assert(speed > 0.0);
+  m_movement_speed = speed;
+}
+
 void game_options::set_right_controller_type(const controller_type t) noexcept
 {
   m_right_controller_type = t;
-  if (m_left_controller_type == t)
+  if (t != controller_type::mouse)
   {
-    m_left_controller_type = get_next(m_left_controller_type);
+    m_left_controller_type = controller_type::mouse;
+  }
+  else if (m_left_controller_type == controller_type::mouse)
+  {
+    m_left_controller_type = controller_type::keyboard;
   }
 }
 
@@ -139,10 +219,15 @@ std::vector<piece> get_starting_pieces(
   const game_options& options
 ) noexcept
 {
-  return get_starting_pieces(
-    get_starting_position(options),
-    get_left_player_color(options)
-  );
+  auto pieces{
+    get_starting_pieces(
+      get_starting_position(options),
+      get_left_player_color(options),
+      get_board_size(options)
+    )
+  };
+  for (auto& p: pieces) p.set_max_health(options.get_max_health(p.get_type()));
+  return pieces;
 }
 
 starting_position_type get_starting_position(const game_options& options) noexcept
@@ -150,6 +235,13 @@ starting_position_type get_starting_position(const game_options& options) noexce
   return options.get_starting_position();
 }
 
+bool has_ai_player(const game_options& options) noexcept
+{
+  return options.get_left_controller_type() == controller_type::ai
+    || options.get_right_controller_type() == controller_type::ai
+  ;
+}
+
 void test_game_options()
 {
 #ifndef NDEBUG
@@ -178,6 +270,41 @@ void test_game_options()
     const auto options{get_default_game_options()};
     assert(options.get_starting_position() == get_starting_position(options));
   }
+  // game_options::set_damage_per_chess_move
+  {
+    auto options{get_default_game_options()};
+    assert(options.get_damage_per_chess_move() == 1.0);
+    options.set_damage_per_chess_move(2.5);
+    assert(options.get_damage_per_chess_move() == 2.5);
+  }
+  // game_options::set_max_health
+  {
+    auto options{get_default_game_options()};
+    for (const auto t: get_all_piece_types())
+    {
+      assert(options.get_max_health(t) == get_max_health(t));
+    }
+    options.set_max_health(piece_type::queen, 3.0);
+    assert(options.get_max_health(piece_type::queen) == 3.0);
+    assert(options.get_max_health(piece_type::king) == get_max_health(piece_type::king));
+  }
+  // get_starting_pieces uses the maximum health of the options
+  {
+    auto options{get_default_game_options()};
+    options.set_max_health(piece_type::pawn, 2.0);
+    for (const auto& p: get_starting_pieces(options))
+    {
+      assert(p.get_max_health() == options.get_max_health(p.get_type()));
+      assert(p.get_health() == p.get_max_health());
+    }
+  }
+  // game_options::set_movement_speed
+  {
+    auto options{get_default_game_options()};
+    assert(options.get_movement_speed() == 1.0);
+    options.set_movement_speed(0.5);
+    assert(options.get_movement_speed() == 0.5);
+  }
   // game_options::set_music_volume
   {
     auto options{get_default_game_options()};
@@ -229,6 +356,50 @@ void test_game_options()
     assert(get_keyboard_user_player_color(options) == chess_color::white);
     assert(get_mouse_user_player_color(options) == chess_color::black);
   }
+  // set_board_size
+  {
+    auto options{get_default_game_options()};
+    assert(get_board_size(options) == 8);
+    options.set_board_size(32);
+    assert(get_board_size(options) == 32);
+  }
+  // set_fog_of_war
+  {
+    auto options{get_default_game_options()};
+    assert(!options.do_fog_of_war());
+    options.set_fog_of_war(true);
+    assert(options.do_fog_of_war());
+  }
+  // set_free_movement
+  {
+    auto options{get_default_game_options()};
+    assert(!options.do_free_movement());
+    options.set_free_movement(true);
+    assert(options.do_free_movement());
+  }
+  // set_measure_latency
+  {
+    auto options{get_default_game_options()};
+    assert(!options.do_measure_latency());
+    options.set_measure_latency(true);
+    assert(options.do_measure_latency());
+  }
+  // set_max_game_time
+  {
+    auto options{get_default_game_options()};
+    const delta_t t(123.0);
+    assert(!(options.get_max_game_time() == t));
+    options.set_max_game_time(t);
+    assert(options.get_max_game_time() == t);
+  }
+  // set_max_idle_time
+  {
+    auto options{get_default_game_options()};
+    const delta_t t(12.0);
+    assert(!(options.get_max_idle_time() == t));
+    options.set_max_idle_time(t);
+    assert(options.get_max_idle_time() == t);
+  }
   // set_right_controller_type
   {
     auto options{get_default_game_options()};
@@ -239,6 +410,30 @@ void test_game_options()
     assert(options.get_left_controller_type() == controller_type::keyboard);
     assert(options.get_right_controller_type() == controller_type::mouse);
   }
+  // set_show_threats
+  {
+    auto options{get_default_game_options()};
+    assert(!options.do_show_threats());
+    options.set_show_threats(true);
+    assert(options.do_show_threats());
+  }
+  // An AI player plays against the mouse user
+  {
+    auto options{get_default_game_options()};
+    assert(!has_ai_player(options));
+    options.set_left_controller_type(controller_type::ai);
+    assert(has_ai_player(options));
+    assert(options.get_right_controller_type() == controller_type::mouse);
+    assert(get_ai_player_color(options) == get_left_player_color(options));
+    assert(get_keyboard_user_player_color(options) == get_left_player_color(options));
+    assert(get_mouse_user_player_color(options) == get_right_player_color(options));
+    options.set_right_controller_type(controller_type::ai);
+    assert(options.get_left_controller_type() == controller_type::mouse);
+    assert(get_ai_player_color(options) == get_right_player_color(options));
+    options.set_right_controller_type(controller_type::mouse);
+    assert(options.get_left_controller_type() == controller_type::keyboard);
+    assert(!has_ai_player(options));
+  }
 #endif // NDEBUG
 }
 
@@ -1,6 +1,7 @@
 #ifndef GAME_OPTIONS_H
 #define GAME_OPTIONS_H
 
+#include <map>
 #include <vector>
 
 #include "controller_type.h"
@@ -23,18 +24,35 @@ public:
     const int margin_width
   );
 
+  /// Does each player only see what its pieces can see?
+  auto do_fog_of_war() const noexcept { return m_fog_of_war; }
+
+  /// Do the pieces move freely between the squares,
+  /// bumping into each other, instead of from square to square?
+  auto do_free_movement() const noexcept { return m_free_movement; }
+
+  /// Is the time measured from user input until its effect is displayed?
+  auto do_measure_latency() const noexcept { return m_measure_latency; }
+
   /// Show the squares that are actually occupied by the piecs?
   auto do_show_occupied() const noexcept { return true; }
 
   /// Are selected units highlighted?
   auto do_show_selected() const noexcept { return false; }
 
+  /// Show the squares threatened by the enemy of the left player,
+  /// as given by the influence of the pieces?
+  auto do_show_threats() const noexcept { return m_show_threats; }
+
+  /// Get the number of squares along one side of the board
+  auto get_board_size() const noexcept { return m_board_size; }
+
   /// Get the distance the mouse must be maximally in
   /// for a click to connect to a piece
   auto get_click_distance() const noexcept { return m_click_distance; }
 
   /// Get the damage per chess move that all pieces deal
-  auto get_damage_per_chess_move() const noexcept { return 1.0; }
+  auto get_damage_per_chess_move() const noexcept { return m_damage_per_chess_move; }
 
   /// Get the game speed
   auto get_game_speed() const noexcept { return m_game_speed; }
@@ -48,6 +66,20 @@ public:
   /// Get the width of the margin in pixels
   auto get_margin_width() const noexcept { return m_margin_width; }
 
+  /// Get the in-game time after which a game is a draw
+  const auto& get_max_game_time() const noexcept { return m_max_game_time; }
+
+  /// Get the in-game time without any piece doing anything,
+  /// after which a game is a draw
+  const auto& get_max_idle_time() const noexcept { return m_max_idle_time; }
+
+  /// Get the health a piece of a type starts with
+  double get_max_health(const piece_type type) const;
+
+  /// Get how fast the pieces move, as the fraction of a square per chess move,
+  /// where 1.0 denotes one square per chess move
+  auto get_movement_speed() const noexcept { return m_movement_speed; }
+
   /// How long log messages are displayed
   double get_message_display_time_secs() const noexcept { return 5.0; }
 
@@ -69,21 +101,57 @@ public:
   /// Get the sound effects volume
   volume get_sound_effects_volume() const noexcept { return volume(0.0); }
 
+  /// Set the number of squares along one side of the board,
+  /// where boards larger than 8x8 are used for large-army matches
+  void set_board_size(const int board_size) noexcept;
+
+  /// Set the damage per chess move that all pieces deal
+  void set_damage_per_chess_move(const double damage) noexcept;
+
+  /// Set if each player only sees what its pieces can see
+  void set_fog_of_war(const bool fog_of_war) noexcept { m_fog_of_war = fog_of_war; }
+
+  /// Set if the pieces move freely between the squares
+  void set_free_movement(const bool free_movement) noexcept { m_free_movement = free_movement; }
+
+  /// Set if the time from user input until its effect is displayed is measured
+  void set_measure_latency(const bool measure_latency) noexcept { m_measure_latency = measure_latency; }
+
   /// Set the game speed
   void set_game_speed(const game_speed speed) noexcept { m_game_speed = speed; }
 
   /// Set the color of the player
   void set_left_player_color(const chess_color c) noexcept;
 
-  /// Set the controller type for the left player
+  /// Set the controller type for the left player.
+  /// As one player uses the mouse, and the other
+  /// the keyboard or the AI, the right player's controller may change
   void set_left_controller_type(const controller_type t) noexcept;
 
+  /// Set the in-game time after which a game is a draw
+  void set_max_game_time(const delta_t& t) noexcept;
+
+  /// Set the health a piece of a type starts with
+  void set_max_health(const piece_type type, const double max_health) noexcept;
+
+  /// Set the in-game time without any piece doing anything,
+  /// after which a game is a draw
+  void set_max_idle_time(const delta_t& t) noexcept;
+
+  /// Set how fast the pieces move, where 1.0 denotes one square per chess move
+  void set_movement_speed(const double speed) noexcept;
+
   /// Set the replayer
   void set_replayer(const replayer& r) noexcept { m_replayer = r; }
 
-  /// Set the controller type for the right player
+  /// Set the controller type for the right player.
+  /// As one player uses the mouse, and the other
+  /// the keyboard or the AI, the left player's controller may change
   void set_right_controller_type(const controller_type t) noexcept;
 
+  /// Set if the squares threatened by the enemy of the left player are shown
+  void set_show_threats(const bool show_threats) noexcept { m_show_threats = show_threats; }
+
   /// Set the starting position
   void set_starting_position(const starting_position_type starting_position) noexcept { m_starting_position = starting_position; }
 
@@ -92,10 +160,22 @@ public:
 
 private:
 
+  /// The number of squares along one side of the board
+  int m_board_size;
+
   /// Get the distance the mouse must be maximally in
   /// for a click to connect to a piece
   double m_click_distance;
 
+  /// The damage per chess move that all pieces deal
+  double m_damage_per_chess_move;
+
+  /// Does each player only see what its pieces can see?
+  bool m_fog_of_war;
+
+  /// Do the pieces move freely between the squares?
+  bool m_free_movement;
+
   /// The game speed
   game_speed m_game_speed;
 
@@ -108,6 +188,22 @@ private:
   /// The width of the margin in pixels
   int m_margin_width;
 
+  /// The in-game time after which a game is a draw
+  delta_t m_max_game_time;
+
+  /// The health a piece starts with, per type of piece
+  std::map<piece_type, double> m_max_healths;
+
+  /// The in-game time without any piece doing anything,
+  /// after which a game is a draw
+  delta_t m_max_idle_time;
+
+  /// Is the time from user input until its effect is displayed measured?
+  bool m_measure_latency;
+
+  /// How fast the pieces move, where 1.0 denotes one square per chess move
+  double m_movement_speed;
+
   /// Replay a match
   replayer m_replayer;
 
@@ -117,6 +213,9 @@ private:
   /// The size of the screen in pixels
   screen_coordinat m_screen_size;
 
+  /// Show the squares threatened by the enemy of the left player?
+  bool m_show_threats;
+
   /// The starting position
   starting_position_type m_starting_position;
 
@@ -127,11 +226,18 @@ private:
 /// Are selected squares shown on-screen?
 bool do_show_selected(const game_options& options) noexcept;
 
+/// Get the number of squares along one side of the board
+int get_board_size(const game_options& options) noexcept;
+
+/// Get the color of the player that uses the AI.
+/// Assumes 'has_ai_player'
+chess_color get_ai_player_color(const game_options& options) noexcept;
+
 /// Get the default game options
 game_options get_default_game_options();
 
-/// Get the color of the keyboard using player
-/// Will throw if no user uses a keyboard
+/// Get the color of the keyboard using player,
+/// which is the AI if it plays
 chess_color get_keyboard_user_player_color(const game_options& options);
 
 /// Get the color of the left player
@@ -166,6 +272,10 @@ controller_type get_player_controller(
 /// Get the color of the right player
 chess_color get_right_player_color(const game_options& options) noexcept;
 
+/// Get the health a piece starts with, per type of piece,
+/// as used when not specified otherwise
+std::map<piece_type, double> get_default_max_healths();
+
 /// Get the controller of the right player
 controller_type get_right_player_controller(const game_options& options) noexcept;
 
@@ -177,6 +287,9 @@ std::vector<piece> get_starting_pieces(
 /// Get the starting position
 starting_position_type get_starting_position(const game_options& options) noexcept;
 
+/// Does a player use the AI?
+bool has_ai_player(const game_options& options) noexcept;
+
 /// Test this class and its free functions
 void test_game_options();
 
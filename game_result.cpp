@@ -0,0 +1,86 @@
+#include "game_result.h"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+std::vector<game_result> get_all_game_results() noexcept
+{
+  return
+  {
+    game_result::undecided,
+    game_result::white_wins,
+    game_result::black_wins,
+    game_result::draw
+  };
+}
+
+game_result get_winning_result(const chess_color winner) noexcept
+{
+  if (winner == chess_color::white) return game_result::white_wins;
+  assert(winner == chess_color::black);
+  return game_result::black_wins;
+}
+
+bool is_over(const game_result r) noexcept
+{
+  return r != game_result::undecided;
+}
+
+void test_game_result()
+{
+#ifndef NDEBUG
+  // get_winning_result
+  {
+    assert(get_winning_result(chess_color::white) == game_result::white_wins);
+    assert(get_winning_result(chess_color::black) == game_result::black_wins);
+  }
+  // is_over
+  {
+    assert(!is_over(game_result::undecided));
+    assert(is_over(game_result::white_wins));
+    assert(is_over(game_result::black_wins));
+    assert(is_over(game_result::draw));
+  }
+  // to_str
+  {
+    assert(to_str(game_result::undecided) == "undecided");
+    assert(to_str(game_result::white_wins) == "white_wins");
+    assert(to_str(game_result::black_wins) == "black_wins");
+    assert(to_str(game_result::draw) == "draw");
+  }
+  // to_str, from collection
+  {
+    for (const auto r: get_all_game_results())
+    {
+      assert(!to_str(r).empty());
+    }
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    s << game_result::draw;
+    assert(!s.str().empty());
+  }
+#endif // NDEBUG
+}
+
+std::string to_str(const game_result r) noexcept
+{
+  switch (r)
+  {
+    case game_result::undecided: return "undecided";
+    case game_result::white_wins: return "white_wins";
+    case game_result::black_wins: return "black_wins";
+    default:
+    case game_result::draw:
+      assert(r == game_result::draw);
+      return "draw";
+  }
+}
+
+std::ostream& operator<<(std::ostream& os, const game_result r) noexcept
+{
+  os << to_str(r);
+  return os;
+}
@@ -0,0 +1,35 @@
+#ifndef GAME_RESULT_H
+#define GAME_RESULT_H
+
+#include "chess_color.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// The result of a game
+enum class game_result
+{
+  undecided,
+  white_wins,
+  black_wins,
+  draw
+};
+
+/// Get all the game results
+std::vector<game_result> get_all_game_results() noexcept;
+
+/// Get the result in which the player of that color wins
+game_result get_winning_result(const chess_color winner) noexcept;
+
+/// Is the game over, i.e. is the result anything but 'undecided'?
+bool is_over(const game_result r) noexcept;
+
+/// Test this class and its free functions
+void test_game_result();
+
+std::string to_str(const game_result r) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const game_result r) noexcept;
+
+#endif // GAME_RESULT_H
@@ -17,13 +17,23 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <random>
 #include <string>
 #include <sstream>
 
 game_view::game_view(const game& game)
   : m_game{game},
+    m_influence_map{get_board_size(game.get_options())},
     m_log{game.get_options().get_message_display_time_secs()}
 {
+  if (has_ai_player(m_game.get_options()))
+  {
+    m_ai = std::make_unique<ai_controller>(
+      m_game,
+      get_ai_player_color(m_game.get_options()),
+      std::random_device{}()
+    );
+  }
   m_game_resources.get_ninja_gods().setVolume(
     get_music_volume_as_percentage(m_game)
   );
@@ -95,12 +105,21 @@ void game_view::exec()
     };
     if (must_quit) return;
 
+    // Let the AI think on its own thread, which never waits
+    if (m_ai) m_ai->play();
+
     // Do a tick, so that one delta_t equals one second under normal game speed
     m_game.tick(
       delta_t(1.0 / m_fps_clock.get_fps())
       * to_delta_t(m_game.get_options().get_game_speed())
     );
 
+    // Only the pieces that changed are updated
+    if (m_game.get_options().do_show_threats())
+    {
+      update_influence_map();
+    }
+
     // Read the pieces' messages and play their sounds
     process_piece_messages();
 
@@ -120,6 +139,10 @@ std::string get_controls_text(
   assert(key <= 4); // Human based counting
   const auto& selected_units = get_selected_pieces(view.get_game(), player);
   std::stringstream s;
+  if (controller == controller_type::ai)
+  {
+    return key == 1 ? "AI" : ".";
+  }
   if (controller == controller_type::keyboard)
   {
     if (selected_units.empty()) return "Spacebar\nSelect";
@@ -216,7 +239,8 @@ bool game_view::process_events()
           static_cast<int>(event.size.width),
           static_cast<int>(event.size.height)
         ),
-        get_default_margin_width()
+        get_default_margin_width(),
+        m_game.get_options().get_board_size()
       );
     }
     else if (event.type == sf::Event::Closed)
@@ -232,6 +256,17 @@ bool game_view::process_events()
         m_window.close();
         return true;
       }
+      else if (key_pressed == sf::Keyboard::Key::T)
+      {
+        m_game.get_options().set_show_threats(
+          !m_game.get_options().do_show_threats()
+        );
+        update_influence_map();
+      }
+      else if (m_ai)
+      {
+        // The AI gives the keyboard actions
+      }
       else if (key_pressed == sf::Keyboard::Key::Up)
       {
         m_game.add_action(create_press_up_action());
@@ -260,6 +295,22 @@ bool game_view::process_events()
       {
         m_game.add_action(create_press_attack_action());
       }
+      else if (
+        key_pressed >= sf::Keyboard::Key::Num0
+        && key_pressed <= sf::Keyboard::Key::Num9
+      )
+      {
+        // Control+number stores a control group, number recalls it
+        const int control_group{key_pressed - sf::Keyboard::Key::Num0};
+        if (event.key.control)
+        {
+          m_game.add_action(create_press_assign_group_action(control_group));
+        }
+        else
+        {
+          m_game.add_action(create_press_recall_group_action(control_group));
+        }
+      }
       else if (key_pressed == sf::Keyboard::Key::F3)
       {
         // debug
@@ -307,6 +358,23 @@ bool game_view::process_events()
         );
       }
     }
+    else if (event.type == sf::Event::MouseButtonReleased)
+    {
+      if (event.mouseButton.button == sf::Mouse::Left)
+      {
+        const auto mouse_screen_pos{
+          screen_coordinat(event.mouseButton.x, event.mouseButton.y)
+        };
+        m_game.add_action(
+          create_release_lmb_action(
+            convert_to_game_coordinat(
+              mouse_screen_pos,
+              m_game.get_layout()
+            )
+          )
+        );
+      }
+    }
     else if (event.type == sf::Event::KeyReleased)
     {
       // Maybe a player input?
@@ -316,6 +384,20 @@ bool game_view::process_events()
   return false; // if no events proceed with tick
 }
 
+game_coordinat get_drawn_coordinat(const game_view& view, const piece& p)
+{
+  if (get_options(view).do_free_movement()) return p.get_coordinat();
+  return to_coordinat(p.get_current_square());
+}
+
+bool is_visible(const game_view& view, const piece& p)
+{
+  const auto& g{view.get_game()};
+  const auto viewer{get_player_color(g, side::lhs)};
+  if (p.get_color() == viewer) return true;
+  return is_visible(g, p.get_current_square(), viewer);
+}
+
 void game_view::process_piece_messages()
 {
   for (const auto& piece_message: collect_messages(m_game))
@@ -349,11 +431,18 @@ void game_view::show()
 
   // Display all shapes
   m_window.display();
+
+  // The effect of the user input processed is shown now
+  m_game.get_latency().on_display();
 }
 
 void show_board(game_view& view)
 {
   show_squares(view);
+  if (get_options(view).do_show_threats())
+  {
+    show_threats(view);
+  }
   if (get_options(view).do_show_occupied())
   {
     show_occupied_squares(view);
@@ -365,6 +454,7 @@ void show_board(game_view& view)
   show_unit_paths(view);
   show_pieces(view);
   show_unit_health_bars(view);
+  show_selection_box(view);
 }
 
 void show_controls(game_view& view, const side player)
@@ -424,7 +514,7 @@ void show_debug_1(game_view& view)
   s << "Color: " << color << '\n'
     << "Controller: " << get_left_player_controller(view.get_game().get_options()) << '\n'
     << "Game position: "
-    << to_notation(get_player_pos(game, side::lhs))
+    << to_notation(get_player_pos(game, side::lhs), get_board_size(game.get_options()))
     << " "
     << get_player_pos(game, side::lhs)
     << '\n'
@@ -470,7 +560,7 @@ void show_debug_2(game_view& view)
   s << "Color: " << color << '\n'
     << "Controller: " << get_right_player_controller(game.get_options()) << '\n'
     << "Game position: "
-    << to_notation(get_player_pos(game, side::rhs))
+    << to_notation(get_player_pos(game, side::rhs), get_board_size(game.get_options()))
     << " "
     << get_player_pos(game, side::rhs)
     << '\n'
@@ -598,6 +688,7 @@ void show_pieces(game_view& view)
   const double square_height{get_square_height(layout)};
   for (const auto& piece: game.get_pieces())
   {
+    if (!is_visible(view, piece)) continue;
     sf::RectangleShape sprite;
     sprite.setSize(sf::Vector2f(0.9 * square_width, 0.9 * square_height));
     sprite.setTexture(
@@ -606,8 +697,9 @@ void show_pieces(game_view& view)
         piece.get_type()
       )
     );
-    // Transparency effect when moving
-    if (!piece.get_actions().empty()
+    // Transparency effect when moving from square to square
+    if (!get_options(view).do_free_movement()
+      && !piece.get_actions().empty()
       && piece.get_actions()[0].get_action_type() == piece_action_type::move
     )
     {
@@ -634,7 +726,7 @@ void show_pieces(game_view& view)
     }
     sprite.setOrigin(sf::Vector2f(0.45 * square_width, 0.45 * square_height));
     const auto screen_position = convert_to_screen_coordinat(
-      to_coordinat(piece.get_current_square()) + game_coordinat(0.0, 0.1),
+      get_drawn_coordinat(view, piece) + game_coordinat(0.0, 0.1),
       layout
     );
     sprite.setPosition(
@@ -698,9 +790,10 @@ void show_squares(game_view& view)
   sf::RectangleShape black_square = create_black_square(view);
   sf::RectangleShape white_square = create_white_square(view);
 
-  for (int x = 0; x != 8; ++x)
+  const int board_size{layout.get_board_size()};
+  for (int x = 0; x != board_size; ++x)
   {
-    for (int y = 0; y != 8; ++y)
+    for (int y = 0; y != board_size; ++y)
     {
       sf::RectangleShape& s = (x + y) % 2 == 0 ? black_square : white_square;
       const screen_coordinat square_pos{
@@ -715,18 +808,50 @@ void show_squares(game_view& view)
   }
 }
 
+void show_selection_box(game_view& view)
+{
+  const auto& game = view.get_game();
+  const auto& actions{game.get_actions()};
+  if (!actions.is_lmb_down()) return;
+  const auto& layout = game.get_layout();
+  const chess_color mouse_color{get_mouse_user_player_color(game)};
+  const side mouse_player{get_player_side(game, mouse_color)};
+  const screen_coordinat from{
+    convert_to_screen_coordinat(actions.get_lmb_down_pos(), layout)
+  };
+  const screen_coordinat to{
+    convert_to_screen_coordinat(get_player_pos(game, mouse_player), layout)
+  };
+  sf::RectangleShape box;
+  box.setPosition(
+    std::min(from.get_x(), to.get_x()),
+    std::min(from.get_y(), to.get_y())
+  );
+  box.setSize(
+    sf::Vector2f(
+      std::abs(to.get_x() - from.get_x()),
+      std::abs(to.get_y() - from.get_y())
+    )
+  );
+  box.setFillColor(sf::Color::Transparent);
+  box.setOutlineColor(to_sfml_color(mouse_color));
+  box.setOutlineThickness(2);
+  view.get_window().draw(box);
+}
+
 void show_square_under_cursor(
   game_view& view,
   const side player)
 {
   const auto& game = view.get_game();
   const auto& layout = game.get_layout();
+  const int board_size{layout.get_board_size()};
   const int x{static_cast<int>(std::trunc(get_player_pos(game, player).get_x()))};
-  if (x < 0 || x >= 8) return;
+  if (x < 0 || x >= board_size) return;
   const int y{static_cast<int>(std::trunc(get_player_pos(game, player).get_y()))};
-  if (y < 0 || y >= 8) return;
+  if (y < 0 || y >= board_size) return;
 
-  assert(x >= 0 && x < 8 && y >= 0 && y < 8);
+  assert(is_valid_square_xy(x, y, board_size));
   sf::RectangleShape s;
   const double square_width{get_square_width(layout)};
   const double square_height{get_square_height(layout)};
@@ -760,12 +885,38 @@ void show_square_under_cursor(
   s.setOutlineThickness(old_thickness);
 }
 
+void show_threats(game_view& view)
+{
+  assert(get_options(view).do_show_threats());
+  const auto& m{view.get_influence_map()};
+  const chess_color color{get_left_player_color(get_options(view))};
+  // A square under the enemy influence of a full-health queen is fully red
+  const double max_threat{
+    static_cast<double>(get_influence_weight(piece_type::queen))
+  };
+  sf::RectangleShape s;
+  for (int x = 0; x != m.get_board_size(); ++x)
+  {
+    for (int y = 0; y != m.get_board_size(); ++y)
+    {
+      const square here(x, y);
+      const int threat{get_threat(m, color, here)};
+      if (threat == 0) continue;
+      const double f{std::min(1.0, threat / max_threat)};
+      set_rect(s, convert_to_screen_rect(to_game_rect(here), get_layout(view)));
+      s.setFillColor(sf::Color(255, 0, 0, static_cast<sf::Uint8>(128.0 * f)));
+      view.get_window().draw(s);
+    }
+  }
+}
+
 void show_unit_health_bars(game_view& view)
 {
   const auto& game = view.get_game();
   const auto& layout = game.get_layout();
   for (const auto& piece: game.get_pieces())
   {
+    if (!is_visible(view, piece)) continue;
     // Black box around it
     sf::RectangleShape black_box;
 
@@ -774,7 +925,7 @@ void show_unit_health_bars(game_view& view)
     black_box.setFillColor(sf::Color(0, 0, 0));
     black_box.setOrigin(0.0, 0.0);
     const auto black_box_pos = convert_to_screen_coordinat(
-      to_coordinat(piece.get_current_square()) + game_coordinat(-0.5, -0.5),
+      get_drawn_coordinat(view, piece) + game_coordinat(-0.5, -0.5),
       layout
     );
     black_box.setPosition(
@@ -795,7 +946,7 @@ void show_unit_health_bars(game_view& view)
     health_bar.setFillColor(f_health_to_color(get_f_health(piece)));
     health_bar.setOrigin(0.0, 0.0);
     const auto health_bar_pos = convert_to_screen_coordinat(
-      to_coordinat(piece.get_current_square()) + game_coordinat(-0.5, -0.5),
+      get_drawn_coordinat(view, piece) + game_coordinat(-0.5, -0.5),
       layout
     );
     health_bar.setPosition(
@@ -813,6 +964,7 @@ void show_unit_paths(game_view& view)
   for (const auto& piece: get_pieces(game))
   {
     if (is_idle(piece)) continue;
+    if (!is_visible(view, piece)) continue;
     const auto& actions{piece.get_actions()};
     for (const auto& action: actions)
     {
@@ -1044,6 +1196,13 @@ void toggle_left_player_color(game_view& view)
   toggle_left_player_color(view.get_game());
 }
 
+void game_view::update_influence_map()
+{
+  m_influence_map.update(
+    get_visible_pieces(m_game, get_left_player_color(m_game.get_options()))
+  );
+}
+
 bool would_be_valid(
   const game_view& view,
   chess_color player_color
@@ -3,14 +3,18 @@
 
 #ifndef LOGIC_ONLY
 
+#include "ai_controller.h"
 #include "ccfwd.h"
 #include "game.h"
 #include "fps_clock.h"
 #include "game_log.h"
 #include "game_resources.h"
 #include "game_view_layout.h"
+#include "influence_map.h"
 #include <SFML/Graphics.hpp>
 
+#include <memory>
+
 /// The game's main window
 /// Displays the game class
 class game_view
@@ -30,6 +34,10 @@ public:
 
   const auto& get_game() const noexcept { return m_game; }
 
+  /// Get the influence of the pieces, which is only
+  /// kept up to date when the threatened squares are shown
+  const auto& get_influence_map() const noexcept { return m_influence_map; }
+
   auto& get_resources() noexcept { return m_game_resources; }
 
   /// Get the text log, i.e. things pieces have to say
@@ -48,9 +56,16 @@ private:
   /// The game logic
   game m_game;
 
+  /// The AI, if one player uses it.
+  /// Declared after the game it plays, so that it stops before the game is gone
+  std::unique_ptr<ai_controller> m_ai;
+
   /// The resources (images, sounds, etc.) of the game
   game_resources m_game_resources;
 
+  /// The influence of the pieces, to show the threatened squares
+  influence_map m_influence_map;
+
   /// The text log
   game_log m_log;
 
@@ -72,6 +87,10 @@ private:
 
   /// Show the mouse cursor on-screen
   void show_mouse_cursor();
+
+  /// Make the influence map match the pieces the left player can see,
+  /// so that the threats shown do not reveal the pieces hidden by the fog-of-war
+  void update_influence_map();
 };
 
 /// Convert 'true' to 'true' and 'false' to 'false'
@@ -97,6 +116,11 @@ std::string get_controls_text(
 /// Get the frames per second
 int get_fps(const game_view& v) noexcept;
 
+/// Get the coordinat to draw the center of a piece at.
+/// When the pieces move freely, this is in between squares while moving.
+/// Else, it is the center of the square the piece is formally on
+game_coordinat get_drawn_coordinat(const game_view& view, const piece& p);
+
 /// Get the last log messages for a player
 std::string get_last_log_messages(
   const game_view& v,
@@ -115,6 +139,11 @@ const std::vector<piece>& get_pieces(const game_view& v) noexcept;
 /// Get the time in the game
 const delta_t& get_time(const game_view& v) noexcept;
 
+/// Can the piece be seen on-screen?
+/// With fog-of-war, the screen shows what the left player can see.
+/// Without fog-of-war, all pieces are visible
+bool is_visible(const game_view& view, const piece& p);
+
 /// Show the board: squares, unit paths, pieces, health bars
 void show_board(game_view& view);
 
@@ -148,9 +177,18 @@ void show_possible_moves(game_view& view, const side player);
 /// Show the info on the side-bar on-screen for player 1
 void show_sidebar_1(game_view& view);
 
+/// Show the box the mouse player is dragging to select pieces, if any
+void show_selection_box(game_view& view);
+
 /// Show the info on the side-bar on-screen for player 2
 void show_sidebar_2(game_view& view);
 
+/// Show the squares threatened by the enemy of the left player on-screen,
+/// darker for squares under more enemy influence,
+/// of the enemy pieces the left player can see.
+/// Throws if this option is turned off
+void show_threats(game_view& view);
+
 /// Show the squares of the board on-screen
 void show_squares(game_view& view);
 
@@ -10,9 +10,12 @@
 
 game_view_layout::game_view_layout(
   const screen_coordinat& window_size,
-  const int margin_width
-) : m_window_size{window_size}
+  const int margin_width,
+  const int board_size
+) : m_board_size{board_size},
+    m_window_size{window_size}
 {
+  assert(m_board_size > 0);
   const int unit_panel_height{100};
   const int control_panel_height{75};
   const int log_panel_height{
@@ -160,8 +163,8 @@ game_coordinat convert_to_game_coordinat(
     static_cast<double>(screen_on_board_y) / static_cast<double>(get_board_height(layout))
   };
   return game_coordinat(
-    8.0 * f_x,
-    8.0 * f_y
+    layout.get_board_size() * f_x,
+    layout.get_board_size() * f_y
   );
 }
 
@@ -284,12 +287,14 @@ std::vector<screen_rect> get_panels(const game_view_layout& layout)
 
 double get_square_height(const game_view_layout& layout) noexcept
 {
-  return static_cast<double>(get_board_height(layout)) / 8.0;
+  return static_cast<double>(get_board_height(layout))
+    / static_cast<double>(layout.get_board_size());
 }
 
 double get_square_width(const game_view_layout& layout) noexcept
 {
-  return static_cast<double>(get_board_width(layout)) / 8.0;
+  return static_cast<double>(get_board_width(layout))
+    / static_cast<double>(layout.get_board_size());
 }
 
 void test_game_view_layout()
@@ -394,5 +399,22 @@ void test_game_view_layout()
     assert(a1_rect.get_tl() == layout.get_board().get_tl());
     assert(h8_rect.get_br() == layout.get_board().get_br());
   }
+  // On a larger board, the squares are smaller
+  {
+    const game_view_layout layout;
+    const game_view_layout large_layout(
+      get_default_screen_size(),
+      get_default_margin_width(),
+      16
+    );
+    assert(large_layout.get_board_size() == 16);
+    assert(large_layout.get_board() == layout.get_board());
+    assert(is_close(get_square_width(large_layout) * 2.0, get_square_width(layout), 0.001));
+    const auto br_board = convert_to_game_coordinat(
+      large_layout.get_board().get_br(),
+      large_layout
+    );
+    assert(br_board.get_x() == 16.0);
+  }
   #endif
 }
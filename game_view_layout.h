@@ -44,10 +44,15 @@ class game_view_layout
 public:
   explicit game_view_layout(
     const screen_coordinat& window_size = get_default_screen_size(),
-    const int margin_width = get_default_margin_width()
+    const int margin_width = get_default_margin_width(),
+    const int board_size = get_default_board_size()
   );
 
   const auto& get_board() const noexcept { return m_board; }
+
+  /// Get the number of squares along one side of the board
+  int get_board_size() const noexcept { return m_board_size; }
+
   const screen_rect& get_controls(const side player) const noexcept;
   const screen_rect& get_controls_key(const side player, const int key) const noexcept;
   const auto& get_debug_1() const noexcept { return m_debug_1; }
@@ -62,6 +67,10 @@ private:
 
 
   screen_rect m_board;
+
+  /// The number of squares along one side of the board
+  int m_board_size;
+
   screen_rect m_controls_lhs;
   screen_rect m_controls_lhs_key_1;
   screen_rect m_controls_lhs_key_2;
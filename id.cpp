@@ -4,10 +4,10 @@
 #include <iostream>
 #include <sstream>
 
-int id::sm_next_value{0};
+std::atomic<int> id::sm_next_value{0};
 
 id::id()
-  : m_value{sm_next_value++}
+  : m_value{sm_next_value.fetch_add(1, std::memory_order_relaxed)}
 {
 
 }
@@ -1,9 +1,11 @@
 #ifndef ID_H
 #define ID_H
 
+#include <atomic>
 #include <iosfwd>
 
-/// An ID, each one being unique
+/// An ID, each one being unique,
+/// also when games are created on multiple threads
 class id
 {
 public:
@@ -12,7 +14,7 @@ public:
 private:
   id();
 
-  static int sm_next_value;
+  static std::atomic<int> sm_next_value;
 
   int m_value;
 
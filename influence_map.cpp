@@ -0,0 +1,401 @@
+#include "influence_map.h"
+
+#include "game.h"
+#include "piece.h"
+#include "pieces.h"
+#include "visibility.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+influence_map::influence_map(const int board_size)
+  : m_board_size{board_size},
+    m_fields{
+      std::vector<int>((board_size * board_size) + (2 * get_influence_stamp_width()), 0),
+      std::vector<int>((board_size * board_size) + (2 * get_influence_stamp_width()), 0)
+    },
+    m_n_updates{0},
+    m_n_changed{0},
+    m_stamps{}
+{
+  assert(m_board_size > 0);
+}
+
+void influence_map::apply(const influence_stamp& s, const int sign) noexcept
+{
+  constexpr int max_range{get_max_influence_range()};
+  constexpr int width{get_influence_stamp_width()};
+  static_assert(width > 2 * max_range, "A row of a stamp covers the range");
+  assert(s.m_range >= 0);
+  assert(s.m_range <= max_range);
+  assert(sign == 1 || sign == -1);
+  auto& field{m_fields[static_cast<int>(s.m_color)]};
+  const int n{m_board_size};
+
+  // A row of the stamp may stick out of the row of the map,
+  // adding zeroes to the rows next to it, or to the room around the map.
+  // The row is copied first, so that the compiler knows
+  // it does not overlap with the map
+  std::array<int, width> row;
+  for (int x{std::max(0, s.m_x - s.m_range)}; x < std::min(n, s.m_x + s.m_range + 1); ++x)
+  {
+    const auto from{std::begin(s.m_values) + ((x - s.m_x + max_range) * width)};
+    std::copy(from, from + width, std::begin(row));
+    int * const to{field.data() + width + (x * n) + s.m_y - max_range};
+    if (sign == 1)
+    {
+      for (int i{0}; i != width; ++i) to[i] += row[i];
+    }
+    else
+    {
+      for (int i{0}; i != width; ++i) to[i] -= row[i];
+    }
+  }
+}
+
+influence_stamp create_influence_stamp(
+  const piece& p,
+  const bitboard& occupied,
+  const int board_size
+)
+{
+  const square& s{p.get_current_square()};
+  const int range{get_influence_range(p.get_type())};
+  const int weight{get_influence_weight(p)};
+  influence_stamp stamp{p.get_color(), range, bitboard(), weight, s.get_x(), s.get_y(), {}};
+  // Only the squares within the range are influenced
+  for (const auto& there: to_squares(get_reach(p, occupied, board_size)))
+  {
+    const int dx{there.get_x() - s.get_x()};
+    const int dy{there.get_y() - s.get_y()};
+    const int distance{std::max(std::abs(dx), std::abs(dy))};
+    if (distance > range) continue;
+    stamp.m_reach.set(there);
+    const int row{dx + get_max_influence_range()};
+    const int column{dy + get_max_influence_range()};
+    stamp.m_values[(row * get_influence_stamp_width()) + column] = weight >> distance;
+  }
+  return stamp;
+}
+
+int influence_map::get_influence(const chess_color c, const square& s) const noexcept
+{
+  assert(s.get_x() >= 0 && s.get_x() < m_board_size);
+  assert(s.get_y() >= 0 && s.get_y() < m_board_size);
+  const auto& field{m_fields[static_cast<int>(c)]};
+  return field[get_influence_stamp_width() + (s.get_x() * m_board_size) + s.get_y()];
+}
+
+std::vector<int> influence_map::get_field(const chess_color c) const
+{
+  const auto& field{m_fields[static_cast<int>(c)]};
+  const auto begin{std::begin(field) + get_influence_stamp_width()};
+  return std::vector<int>(begin, begin + (m_board_size * m_board_size));
+}
+
+int get_influence_balance(
+  const influence_map& m,
+  const chess_color c,
+  const square& s
+) noexcept
+{
+  return m.get_influence(c, s) - m.get_influence(get_other_color(c), s);
+}
+
+int get_influence_range(const piece_type type) noexcept
+{
+  // About how far a piece reaches in one order,
+  // capped, as its influence further away is negligible
+  switch (type)
+  {
+    case piece_type::king: return 1;
+    case piece_type::pawn: return 1;
+    case piece_type::knight: return 3;
+    case piece_type::bishop:
+    case piece_type::queen:
+    case piece_type::rook:
+    default:
+      return 4;
+  }
+}
+
+int get_influence_weight(const piece_type type) noexcept
+{
+  // The king is worth the game, yet fights like a minor piece
+  const int value{type == piece_type::king ? 4 : get_material_value(type)};
+  return value * 256;
+}
+
+int get_influence_weight(const piece& p) noexcept
+{
+  return static_cast<int>(std::round(get_influence_weight(p.get_type()) * get_f_health(p)));
+}
+
+int get_threat(
+  const influence_map& m,
+  const chess_color c,
+  const square& s
+) noexcept
+{
+  return std::max(0, -get_influence_balance(m, c, s));
+}
+
+void test_influence_map()
+{
+#ifndef NDEBUG
+  // An empty map has no influence
+  {
+    const influence_map m;
+    assert(m.get_board_size() == 8);
+    assert(m.get_influence(chess_color::white, square("e4")) == 0);
+    assert(m.get_field(chess_color::black).size() == 64);
+    assert(m.get_n_changed() == 0);
+  }
+  // A king influences the squares next to it, at half its weight
+  {
+    const game g{get_game_with_starting_position(starting_position_type::kings_only)};
+    influence_map m;
+    m.update(g);
+    assert(m.get_n_changed() == 2);
+    const int weight{get_influence_weight(piece_type::king)};
+    assert(m.get_influence(chess_color::white, square("e1")) == weight);
+    assert(m.get_influence(chess_color::white, square("e2")) == weight / 2);
+    assert(m.get_influence(chess_color::white, square("d2")) == weight / 2);
+    assert(m.get_influence(chess_color::white, square("e3")) == 0);
+    assert(m.get_influence(chess_color::black, square("e1")) == 0);
+    assert(get_influence_balance(m, chess_color::white, square("e1")) == weight);
+    assert(get_threat(m, chess_color::white, square("e1")) == 0);
+    assert(get_threat(m, chess_color::black, square("e1")) == weight);
+  }
+  // An update only changes the pieces that changed
+  {
+    game g;
+    influence_map m;
+    m.update(g);
+    assert(m.get_n_changed() == 32);
+    m.update(g);
+    assert(m.get_n_changed() == 0);
+
+    // A piece that moved, and the pieces that could see it
+    g.get_pieces()[0].set_current_square(square("d4"));
+    m.update(g);
+    assert(m.get_n_changed() >= 1);
+    assert(m.get_n_changed() < 32);
+
+    // A piece that was damaged
+    g.get_pieces()[1].receive_damage(0.5 * g.get_pieces()[1].get_max_health());
+    m.update(g);
+    assert(m.get_n_changed() == 1);
+
+    // A piece that is gone, and the pieces that could see it
+    g.get_pieces().pop_back();
+    m.update(g);
+    assert(m.get_n_changed() >= 1);
+    assert(m.get_n_changed() < 31);
+
+    // The map is the same as a map made from scratch
+    influence_map from_scratch;
+    from_scratch.update(g);
+    for (const auto c: get_all_chess_colors())
+    {
+      assert(m.get_field(c) == from_scratch.get_field(c));
+    }
+  }
+  // A damaged piece has less influence
+  {
+    game g{get_game_with_starting_position(starting_position_type::kings_only)};
+    influence_map m;
+    m.update(g);
+    const int before{m.get_influence(chess_color::white, square("e1"))};
+    for (auto& p: g.get_pieces())
+    {
+      if (p.get_color() == chess_color::white) p.receive_damage(0.5 * p.get_max_health());
+    }
+    m.update(g);
+    assert(m.get_influence(chess_color::white, square("e1")) == before / 2);
+  }
+  // The influence of a piece at the edge stays on the board
+  {
+    std::vector<piece> pieces{get_starting_pieces(starting_position_type::standard)};
+    influence_map m;
+    m.update(pieces);
+    int sum{0};
+    for (const int i: m.get_field(chess_color::white)) sum += i;
+    assert(sum > 0);
+    m.update(std::vector<piece>());
+    assert(m.get_n_changed() == 32);
+    for (const auto c: get_all_chess_colors())
+    {
+      for (const int i: m.get_field(c)) assert(i == 0);
+    }
+  }
+  // A piece only influences the squares it can see
+  {
+    const game g;
+    influence_map m;
+    m.update(g);
+    // The rook at a1 is blocked by the pawn at a2,
+    // and the knight at b1 cannot reach b2
+    bitboard occupied;
+    for (const auto& p: g.get_pieces()) occupied.set(p.get_current_square());
+    const auto rook{create_influence_stamp(get_piece_at(g, square("a1")), occupied)};
+    assert(rook.m_reach.is_set(square("a2")));
+    assert(!rook.m_reach.is_set(square("a3")));
+    const auto knight{create_influence_stamp(get_piece_at(g, square("b1")), occupied)};
+    assert(!knight.m_reach.is_set(square("b2")));
+    assert(m.get_influence(chess_color::white, square("a4")) == 0);
+  }
+  // A piece whose way is cleared influences further
+  {
+    game g;
+    influence_map m;
+    m.update(g);
+    const int before{m.get_influence(chess_color::white, square("a3"))};
+    // The pawn at a2 is gone, so the rook at a1 sees a3
+    auto& pieces{g.get_pieces()};
+    pieces.erase(
+      std::find_if(
+        std::begin(pieces),
+        std::end(pieces),
+        [](const auto& p) { return p.get_current_square() == square("a2"); }
+      )
+    );
+    m.update(g);
+    assert(m.get_influence(chess_color::white, square("a3")) > before);
+    influence_map from_scratch;
+    from_scratch.update(g);
+    for (const auto c: get_all_chess_colors())
+    {
+      assert(m.get_field(c) == from_scratch.get_field(c));
+    }
+  }
+  // With fog-of-war, a map of the pieces a player can see
+  // shows no threats of the enemy pieces it cannot see
+  {
+    game_options options{get_default_game_options()};
+    options.set_starting_position(starting_position_type::kings_only);
+    options.set_fog_of_war(true);
+    const game g(options);
+    influence_map m;
+    m.update(get_visible_pieces(g, chess_color::white));
+    for (const int i: m.get_field(chess_color::black)) assert(i == 0);
+    assert(get_threat(m, chess_color::white, square("e7")) == 0);
+    influence_map all;
+    all.update(g);
+    assert(get_threat(all, chess_color::white, square("e7")) > 0);
+  }
+  // operator==
+  {
+    bitboard reach;
+    reach.set(square("a5"));
+    const influence_stamp a{chess_color::white, 1, reach, 1024, 0, 4, {}};
+    auto b{a};
+    assert(a == b);
+    b.m_y = 3;
+    assert(a != b);
+    auto c{a};
+    c.m_reach.set(square("a4"));
+    assert(a != c);
+  }
+#endif // NDEBUG
+}
+
+void influence_map::update(const game& g)
+{
+  update(g.get_pieces());
+}
+
+void influence_map::update(const std::vector<piece>& pieces)
+{
+  ++m_n_updates;
+  m_n_changed = 0;
+  bitboard occupied;
+  for (const auto& p: pieces) occupied.set(p.get_current_square());
+
+  // The squares that were entered or left since the last update
+  bitboard changed;
+  for (const auto& p: pieces)
+  {
+    const auto there{m_stamps.find(p.get_id().get())};
+    const square& now{p.get_current_square()};
+    if (there == std::end(m_stamps))
+    {
+      changed.set(now);
+      continue;
+    }
+    auto& [stamp, last_update]{there->second};
+    if (stamp.m_x != now.get_x() || stamp.m_y != now.get_y())
+    {
+      changed.set(square(stamp.m_x, stamp.m_y));
+      changed.set(now);
+    }
+    last_update = m_n_updates;
+  }
+  for (const auto& i: m_stamps)
+  {
+    const auto& [stamp, last_update]{i.second};
+    if (last_update != m_n_updates) changed.set(square(stamp.m_x, stamp.m_y));
+  }
+
+  for (const auto& p: pieces)
+  {
+    const auto there{m_stamps.find(p.get_id().get())};
+    if (there == std::end(m_stamps))
+    {
+      const auto s{create_influence_stamp(p, occupied, m_board_size)};
+      apply(s, 1);
+      m_stamps.emplace(p.get_id().get(), std::make_pair(s, m_n_updates));
+      ++m_n_changed;
+      continue;
+    }
+    auto& stamp{there->second.first};
+    // Only a piece that can see a changed square has a different reach now
+    const square& now{p.get_current_square()};
+    if (stamp.m_x == now.get_x()
+      && stamp.m_y == now.get_y()
+      && stamp.m_weight == get_influence_weight(p)
+      && !have_common_squares(stamp.m_reach, changed)
+    )
+    {
+      continue;
+    }
+    const auto s{create_influence_stamp(p, occupied, m_board_size)};
+    if (stamp != s)
+    {
+      apply(stamp, -1);
+      apply(s, 1);
+      stamp = s;
+      ++m_n_changed;
+    }
+  }
+  // Remove the influence of the pieces that are gone
+  for (auto i{std::begin(m_stamps)}; i != std::end(m_stamps); )
+  {
+    if (i->second.second == m_n_updates)
+    {
+      ++i;
+      continue;
+    }
+    apply(i->second.first, -1);
+    i = m_stamps.erase(i);
+    ++m_n_changed;
+  }
+}
+
+bool operator==(const influence_stamp& lhs, const influence_stamp& rhs) noexcept
+{
+  return lhs.m_color == rhs.m_color
+    && lhs.m_range == rhs.m_range
+    && lhs.m_reach == rhs.m_reach
+    && lhs.m_weight == rhs.m_weight
+    && lhs.m_x == rhs.m_x
+    && lhs.m_y == rhs.m_y
+  ;
+}
+
+bool operator!=(const influence_stamp& lhs, const influence_stamp& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
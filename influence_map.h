@@ -0,0 +1,171 @@
+#ifndef INFLUENCE_MAP_H
+#define INFLUENCE_MAP_H
+
+#include "ccfwd.h"
+#include "bitboard.h"
+#include "chess_color.h"
+#include "piece_type.h"
+#include "square.h"
+
+#include <array>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// The maximum number of squares far the influence of a piece reaches
+constexpr int get_max_influence_range() noexcept { return 4; }
+
+/// The number of values per row of an 'influence_stamp'.
+/// This is more than the squares of a row within the maximum range,
+/// so that a row is always added in full, as a multiple of the vector width,
+/// which lets the compiler use vector instructions without a remainder loop
+constexpr int get_influence_stamp_width() noexcept { return 16; }
+
+/// The influence of one piece, as added to the influence map
+struct influence_stamp
+{
+  chess_color m_color;
+
+  /// How many squares far the influence reaches
+  int m_range;
+
+  /// The squares within the range that the piece can see,
+  /// as given by 'get_reach', which are the squares it influences
+  bitboard m_reach;
+
+  /// The influence on the square of the piece itself,
+  /// which halves with each square further away
+  int m_weight;
+
+  /// The square of the piece
+  int m_x;
+  int m_y;
+
+  /// The influence per square around the piece, which is zero
+  /// on the squares out of reach, in rows of 'get_influence_stamp_width' values.
+  /// The first value is 'get_max_influence_range' squares
+  /// to the left of and below the piece
+  std::array<
+    int,
+    ((2 * get_max_influence_range()) + 1) * get_influence_stamp_width()
+  > m_values;
+};
+
+/// Per player, how much each square of the board is under
+/// the influence of its pieces.
+///
+/// Each piece adds its weight to the squares it can move to or attack,
+/// as given by 'get_reach', up to its range,
+/// halved for each square further away. The weight is the fighting
+/// value of the piece, scaled by its health, as given by 'get_f_health'.
+/// The influence of all pieces adds up.
+///
+/// The influence is kept up to date incrementally:
+/// an update only removes and adds the influence
+/// of the pieces that moved to another square, changed in health,
+/// appeared or are gone, and of the pieces that can see a square
+/// that was entered or left, as their reach may have changed,
+/// which takes time in the order of the pieces changed, instead of all pieces.
+/// The influence is in integers, so that adding and removing the influence
+/// of a piece again gives exactly the same map.
+///
+/// The influence of a piece is added row by row,
+/// each row being a sum of two arrays of a fixed length,
+/// which the compiler turns into vector instructions.
+/// To allow for this, the rows of the map have no gaps in between,
+/// and there is room before the first and after the last row
+class influence_map
+{
+public:
+  /// @param board_size the number of squares along one side of the board
+  explicit influence_map(const int board_size = get_default_board_size());
+
+  auto get_board_size() const noexcept { return m_board_size; }
+
+  /// Get the influence of a player on all squares,
+  /// where the influence on square (x, y) is at index
+  /// x * board_size + y
+  std::vector<int> get_field(const chess_color c) const;
+
+  /// Get the influence of a player on a square
+  int get_influence(const chess_color c, const square& s) const noexcept;
+
+  /// Get the number of pieces whose influence was
+  /// added or removed by the last update
+  auto get_n_changed() const noexcept { return m_n_changed; }
+
+  /// Make the map match the pieces in the game,
+  /// changing only the influence of the pieces that changed
+  void update(const game& g);
+
+  /// Make the map match the pieces,
+  /// changing only the influence of the pieces that changed
+  void update(const std::vector<piece>& pieces);
+
+private:
+
+  int m_board_size;
+
+  /// The influence per color, indexed by the color,
+  /// where the influence on square (x, y) is at index
+  /// get_influence_stamp_width() + (x * board_size) + y
+  std::array<std::vector<int>, 2> m_fields;
+
+  /// The number of updates done
+  int m_n_updates;
+
+  /// The number of pieces whose influence was changed by the last update
+  int m_n_changed;
+
+  /// Per piece ID value, the influence added to the map,
+  /// and the last update the piece was seen at
+  std::unordered_map<int, std::pair<influence_stamp, int>> m_stamps;
+
+  /// Add or remove the influence of a piece
+  /// @param sign 1 to add, -1 to remove the influence
+  void apply(const influence_stamp& s, const int sign) noexcept;
+};
+
+/// Get the influence of a piece, as added to the influence map
+/// @param occupied the squares with a piece on it, which block the reach
+influence_stamp create_influence_stamp(
+  const piece& p,
+  const bitboard& occupied,
+  const int board_size = get_default_board_size()
+);
+
+/// Get the influence of all pieces of a player on a square,
+/// minus the influence of all enemy pieces on that square
+int get_influence_balance(
+  const influence_map& m,
+  const chess_color c,
+  const square& s
+) noexcept;
+
+/// Get the number of squares far the influence of a type of piece reaches
+int get_influence_range(const piece_type type) noexcept;
+
+/// Get the influence of a type of piece at full health
+/// on its own square, which is its fighting value
+int get_influence_weight(const piece_type type) noexcept;
+
+/// Get the influence of a piece on its own square,
+/// which is the fighting value of its type, scaled by its health
+int get_influence_weight(const piece& p) noexcept;
+
+/// Get how threatened a square is for a player:
+/// the amount the enemy influence exceeds the influence of the player,
+/// which is zero if the player has at least as much influence
+int get_threat(
+  const influence_map& m,
+  const chess_color c,
+  const square& s
+) noexcept;
+
+/// Test this class and its free functions
+void test_influence_map();
+
+bool operator==(const influence_stamp& lhs, const influence_stamp& rhs) noexcept;
+bool operator!=(const influence_stamp& lhs, const influence_stamp& rhs) noexcept;
+
+#endif // INFLUENCE_MAP_H
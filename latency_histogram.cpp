@@ -0,0 +1,120 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+latency_histogram::latency_histogram()
+  : m_counts{},
+    m_max{0},
+    m_n{0}
+{
+
+}
+
+void latency_histogram::add(const std::chrono::microseconds& latency) noexcept
+{
+  ++m_counts[get_latency_bucket(latency.count())];
+  m_max = std::max(m_max, latency);
+  ++m_n;
+}
+
+int get_latency_bucket(const std::int64_t microseconds) noexcept
+{
+  // Clock adjustments could give a negative latency
+  if (microseconds < 16) return static_cast<int>(std::max(std::int64_t{0}, microseconds));
+  // The highest bit set, at least 4
+  int octave{4};
+  while ((microseconds >> (octave + 1)) != 0) ++octave;
+  // The two bits after the highest bit
+  const int sub{static_cast<int>((microseconds >> (octave - 2)) & 3)};
+  return std::min(
+    16 + ((octave - 4) * 4) + sub,
+    get_latency_histogram_n_buckets() - 1
+  );
+}
+
+std::int64_t get_latency_bucket_upper_bound(const int bucket) noexcept
+{
+  assert(bucket >= 0);
+  assert(bucket < get_latency_histogram_n_buckets());
+  if (bucket < 16) return bucket;
+  const int octave{4 + ((bucket - 16) / 4)};
+  const int sub{(bucket - 16) % 4};
+  return ((std::int64_t{5 + sub}) << (octave - 2)) - 1;
+}
+
+std::chrono::microseconds latency_histogram::get_percentile(const double fraction) const noexcept
+{
+  assert(fraction >= 0.0);
+  assert(fraction <= 1.0);
+  if (m_n == 0) return std::chrono::microseconds(0);
+  // The number of latencies at or below the percentile
+  const std::int64_t n{
+    std::max(std::int64_t{1}, static_cast<std::int64_t>(std::ceil(fraction * m_n)))
+  };
+  std::int64_t sum{0};
+  for (int i{0}; i != get_latency_histogram_n_buckets(); ++i)
+  {
+    sum += m_counts[i];
+    if (sum >= n)
+    {
+      // The bucket cannot go beyond the longest latency
+      return std::min(
+        m_max,
+        std::chrono::microseconds(get_latency_bucket_upper_bound(i))
+      );
+    }
+  }
+  assert(!"Should not get here");
+  return m_max;
+}
+
+void test_latency_histogram()
+{
+#ifndef NDEBUG
+  // An empty histogram
+  {
+    const latency_histogram h;
+    assert(h.get_n() == 0);
+    assert(h.get_percentile(0.5).count() == 0);
+  }
+  // Short latencies are exact
+  {
+    assert(get_latency_bucket(0) == 0);
+    assert(get_latency_bucket(15) == 15);
+    assert(get_latency_bucket_upper_bound(15) == 15);
+    assert(get_latency_bucket(-3) == 0);
+  }
+  // Each latency is at or below the upper bound of its bucket,
+  // and above the upper bound of the bucket before
+  {
+    for (std::int64_t us{1}; us < 100000000; us = (us * 5 / 4) + 1)
+    {
+      const int bucket{get_latency_bucket(us)};
+      assert(us <= get_latency_bucket_upper_bound(bucket));
+      assert(us > get_latency_bucket_upper_bound(bucket - 1));
+      // At most 25% off
+      assert(get_latency_bucket_upper_bound(bucket) <= us + (us / 4) + 1);
+    }
+  }
+  // Very long latencies end up in the last bucket
+  {
+    assert(get_latency_bucket(std::int64_t{1} << 60) == get_latency_histogram_n_buckets() - 1);
+  }
+  // Percentiles
+  {
+    latency_histogram h;
+    for (int i{1}; i <= 100; ++i) h.add(std::chrono::microseconds(i * 1000));
+    assert(h.get_n() == 100);
+    assert(h.get_max().count() == 100000);
+    const auto p50{h.get_percentile(0.5).count()};
+    assert(p50 >= 50000);
+    assert(p50 <= 50000 * 5 / 4);
+    const auto p99{h.get_percentile(0.99).count()};
+    assert(p99 >= 99000);
+    assert(p99 <= 100000);
+    assert(h.get_percentile(1.0).count() == 100000);
+  }
+#endif // NDEBUG
+}
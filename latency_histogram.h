@@ -0,0 +1,56 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+/// The number of buckets of a latency histogram
+constexpr int get_latency_histogram_n_buckets() { return 144; }
+
+/// Counts how often latencies occur,
+/// to know the percentiles without keeping all latencies.
+///
+/// Latencies are counted per microsecond up to 16 microseconds.
+/// Above that, each doubling of the latency is split in four buckets,
+/// so that a percentile is off by at most 25%,
+/// however long the latency
+class latency_histogram
+{
+public:
+  latency_histogram();
+
+  /// Count a latency
+  void add(const std::chrono::microseconds& latency) noexcept;
+
+  /// Get the longest latency counted
+  const auto& get_max() const noexcept { return m_max; }
+
+  /// Get the number of latencies counted
+  auto get_n() const noexcept { return m_n; }
+
+  /// Get the latency that a fraction of the latencies is at or below,
+  /// e.g. 0.99 for the 99th percentile.
+  /// This is the upper bound of the bucket the percentile is in.
+  /// Zero if no latencies have been counted
+  std::chrono::microseconds get_percentile(const double fraction) const noexcept;
+
+private:
+
+  std::array<std::int64_t, get_latency_histogram_n_buckets()> m_counts;
+
+  std::chrono::microseconds m_max;
+
+  std::int64_t m_n;
+};
+
+/// Get the index of the bucket of a latency in microseconds
+int get_latency_bucket(const std::int64_t microseconds) noexcept;
+
+/// Get the highest latency in microseconds that is in a bucket
+std::int64_t get_latency_bucket_upper_bound(const int bucket) noexcept;
+
+/// Test this class and its free functions
+void test_latency_histogram();
+
+#endif // LATENCY_HISTOGRAM_H
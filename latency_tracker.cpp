@@ -0,0 +1,183 @@
+#include "latency_tracker.h"
+
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+latency_tracker::latency_tracker(const bool is_enabled)
+  : m_current{},
+    m_histograms(is_enabled ? get_n_control_action_types() : 0),
+    m_is_enabled{is_enabled},
+    m_not_displayed{}
+{
+
+}
+
+void latency_tracker::add(
+  const tracked_action& action,
+  const latency_stage stage,
+  const std::chrono::steady_clock::time_point& now
+)
+{
+  m_histograms[static_cast<int>(action.m_type)][static_cast<int>(stage)].add(
+    std::chrono::duration_cast<std::chrono::microseconds>(now - action.m_timestamp)
+  );
+}
+
+void latency_tracker::end_processing()
+{
+  if (!m_is_enabled) return;
+  assert(m_current);
+  add(*m_current, latency_stage::processed, std::chrono::steady_clock::now());
+  m_not_displayed.push_back(*m_current);
+  m_current.reset();
+}
+
+const latency_histogram& latency_tracker::get_histogram(
+  const control_action_type type,
+  const latency_stage stage
+) const noexcept
+{
+  if (!m_is_enabled)
+  {
+    static const latency_histogram empty;
+    return empty;
+  }
+  return m_histograms[static_cast<int>(type)][static_cast<int>(stage)];
+}
+
+void latency_tracker::on_display()
+{
+  if (!m_is_enabled) return;
+  const auto now{std::chrono::steady_clock::now()};
+  for (const auto& action: m_not_displayed)
+  {
+    add(action, latency_stage::displayed, now);
+  }
+  m_not_displayed.clear();
+}
+
+void latency_tracker::on_piece_action()
+{
+  if (!m_is_enabled) return;
+  // Orders given by the game itself are not measured
+  if (!m_current) return;
+  // Only the first piece counts, when an order is given to many pieces
+  if (m_current->m_has_piece_action) return;
+  m_current->m_has_piece_action = true;
+  add(*m_current, latency_stage::piece_action, std::chrono::steady_clock::now());
+}
+
+void latency_tracker::start_processing(const control_action& action)
+{
+  if (!m_is_enabled) return;
+  assert(!m_current);
+  m_current = tracked_action{action.get_type(), action.get_timestamp(), false};
+}
+
+void test_latency_tracker()
+{
+#ifndef NDEBUG
+  // to_str
+  {
+    assert(to_str(latency_stage::processed) == "processed");
+    assert(to_str(latency_stage::piece_action) == "piece_action");
+    assert(to_str(latency_stage::displayed) == "displayed");
+  }
+  // A disabled tracker measures nothing
+  {
+    latency_tracker t;
+    assert(!t.is_enabled());
+    t.start_processing(create_press_move_action());
+    t.on_piece_action();
+    t.end_processing();
+    t.on_display();
+    assert(t.get_histogram(control_action_type::press_move, latency_stage::processed).get_n() == 0);
+  }
+  // An enabled tracker follows a control action through all stages
+  {
+    latency_tracker t(true);
+    t.start_processing(create_press_move_action());
+    t.on_piece_action();
+    t.on_piece_action();
+    t.end_processing();
+    const auto type{control_action_type::press_move};
+    assert(t.get_histogram(type, latency_stage::processed).get_n() == 1);
+    assert(t.get_histogram(type, latency_stage::piece_action).get_n() == 1);
+    assert(t.get_histogram(type, latency_stage::displayed).get_n() == 0);
+    t.on_display();
+    assert(t.get_histogram(type, latency_stage::displayed).get_n() == 1);
+    // Only the first frame after processing counts
+    t.on_display();
+    assert(t.get_histogram(type, latency_stage::displayed).get_n() == 1);
+  }
+  // A piece action outside of processing a control action is not measured
+  {
+    latency_tracker t(true);
+    t.on_piece_action();
+    assert(t.get_histogram(control_action_type::press_move, latency_stage::piece_action).get_n() == 0);
+  }
+  // operator<< only shows the control actions that happened
+  {
+    latency_tracker t(true);
+    t.start_processing(create_press_select_action());
+    t.end_processing();
+    std::stringstream s;
+    s << t;
+    assert(s.str().find("press_select") != std::string::npos);
+    assert(s.str().find("press_move") == std::string::npos);
+  }
+#endif // NDEBUG
+}
+
+std::string to_str(const latency_stage s) noexcept
+{
+  switch (s)
+  {
+    case latency_stage::processed: return "processed";
+    case latency_stage::piece_action: return "piece_action";
+    case latency_stage::displayed:
+    default:
+      assert(s == latency_stage::displayed);
+      return "displayed";
+  }
+}
+
+std::ostream& operator<<(std::ostream& os, const latency_tracker& t) noexcept
+{
+  const auto to_ms = [](const std::chrono::microseconds& us)
+  {
+    return static_cast<double>(us.count()) / 1000.0;
+  };
+  os << std::left << std::setw(20) << "input"
+    << std::setw(14) << "stage"
+    << std::right << std::setw(8) << "n"
+    << std::setw(10) << "p50 (ms)"
+    << std::setw(10) << "p90 (ms)"
+    << std::setw(10) << "p99 (ms)"
+    << std::setw(10) << "max (ms)"
+    << '\n'
+  ;
+  os << std::fixed << std::setprecision(2);
+  for (int i{0}; i != get_n_control_action_types(); ++i)
+  {
+    const auto type{static_cast<control_action_type>(i)};
+    for (int j{0}; j != get_n_latency_stages(); ++j)
+    {
+      const auto stage{static_cast<latency_stage>(j)};
+      const auto& h{t.get_histogram(type, stage)};
+      if (h.get_n() == 0) continue;
+      os << std::left << std::setw(20) << to_str(type)
+        << std::setw(14) << to_str(stage)
+        << std::right << std::setw(8) << h.get_n()
+        << std::setw(10) << to_ms(h.get_percentile(0.5))
+        << std::setw(10) << to_ms(h.get_percentile(0.9))
+        << std::setw(10) << to_ms(h.get_percentile(0.99))
+        << std::setw(10) << to_ms(h.get_max())
+        << '\n'
+      ;
+    }
+  }
+  return os;
+}
@@ -0,0 +1,114 @@
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#include "ccfwd.h"
+#include "control_action.h"
+#include "control_action_type.h"
+#include "latency_histogram.h"
+
+#include <array>
+#include <chrono>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// How far a control action has come, since the user did it
+enum class latency_stage
+{
+  /// The control action is processed by the game
+  processed,
+
+  /// The control action has resulted in a piece action
+  piece_action,
+
+  /// The first frame with the effect of the control action is displayed
+  displayed
+};
+
+/// The number of latency stages
+constexpr int get_n_latency_stages()
+{
+  return static_cast<int>(latency_stage::displayed) + 1;
+}
+
+std::string to_str(const latency_stage s) noexcept;
+
+/// Measures how long it takes from when the user does something,
+/// until its effect is seen, per type of control action.
+///
+/// A control action is followed through these stages:
+///  * processed: the game processes it, at the next tick
+///  * piece_action: a piece gets a piece action because of it
+///  * displayed: the next frame is displayed
+///
+/// When not enabled, nothing is measured,
+/// the clock is never read and there are no histograms,
+/// so that copying the tracker of a game is cheap
+class latency_tracker
+{
+public:
+  explicit latency_tracker(const bool is_enabled = false);
+
+  /// The game is done processing the control action
+  /// from the last call to 'start_processing'
+  void end_processing();
+
+  /// Get the latencies of a type of control action up to a stage
+  const latency_histogram& get_histogram(
+    const control_action_type type,
+    const latency_stage stage
+  ) const noexcept;
+
+  /// Is the latency measured?
+  bool is_enabled() const noexcept { return m_is_enabled; }
+
+  /// A frame is displayed,
+  /// showing the effect of the control actions processed before
+  void on_display();
+
+  /// A piece got a piece action
+  /// because of the control action being processed, if any
+  void on_piece_action();
+
+  /// The game starts processing a control action
+  void start_processing(const control_action& action);
+
+private:
+
+  /// A control action, and when the user did it
+  struct tracked_action
+  {
+    control_action_type m_type;
+    std::chrono::steady_clock::time_point m_timestamp;
+    bool m_has_piece_action;
+  };
+
+  /// The control action being processed, if any
+  std::optional<tracked_action> m_current;
+
+  /// The latencies per control action type, per stage,
+  /// which is empty when not enabled
+  std::vector<std::array<latency_histogram, get_n_latency_stages()>> m_histograms;
+
+  bool m_is_enabled;
+
+  /// The control actions processed, which are not displayed yet
+  std::vector<tracked_action> m_not_displayed;
+
+  /// Count the time from when the user did the control action until now
+  void add(
+    const tracked_action& action,
+    const latency_stage stage,
+    const std::chrono::steady_clock::time_point& now
+  );
+};
+
+/// Test this class and its free functions
+void test_latency_tracker();
+
+/// Show the percentiles of the latencies in milliseconds,
+/// per type of control action that happened, per stage
+std::ostream& operator<<(std::ostream& os, const latency_tracker& t) noexcept;
+
+#endif // LATENCY_TRACKER_H
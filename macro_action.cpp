@@ -0,0 +1,149 @@
+#include "macro_action.h"
+
+#include "game.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+void do_macro_action(game& g, const macro_action& a)
+{
+  if (is_pass(a)) return;
+  assert(a.m_piece_index >= 0);
+  assert(a.m_piece_index < static_cast<int>(g.get_pieces().size()));
+  give_order(g, a.m_piece_index, a.m_action_type, a.m_to);
+}
+
+macro_action get_pass_macro_action() noexcept
+{
+  return macro_action{-1, piece_action_type::move, square(0, 0)};
+}
+
+std::vector<macro_action> get_macro_actions(
+  const game& g,
+  const chess_color color
+)
+{
+  std::vector<macro_action> actions;
+  const int n_pieces{static_cast<int>(g.get_pieces().size())};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    const auto& p{g.get_pieces()[i]};
+    if (p.get_color() != color) continue;
+    if (has_actions(p)) continue;
+    for (const auto& s: get_possible_moves(g.get_pieces(), g.get_occupancy(), p))
+    {
+      const bool is_occupied{g.get_occupancy().get_index(s) != -1};
+      actions.push_back(
+        macro_action{
+          i,
+          is_occupied ? piece_action_type::attack : piece_action_type::move,
+          s
+        }
+      );
+    }
+  }
+  return actions;
+}
+
+bool is_pass(const macro_action& a) noexcept
+{
+  return a.m_piece_index == -1;
+}
+
+void test_macro_action()
+{
+#ifndef NDEBUG
+  // get_pass_macro_action
+  {
+    assert(is_pass(get_pass_macro_action()));
+    assert(!is_pass(macro_action{0, piece_action_type::move, square("e4")}));
+  }
+  // get_macro_actions, of the standard starting position
+  {
+    const game g;
+    // Only the pawns and knights can go somewhere
+    const auto white_actions{get_macro_actions(g, chess_color::white)};
+    assert(!white_actions.empty());
+    for (const auto& a: white_actions)
+    {
+      assert(g.get_pieces()[a.m_piece_index].get_color() == chess_color::white);
+      const auto type{g.get_pieces()[a.m_piece_index].get_type()};
+      assert(type == piece_type::pawn || type == piece_type::knight);
+    }
+    assert(get_macro_actions(g, chess_color::black).size() == white_actions.size());
+  }
+  // get_macro_actions, a piece that is busy has none
+  {
+    game g;
+    const auto actions{get_macro_actions(g, chess_color::white)};
+    do_macro_action(g, actions[0]);
+    const auto fewer_actions{get_macro_actions(g, chess_color::white)};
+    assert(fewer_actions.size() < actions.size());
+    for (const auto& a: fewer_actions) assert(a.m_piece_index != actions[0].m_piece_index);
+  }
+  // get_macro_actions, an enemy in reach is attacked
+  {
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    auto& black_king{g.get_pieces()[3]};
+    assert(black_king.get_type() == piece_type::king);
+    black_king.set_current_square(square("a4"));
+    g.tick(delta_t(0.01));
+    const macro_action attack{0, piece_action_type::attack, square("a4")};
+    const auto actions{get_macro_actions(g, chess_color::white)};
+    assert(std::find(std::begin(actions), std::end(actions), attack) != std::end(actions));
+  }
+  // do_macro_action
+  {
+    game g;
+    do_macro_action(g, get_pass_macro_action());
+    assert(count_piece_actions(g) == 0);
+    do_macro_action(g, get_macro_actions(g, chess_color::white).back());
+    assert(count_piece_actions(g, chess_color::white) > 0);
+  }
+  // to_str and operator<<
+  {
+    const macro_action a{3, piece_action_type::attack, square("e5")};
+    assert(to_str(a) == "3 attack e5");
+    assert(to_str(get_pass_macro_action()) == "pass");
+    std::stringstream s;
+    s << a;
+    assert(s.str() == to_str(a));
+  }
+  // operator==
+  {
+    const macro_action a{3, piece_action_type::attack, square("e5")};
+    const macro_action b{3, piece_action_type::move, square("e5")};
+    assert(a == a);
+    assert(a != b);
+  }
+#endif // NDEBUG
+}
+
+std::string to_str(const macro_action& a)
+{
+  if (is_pass(a)) return "pass";
+  std::stringstream s;
+  s << a.m_piece_index << ' ' << to_str(a.m_action_type) << ' ' << to_str(a.m_to);
+  return s.str();
+}
+
+bool operator==(const macro_action& lhs, const macro_action& rhs) noexcept
+{
+  return lhs.m_piece_index == rhs.m_piece_index
+    && lhs.m_action_type == rhs.m_action_type
+    && lhs.m_to == rhs.m_to
+  ;
+}
+
+bool operator!=(const macro_action& lhs, const macro_action& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+std::ostream& operator<<(std::ostream& os, const macro_action& a) noexcept
+{
+  os << to_str(a);
+  return os;
+}
@@ -0,0 +1,56 @@
+#ifndef MACRO_ACTION_H
+#define MACRO_ACTION_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "piece_action_type.h"
+#include "square.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// An order for one piece, e.g. 'the piece with index 3 attacks e5',
+/// as chosen by a search.
+/// A piece index of -1 denotes to give no order at all
+struct macro_action
+{
+  /// The index of the piece in the game,
+  /// where -1 denotes to give no order
+  int m_piece_index;
+
+  piece_action_type m_action_type;
+
+  square m_to;
+};
+
+/// Give the order of the macro action, if any
+void do_macro_action(game& g, const macro_action& a);
+
+/// Get the macro action that gives no order
+macro_action get_pass_macro_action() noexcept;
+
+/// Get the macro actions of a player: a move or an attack
+/// for each square each idle piece of that color can go to.
+/// A square with an enemy piece on it is attacked.
+/// Is empty if no piece of that color can do anything
+std::vector<macro_action> get_macro_actions(
+  const game& g,
+  const chess_color color
+);
+
+/// Is this the macro action that gives no order?
+bool is_pass(const macro_action& a) noexcept;
+
+/// Test this class and its free functions
+void test_macro_action();
+
+/// Get the macro action as text, e.g. '3 attack e5'
+std::string to_str(const macro_action& a);
+
+bool operator==(const macro_action& lhs, const macro_action& rhs) noexcept;
+bool operator!=(const macro_action& lhs, const macro_action& rhs) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const macro_action& a) noexcept;
+
+#endif // MACRO_ACTION_H
@@ -1,5 +1,15 @@
 /// Use LOGIC_ONLY to be able to run on GHA
 
+#include "ai_controller.h"
+#include "alpha_beta.h"
+#include "balance_sweep.h"
+#include "batch_scheduler.h"
+#include "benchmark.h"
+#include "bot.h"
+#include "bot_type.h"
+#include "bot_version.h"
+#include "elo_rating.h"
+#include "engagement.h"
 #include "game.h"
 #include "game_rect.h"
 #include "game_resources.h"
@@ -7,21 +17,45 @@
 #include "game_view_layout.h"
 #include "helper.h"
 #include "id.h"
+#include "influence_map.h"
 #include "fps_clock.h"
 #include "game_log.h"
+#include "macro_action.h"
+#include "mapped_file.h"
+#include "mcts.h"
+#include "nnue.h"
 #include "menu_view.h"
 #include "menu_view_item.h"
 #include "menu_view_layout.h"
 #include "chess_move.h"
+#include "chess_position.h"
+#include "collision_grid.h"
+#include "opening_book.h"
 #include "options_view_layout.h"
+#include "pgn.h"
 #include "replay.h"
 #include "screen_coordinat.h"
+#include "simulation.h"
+#include "simulation_job.h"
+#include "tablebase.h"
 #include "test_game.h"
+#include "texel_tuner.h"
+#include "tournament.h"
+#include "transposition_table.h"
+#include "work_stealing_queue.h"
+#ifndef _WIN32
+#include "distributed_simulation.h"
+#include "tcp_listener.h"
+#include "tcp_socket.h"
+#endif // _WIN32
 #include <SFML/Graphics.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <iostream>
+#include <stdexcept>
+#include <thread>
 
 /// All tests are called from here, only in debug mode
 void test()
@@ -29,28 +63,53 @@ void test()
 #ifndef NDEBUG
   test_helper();
 
+  test_ai_controller();
+  test_alpha_beta();
+  test_balance_sweep();
+  test_batch_scheduler();
+  test_benchmark();
+  test_bot();
+  test_bot_type();
+  test_bot_version();
+  test_bitboard();
   test_chess_color();
   test_chess_move();
+  test_chess_position();
+  test_collision_grid();
   test_control_action();
   test_control_actions();
   test_controller_type();
   test_delta_t();
+  test_elo_rating();
+  test_engagement();
+  test_flow_field();
   test_fps_clock();
   test_game();
   test_game_coordinat();
   test_game_options();
   test_game_rect();
+  test_game_result();
   test_game_speed();
   test_game_view_layout();
   test_helper();
   test_id();
+  test_influence_map();
+  test_latency_histogram();
+  test_latency_tracker();
   test_log();
+  test_macro_action();
+  test_mapped_file();
+  test_mcts();
   test_menu_view_item();
   test_menu_view_layout();
   test_message();
   test_message_type();
+  test_nnue();
+  test_occupancy_grid();
+  test_opening_book();
   test_options_view_item();
   test_options_view_layout();
+  test_pgn();
   test_piece();
   test_piece_action();
   test_piece_action_type();
@@ -58,12 +117,30 @@ void test()
   test_pieces();
   test_replay();
   test_replayer();
+  test_route_planner();
+  test_scheduled_order();
   test_screen_coordinat();
+  test_simulation();
+  test_simulation_job();
   test_screen_rect();
+  test_selection();
   test_side();
+  test_spsc_queue();
   test_square();
   test_starting_position_type();
+  test_tablebase();
+  test_texel_tuner();
+  test_timing_wheel();
+  test_tournament();
+  test_transposition_table();
+  test_visibility();
   test_volume();
+  test_work_stealing_queue();
+#ifndef _WIN32
+  test_distributed_simulation();
+  test_tcp_listener();
+  test_tcp_socket();
+#endif // _WIN32
 #ifndef LOGIC_ONLY
   test_game_resources();
   test_game_view();
@@ -83,11 +160,140 @@ int main(int argc, char **argv) //!OCLINT tests may be long
   test();
   #endif
   const auto args = collect_args(argc, argv);
+  if (args.size() == 2 && args[1] == "--benchmark")
+  {
+    benchmark_ticks(std::cout);
+    return 0;
+  }
+  if (args.size() == 2 && args[1] == "--benchmark-search")
+  {
+    benchmark_alpha_beta(std::cout);
+    return 0;
+  }
+  if (args.size() == 2 && args[1] == "--benchmark-nnue")
+  {
+    benchmark_nnue(std::cout);
+    return 0;
+  }
+  if (args.size() == 4 && args[1] == "--opening-book")
+  {
+    try
+    {
+      generate_opening_book(args[2], args[3], get_default_opening_book_options());
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << '\n'
+        << "Usage: --opening-book [PGN filename] [filename]\n";
+      return 1;
+    }
+    return 0;
+  }
+  if (args.size() >= 2 && args[1] == "--simulate")
+  {
+    try
+    {
+      run_simulations(parse_simulation_args(args), std::cout);
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << '\n' << get_simulation_usage();
+      return 1;
+    }
+    return 0;
+  }
+  if (args.size() >= 2 && args[1] == "--sweep")
+  {
+    try
+    {
+      const auto options{parse_sweep_args(args)};
+      show_sweep_results(options, run_sweep(options), std::cout);
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << '\n' << get_sweep_usage();
+      return 1;
+    }
+    return 0;
+  }
+  if (args.size() == 4 && args[1] == "--tablebase")
+  {
+    try
+    {
+      const int n_threads{std::max(1, static_cast<int>(std::thread::hardware_concurrency()))};
+      generate_tablebase(args[2], args[3], n_threads);
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << '\n'
+        << "Usage: --tablebase [material, e.g. KBNvK] [filename]\n";
+      return 1;
+    }
+    return 0;
+  }
+  if (args.size() >= 2 && args[1] == "--tournament")
+  {
+    try
+    {
+      const auto options{parse_tournament_args(args)};
+      show_tournament_results(options, run_tournament(options), std::cout);
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << '\n' << get_tournament_usage();
+      return 1;
+    }
+    return 0;
+  }
+  if (args.size() == 4 && args[1] == "--tune")
+  {
+    try
+    {
+      tune_evaluation(args[2], args[3], get_default_tuning_options(), std::cout);
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << '\n'
+        << "Usage: --tune [PGN filename] [filename, e.g. evaluation_weights.h]\n";
+      return 1;
+    }
+    return 0;
+  }
+  if (args.size() == 4 && args[1] == "--worker")
+  {
+    #ifndef _WIN32
+    try
+    {
+      const int n_games{run_worker(args[2], std::stoi(args[3]))};
+      std::cout << "games: " << n_games << '\n';
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << e.what() << '\n' << get_simulation_usage();
+      return 1;
+    }
+    #endif // _WIN32
+    return 0;
+  }
+  if (args.size() == 2 && args[1] == "--latency")
+  {
+    #ifndef LOGIC_ONLY
+    game_options options{get_default_game_options()};
+    options.set_measure_latency(true);
+    game_view v{game(options)};
+    v.exec();
+    std::cout << v.get_game().get_latency();
+    #endif // LOGIC_ONLY
+    return 0;
+  }
   if (args.size() == 1)
   {
     #ifndef LOGIC_ONLY
     menu_view v;
     v.exec();
+    #else
+    // Without a window, only the simulations can be run
+    std::cout << get_simulation_usage();
     #endif // LOGIC_ONLY
   }
   else
@@ -0,0 +1,133 @@
+#include "mapped_file.h"
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+mapped_file::mapped_file(const std::string& filename)
+  : m_buffer{},
+    m_data{nullptr},
+    m_is_mapped{false},
+    m_size{0}
+{
+#ifndef _WIN32
+  const int fd{::open(filename.c_str(), O_RDONLY)};
+  if (fd == -1)
+  {
+    throw std::runtime_error("Cannot open '" + filename + "'");
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0)
+  {
+    ::close(fd);
+    throw std::runtime_error("Cannot get the size of '" + filename + "'");
+  }
+  m_size = static_cast<std::size_t>(info.st_size);
+  // An empty file cannot be mapped
+  if (m_size == 0)
+  {
+    ::close(fd);
+    m_data = m_buffer.data();
+    return;
+  }
+  void * const data{::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0)};
+  // The mapping stays after closing the file
+  ::close(fd);
+  if (data == MAP_FAILED)
+  {
+    throw std::runtime_error("Cannot map '" + filename + "' into memory");
+  }
+  m_data = static_cast<const std::uint8_t*>(data);
+  m_is_mapped = true;
+#else
+  std::ifstream f(filename, std::ios::binary);
+  if (!f)
+  {
+    throw std::runtime_error("Cannot open '" + filename + "'");
+  }
+  m_buffer.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+#endif // _WIN32
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+  : m_buffer{std::move(other.m_buffer)},
+    m_data{other.m_data},
+    m_is_mapped{other.m_is_mapped},
+    m_size{other.m_size}
+{
+  other.m_data = nullptr;
+  other.m_is_mapped = false;
+  other.m_size = 0;
+}
+
+mapped_file::~mapped_file()
+{
+#ifndef _WIN32
+  if (m_is_mapped)
+  {
+    ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+  }
+#endif // _WIN32
+}
+
+void test_mapped_file()
+{
+#ifndef NDEBUG
+  // A file is read as written
+  {
+    const std::string filename{"test_mapped_file.bin"};
+    {
+      std::ofstream f(filename, std::ios::binary);
+      f << "Hello";
+    }
+    const mapped_file m(filename);
+    assert(m.get_size() == 5);
+    assert(m.get_data()[0] == 'H');
+    assert(m.get_data()[4] == 'o');
+    std::remove(filename.c_str());
+    // The mapping stays after removing the file
+    assert(m.get_data()[1] == 'e');
+  }
+  // A moved file is mapped once
+  {
+    const std::string filename{"test_mapped_file_moved.bin"};
+    {
+      std::ofstream f(filename, std::ios::binary);
+      f << "abc";
+    }
+    mapped_file a(filename);
+    const mapped_file b(std::move(a));
+    assert(b.get_size() == 3);
+    assert(b.get_data()[2] == 'c');
+    std::remove(filename.c_str());
+  }
+  // An empty file
+  {
+    const std::string filename{"test_mapped_file_empty.bin"};
+    {
+      std::ofstream f(filename, std::ios::binary);
+    }
+    const mapped_file m(filename);
+    assert(m.get_size() == 0);
+    std::remove(filename.c_str());
+  }
+  // A file that does not exist
+  {
+    bool has_thrown{false};
+    try { const mapped_file m("test_mapped_file_absent.bin"); }
+    catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,46 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// A file that is read-only and mapped into memory,
+/// so that only the parts that are read are loaded from disk.
+/// Where memory-mapping is not available, the file is read as a whole
+class mapped_file
+{
+public:
+  /// Map a file into memory. Throws if the file cannot be read
+  explicit mapped_file(const std::string& filename);
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+  mapped_file(mapped_file&& other) noexcept;
+  mapped_file& operator=(mapped_file&&) = delete;
+  ~mapped_file();
+
+  /// Get the bytes of the file
+  auto get_data() const noexcept { return m_data; }
+
+  /// Get the number of bytes of the file
+  auto get_size() const noexcept { return m_size; }
+
+private:
+
+  /// The contents of the file, if it is not memory-mapped
+  std::vector<std::uint8_t> m_buffer;
+
+  /// The file, as mapped into memory or read into the buffer
+  const std::uint8_t* m_data;
+
+  /// Is the file memory-mapped, so that it must be unmapped?
+  bool m_is_mapped;
+
+  std::size_t m_size;
+};
+
+/// Test this class and its free functions
+void test_mapped_file();
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,607 @@
+#include "mcts.h"
+
+#include "bot.h"
+#include "nnue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <thread>
+
+mcts_searcher::mcts_searcher(
+  const game& g,
+  const chess_color color,
+  const mcts_options& options,
+  const unsigned int seed,
+  const std::atomic<bool>* stop
+) : m_color{color},
+    m_elapsed{0},
+    m_nodes{},
+    m_n_iterations{0},
+    m_n_iterations_started{0},
+    m_mutex{},
+    m_options{options},
+    m_root_game{g},
+    m_seed{seed},
+    m_stop{stop}
+{
+  assert(m_options.m_n_threads > 0);
+  assert(m_options.m_max_n_iterations >= 0);
+  assert(m_options.m_max_n_iterations > 0 || m_options.m_time_budget.count() > 0);
+  assert(m_options.m_slice_n_iterations >= 0);
+  assert(m_options.m_slice_time.count() >= 0);
+  assert(m_options.m_tick_time.get() > 0.0);
+  assert(m_options.m_virtual_loss >= 0);
+  m_nodes.push_back(mcts_node{get_pass_macro_action(), -1, 0, 0, 0, 0.0});
+}
+
+void mcts_searcher::do_iteration(
+  const int iteration,
+  game& g,
+  nnue_accumulator* accumulator,
+  const std::optional<std::chrono::steady_clock::time_point>& deadline
+)
+{
+  std::mt19937 rng_engine(m_seed + iteration);
+
+  // Select a path down the tree.
+  // The macro actions are copied, as other threads may add nodes meanwhile
+  std::vector<int> path{0};
+  std::vector<macro_action> actions_done;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_nodes[0].m_n_threads_here;
+    while (m_nodes[path.back()].m_first_child != -1)
+    {
+      const int child{select_child(path.back())};
+      ++m_nodes[child].m_n_threads_here;
+      path.push_back(child);
+      actions_done.push_back(m_nodes[child].m_action);
+    }
+  }
+
+  // Replay the path, which needs no lock.
+  // Assigning reuses the memory of the game of the previous iteration
+  g = m_root_game;
+  for (std::size_t i{0}; i != actions_done.size() && !is_over(g); ++i)
+  {
+    do_macro_action(g, actions_done[i]);
+    do_ply(g);
+  }
+
+  // Expand the last node and pick one of its children
+  if (!is_over(g))
+  {
+    const int depth{static_cast<int>(path.size()) - 1};
+    auto actions{get_macro_actions(g, get_mcts_player(m_color, depth))};
+    std::shuffle(std::begin(actions), std::end(actions), rng_engine);
+    macro_action action{get_pass_macro_action()};
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      expand(path.back(), std::move(actions));
+      const int child{select_child(path.back())};
+      ++m_nodes[child].m_n_threads_here;
+      path.push_back(child);
+      action = m_nodes[child].m_action;
+    }
+    do_macro_action(g, action);
+    do_ply(g);
+  }
+
+  play_rollout(g, m_options, rng_engine(), deadline);
+  const double score{
+    accumulator ? evaluate_position(g, m_color, *accumulator) : evaluate_position(g, m_color)
+  };
+
+  // Update the nodes on the path, removing their virtual loss
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::size_t i{0}; i != path.size(); ++i)
+    {
+      auto& node{m_nodes[path[i]]};
+      --node.m_n_threads_here;
+      ++node.m_n_visits;
+      // The macro action of a node at depth i is done by the player at depth i - 1
+      const bool is_own_action{i == 0 || get_mcts_player(m_color, i - 1) == m_color};
+      node.m_score += is_own_action ? score : 1.0 - score;
+    }
+  }
+  ++m_n_iterations;
+}
+
+void mcts_searcher::do_ply(game& g) const
+{
+  const int n_ticks{
+    std::max(1, static_cast<int>(std::round(m_options.m_ply_time.get() / m_options.m_tick_time.get())))
+  };
+  for (int i{0}; i != n_ticks && !is_over(g); ++i)
+  {
+    g.tick(m_options.m_tick_time);
+  }
+}
+
+void mcts_searcher::expand(const int node_index, std::vector<macro_action> actions)
+{
+  if (m_nodes[node_index].m_first_child != -1) return;
+  if (actions.empty()) actions.push_back(get_pass_macro_action());
+  const int first_child{static_cast<int>(m_nodes.size())};
+  for (const auto& a: actions)
+  {
+    m_nodes.push_back(mcts_node{a, -1, 0, 0, 0, 0.0});
+  }
+  m_nodes[node_index].m_first_child = first_child;
+  m_nodes[node_index].m_n_children = static_cast<int>(actions.size());
+}
+
+int mcts_searcher::get_n_nodes() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return static_cast<int>(m_nodes.size());
+}
+
+mcts_result mcts_searcher::get_result() const
+{
+  const auto children{get_root_children()};
+  if (children.empty())
+  {
+    return mcts_result{get_pass_macro_action(), m_elapsed, m_n_iterations, 0, 0.5};
+  }
+  const auto best{
+    std::max_element(
+      std::begin(children),
+      std::end(children),
+      [](const auto& lhs, const auto& rhs) { return lhs.m_n_visits < rhs.m_n_visits; }
+    )
+  };
+  return mcts_result{
+    best->m_action,
+    m_elapsed,
+    m_n_iterations,
+    best->m_n_visits,
+    best->m_n_visits == 0 ? 0.5 : best->m_score / best->m_n_visits
+  };
+}
+
+std::vector<mcts_node> mcts_searcher::get_root_children() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto& root{m_nodes[0]};
+  if (root.m_first_child == -1) return {};
+  return std::vector<mcts_node>(
+    std::begin(m_nodes) + root.m_first_child,
+    std::begin(m_nodes) + root.m_first_child + root.m_n_children
+  );
+}
+
+bool mcts_searcher::is_done() const noexcept
+{
+  if (m_stop && *m_stop) return true;
+  if (m_options.m_max_n_iterations > 0
+    && m_n_iterations_started >= m_options.m_max_n_iterations)
+  {
+    return true;
+  }
+  return m_options.m_time_budget.count() > 0 && m_elapsed >= m_options.m_time_budget;
+}
+
+mcts_result mcts_searcher::search()
+{
+  const auto start{std::chrono::steady_clock::now()};
+  const auto deadline{start + m_options.m_time_budget - m_elapsed};
+  {
+    // The calling thread is searcher zero
+    std::vector<std::thread> threads;
+    threads.reserve(m_options.m_n_threads - 1);
+    for (int i{1}; i < m_options.m_n_threads; ++i)
+    {
+      threads.emplace_back(&mcts_searcher::search_worker, this, std::cref(deadline));
+    }
+    search_worker(deadline);
+    for (auto& t: threads) t.join();
+  }
+  m_elapsed += std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start
+  );
+  return get_result();
+}
+
+bool mcts_searcher::search_slice()
+{
+  const auto start{std::chrono::steady_clock::now()};
+  auto last{start};
+  const bool has_slice_time{m_options.m_slice_time.count() > 0};
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  if (m_options.m_time_budget.count() > 0)
+  {
+    deadline = start + m_options.m_time_budget - m_elapsed;
+  }
+  std::optional<nnue_accumulator> accumulator;
+  if (m_options.m_network) accumulator.emplace(*m_options.m_network);
+  game g{m_root_game};
+  for (int i{1}; !is_done(); ++i)
+  {
+    do_iteration(
+      m_n_iterations_started++,
+      g,
+      accumulator ? &*accumulator : nullptr,
+      deadline
+    );
+    const auto now{std::chrono::steady_clock::now()};
+    m_elapsed += std::chrono::duration_cast<std::chrono::microseconds>(now - last);
+    last = now;
+    if (i == m_options.m_slice_n_iterations) break;
+    if (has_slice_time && now - start >= m_options.m_slice_time) break;
+  }
+  return is_done();
+}
+
+void mcts_searcher::search_worker(const std::chrono::steady_clock::time_point& deadline)
+{
+  const bool has_time_budget{m_options.m_time_budget.count() > 0};
+  const int max_n_iterations{m_options.m_max_n_iterations};
+  // The leaves of successive iterations share most pieces,
+  // so the accumulator mostly needs a few pieces changed
+  std::optional<nnue_accumulator> accumulator;
+  if (m_options.m_network) accumulator.emplace(*m_options.m_network);
+  std::optional<std::chrono::steady_clock::time_point> rollout_deadline;
+  if (has_time_budget) rollout_deadline = deadline;
+  game g{m_root_game};
+  while (!has_time_budget || std::chrono::steady_clock::now() < deadline)
+  {
+    if (m_stop && *m_stop) return;
+    const int iteration{m_n_iterations_started++};
+    if (max_n_iterations > 0 && iteration >= max_n_iterations) return;
+    do_iteration(iteration, g, accumulator ? &*accumulator : nullptr, rollout_deadline);
+  }
+}
+
+int mcts_searcher::select_child(const int node_index) const
+{
+  const auto& parent{m_nodes[node_index]};
+  assert(parent.m_first_child != -1);
+  assert(parent.m_n_children > 0);
+  const int parent_n{
+    std::max(1, parent.m_n_visits + (parent.m_n_threads_here * m_options.m_virtual_loss))
+  };
+  const double log_parent_n{std::log(static_cast<double>(parent_n))};
+  int best_child{parent.m_first_child};
+  double best_value{-1.0};
+  for (int i{0}; i != parent.m_n_children; ++i)
+  {
+    const int child_index{parent.m_first_child + i};
+    const auto& child{m_nodes[child_index]};
+    // A virtual loss counts as a visit with a score of zero
+    const int n{child.m_n_visits + (child.m_n_threads_here * m_options.m_virtual_loss)};
+    if (n == 0) return child_index;
+    const double value{
+      (child.m_score / n) + (m_options.m_exploration * std::sqrt(log_parent_n / n))
+    };
+    if (value > best_value)
+    {
+      best_value = value;
+      best_child = child_index;
+    }
+  }
+  return best_child;
+}
+
+double evaluate_position(const game& g, const chess_color color)
+{
+  if (is_over(g))
+  {
+    if (g.get_result() == get_winning_result(color)) return 1.0;
+    if (g.get_result() == get_winning_result(get_other_color(color))) return 0.0;
+    return 0.5;
+  }
+  double balance{0.0};
+  for (const auto& p: g.get_pieces())
+  {
+    if (p.get_type() == piece_type::king) continue;
+    const double value{get_material_value(p.get_type()) * get_f_health(p)};
+    balance += p.get_color() == color ? value : -value;
+  }
+  // A difference of a minor piece is about a 68% chance to win
+  return 1.0 / (1.0 + std::exp(-balance / 4.0));
+}
+
+double evaluate_position(
+  const game& g,
+  const chess_color color,
+  nnue_accumulator& accumulator
+)
+{
+  if (is_over(g)) return evaluate_position(g, color);
+  accumulator.update(g);
+  const int score{accumulator.get_network().evaluate(accumulator)};
+  const int own_score{color == chess_color::white ? score : -score};
+  // As for the material, a minor piece ahead is about a 68% chance to win
+  return 1.0 / (1.0 + std::exp(-own_score / 400.0));
+}
+
+mcts_options get_default_mcts_options() noexcept
+{
+  return mcts_options{
+    1.0,
+    100,
+    1,
+    nullptr,
+    delta_t(0.5),
+    delta_t(2.0),
+    10,
+    std::chrono::microseconds(0),
+    delta_t(0.1),
+    std::chrono::microseconds(0),
+    1
+  };
+}
+
+chess_color get_mcts_player(const chess_color color, const int depth) noexcept
+{
+  assert(depth >= 0);
+  return depth % 2 == 0 ? color : get_other_color(color);
+}
+
+bool is_sliced(const mcts_options& options) noexcept
+{
+  return options.m_slice_n_iterations > 0 || options.m_slice_time.count() > 0;
+}
+
+void play_rollout(
+  game& g,
+  const mcts_options& options,
+  const unsigned int seed,
+  const std::optional<std::chrono::steady_clock::time_point>& deadline
+)
+{
+  bot white(chess_color::white, seed, options.m_ply_time);
+  bot black(chess_color::black, seed + 1, options.m_ply_time);
+  const int n_ticks{
+    static_cast<int>(std::round(options.m_rollout_time.get() / options.m_tick_time.get()))
+  };
+  for (int i{0}; i != n_ticks && !is_over(g); ++i)
+  {
+    if (deadline && std::chrono::steady_clock::now() >= *deadline) return;
+    white.play(g);
+    black.play(g);
+    g.tick(options.m_tick_time);
+  }
+}
+
+mcts_result search_best_action(
+  const game& g,
+  const chess_color color,
+  const mcts_options& options,
+  const unsigned int seed
+)
+{
+  mcts_searcher s(g, color, options, seed);
+  return s.search();
+}
+
+void test_mcts()
+{
+#ifndef NDEBUG
+  // get_mcts_player
+  {
+    assert(get_mcts_player(chess_color::white, 0) == chess_color::white);
+    assert(get_mcts_player(chess_color::white, 1) == chess_color::black);
+    assert(get_mcts_player(chess_color::black, 2) == chess_color::black);
+  }
+  // evaluate_position, equal material is even
+  {
+    const game g;
+    assert(evaluate_position(g, chess_color::white) == 0.5);
+    assert(evaluate_position(g, chess_color::black) == 0.5);
+  }
+  // evaluate_position, more material is better
+  {
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    auto& pieces{g.get_pieces()};
+    pieces.erase(std::begin(pieces) + 2);
+    assert(evaluate_position(g, chess_color::white) > 0.5);
+    assert(evaluate_position(g, chess_color::black) < 0.5);
+    assert(std::abs(evaluate_position(g, chess_color::white) + evaluate_position(g, chess_color::black) - 1.0) < 1.0e-9);
+  }
+  // evaluate_position by a network, a symmetric position is even
+  {
+    const game g;
+    const nnue_network n;
+    nnue_accumulator a(n);
+    assert(evaluate_position(g, chess_color::white, a) == 0.5);
+    assert(evaluate_position(g, chess_color::black, a) == 0.5);
+  }
+  // play_rollout advances the game
+  {
+    game g;
+    auto options{get_default_mcts_options()};
+    play_rollout(g, options, 42);
+    assert(g.get_time().get() > 1.0);
+  }
+  // play_rollout stops when the deadline has passed
+  {
+    game g;
+    const auto options{get_default_mcts_options()};
+    play_rollout(g, options, 42, std::chrono::steady_clock::now());
+    assert(g.get_time().get() == 0.0);
+  }
+  // A search visits the root children and picks an action of its own color
+  {
+    const game g;
+    auto options{get_default_mcts_options()};
+    options.m_max_n_iterations = 30;
+    mcts_searcher s(g, chess_color::black, options, 42);
+    const auto r{s.search()};
+    assert(r.m_n_iterations == 30);
+    assert(s.get_n_iterations() == 30);
+    assert(!is_pass(r.m_action));
+    assert(g.get_pieces()[r.m_action.m_piece_index].get_color() == chess_color::black);
+    assert(r.m_score >= 0.0 && r.m_score <= 1.0);
+    const auto children{s.get_root_children()};
+    assert(children.size() == get_macro_actions(g, chess_color::black).size());
+    int n_visits{0};
+    for (const auto& c: children)
+    {
+      assert(c.m_n_threads_here == 0);
+      n_visits += c.m_n_visits;
+    }
+    assert(n_visits == 30);
+    assert(s.get_n_nodes() > 21);
+  }
+  // A search with the same seed on one thread finds the same action
+  {
+    const game g;
+    auto options{get_default_mcts_options()};
+    options.m_max_n_iterations = 25;
+    const auto a{search_best_action(g, chess_color::white, options, 123).m_action};
+    const auto b{search_best_action(g, chess_color::white, options, 123).m_action};
+    assert(a == b);
+  }
+  // A search finds the attack that wins the game
+  {
+    // The black king is put at a4, in reach of the white queen at d1,
+    // and has so little health that one attack kills it
+    game g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    auto& black_king{g.get_pieces()[3]};
+    assert(black_king.get_type() == piece_type::king);
+    black_king.set_current_square(square("a4"));
+    black_king.set_max_health(0.01);
+    g.tick(delta_t(0.01));
+    auto options{get_default_mcts_options()};
+    options.m_max_n_iterations = 200;
+    const auto r{search_best_action(g, chess_color::white, options, 42)};
+    assert(r.m_action == macro_action({0, piece_action_type::attack, square("a4")}));
+    assert(r.m_score > 0.5);
+  }
+  // A search on threads stays within its time budget
+  {
+    const game g;
+    auto options{get_default_mcts_options()};
+    options.m_max_n_iterations = 0;
+    options.m_n_threads = 4;
+    options.m_time_budget = std::chrono::milliseconds(50);
+    mcts_searcher s(g, chess_color::white, options, 42);
+    const auto r{s.search()};
+    assert(r.m_n_iterations > 0);
+    assert(!is_pass(r.m_action));
+    // Each thread finishes the iteration it is doing
+    assert(r.m_elapsed < std::chrono::milliseconds(1000));
+    for (const auto& c: s.get_root_children()) assert(c.m_n_threads_here == 0);
+  }
+  // A search with rollouts far longer than its time budget
+  // stops them at the deadline
+  {
+    const game g;
+    auto options{get_default_mcts_options()};
+    options.m_max_n_iterations = 0;
+    options.m_rollout_time = delta_t(10000.0);
+    options.m_time_budget = std::chrono::milliseconds(50);
+    const auto r{search_best_action(g, chess_color::white, options, 42)};
+    assert(r.m_n_iterations > 0);
+    assert(r.m_elapsed < std::chrono::milliseconds(1000));
+  }
+  // A search on threads does the same number of iterations
+  {
+    const game g;
+    auto options{get_default_mcts_options()};
+    options.m_max_n_iterations = 40;
+    options.m_n_threads = 3;
+    const auto r{search_best_action(g, chess_color::white, options, 42)};
+    assert(r.m_n_iterations == 40);
+  }
+  // A search in slices finds the same as a search all at once
+  {
+    const game g;
+    auto options{get_default_mcts_options()};
+    options.m_max_n_iterations = 30;
+    options.m_slice_n_iterations = 7;
+    assert(is_sliced(options));
+    mcts_searcher s(g, chess_color::white, options, 42);
+    int n_unfinished_slices{0};
+    while (!s.search_slice())
+    {
+      assert(!s.is_done());
+      ++n_unfinished_slices;
+      assert(s.get_result().m_n_iterations == 7 * n_unfinished_slices);
+    }
+    assert(n_unfinished_slices == 4);
+    assert(s.is_done());
+    const auto r{s.get_result()};
+    assert(r.m_n_iterations == 30);
+    const auto expected{search_best_action(g, chess_color::white, options, 42)};
+    assert(r.m_action == expected.m_action);
+    assert(r.m_n_visits == expected.m_n_visits);
+  }
+  // A search by a network, in slices, finds the same as a search all at once,
+  // as the accumulator gives the same evaluation whatever it was updated from
+  {
+    const game g;
+    const nnue_network n;
+    auto options{get_default_mcts_options()};
+    options.m_max_n_iterations = 20;
+    options.m_slice_n_iterations = 7;
+    options.m_network = &n;
+    mcts_searcher s(g, chess_color::white, options, 42);
+    while (!s.search_slice()) {}
+    const auto r{s.get_result()};
+    assert(r.m_n_iterations == 20);
+    const auto expected{search_best_action(g, chess_color::white, options, 42)};
+    assert(r.m_action == expected.m_action);
+    assert(r.m_n_visits == expected.m_n_visits);
+  }
+  // A search slice stops after its time
+  {
+    const game g;
+    auto options{get_default_mcts_options()};
+    options.m_max_n_iterations = 0;
+    options.m_slice_n_iterations = 0;
+    options.m_slice_time = std::chrono::milliseconds(1);
+    options.m_time_budget = std::chrono::seconds(100);
+    mcts_searcher s(g, chess_color::white, options, 42);
+    assert(!s.search_slice());
+    // Each slice finishes the iteration it is doing
+    assert(s.get_result().m_n_iterations > 0);
+    assert(s.get_result().m_elapsed < std::chrono::seconds(1));
+  }
+  // A search without a slice searches all at once
+  {
+    auto options{get_default_mcts_options()};
+    options.m_slice_n_iterations = 0;
+    assert(!is_sliced(options));
+    mcts_searcher s(game(), chess_color::white, options, 42);
+    assert(s.search_slice());
+    assert(s.get_result().m_n_iterations == options.m_max_n_iterations);
+  }
+  // A stopped search does no iterations
+  {
+    const game g;
+    const std::atomic<bool> stop{true};
+    mcts_searcher s(g, chess_color::white, get_default_mcts_options(), 42, &stop);
+    const auto r{s.search()};
+    assert(r.m_n_iterations == 0);
+    assert(is_pass(r.m_action));
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    s << search_best_action(game(), chess_color::white, get_default_mcts_options(), 42);
+    assert(s.str().find("iterations") != std::string::npos);
+  }
+#endif // NDEBUG
+}
+
+std::ostream& operator<<(std::ostream& os, const mcts_result& r) noexcept
+{
+  os << "action: " << r.m_action << '\n'
+    << "score: " << r.m_score << '\n'
+    << "visits: " << r.m_n_visits << '\n'
+    << "iterations: " << r.m_n_iterations << '\n'
+    << "microseconds: " << r.m_elapsed.count() << '\n'
+    << "iterations_per_sec: "
+    << (r.m_elapsed.count() == 0 ? 0.0 : r.m_n_iterations * 1.0e6 / r.m_elapsed.count())
+  ;
+  return os;
+}
@@ -0,0 +1,285 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "delta_t.h"
+#include "game.h"
+#include "macro_action.h"
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+/// The settings of a Monte Carlo tree search
+struct mcts_options
+{
+  /// The exploration constant of the UCT formula:
+  /// the higher, the more the search tries less promising actions
+  double m_exploration;
+
+  /// The number of iterations after which the search stops,
+  /// where zero denotes no limit
+  int m_max_n_iterations;
+
+  /// The number of threads that search the same tree
+  int m_n_threads;
+
+  /// The network that evaluates the positions after the rollouts,
+  /// where nullptr denotes the difference in material.
+  /// Each thread keeps its own accumulator up to date
+  const nnue_network* m_network;
+
+  /// The in-game time the game is advanced by after each macro action
+  delta_t m_ply_time;
+
+  /// The in-game time a rollout plays on for,
+  /// after which the position is evaluated
+  delta_t m_rollout_time;
+
+  /// The number of iterations a bot searches per tick,
+  /// after which it continues at the next tick,
+  /// where zero denotes no limit
+  int m_slice_n_iterations;
+
+  /// The wall-clock time a bot searches per tick at most,
+  /// where zero denotes no limit.
+  /// If both the slice's iterations and time are zero,
+  /// a bot searches all at once
+  std::chrono::microseconds m_slice_time;
+
+  /// The in-game time of one tick in the search
+  delta_t m_tick_time;
+
+  /// The wall-clock time after which the search stops,
+  /// where zero denotes no limit
+  std::chrono::microseconds m_time_budget;
+
+  /// The number of losses a thread adds to the nodes it is searching,
+  /// so that other threads search other nodes meanwhile
+  int m_virtual_loss;
+};
+
+/// A node of the search tree: the state after a macro action
+struct mcts_node
+{
+  /// The macro action that leads from the parent to here
+  macro_action m_action;
+
+  /// The index of the first child, where -1 denotes not expanded yet.
+  /// The children are next to each other
+  int m_first_child;
+
+  int m_n_children;
+
+  /// The number of threads searching this node right now
+  int m_n_threads_here;
+
+  int m_n_visits;
+
+  /// The sum of the scores of all visits,
+  /// for the player that did the macro action
+  double m_score;
+};
+
+/// The outcome of a search
+struct mcts_result
+{
+  /// The best macro action found, i.e. the one visited most
+  macro_action m_action;
+
+  /// The wall-clock time the search took
+  std::chrono::microseconds m_elapsed;
+
+  /// The number of iterations done in total
+  int m_n_iterations;
+
+  /// The number of visits of the best macro action
+  int m_n_visits;
+
+  /// The average score of the best macro action,
+  /// from 0.0 (a sure loss) to 1.0 (a sure win)
+  double m_score;
+};
+
+/// A Monte Carlo tree search over the macro actions of both players,
+/// searching for the best macro action of one player.
+///
+/// Each iteration selects a path through the tree by UCT,
+/// replays its macro actions on a copy of the game,
+/// adds the children of the last node,
+/// then plays on with bots for a while and evaluates the position.
+/// The players take turns in giving a macro action,
+/// after which the game is advanced for a while.
+///
+/// Threads search the same tree, taking a lock only
+/// to select, expand and update nodes,
+/// while the replays and rollouts, that take most time, are done unlocked.
+/// A virtual loss keeps threads from all searching the same path
+class mcts_searcher
+{
+public:
+  /// @param g the game to search from, which is copied
+  /// @param color the color of the player to search the best macro action of
+  /// @param seed the seed of the random numbers of the rollouts
+  /// @param stop if not null, the search stops as soon as this becomes true,
+  ///   e.g. when another thread cancels the search
+  explicit mcts_searcher(
+    const game& g,
+    const chess_color color,
+    const mcts_options& options,
+    const unsigned int seed,
+    const std::atomic<bool>* stop = nullptr
+  );
+
+  auto get_color() const noexcept { return m_color; }
+
+  /// Get the number of iterations done
+  int get_n_iterations() const noexcept { return m_n_iterations; }
+
+  /// Get the number of nodes in the tree
+  int get_n_nodes() const;
+
+  /// Get the game searched from
+  const auto& get_game() const noexcept { return m_root_game; }
+
+  /// Get the best macro action found so far
+  mcts_result get_result() const;
+
+  /// Get the children of the root, i.e. the macro actions searched
+  std::vector<mcts_node> get_root_children() const;
+
+  /// Is the search done, i.e. are its iterations or time budget used up,
+  /// or is it stopped?
+  bool is_done() const noexcept;
+
+  /// Search until the number of iterations or the time budget is used up
+  mcts_result search();
+
+  /// Search one slice, as set in the options, on the calling thread only.
+  /// The search continues where it stopped at the next call,
+  /// so that a search can be spread over many ticks of a game.
+  /// Searching in slices finds the same as searching all at once
+  /// on one thread, as each iteration has its own random numbers
+  /// @return true if the search is done
+  bool search_slice();
+
+private:
+
+  chess_color m_color;
+
+  /// The wall-clock time searched so far
+  std::chrono::microseconds m_elapsed;
+
+  /// Only accessed under 'm_mutex' while searching
+  std::vector<mcts_node> m_nodes;
+
+  /// The number of iterations done
+  std::atomic<int> m_n_iterations;
+
+  /// The number of iterations started
+  std::atomic<int> m_n_iterations_started;
+
+  /// Guards the tree
+  mutable std::mutex m_mutex;
+
+  mcts_options m_options;
+
+  /// The game to search from
+  game m_root_game;
+
+  unsigned int m_seed;
+
+  /// If not null, the search stops as soon as this becomes true
+  const std::atomic<bool>* m_stop;
+
+  /// Advance a game by the ply time
+  void do_ply(game& g) const;
+
+  /// Do one iteration
+  /// @param iteration the index of the iteration, that determines
+  ///   its random numbers
+  /// @param g the game of this thread to replay the path on,
+  ///   which is overwritten by the game searched from,
+  ///   so that its memory is reused instead of copying a new game
+  /// @param accumulator the accumulator of the network of this thread,
+  ///   which is nullptr if the material is evaluated
+  /// @param deadline when the time budget is used up, if there is one,
+  ///   after which the rollout stops early
+  void do_iteration(
+    const int iteration,
+    game& g,
+    nnue_accumulator* accumulator,
+    const std::optional<std::chrono::steady_clock::time_point>& deadline
+  );
+
+  /// Add the children of a node, unless another thread already did.
+  /// Assumes the lock is held
+  void expand(const int node_index, std::vector<macro_action> actions);
+
+  /// Select the child of a node to search by UCT, with virtual loss.
+  /// Assumes the lock is held and the node is expanded
+  int select_child(const int node_index) const;
+
+  /// Do iterations until the search is done
+  void search_worker(const std::chrono::steady_clock::time_point& deadline);
+};
+
+/// Evaluate a position for a player,
+/// from 0.0 (a sure loss) to 1.0 (a sure win).
+/// A game that is over is a win, loss or draw.
+/// Else, it is the difference in material,
+/// where each piece counts by its material value and health
+double evaluate_position(const game& g, const chess_color color);
+
+/// Evaluate a position for a player,
+/// from 0.0 (a sure loss) to 1.0 (a sure win),
+/// by a neural network, of which the accumulator
+/// is updated to the pieces of the game first.
+/// A game that is over is a win, loss or draw
+double evaluate_position(
+  const game& g,
+  const chess_color color,
+  nnue_accumulator& accumulator
+);
+
+/// Get the search options used when not specified otherwise.
+/// These search a fixed number of iterations on one thread,
+/// so that a search with the same seed always finds the same action
+mcts_options get_default_mcts_options() noexcept;
+
+/// Get the player whose turn it is at a depth of the tree,
+/// where the player searched for moves at depth zero
+chess_color get_mcts_player(const chess_color color, const int depth) noexcept;
+
+/// Does a bot search in slices, i.e. a bit at each tick?
+bool is_sliced(const mcts_options& options) noexcept;
+
+/// Play on for the rollout time, with bots for both players.
+/// When the deadline passes, the rollout stops early,
+/// so that a search does not overrun its time budget
+/// by the length of a rollout
+void play_rollout(
+  game& g,
+  const mcts_options& options,
+  const unsigned int seed,
+  const std::optional<std::chrono::steady_clock::time_point>& deadline = {}
+);
+
+/// Search the best macro action of a player
+mcts_result search_best_action(
+  const game& g,
+  const chess_color color,
+  const mcts_options& options,
+  const unsigned int seed
+);
+
+/// Test this class and its free functions
+void test_mcts();
+
+std::ostream& operator<<(std::ostream& os, const mcts_result& r) noexcept;
+
+#endif // MCTS_H
@@ -0,0 +1,941 @@
+#include "nnue.h"
+
+#include "benchmark.h"
+#include "game.h"
+#include "piece.h"
+#include "pieces.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// The vector kernels are compiled for their instructions one function
+// at a time, so that the same build runs on any x86 CPU,
+// and the CPU the game runs on picks the kernel, see 'get_nnue_kernel'
+#define NNUE_HAS_VECTOR_KERNELS
+#include <immintrin.h>
+#endif
+
+/// The bytes before the weights in a network file:
+/// 'CCNN', the version, three zeroes and the board size
+constexpr int get_nnue_header_size() noexcept { return 12; }
+
+/// The number of bits the sum of a hidden neuron is shifted right by
+constexpr int get_nnue_hidden_shift() noexcept { return 6; }
+
+/// The output of a view per hundredth of a pawn
+constexpr int get_nnue_output_scale() noexcept { return 16; }
+
+/// Get the output of a neuron of the hidden layer from the sum of its inputs
+/// and its bias: scaled down, then clipped to the range of a byte
+/// that the vector instructions multiply without overflow
+constexpr std::uint8_t get_nnue_hidden_output(const std::int32_t sum) noexcept
+{
+  return static_cast<std::uint8_t>(
+    sum <= 0 ? 0 : (sum >> get_nnue_hidden_shift()) > 127 ? 127 : sum >> get_nnue_hidden_shift()
+  );
+}
+
+#ifdef NNUE_HAS_VECTOR_KERNELS
+
+/// Add or subtract the weights of a feature with AVX2
+__attribute__((target("avx2")))
+void apply_nnue_weights_avx2(
+  std::int16_t* values,
+  const std::int16_t* weights,
+  const int sign
+) noexcept
+{
+  for (int i{0}; i != get_nnue_n_accumulated(); i += 16)
+  {
+    const __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i))};
+    const __m256i w{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i))};
+    _mm256_storeu_si256(
+      reinterpret_cast<__m256i*>(values + i),
+      sign == 1 ? _mm256_add_epi16(v, w) : _mm256_sub_epi16(v, w)
+    );
+  }
+}
+
+/// Add or subtract the weights of a feature with AVX-512
+__attribute__((target("avx512f,avx512bw")))
+void apply_nnue_weights_avx512(
+  std::int16_t* values,
+  const std::int16_t* weights,
+  const int sign
+) noexcept
+{
+  for (int i{0}; i != get_nnue_n_accumulated(); i += 32)
+  {
+    const __m512i v{_mm512_loadu_si512(values + i)};
+    const __m512i w{_mm512_loadu_si512(weights + i)};
+    _mm512_storeu_si512(values + i, sign == 1 ? _mm512_add_epi16(v, w) : _mm512_sub_epi16(v, w));
+  }
+}
+
+/// Sum each of four sums of eight 32-bit integers, plus the biases,
+/// and write the outputs of the hidden neurons 'j' to 'j + 3'
+__attribute__((target("avx2")))
+inline void write_nnue_hidden_outputs(
+  const std::int32_t* biases,
+  std::uint8_t* hidden,
+  const int j,
+  const __m256i s0,
+  const __m256i s1,
+  const __m256i s2,
+  const __m256i s3
+) noexcept
+{
+  const __m256i s{_mm256_hadd_epi32(_mm256_hadd_epi32(s0, s1), _mm256_hadd_epi32(s2, s3))};
+  alignas(16) std::array<std::int32_t, 4> sums;
+  _mm_store_si128(
+    reinterpret_cast<__m128i*>(sums.data()),
+    _mm_add_epi32(
+      _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1)),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(biases + j))
+    )
+  );
+  for (int k{0}; k != 4; ++k) hidden[j + k] = get_nnue_hidden_output(sums[k]);
+}
+
+/// Do the hidden layer with AVX2
+__attribute__((target("avx2")))
+void propagate_nnue_hidden_layer_avx2(
+  const std::int16_t* values,
+  const std::int8_t* weights,
+  const std::int32_t* biases,
+  std::uint8_t* hidden
+) noexcept
+{
+  constexpr int n{get_nnue_n_accumulated()};
+  // The clipped ReLU: saturate to bytes, then clip the negative ones.
+  // Packing interleaves the 128-bit lanes, which the permutation undoes
+  __m256i input[n / 32];
+  const __m256i zero{_mm256_setzero_si256()};
+  for (int i{0}; i != n / 32; ++i)
+  {
+    const __m256i packed{
+      _mm256_packs_epi16(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + (32 * i))),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + (32 * i) + 16))
+      )
+    };
+    input[i] = _mm256_max_epi8(_mm256_permute4x64_epi64(packed, 0xD8), zero);
+  }
+  // Multiply the unsigned inputs by the signed weights, in pairs,
+  // and sum the pairs to 32 bits
+  const __m256i ones{_mm256_set1_epi16(1)};
+  __m256i sums[4];
+  for (int j{0}; j != get_nnue_n_hidden(); j += 4)
+  {
+    for (int k{0}; k != 4; ++k)
+    {
+      sums[k] = _mm256_setzero_si256();
+      for (int i{0}; i != n / 32; ++i)
+      {
+        const __m256i w{
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + ((j + k) * n) + (32 * i)))
+        };
+        sums[k] = _mm256_add_epi32(sums[k], _mm256_madd_epi16(_mm256_maddubs_epi16(input[i], w), ones));
+      }
+    }
+    write_nnue_hidden_outputs(biases, hidden, j, sums[0], sums[1], sums[2], sums[3]);
+  }
+}
+
+/// The clipped ReLU of the values, with AVX-512: saturate to bytes,
+/// then clip the negative ones.
+/// The masked forms of the intrinsics are used,
+/// as the unmasked ones trip the uninitialized warnings of GCC.
+/// Packing interleaves the 128-bit lanes, which the permutation undoes
+__attribute__((target("avx512f,avx512bw")))
+void pack_nnue_input_avx512(
+  const std::int16_t* values,
+  __m512i* input
+) noexcept
+{
+  const __m512i zero{_mm512_setzero_si512()};
+  const __m512i order{_mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7)};
+  for (int i{0}; i != get_nnue_n_accumulated() / 64; ++i)
+  {
+    const __m512i packed{
+      _mm512_packs_epi16(_mm512_loadu_si512(values + (64 * i)), _mm512_loadu_si512(values + (64 * i) + 32))
+    };
+    input[i] = _mm512_max_epi8(_mm512_maskz_permutexvar_epi64(0xFF, order, packed), zero);
+  }
+}
+
+/// Do the hidden layer with AVX-512
+__attribute__((target("avx512f,avx512bw")))
+void propagate_nnue_hidden_layer_avx512(
+  const std::int16_t* values,
+  const std::int8_t* weights,
+  const std::int32_t* biases,
+  std::uint8_t* hidden
+) noexcept
+{
+  constexpr int n{get_nnue_n_accumulated()};
+  __m512i input[n / 64];
+  pack_nnue_input_avx512(values, input);
+  // Multiply the unsigned inputs by the signed weights, in pairs,
+  // and sum the pairs to 32 bits
+  const __m512i ones{_mm512_set1_epi16(1)};
+  __m256i sums[4];
+  for (int j{0}; j != get_nnue_n_hidden(); j += 4)
+  {
+    for (int k{0}; k != 4; ++k)
+    {
+      __m512i sum{_mm512_setzero_si512()};
+      for (int i{0}; i != n / 64; ++i)
+      {
+        const __m512i w{_mm512_loadu_si512(weights + ((j + k) * n) + (64 * i))};
+        sum = _mm512_add_epi32(sum, _mm512_madd_epi16(_mm512_maddubs_epi16(input[i], w), ones));
+      }
+      sums[k] = _mm256_add_epi32(
+        _mm512_maskz_extracti64x4_epi64(0xFF, sum, 0),
+        _mm512_maskz_extracti64x4_epi64(0xFF, sum, 1)
+      );
+    }
+    write_nnue_hidden_outputs(biases, hidden, j, sums[0], sums[1], sums[2], sums[3]);
+  }
+}
+
+/// Do the hidden layer with AVX-512 and VNNI, which multiplies
+/// the unsigned inputs by the signed weights and sums each four products
+/// to 32 bits in one instruction
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+void propagate_nnue_hidden_layer_avx512vnni(
+  const std::int16_t* values,
+  const std::int8_t* weights,
+  const std::int32_t* biases,
+  std::uint8_t* hidden
+) noexcept
+{
+  constexpr int n{get_nnue_n_accumulated()};
+  __m512i input[n / 64];
+  pack_nnue_input_avx512(values, input);
+  __m256i sums[4];
+  for (int j{0}; j != get_nnue_n_hidden(); j += 4)
+  {
+    for (int k{0}; k != 4; ++k)
+    {
+      __m512i sum{_mm512_setzero_si512()};
+      for (int i{0}; i != n / 64; ++i)
+      {
+        sum = _mm512_dpbusd_epi32(sum, input[i], _mm512_loadu_si512(weights + ((j + k) * n) + (64 * i)));
+      }
+      sums[k] = _mm256_add_epi32(
+        _mm512_maskz_extracti64x4_epi64(0xFF, sum, 0),
+        _mm512_maskz_extracti64x4_epi64(0xFF, sum, 1)
+      );
+    }
+    write_nnue_hidden_outputs(biases, hidden, j, sums[0], sums[1], sums[2], sums[3]);
+  }
+}
+
+#endif // NNUE_HAS_VECTOR_KERNELS
+
+nnue_network::nnue_network(const int board_size, const unsigned int seed)
+  : m_board_size{board_size},
+    m_feature_biases(get_nnue_n_accumulated()),
+    m_feature_weights(static_cast<std::size_t>(get_n_nnue_features(board_size)) * get_nnue_n_accumulated()),
+    m_hidden_biases(get_nnue_n_hidden()),
+    m_hidden_weights(get_nnue_n_hidden() * get_nnue_n_accumulated()),
+    m_output_bias{0},
+    m_output_weights(get_nnue_n_hidden())
+{
+  assert(m_board_size > 0);
+  assert(m_board_size <= get_max_board_size());
+  // Uniform in [-max, max], drawn from the raw random numbers,
+  // so that each standard library gives the same network
+  std::mt19937 rng_engine(seed);
+  const auto draw{
+    [&rng_engine](const int max)
+    {
+      return static_cast<int>(rng_engine() % static_cast<unsigned int>((2 * max) + 1)) - max;
+    }
+  };
+  for (auto& b: m_feature_biases) b = static_cast<std::int16_t>(32 + draw(16));
+  for (auto& w: m_feature_weights) w = static_cast<std::int16_t>(draw(16));
+  for (auto& b: m_hidden_biases) b = draw(1024);
+  for (auto& w: m_hidden_weights) w = static_cast<std::int8_t>(draw(16));
+  for (auto& w: m_output_weights) w = static_cast<std::int8_t>(draw(32));
+}
+
+nnue_network::nnue_network(const std::string& filename)
+  : m_board_size{0},
+    m_feature_biases{},
+    m_feature_weights{},
+    m_hidden_biases{},
+    m_hidden_weights{},
+    m_output_bias{0},
+    m_output_weights{}
+{
+  std::ifstream f(filename, std::ios::binary);
+  if (!f)
+  {
+    throw std::runtime_error("Cannot open '" + filename + "'");
+  }
+  const std::vector<std::uint8_t> bytes{
+    std::istreambuf_iterator<char>(f),
+    std::istreambuf_iterator<char>()
+  };
+  if (bytes.size() < static_cast<std::size_t>(get_nnue_header_size())
+    || std::memcmp(bytes.data(), "CCNN", 4) != 0
+    || bytes[4] != 1
+    || bytes[5] != 0
+    || bytes[6] != 0
+    || bytes[7] != 0
+  )
+  {
+    throw std::runtime_error("File '" + filename + "' is no neural network");
+  }
+  // Read an unsigned number, stored least significant byte first
+  std::size_t position{8};
+  const auto read{
+    [&bytes, &position](const int n_bytes)
+    {
+      std::uint32_t value{0};
+      for (int i{n_bytes - 1}; i >= 0; --i) value = (value << 8) | bytes[position + i];
+      position += n_bytes;
+      return value;
+    }
+  };
+  const std::uint32_t board_size{read(4)};
+  if (board_size == 0 || board_size > static_cast<std::uint32_t>(get_max_board_size()))
+  {
+    throw std::runtime_error("Neural network '" + filename + "' has an invalid board size");
+  }
+  m_board_size = static_cast<int>(board_size);
+  m_feature_biases.resize(get_nnue_n_accumulated());
+  m_feature_weights.resize(static_cast<std::size_t>(get_n_nnue_features(m_board_size)) * get_nnue_n_accumulated());
+  m_hidden_biases.resize(get_nnue_n_hidden());
+  m_hidden_weights.resize(get_nnue_n_hidden() * get_nnue_n_accumulated());
+  m_output_weights.resize(get_nnue_n_hidden());
+  const std::size_t expected_size{
+    get_nnue_header_size()
+    + (2 * (m_feature_biases.size() + m_feature_weights.size()))
+    + (4 * m_hidden_biases.size())
+    + m_hidden_weights.size()
+    + 4
+    + m_output_weights.size()
+  };
+  if (bytes.size() != expected_size)
+  {
+    throw std::runtime_error("Neural network '" + filename + "' has the wrong size");
+  }
+  for (auto& b: m_feature_biases) b = static_cast<std::int16_t>(read(2));
+  for (auto& w: m_feature_weights) w = static_cast<std::int16_t>(read(2));
+  for (auto& b: m_hidden_biases) b = static_cast<std::int32_t>(read(4));
+  for (auto& w: m_hidden_weights) w = static_cast<std::int8_t>(read(1));
+  m_output_bias = static_cast<std::int32_t>(read(4));
+  for (auto& w: m_output_weights) w = static_cast<std::int8_t>(read(1));
+  assert(position == bytes.size());
+}
+
+int nnue_network::evaluate(const nnue_accumulator& a) const noexcept
+{
+  assert(&a.get_network() == this);
+  const int output{
+    propagate(a.get_values(chess_color::white))
+    - propagate(a.get_values(chess_color::black))
+  };
+  return output / get_nnue_output_scale();
+}
+
+int nnue_network::propagate(const std::int16_t* accumulated) const noexcept
+{
+  alignas(64) std::array<std::uint8_t, get_nnue_n_hidden()> hidden;
+  propagate_nnue_hidden_layer(
+    accumulated,
+    m_hidden_weights.data(),
+    m_hidden_biases.data(),
+    hidden.data()
+  );
+  int output{m_output_bias};
+  for (int i{0}; i != get_nnue_n_hidden(); ++i)
+  {
+    output += hidden[i] * m_output_weights[i];
+  }
+  return output;
+}
+
+void nnue_network::save(const std::string& filename) const
+{
+  std::vector<std::uint8_t> bytes;
+  // Write an unsigned number, least significant byte first
+  const auto write{
+    [&bytes](std::uint32_t value, const int n_bytes)
+    {
+      for (int i{0}; i != n_bytes; ++i)
+      {
+        bytes.push_back(static_cast<std::uint8_t>(value & 0xff));
+        value >>= 8;
+      }
+    }
+  };
+  bytes.insert(std::end(bytes), { 'C', 'C', 'N', 'N', 1, 0, 0, 0 });
+  write(m_board_size, 4);
+  for (const auto b: m_feature_biases) write(static_cast<std::uint16_t>(b), 2);
+  for (const auto w: m_feature_weights) write(static_cast<std::uint16_t>(w), 2);
+  for (const auto b: m_hidden_biases) write(static_cast<std::uint32_t>(b), 4);
+  for (const auto w: m_hidden_weights) write(static_cast<std::uint8_t>(w), 1);
+  write(static_cast<std::uint32_t>(m_output_bias), 4);
+  for (const auto w: m_output_weights) write(static_cast<std::uint8_t>(w), 1);
+  std::ofstream f(filename, std::ios::binary);
+  f.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  if (!f)
+  {
+    throw std::runtime_error("Cannot write neural network to '" + filename + "'");
+  }
+}
+
+nnue_accumulator::nnue_accumulator(const nnue_network& network)
+  : m_network{&network},
+    m_values{},
+    m_n_updates{0},
+    m_n_changed{0},
+    m_stamps{}
+{
+  for (auto& values: m_values)
+  {
+    std::copy(
+      std::begin(network.get_feature_biases()),
+      std::end(network.get_feature_biases()),
+      std::begin(values)
+    );
+  }
+}
+
+void nnue_accumulator::apply(const chess_color c, const int feature, const int sign) noexcept
+{
+  if (feature == -1) return;
+  assert(feature >= 0);
+  assert(feature < get_n_nnue_features(m_network->get_board_size()));
+  apply_nnue_weights(
+    m_values[static_cast<int>(c)].data(),
+    m_network->get_feature_weights().data() + (static_cast<std::size_t>(feature) * get_nnue_n_accumulated()),
+    sign
+  );
+}
+
+void nnue_accumulator::update(const game& g)
+{
+  assert(get_board_size(g.get_options()) == m_network->get_board_size());
+  update(g.get_pieces());
+}
+
+void nnue_accumulator::update(const std::vector<piece>& pieces)
+{
+  ++m_n_updates;
+  m_n_changed = 0;
+  const int board_size{m_network->get_board_size()};
+  for (const auto& p: pieces)
+  {
+    const auto there{m_stamps.find(p.get_id().get())};
+    if (there == std::end(m_stamps))
+    {
+      const auto s{create_nnue_stamp(p, board_size)};
+      for (const auto c: { chess_color::black, chess_color::white })
+      {
+        for (const int feature: s.m_features[static_cast<int>(c)]) apply(c, feature, 1);
+      }
+      m_stamps.emplace(p.get_id().get(), std::make_pair(s, m_n_updates));
+      ++m_n_changed;
+      continue;
+    }
+    auto& [stamp, last_update]{there->second};
+    // The features of one view tell all there is to a piece,
+    // so the other view is only needed if the piece changed
+    if (get_nnue_features(p, chess_color::white, board_size)
+      != stamp.m_features[static_cast<int>(chess_color::white)]
+    )
+    {
+      const auto s{create_nnue_stamp(p, board_size)};
+      // Only the features that differ are subtracted and added,
+      // e.g. only the health of a piece that is attacked
+      for (const auto c: { chess_color::black, chess_color::white })
+      {
+        const auto& before{stamp.m_features[static_cast<int>(c)]};
+        const auto& after{s.m_features[static_cast<int>(c)]};
+        for (std::size_t i{0}; i != before.size(); ++i)
+        {
+          if (before[i] == after[i]) continue;
+          apply(c, before[i], -1);
+          apply(c, after[i], 1);
+        }
+      }
+      stamp = s;
+      ++m_n_changed;
+    }
+    last_update = m_n_updates;
+  }
+  // Remove the features of the pieces that are gone, if any
+  if (m_stamps.size() == pieces.size()) return;
+  for (auto i{std::begin(m_stamps)}; i != std::end(m_stamps); )
+  {
+    if (i->second.second == m_n_updates)
+    {
+      ++i;
+      continue;
+    }
+    for (const auto c: { chess_color::black, chess_color::white })
+    {
+      for (const int feature: i->second.first.m_features[static_cast<int>(c)]) apply(c, feature, -1);
+    }
+    i = m_stamps.erase(i);
+    ++m_n_changed;
+  }
+}
+
+void apply_nnue_weights(
+  std::int16_t* values,
+  const std::int16_t* weights,
+  const int sign,
+  const nnue_kernel kernel
+) noexcept
+{
+  assert(sign == 1 || sign == -1);
+  switch (kernel)
+  {
+#ifdef NNUE_HAS_VECTOR_KERNELS
+    case nnue_kernel::avx2:
+      apply_nnue_weights_avx2(values, weights, sign);
+      return;
+    case nnue_kernel::avx512:
+    case nnue_kernel::avx512vnni:
+      apply_nnue_weights_avx512(values, weights, sign);
+      return;
+#endif
+    default:
+      assert(kernel == nnue_kernel::scalar);
+      break;
+  }
+  for (int i{0}; i != get_nnue_n_accumulated(); ++i)
+  {
+    values[i] = static_cast<std::int16_t>(values[i] + (sign * weights[i]));
+  }
+}
+
+void benchmark_nnue(std::ostream& os, const int n_ticks)
+{
+  assert(n_ticks > 0);
+  os << "board_size\tkernel\tn_pieces\tn_changed_per_tick"
+    << "\tns_per_update\tns_per_evaluation\tevaluations_per_sec\tmean_evaluation\n";
+  for (const int board_size: { 8, 16, 32 })
+  {
+    const nnue_network network(board_size);
+    nnue_accumulator a(network);
+    auto options{get_default_game_options()};
+    options.set_board_size(board_size);
+    game g(options);
+    const int n_pieces{static_cast<int>(g.get_pieces().size())};
+    std::chrono::steady_clock::duration t_update{0};
+    std::chrono::steady_clock::duration t_evaluation{0};
+    int n_changed{0};
+    // Shown, so that the evaluations are not optimized away
+    double sum{0.0};
+    for (int i{0}; i != n_ticks; ++i)
+    {
+      if (i % 10 == 0) order_idle_pieces_forward(g);
+      clear_piece_messages(g);
+      g.tick(delta_t(0.1));
+      const auto start{std::chrono::steady_clock::now()};
+      a.update(g);
+      const auto updated{std::chrono::steady_clock::now()};
+      sum += network.evaluate(a);
+      t_update += updated - start;
+      t_evaluation += std::chrono::steady_clock::now() - updated;
+      n_changed += a.get_n_changed();
+    }
+    const double ns_per_update{
+      std::chrono::duration<double, std::nano>(t_update).count() / n_ticks
+    };
+    const double ns_per_evaluation{
+      std::chrono::duration<double, std::nano>(t_evaluation).count() / n_ticks
+    };
+    os << board_size << '\t'
+      << to_str(get_nnue_kernel()) << '\t'
+      << n_pieces << '\t'
+      << (static_cast<double>(n_changed) / n_ticks) << '\t'
+      << ns_per_update << '\t'
+      << ns_per_evaluation << '\t'
+      << (1.0e9 / (ns_per_update + ns_per_evaluation)) << '\t'
+      << (sum / n_ticks) << '\n'
+    ;
+  }
+}
+
+nnue_stamp create_nnue_stamp(const piece& p, const int board_size) noexcept
+{
+  return nnue_stamp{
+    {
+      get_nnue_features(p, chess_color::black, board_size),
+      get_nnue_features(p, chess_color::white, board_size)
+    }
+  };
+}
+
+nnue_kernel get_nnue_kernel() noexcept
+{
+  static const nnue_kernel kernel{
+    []()
+    {
+#ifdef NNUE_HAS_VECTOR_KERNELS
+      __builtin_cpu_init();
+      if (!__builtin_cpu_supports("avx2")) return nnue_kernel::scalar;
+      if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw"))
+      {
+        return nnue_kernel::avx2;
+      }
+      if (!__builtin_cpu_supports("avx512vnni")) return nnue_kernel::avx512;
+      return nnue_kernel::avx512vnni;
+#else
+      return nnue_kernel::scalar;
+#endif
+    }()
+  };
+  return kernel;
+}
+
+std::vector<nnue_kernel> get_nnue_kernels()
+{
+  std::vector<nnue_kernel> kernels{nnue_kernel::scalar};
+  for (const auto k: { nnue_kernel::avx2, nnue_kernel::avx512, nnue_kernel::avx512vnni })
+  {
+    if (k <= get_nnue_kernel()) kernels.push_back(k);
+  }
+  return kernels;
+}
+
+std::array<int, 3> get_nnue_features(
+  const piece& p,
+  const chess_color viewer,
+  const int board_size
+) noexcept
+{
+  const int n_squares{board_size * board_size};
+  const auto to_index{
+    [board_size, viewer](const square& s)
+    {
+      assert(is_valid_square_xy(s.get_x(), s.get_y(), board_size));
+      const int x{viewer == chess_color::white ? s.get_x() : board_size - 1 - s.get_x()};
+      return (x * board_size) + s.get_y();
+    }
+  };
+  // The pieces of the viewer are the first color
+  const int color{p.get_color() == viewer ? 0 : 1};
+  const int kind{(color * 6) + static_cast<int>(p.get_type())};
+  const int health{std::clamp(static_cast<int>(get_f_health(p) * 4.0), 0, 3)};
+  std::array<int, 3> features{
+    (kind * n_squares) + to_index(p.get_current_square()),
+    (12 * n_squares) + (kind * 4) + health,
+    -1
+  };
+  if (!p.get_actions().empty())
+  {
+    const auto& action{p.get_actions()[0]};
+    const int type{action.get_action_type() == piece_action_type::move ? 0 : 1};
+    features[2] = (12 * n_squares) + 48 + ((((color * 2) + type) * n_squares) + to_index(action.get_to()));
+  }
+  return features;
+}
+
+int get_n_nnue_features(const int board_size) noexcept
+{
+  assert(board_size > 0);
+  const int n_squares{board_size * board_size};
+  // Per color and type, the squares and the health in quarters,
+  // and per color and action type, the target squares
+  return (12 * n_squares) + 48 + (4 * n_squares);
+}
+
+void propagate_nnue_hidden_layer(
+  const std::int16_t* values,
+  const std::int8_t* weights,
+  const std::int32_t* biases,
+  std::uint8_t* hidden,
+  const nnue_kernel kernel
+) noexcept
+{
+  static_assert(get_nnue_n_hidden() % 4 == 0);
+  switch (kernel)
+  {
+#ifdef NNUE_HAS_VECTOR_KERNELS
+    case nnue_kernel::avx2:
+      propagate_nnue_hidden_layer_avx2(values, weights, biases, hidden);
+      return;
+    case nnue_kernel::avx512:
+      propagate_nnue_hidden_layer_avx512(values, weights, biases, hidden);
+      return;
+    case nnue_kernel::avx512vnni:
+      propagate_nnue_hidden_layer_avx512vnni(values, weights, biases, hidden);
+      return;
+#endif
+    default:
+      assert(kernel == nnue_kernel::scalar);
+      break;
+  }
+  constexpr int n{get_nnue_n_accumulated()};
+  std::array<std::uint8_t, n> input;
+  for (int i{0}; i != n; ++i)
+  {
+    input[i] = static_cast<std::uint8_t>(std::clamp<int>(values[i], 0, 127));
+  }
+  for (int j{0}; j != get_nnue_n_hidden(); ++j)
+  {
+    std::int32_t sum{biases[j]};
+    for (int i{0}; i != n; ++i) sum += input[i] * weights[(j * n) + i];
+    hidden[j] = get_nnue_hidden_output(sum);
+  }
+}
+
+void test_nnue()
+{
+#ifndef NDEBUG
+  // get_n_nnue_features
+  {
+    assert(get_n_nnue_features(8) == (16 * 64) + 48);
+    assert(get_n_nnue_features(32) == (16 * 1024) + 48);
+  }
+  // get_nnue_features, black sees the board mirrored, with the colors swapped
+  {
+    const piece white_pawn(chess_color::white, piece_type::pawn, square("e2"), side::lhs);
+    const piece black_pawn(chess_color::black, piece_type::pawn, square("e7"), side::rhs);
+    assert(get_nnue_features(white_pawn, chess_color::white, 8) == get_nnue_features(black_pawn, chess_color::black, 8));
+    assert(get_nnue_features(white_pawn, chess_color::black, 8) == get_nnue_features(black_pawn, chess_color::white, 8));
+    assert(get_nnue_features(white_pawn, chess_color::white, 8) != get_nnue_features(white_pawn, chess_color::black, 8));
+    // An idle piece at full health
+    const auto f{get_nnue_features(white_pawn, chess_color::white, 8)};
+    assert(f[0] == (static_cast<int>(piece_type::pawn) * 64) + 12);
+    assert(f[1] == (12 * 64) + (static_cast<int>(piece_type::pawn) * 4) + 3);
+    assert(f[2] == -1);
+  }
+  // get_nnue_features, the health and the action are features
+  {
+    piece p(chess_color::white, piece_type::knight, square("c3"), side::lhs);
+    const auto before{get_nnue_features(p, chess_color::white, 8)};
+    p.receive_damage(0.5 * p.get_max_health());
+    const auto damaged{get_nnue_features(p, chess_color::white, 8)};
+    assert(damaged[0] == before[0]);
+    assert(damaged[1] == before[1] - 1);
+    p.add_action(piece_action(side::lhs, piece_type::knight, piece_action_type::move, square("c3"), square("d5")));
+    const auto moving{get_nnue_features(p, chess_color::white, 8)};
+    assert(moving[2] == (12 * 64) + 48 + (4 * 8) + 3);
+    assert(moving[2] < get_n_nnue_features(8));
+  }
+  // get_nnue_kernels, the fastest is the one used
+  {
+    const auto kernels{get_nnue_kernels()};
+    assert(kernels.front() == nnue_kernel::scalar);
+    assert(kernels.back() == get_nnue_kernel());
+    assert(std::is_sorted(std::begin(kernels), std::end(kernels)));
+  }
+  // to_str
+  {
+    assert(to_str(nnue_kernel::scalar) == "scalar");
+    assert(to_str(nnue_kernel::avx2) == "avx2");
+    assert(to_str(nnue_kernel::avx512) == "avx512");
+    assert(to_str(nnue_kernel::avx512vnni) == "avx512vnni");
+  }
+  // Every kernel the CPU can do gives the same as the scalar code
+  {
+    const nnue_network n(8, 123);
+    std::mt19937 rng_engine(42);
+    std::array<std::int16_t, get_nnue_n_accumulated()> values;
+    for (auto& v: values) v = static_cast<std::int16_t>(static_cast<int>(rng_engine() % 600) - 200);
+    const auto weights{n.get_feature_weights().data() + (5 * get_nnue_n_accumulated())};
+    std::vector<std::int8_t> hidden_weights(get_nnue_n_hidden() * get_nnue_n_accumulated());
+    for (auto& w: hidden_weights) w = static_cast<std::int8_t>(rng_engine() % 256);
+    std::vector<std::int32_t> biases(get_nnue_n_hidden());
+    for (auto& w: biases) w = static_cast<std::int32_t>(rng_engine() % 20000) - 10000;
+    auto b{values};
+    apply_nnue_weights(b.data(), weights, 1, nnue_kernel::scalar);
+    std::array<std::uint8_t, get_nnue_n_hidden()> hidden_scalar;
+    propagate_nnue_hidden_layer(b.data(), hidden_weights.data(), biases.data(), hidden_scalar.data(), nnue_kernel::scalar);
+    for (const auto k: get_nnue_kernels())
+    {
+      auto a{values};
+      apply_nnue_weights(a.data(), weights, 1, k);
+      assert(a == b);
+      std::array<std::uint8_t, get_nnue_n_hidden()> hidden;
+      propagate_nnue_hidden_layer(a.data(), hidden_weights.data(), biases.data(), hidden.data(), k);
+      assert(hidden == hidden_scalar);
+      apply_nnue_weights(a.data(), weights, -1, k);
+      assert(a == values);
+    }
+  }
+  // An empty accumulator has the biases
+  {
+    const nnue_network n;
+    const nnue_accumulator a(n);
+    assert(a.get_n_changed() == 0);
+    assert(a.get_values(chess_color::white)[0] == n.get_feature_biases()[0]);
+    assert(n.evaluate(a) == 0);
+  }
+  // The starting position is even, and a mirrored game has the opposite evaluation
+  {
+    const nnue_network n;
+    nnue_accumulator a(n);
+    game g;
+    a.update(g);
+    assert(a.get_n_changed() == 32);
+    assert(n.evaluate(a) == 0);
+
+    game white_moved;
+    game black_moved;
+    for (auto& p: white_moved.get_pieces())
+    {
+      if (p.get_current_square() == square("e2")) p.set_current_square(square("e4"));
+    }
+    for (auto& p: black_moved.get_pieces())
+    {
+      if (p.get_current_square() == square("e7")) p.set_current_square(square("e5"));
+    }
+    nnue_accumulator a_white(n);
+    a_white.update(white_moved);
+    nnue_accumulator a_black(n);
+    a_black.update(black_moved);
+    assert(n.evaluate(a_white) == -n.evaluate(a_black));
+  }
+  // An update only changes the pieces that changed,
+  // and gives the same as an accumulator made from scratch
+  {
+    const nnue_network n;
+    nnue_accumulator a(n);
+    game g;
+    a.update(g);
+    a.update(g);
+    assert(a.get_n_changed() == 0);
+
+    // A piece that moved
+    g.get_pieces()[0].set_current_square(square("d4"));
+    a.update(g);
+    assert(a.get_n_changed() == 1);
+
+    // A piece that was damaged
+    const std::vector<std::int16_t> before(a.get_values(chess_color::white), a.get_values(chess_color::white) + get_nnue_n_accumulated());
+    g.get_pieces()[1].receive_damage(0.5 * g.get_pieces()[1].get_max_health());
+    a.update(g);
+    assert(a.get_n_changed() == 1);
+    const std::vector<std::int16_t> after(a.get_values(chess_color::white), a.get_values(chess_color::white) + get_nnue_n_accumulated());
+    assert(before != after);
+
+    // A piece that is gone
+    g.get_pieces().pop_back();
+    a.update(g);
+    assert(a.get_n_changed() == 1);
+
+    nnue_accumulator from_scratch(n);
+    from_scratch.update(g);
+    for (const auto c: get_all_chess_colors())
+    {
+      assert(std::equal(a.get_values(c), a.get_values(c) + get_nnue_n_accumulated(), from_scratch.get_values(c)));
+    }
+    assert(n.evaluate(a) == n.evaluate(from_scratch));
+
+    // No pieces at all
+    a.update(std::vector<piece>());
+    assert(a.get_n_changed() == 31);
+    for (const auto c: get_all_chess_colors())
+    {
+      assert(std::equal(a.get_values(c), a.get_values(c) + get_nnue_n_accumulated(), std::begin(n.get_feature_biases())));
+    }
+  }
+  // An update while the pieces move and attack gives the same
+  // as an accumulator made from scratch
+  {
+    const nnue_network n(16);
+    nnue_accumulator a(n);
+    auto options{get_default_game_options()};
+    options.set_board_size(16);
+    game g(options);
+    for (int i{0}; i != 20; ++i)
+    {
+      if (i % 10 == 0) order_idle_pieces_forward(g);
+      g.tick(delta_t(0.1));
+      a.update(g);
+    }
+    nnue_accumulator from_scratch(n);
+    from_scratch.update(g);
+    assert(n.evaluate(a) == n.evaluate(from_scratch));
+  }
+  // Saving and loading a network
+  {
+    const std::string filename{"test_nnue.ccnn"};
+    const nnue_network n(8, 314);
+    n.save(filename);
+    const nnue_network m(filename);
+    assert(m.get_board_size() == 8);
+    assert(m.get_feature_weights() == n.get_feature_weights());
+    const game g;
+    nnue_accumulator a(n);
+    a.update(g);
+    nnue_accumulator b(m);
+    b.update(g);
+    assert(n.evaluate(a) == m.evaluate(b));
+    std::remove(filename.c_str());
+  }
+  // A file that is no network
+  {
+    const std::string filename{"test_nnue_invalid.ccnn"};
+    {
+      std::ofstream f(filename);
+      f << "This is no neural network, yet is long enough to have a header";
+    }
+    bool has_thrown{false};
+    try { const nnue_network n(filename); }
+    catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+    std::remove(filename.c_str());
+  }
+  // benchmark_nnue
+  {
+    std::stringstream s;
+    benchmark_nnue(s, 2);
+    assert(s.str().find(to_str(get_nnue_kernel())) != std::string::npos);
+  }
+  // operator==
+  {
+    const piece p(chess_color::white, piece_type::pawn, square("e2"), side::lhs);
+    const auto a{create_nnue_stamp(p, 8)};
+    auto b{a};
+    assert(a == b);
+    b.m_features[0][2] = 1;
+    assert(a != b);
+  }
+#endif // NDEBUG
+}
+
+bool operator==(const nnue_stamp& lhs, const nnue_stamp& rhs) noexcept
+{
+  return lhs.m_features == rhs.m_features;
+}
+
+bool operator!=(const nnue_stamp& lhs, const nnue_stamp& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+std::string to_str(const nnue_kernel k) noexcept
+{
+  switch (k)
+  {
+    case nnue_kernel::scalar: return "scalar";
+    case nnue_kernel::avx2: return "avx2";
+    case nnue_kernel::avx512: return "avx512";
+    default:
+    case nnue_kernel::avx512vnni:
+      assert(k == nnue_kernel::avx512vnni);
+      return "avx512vnni";
+  }
+}
@@ -0,0 +1,249 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "square.h"
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// The number of values of the accumulator per view,
+/// i.e. the size of the first hidden layer
+constexpr int get_nnue_n_accumulated() noexcept { return 256; }
+
+/// The number of neurons of the second hidden layer
+constexpr int get_nnue_n_hidden() noexcept { return 16; }
+
+/// The vector instructions that the kernels of an 'nnue_network' use,
+/// where each one can do all before it
+enum class nnue_kernel
+{
+  /// No vector instructions
+  scalar,
+
+  /// AVX2, that does 16 values of the accumulator at once
+  avx2,
+
+  /// AVX-512, that does 32 values of the accumulator at once
+  avx512,
+
+  /// AVX-512 with VNNI, that multiplies and sums the inputs
+  /// of the hidden layer in one instruction
+  avx512vnni
+};
+
+/// Get the fastest kernel that the CPU the game runs on can do,
+/// which is detected once
+nnue_kernel get_nnue_kernel() noexcept;
+
+/// The input features of one piece, as added to the accumulator
+struct nnue_stamp
+{
+  /// Per view, indexed by the color of the viewer, the features
+  /// as by 'get_nnue_features', where -1 denotes no feature
+  std::array<std::array<int, 3>, 2> m_features;
+};
+
+/// A small neural network that evaluates a game,
+/// including the health of the pieces and what they are doing.
+///
+/// Its input is sparse: per piece, its type and square,
+/// its type and health, and the target of its current action,
+/// as given by 'get_nnue_features', each seen from both players.
+/// The first layer is the sum of the weights of the input features,
+/// which is kept up to date incrementally by an 'nnue_accumulator'.
+/// The values of a view go through a clipped ReLU, a hidden layer
+/// of 'get_nnue_n_hidden' neurons and another clipped ReLU
+/// to a single output. The evaluation is the output of white's view,
+/// minus the output of black's view, so that a mirrored game
+/// has the opposite evaluation.
+///
+/// All weights are integers, so that the hidden layer is done
+/// with AVX-512 or AVX2 vector instructions, when the CPU has these,
+/// as shown by 'get_nnue_kernel'. The hidden layer is small,
+/// as it is done anew at each evaluation, unlike the accumulator.
+///
+/// A network is created with random weights, from a seed,
+/// or loaded from a file, as written by 'save'
+class nnue_network
+{
+public:
+  /// Create a network with random weights
+  /// @param board_size the number of squares along one side of the board
+  explicit nnue_network(
+    const int board_size = get_default_board_size(),
+    const unsigned int seed = 42
+  );
+
+  /// Load a network from a file, as written by 'save'.
+  /// Throws if the file cannot be read or is no network
+  explicit nnue_network(const std::string& filename);
+
+  /// Evaluate the game of which the pieces are in the accumulator,
+  /// in hundredths of a pawn, where positive is good for white
+  int evaluate(const nnue_accumulator& a) const noexcept;
+
+  auto get_board_size() const noexcept { return m_board_size; }
+
+  /// Get the weights of the first layer, per input feature,
+  /// 'get_nnue_n_accumulated' values one feature after the other
+  const auto& get_feature_weights() const noexcept { return m_feature_weights; }
+
+  /// Get the biases of the first layer, which an empty accumulator has
+  const auto& get_feature_biases() const noexcept { return m_feature_biases; }
+
+  /// Save the network. Throws if the file cannot be written
+  void save(const std::string& filename) const;
+
+private:
+
+  int m_board_size;
+
+  std::vector<std::int16_t> m_feature_biases;
+
+  /// Per input feature, the weights of all values of the accumulator
+  std::vector<std::int16_t> m_feature_weights;
+
+  std::vector<std::int32_t> m_hidden_biases;
+
+  /// Per neuron of the hidden layer, the weights of all values of the accumulator
+  std::vector<std::int8_t> m_hidden_weights;
+
+  std::int32_t m_output_bias;
+
+  std::vector<std::int8_t> m_output_weights;
+
+  /// Get the output of the network for the accumulator of one view
+  int propagate(const std::int16_t* accumulated) const noexcept;
+};
+
+/// The first layer of an 'nnue_network', of both views,
+/// kept up to date with the pieces of a game.
+///
+/// An update only subtracts and adds the weights of the features
+/// that changed since the last update, such as the square of a piece
+/// that moved, or the health of a piece that was attacked,
+/// which takes time in the order of the pieces changed, instead of all pieces.
+/// The values are integers, so that adding and removing
+/// a feature again gives exactly the same values
+class nnue_accumulator
+{
+public:
+  /// @param network the network to use the weights of,
+  ///   which must outlive the accumulator
+  explicit nnue_accumulator(const nnue_network& network);
+
+  /// Get the number of pieces whose features were
+  /// added or removed by the last update
+  auto get_n_changed() const noexcept { return m_n_changed; }
+
+  const auto& get_network() const noexcept { return *m_network; }
+
+  /// Get the 'get_nnue_n_accumulated' values of the view of a player
+  const std::int16_t* get_values(const chess_color c) const noexcept
+  {
+    return m_values[static_cast<int>(c)].data();
+  }
+
+  /// Make the accumulator match the pieces in the game,
+  /// changing only the features of the pieces that changed
+  void update(const game& g);
+
+  /// Make the accumulator match the pieces,
+  /// changing only the features of the pieces that changed
+  void update(const std::vector<piece>& pieces);
+
+private:
+
+  const nnue_network* m_network;
+
+  /// The values per view, indexed by the color of the viewer,
+  /// aligned for the vector instructions
+  alignas(64) std::array<std::array<std::int16_t, get_nnue_n_accumulated()>, 2> m_values;
+
+  /// The number of updates done
+  int m_n_updates;
+
+  /// The number of pieces whose features were changed by the last update
+  int m_n_changed;
+
+  /// Per piece ID value, the features added,
+  /// and the last update the piece was seen at
+  std::unordered_map<int, std::pair<nnue_stamp, int>> m_stamps;
+
+  /// Add or remove one feature of a view, where -1 denotes no feature
+  /// @param sign 1 to add, -1 to remove the feature
+  void apply(const chess_color c, const int feature, const int sign) noexcept;
+};
+
+/// Add (sign 1) or subtract (sign -1) the weights of a feature
+/// from the 'get_nnue_n_accumulated' values of an accumulator
+/// @param kernel the kernel to use, which the CPU must be able to do
+void apply_nnue_weights(
+  std::int16_t* values,
+  const std::int16_t* weights,
+  const int sign,
+  const nnue_kernel kernel = get_nnue_kernel()
+) noexcept;
+
+/// Measure how long an update of the accumulator and an evaluation
+/// of an 'nnue_network' take, and how many of both are done per second,
+/// on the different board sizes,
+/// for a large-army match in which all pieces keep moving and attacking.
+/// Run the game with '--benchmark-nnue' to see the results.
+/// Use a release build, as the debug asserts dominate the timings
+void benchmark_nnue(std::ostream& os, const int n_ticks = 1000);
+
+/// Get the features of a piece, as added to the accumulator
+nnue_stamp create_nnue_stamp(const piece& p, const int board_size) noexcept;
+
+/// Get the input features of a piece, as seen by a player,
+/// which are the index of its color, type and square,
+/// the index of its color, type and health, in quarters,
+/// and the index of its color, the type and the target square of its
+/// current action, where -1 denotes no action.
+/// Black sees the board mirrored and the colors swapped,
+/// so that both players see their own pieces the same
+std::array<int, 3> get_nnue_features(
+  const piece& p,
+  const chess_color viewer,
+  const int board_size
+) noexcept;
+
+/// Get the kernels that the CPU the game runs on can do,
+/// from the slowest, 'nnue_kernel::scalar', to the fastest
+std::vector<nnue_kernel> get_nnue_kernels();
+
+/// Get the number of input features of a network
+int get_n_nnue_features(const int board_size) noexcept;
+
+/// Do the hidden layer of an 'nnue_network' on the values of one view:
+/// the clipped ReLU of the values, multiplied by the weights,
+/// plus the biases, scaled down, then clipped again
+/// @param weights per hidden neuron, 'get_nnue_n_accumulated' weights
+/// @param hidden the 'get_nnue_n_hidden' outputs are written here
+/// @param kernel the kernel to use, which the CPU must be able to do
+void propagate_nnue_hidden_layer(
+  const std::int16_t* values,
+  const std::int8_t* weights,
+  const std::int32_t* biases,
+  std::uint8_t* hidden,
+  const nnue_kernel kernel = get_nnue_kernel()
+) noexcept;
+
+/// Test these classes and their free functions
+void test_nnue();
+
+/// Get the name of a kernel, e.g. 'avx2'
+std::string to_str(const nnue_kernel k) noexcept;
+
+bool operator==(const nnue_stamp& lhs, const nnue_stamp& rhs) noexcept;
+bool operator!=(const nnue_stamp& lhs, const nnue_stamp& rhs) noexcept;
+
+#endif // NNUE_H
@@ -0,0 +1,154 @@
+#include "occupancy_grid.h"
+
+#include "piece.h"
+#include "pieces.h"
+
+#include <algorithm>
+#include <cassert>
+
+occupancy_grid::occupancy_grid(const int board_size)
+  : m_board_size{board_size},
+    m_indices(board_size * board_size, -1),
+    m_occupied{},
+    m_version{0}
+{
+  assert(m_board_size > 0);
+  assert(m_board_size <= get_max_board_size());
+}
+
+int count_occupied_squares(const occupancy_grid& g) noexcept
+{
+  int n{0};
+  const int board_size{g.get_board_size()};
+  for (int x{0}; x != board_size; ++x)
+  {
+    for (int y{0}; y != board_size; ++y)
+    {
+      if (g.get_index(x, y) != -1) ++n;
+    }
+  }
+  return n;
+}
+
+int occupancy_grid::get_index(const square& s) const noexcept
+{
+  return get_index(s.get_x(), s.get_y());
+}
+
+int occupancy_grid::get_index(const int x, const int y) const noexcept
+{
+  assert(is_valid_square_xy(x, y, m_board_size));
+  return m_indices[(x * m_board_size) + y];
+}
+
+bool occupancy_grid::is_occupied(const square& s) const noexcept
+{
+  return get_index(s) != -1;
+}
+
+void occupancy_grid::reset(const square& s) noexcept
+{
+  assert(is_valid_square_xy(s.get_x(), s.get_y(), m_board_size));
+  m_indices[(s.get_x() * m_board_size) + s.get_y()] = -1;
+  if (m_occupied.is_set(s))
+  {
+    m_occupied.reset(s);
+    ++m_version;
+  }
+}
+
+void occupancy_grid::set(const square& s, const int index) noexcept
+{
+  assert(is_valid_square_xy(s.get_x(), s.get_y(), m_board_size));
+  assert(index >= 0);
+  m_indices[(s.get_x() * m_board_size) + s.get_y()] = index;
+  if (!m_occupied.is_set(s))
+  {
+    m_occupied.set(s);
+    ++m_version;
+  }
+}
+
+void occupancy_grid::update(const std::vector<piece>& pieces)
+{
+  std::fill(std::begin(m_indices), std::end(m_indices), -1);
+  bitboard occupied;
+  const int n_pieces{static_cast<int>(pieces.size())};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    const auto& s{pieces[i].get_current_square()};
+    assert(!is_occupied(s));
+    m_indices[(s.get_x() * m_board_size) + s.get_y()] = i;
+    occupied.set(s);
+  }
+  // Only a different set of occupied squares is a new version
+  if (occupied != m_occupied)
+  {
+    m_occupied = occupied;
+    ++m_version;
+  }
+}
+
+void test_occupancy_grid()
+{
+#ifndef NDEBUG
+  // An empty grid has no pieces
+  {
+    const occupancy_grid g;
+    assert(g.get_board_size() == 8);
+    assert(count_occupied_squares(g) == 0);
+    assert(!g.is_occupied(square("e4")));
+    assert(g.get_index(square("e4")) == -1);
+  }
+  // occupancy_grid::update
+  {
+    const auto pieces{get_standard_starting_pieces()};
+    occupancy_grid g;
+    g.update(pieces);
+    assert(count_occupied_squares(g) == 32);
+    const int i{g.get_index(square("d1"))};
+    assert(i != -1);
+    assert(pieces[i].get_type() == piece_type::queen);
+    assert(!g.is_occupied(square("e4")));
+  }
+  // occupancy_grid::set and occupancy_grid::reset
+  {
+    occupancy_grid g(32);
+    g.set(square("af32"), 42);
+    assert(g.get_index(square("af32")) == 42);
+    assert(g.get_index(31, 31) == 42);
+    assert(count_occupied_squares(g) == 1);
+    g.reset(square("af32"));
+    assert(!g.is_occupied(square("af32")));
+  }
+  // occupancy_grid::get_version only changes when squares are entered or left
+  {
+    const auto pieces{get_standard_starting_pieces()};
+    occupancy_grid g;
+    const int v0{g.get_version()};
+    g.update(pieces);
+    const int v1{g.get_version()};
+    assert(v1 != v0);
+    assert(count_squares(g.get_occupied()) == 32);
+    g.update(pieces);
+    assert(g.get_version() == v1);
+    // Another piece on an occupied square
+    g.set(square("e1"), 3);
+    assert(g.get_version() == v1);
+    g.set(square("e4"), 3);
+    assert(g.get_version() != v1);
+    const int v2{g.get_version()};
+    g.reset(square("e5"));
+    assert(g.get_version() == v2);
+    g.reset(square("e4"));
+    assert(g.get_version() != v2);
+  }
+  // occupancy_grid::update on a large board
+  {
+    const auto pieces{get_standard_starting_pieces(chess_color::white, 32)};
+    occupancy_grid g(32);
+    g.update(pieces);
+    assert(count_occupied_squares(g) == static_cast<int>(pieces.size()));
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,75 @@
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+#include "ccfwd.h"
+#include "bitboard.h"
+#include "square.h"
+
+#include <vector>
+
+/// Which piece is at which square,
+/// to find a piece at a square in constant time,
+/// instead of searching all pieces.
+/// The pieces are denoted by their index in the collection of pieces
+class occupancy_grid
+{
+public:
+  /// Create an empty grid
+  explicit occupancy_grid(const int board_size = get_default_board_size());
+
+  /// Get the number of squares along one side of the board
+  int get_board_size() const noexcept { return m_board_size; }
+
+  /// Get the squares that are occupied
+  const auto& get_occupied() const noexcept { return m_occupied; }
+
+  /// Get the version of the occupied squares,
+  /// which increases each time a square is entered or left,
+  /// so that what is calculated from the occupied squares
+  /// can be reused for as long as the version stays the same
+  int get_version() const noexcept { return m_version; }
+
+  /// Get the index of the piece at a square,
+  /// which is -1 if there is no piece there
+  int get_index(const square& s) const noexcept;
+
+  /// Get the index of the piece at an x and y,
+  /// which is -1 if there is no piece there
+  int get_index(const int x, const int y) const noexcept;
+
+  /// Is there a piece at the square?
+  bool is_occupied(const square& s) const noexcept;
+
+  /// Remove the piece at the square
+  void reset(const square& s) noexcept;
+
+  /// Put the piece with the index at the square,
+  /// replacing the piece that was there, if any
+  void set(const square& s, const int index) noexcept;
+
+  /// Rebuild the grid from scratch,
+  /// which is needed after pieces have been removed
+  void update(const std::vector<piece>& pieces);
+
+private:
+
+  int m_board_size;
+
+  /// The index of the piece at each square, which is -1 if empty,
+  /// where 'x * board_size + y' is the square at (x, y)
+  std::vector<int> m_indices;
+
+  /// The squares that are occupied
+  bitboard m_occupied;
+
+  /// The version of the occupied squares
+  int m_version;
+};
+
+/// Count the number of squares that are occupied
+int count_occupied_squares(const occupancy_grid& g) noexcept;
+
+/// Test this class and its free functions
+void test_occupancy_grid();
+
+#endif // OCCUPANCY_GRID_H
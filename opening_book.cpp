@@ -0,0 +1,350 @@
+#include "opening_book.h"
+
+#include "pgn.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+/// The bytes before the entries in an opening book file:
+/// 'CCOB', the version, three zeroes and the number of entries
+constexpr int get_opening_book_header_size() noexcept { return 16; }
+
+/// The bytes per entry in an opening book file: the hash,
+/// the numbers of games, wins and draws, and the squares moved from and to
+constexpr int get_opening_book_entry_size() noexcept { return 24; }
+
+opening_book::opening_book(const std::string& filename)
+  : m_file(filename),
+    m_n_entries{0}
+{
+  const auto data{m_file.get_data()};
+  if (m_file.get_size() < static_cast<std::size_t>(get_opening_book_header_size())
+    || std::memcmp(data, "CCOB", 4) != 0
+    || data[4] != 1
+    || data[5] != 0
+    || data[6] != 0
+    || data[7] != 0
+  )
+  {
+    throw std::runtime_error("File '" + filename + "' is no opening book");
+  }
+  std::uint64_t n_entries{0};
+  for (int i{7}; i >= 0; --i) n_entries = (n_entries << 8) | data[8 + i];
+  if (n_entries != (m_file.get_size() - get_opening_book_header_size()) / get_opening_book_entry_size()
+    || (m_file.get_size() - get_opening_book_header_size()) % get_opening_book_entry_size() != 0
+  )
+  {
+    throw std::runtime_error("Opening book '" + filename + "' has the wrong size");
+  }
+  m_n_entries = static_cast<std::int64_t>(n_entries);
+}
+
+std::vector<opening_book_entry> opening_book::probe(const std::uint64_t hash) const
+{
+  const auto entries{m_file.get_data() + get_opening_book_header_size()};
+  // Read an unsigned number, stored least significant byte first
+  const auto read{
+    [](const std::uint8_t* p, const int n_bytes)
+    {
+      std::uint64_t value{0};
+      for (int i{n_bytes - 1}; i >= 0; --i) value = (value << 8) | p[i];
+      return value;
+    }
+  };
+  const auto get_hash{
+    [entries, read](const std::int64_t i)
+    {
+      return read(entries + (i * get_opening_book_entry_size()), 8);
+    }
+  };
+  // The first entry with a hash that is not less
+  std::int64_t first{0};
+  std::int64_t last{m_n_entries};
+  while (first < last)
+  {
+    const std::int64_t middle{first + ((last - first) / 2)};
+    if (get_hash(middle) < hash) first = middle + 1;
+    else last = middle;
+  }
+  std::vector<opening_book_entry> moves;
+  for (std::int64_t i{first}; i != m_n_entries && get_hash(i) == hash; ++i)
+  {
+    const auto e{entries + (i * get_opening_book_entry_size())};
+    moves.push_back(
+      opening_book_entry{
+        hash,
+        static_cast<int>(read(e + 20, 2)),
+        static_cast<int>(read(e + 22, 2)),
+        static_cast<int>(read(e + 8, 4)),
+        static_cast<int>(read(e + 12, 4)),
+        static_cast<int>(read(e + 16, 4))
+      }
+    );
+  }
+  return moves;
+}
+
+std::vector<opening_book_entry> opening_book::probe(const chess_position& p) const
+{
+  return probe(p.get_hash());
+}
+
+const opening_book_entry& choose_opening_book_move(
+  const std::vector<opening_book_entry>& moves,
+  std::mt19937& rng_engine
+)
+{
+  assert(!moves.empty());
+  std::vector<int> weights;
+  weights.reserve(moves.size());
+  for (const auto& m: moves) weights.push_back(m.m_n_games);
+  std::discrete_distribution<int> d(std::begin(weights), std::end(weights));
+  return moves[d(rng_engine)];
+}
+
+std::vector<opening_book_entry> compile_opening_book(
+  std::istream& pgn,
+  const opening_book_options& options
+)
+{
+  assert(options.m_max_n_plies >= 0);
+  assert(options.m_min_n_games >= 1);
+  const auto start{create_chess_position(starting_position_type::standard).get_board()};
+  assert(start.size() == 64);
+
+  // The number of games, wins and draws per position hash,
+  // square moved from and square moved to
+  std::map<std::tuple<std::uint64_t, int, int>, std::array<int, 3>> counts;
+
+  read_pgn_games(
+    pgn,
+    [&](const std::vector<std::string>& moves, const std::string& result)
+    {
+      auto board{start};
+      chess_color color{chess_color::white};
+      for (const auto& s: moves)
+      {
+        const auto hash{chess_position(board, color, 8).get_hash()};
+        const auto m{do_pgn_move(board, color, s)};
+        if (!m) break;
+        auto& c{counts[std::make_tuple(hash, int{m->m_from}, int{m->m_to})]};
+        ++c[0];
+        if (result == "1/2-1/2") ++c[2];
+        else if (result == (color == chess_color::white ? "1-0" : "0-1")) ++c[1];
+        color = get_other_color(color);
+      }
+    },
+    options.m_max_n_plies
+  );
+
+  std::vector<opening_book_entry> entries;
+  for (const auto& [key, c]: counts)
+  {
+    if (c[0] < options.m_min_n_games) continue;
+    entries.push_back(
+      opening_book_entry{std::get<0>(key), std::get<1>(key), std::get<2>(key), c[0], c[1], c[2]}
+    );
+  }
+  std::stable_sort(
+    std::begin(entries),
+    std::end(entries),
+    [](const auto& lhs, const auto& rhs)
+    {
+      if (lhs.m_hash != rhs.m_hash) return lhs.m_hash < rhs.m_hash;
+      return lhs.m_n_games > rhs.m_n_games;
+    }
+  );
+  return entries;
+}
+
+void generate_opening_book(
+  const std::string& pgn_filename,
+  const std::string& filename,
+  const opening_book_options& options
+)
+{
+  std::ifstream f(pgn_filename);
+  if (!f)
+  {
+    throw std::runtime_error("Cannot open '" + pgn_filename + "'");
+  }
+  save_opening_book(compile_opening_book(f, options), filename);
+}
+
+opening_book_options get_default_opening_book_options() noexcept
+{
+  return opening_book_options{16, 2};
+}
+
+void save_opening_book(
+  const std::vector<opening_book_entry>& entries,
+  const std::string& filename
+)
+{
+  assert(
+    std::is_sorted(
+      std::begin(entries),
+      std::end(entries),
+      [](const auto& lhs, const auto& rhs) { return lhs.m_hash < rhs.m_hash; }
+    )
+  );
+  std::vector<std::uint8_t> bytes;
+  bytes.reserve(get_opening_book_header_size() + (entries.size() * get_opening_book_entry_size()));
+  // Write an unsigned number, least significant byte first
+  const auto write{
+    [&bytes](std::uint64_t value, const int n_bytes)
+    {
+      for (int i{0}; i != n_bytes; ++i)
+      {
+        bytes.push_back(static_cast<std::uint8_t>(value & 0xff));
+        value >>= 8;
+      }
+    }
+  };
+  bytes.insert(std::end(bytes), { 'C', 'C', 'O', 'B', 1, 0, 0, 0 });
+  write(entries.size(), 8);
+  for (const auto& e: entries)
+  {
+    assert(e.m_n_games >= e.m_n_wins + e.m_n_draws);
+    write(e.m_hash, 8);
+    write(e.m_n_games, 4);
+    write(e.m_n_wins, 4);
+    write(e.m_n_draws, 4);
+    write(e.m_from, 2);
+    write(e.m_to, 2);
+  }
+  std::ofstream f(filename, std::ios::binary);
+  f.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  if (!f)
+  {
+    throw std::runtime_error("Cannot write opening book to '" + filename + "'");
+  }
+}
+
+void test_opening_book()
+{
+#ifndef NDEBUG
+  const auto start{create_chess_position(starting_position_type::standard)};
+  const auto get_index{[](const std::string& s) { return ((s[1] - '1') * 8) + (s[0] - 'a'); }};
+  // compile_opening_book
+  const std::string pgn{
+    "[Event \"A\"]\n"
+    "[Result \"1-0\"]\n"
+    "\n"
+    "1. e4 e5 2. Nf3 {A comment, with 1. d4} Nc6 (2... d6 3. d4) 3. Bc4 1-0\n"
+    "\n"
+    "[Event \"B\"]\n"
+    "[Result \"0-1\"]\n"
+    "\n"
+    "1. e4 { [%clk 0:03:00]\n"
+    "} 1... c5 0-1\n"
+    "\n"
+    "[Event \"C\"]\n"
+    "[Result \"1/2-1/2\"]\n"
+    "\n"
+    "1.d4 d5 1/2-1/2\n"
+  };
+  {
+    std::istringstream s(pgn);
+    const auto entries{compile_opening_book(s, opening_book_options{4, 1})};
+    assert(entries.size() == 7);
+    const auto first{
+      std::find_if(
+        std::begin(entries),
+        std::end(entries),
+        [&start](const auto& e) { return e.m_hash == start.get_hash(); }
+      )
+    };
+    assert(first != std::end(entries));
+    assert(first->m_from == get_index("e2"));
+    assert(first->m_to == get_index("e4"));
+    assert(first->m_n_games == 2);
+    assert(first->m_n_wins == 1);
+    assert(first->m_n_draws == 0);
+    const auto second{first + 1};
+    assert(second->m_hash == start.get_hash());
+    assert(second->m_from == get_index("d2"));
+    assert(second->m_n_games == 1);
+    assert(second->m_n_draws == 1);
+  }
+  {
+    std::istringstream s(pgn);
+    assert(compile_opening_book(s, opening_book_options{4, 2}).size() == 1);
+  }
+  // Saving and probing an opening book
+  {
+    const std::string filename{"test_opening_book.ccob"};
+    std::istringstream s(pgn);
+    save_opening_book(compile_opening_book(s, opening_book_options{4, 1}), filename);
+    const opening_book book(filename);
+    assert(book.get_n_entries() == 7);
+    const auto moves{book.probe(start)};
+    assert(moves.size() == 2);
+    assert(moves[0].m_to == get_index("e4"));
+    assert(moves[0].m_n_games == 2);
+    assert(moves[0].m_n_wins == 1);
+    assert(moves[1].m_to == get_index("d4"));
+    assert(moves[1].m_n_draws == 1);
+    auto board{start.get_board()};
+    do_pgn_move(board, chess_color::white, "e4");
+    const auto replies{book.probe(chess_position(board, chess_color::black, 8))};
+    assert(replies.size() == 2);
+    // Black won the game with 'c5'
+    const auto c5{replies[0].m_to == get_index("c5") ? replies[0] : replies[1]};
+    assert(c5.m_n_wins == 1);
+    assert(book.probe(chess_position(board, chess_color::white, 8)).empty());
+
+    std::mt19937 rng_engine(42);
+    for (int i{0}; i != 10; ++i)
+    {
+      const auto& m{choose_opening_book_move(moves, rng_engine)};
+      assert(m.m_from == get_index("e2") || m.m_from == get_index("d2"));
+    }
+    std::remove(filename.c_str());
+  }
+  // An empty opening book
+  {
+    const std::string filename{"test_opening_book_empty.ccob"};
+    save_opening_book({}, filename);
+    const opening_book book(filename);
+    assert(book.get_n_entries() == 0);
+    assert(book.probe(start).empty());
+    std::remove(filename.c_str());
+  }
+  // A file that is no opening book
+  {
+    const std::string filename{"test_opening_book_invalid.ccob"};
+    {
+      std::ofstream f(filename);
+      f << "This is no opening book, yet is long enough to have a header";
+    }
+    bool has_thrown{false};
+    try { opening_book book(filename); }
+    catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+    std::remove(filename.c_str());
+  }
+  // A PGN file that does not exist
+  {
+    bool has_thrown{false};
+    try
+    {
+      generate_opening_book(
+        "test_opening_book_absent.pgn",
+        "test_opening_book_absent.ccob",
+        get_default_opening_book_options()
+      );
+    }
+    catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,124 @@
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "chess_position.h"
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <random>
+#include <string>
+#include <vector>
+
+/// A move in a position of an opening book,
+/// with how often it was played and how these games ended
+struct opening_book_entry
+{
+  /// The Zobrist hash of the position, as by 'chess_position::get_hash'
+  std::uint64_t m_hash;
+
+  /// The square index moved from
+  int m_from;
+
+  /// The square index moved to
+  int m_to;
+
+  /// The number of games in which the move was played
+  int m_n_games;
+
+  /// The number of these games won by the player that moved
+  int m_n_wins;
+
+  /// The number of these games that were a draw
+  int m_n_draws;
+};
+
+/// How to compile an opening book from chess games
+struct opening_book_options
+{
+  /// The number of plies per game that are put in the book
+  int m_max_n_plies;
+
+  /// The number of games a move must be played in to be put in the book
+  int m_min_n_games;
+};
+
+/// An opening book, as written by 'save_opening_book',
+/// that is memory-mapped, so that a probe reads
+/// only the entries visited by a binary search
+class opening_book
+{
+public:
+  /// Map an opening book file into memory.
+  /// Throws if the file cannot be read or is no opening book
+  explicit opening_book(const std::string& filename);
+
+  /// Get the number of moves in the book, of all positions
+  auto get_n_entries() const noexcept { return m_n_entries; }
+
+  /// Get the moves of a position, most played first,
+  /// which is empty if the position is not in the book
+  std::vector<opening_book_entry> probe(const std::uint64_t hash) const;
+
+  /// Get the moves of a position, most played first,
+  /// which is empty if the position is not in the book
+  std::vector<opening_book_entry> probe(const chess_position& p) const;
+
+private:
+
+  /// The file, of which a probe reads a few entries
+  mapped_file m_file;
+
+  std::int64_t m_n_entries;
+};
+
+/// Choose a move from the moves of a position in an opening book,
+/// at random, in proportion to how often each was played.
+/// The moves must not be empty
+const opening_book_entry& choose_opening_book_move(
+  const std::vector<opening_book_entry>& moves,
+  std::mt19937& rng_engine
+);
+
+/// Compile an opening book from chess games in PGN notation,
+/// such as the ones downloaded by 'scripts/download_chess_games.sh'.
+///
+/// The games are read by 'read_pgn_games', one line at a time, so a file
+/// of any size can be read, yet a move in a position is counted
+/// in memory, until the end.
+/// Each game is replayed on a board from the standard starting position,
+/// counting the moves and the result of the game, per position.
+/// A game that has a move that cannot be done is used up to that move.
+///
+/// @return the moves that are played often enough, ordered by position
+///   hash, with the moves of the same position most played first
+std::vector<opening_book_entry> compile_opening_book(
+  std::istream& pgn,
+  const opening_book_options& options
+);
+
+/// Compile an opening book from a file with chess games in PGN notation
+/// and save it. Throws if a file cannot be read or written
+void generate_opening_book(
+  const std::string& pgn_filename,
+  const std::string& filename,
+  const opening_book_options& options
+);
+
+/// Get the options to compile an opening book with, when not specified otherwise
+opening_book_options get_default_opening_book_options() noexcept;
+
+/// Save the moves of an opening book to a file,
+/// where the moves must be ordered by position hash.
+/// Throws if the file cannot be written
+void save_opening_book(
+  const std::vector<opening_book_entry>& entries,
+  const std::string& filename
+);
+
+/// Test this class and its free functions
+void test_opening_book();
+
+#endif // OPENING_BOOK_H
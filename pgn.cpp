@@ -0,0 +1,421 @@
+#include "pgn.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <sstream>
+
+bool can_do_standard_chess_move(
+  const std::vector<std::int8_t>& board,
+  const int from,
+  const int to
+)
+{
+  assert(board.size() == 64);
+  const int code{board[from]};
+  if (code == 0 || from == to) return false;
+  const int target{board[to]};
+  if (target != 0 && (target > 0) == (code > 0)) return false;
+  const int dx{(to / 8) - (from / 8)};
+  const int dy{(to % 8) - (from % 8)};
+  switch (get_piece_type(code))
+  {
+    case piece_type::bishop:
+      if (std::abs(dx) != std::abs(dy)) return false;
+      break;
+    case piece_type::king:
+      return std::max(std::abs(dx), std::abs(dy)) == 1;
+    case piece_type::knight:
+      return std::abs(dx) * std::abs(dy) == 2;
+    case piece_type::pawn:
+    {
+      const int forward{code > 0 ? 1 : -1};
+      if (dy != 0)
+      {
+        if (std::abs(dy) != 1 || dx != forward) return false;
+        // A capture, or en passant when to an empty square
+        return target != 0 || board[((from / 8) * 8) + (to % 8)] == -code;
+      }
+      if (target != 0) return false;
+      if (dx == forward) return true;
+      const int start_rank{code > 0 ? 1 : 6};
+      return dx == 2 * forward
+        && from / 8 == start_rank
+        && board[from + (8 * forward)] == 0
+      ;
+    }
+    case piece_type::queen:
+      if (dx != 0 && dy != 0 && std::abs(dx) != std::abs(dy)) return false;
+      break;
+    case piece_type::rook:
+      if (dx != 0 && dy != 0) return false;
+      break;
+  }
+  // The squares in between must be empty
+  const int step{(dx > 0 ? 8 : dx < 0 ? -8 : 0) + (dy > 0 ? 1 : dy < 0 ? -1 : 0)};
+  for (int i{from + step}; i != to; i += step)
+  {
+    if (board[i] != 0) return false;
+  }
+  return true;
+}
+
+std::optional<position_move> do_pgn_move(
+  std::vector<std::int8_t>& board,
+  const chess_color color,
+  const std::string& pgn_str
+)
+{
+  assert(board.size() == 64);
+  const int sign{color == chess_color::white ? 1 : -1};
+  const auto get_code{
+    [sign](const piece_type t) { return static_cast<std::int8_t>(sign * (static_cast<int>(t) + 1)); }
+  };
+  const auto to_piece_type{
+    [](const char c) -> std::optional<piece_type>
+    {
+      switch (c)
+      {
+        case 'B': return piece_type::bishop;
+        case 'K': return piece_type::king;
+        case 'N': return piece_type::knight;
+        case 'Q': return piece_type::queen;
+        case 'R': return piece_type::rook;
+      }
+      return {};
+    }
+  };
+  // Remove the check, checkmate and annotation symbols
+  std::string s{pgn_str};
+  while (!s.empty() && (s.back() == '+' || s.back() == '#' || s.back() == '!' || s.back() == '?'))
+  {
+    s.pop_back();
+  }
+  if (s == "O-O" || s == "0-0" || s == "O-O-O" || s == "0-0-0")
+  {
+    const int rank{color == chess_color::white ? 0 : 7};
+    const bool is_long{s.size() == 5};
+    const int king_from{(rank * 8) + 4};
+    const int king_to{(rank * 8) + (is_long ? 2 : 6)};
+    const int rook_from{(rank * 8) + (is_long ? 0 : 7)};
+    const int rook_to{(rank * 8) + (is_long ? 3 : 5)};
+    if (board[king_from] != get_code(piece_type::king)
+      || board[rook_from] != get_code(piece_type::rook)
+    )
+    {
+      return {};
+    }
+    for (int i{std::min(king_from, rook_from) + 1}; i != std::max(king_from, rook_from); ++i)
+    {
+      if (board[i] != 0) return {};
+    }
+    board[king_from] = 0;
+    board[rook_from] = 0;
+    board[king_to] = get_code(piece_type::king);
+    board[rook_to] = get_code(piece_type::rook);
+    return position_move{
+      static_cast<std::int16_t>(king_from),
+      static_cast<std::int16_t>(king_to),
+      0
+    };
+  }
+  // The type promoted to, e.g. 'e8=Q' or 'e8Q', if any
+  std::optional<piece_type> promotion_type;
+  if (s.size() > 2 && to_piece_type(s.back()))
+  {
+    promotion_type = to_piece_type(s.back());
+    s.pop_back();
+    if (s.back() == '=') s.pop_back();
+  }
+  piece_type type{piece_type::pawn};
+  if (!s.empty() && to_piece_type(s[0]))
+  {
+    type = *to_piece_type(s[0]);
+    s.erase(0, 1);
+  }
+  if (promotion_type && type != piece_type::pawn) return {};
+  s.erase(std::remove(std::begin(s), std::end(s), 'x'), std::end(s));
+  if (s.size() < 2 || s.size() > 4) return {};
+  const char file{s[s.size() - 2]};
+  const char rank{s.back()};
+  if (file < 'a' || file > 'h' || rank < '1' || rank > '8') return {};
+  const int to{((rank - '1') * 8) + (file - 'a')};
+
+  // The pieces that can get there, of which the file and/or rank
+  // are given if there would be multiple otherwise
+  const std::string hint{s.substr(0, s.size() - 2)};
+  std::optional<position_move> m;
+  std::vector<std::int8_t> after;
+  for (int from{0}; from != 64; ++from)
+  {
+    if (board[from] != get_code(type)) continue;
+    const bool is_hinted{
+      std::all_of(
+        std::begin(hint),
+        std::end(hint),
+        [from](const char c)
+        {
+          return c == 'a' + (from % 8) || c == '1' + (from / 8);
+        }
+      )
+    };
+    if (!is_hinted || !can_do_standard_chess_move(board, from, to)) continue;
+    auto next{board};
+    if (type == piece_type::pawn && from % 8 != to % 8 && next[to] == 0)
+    {
+      // En passant
+      next[((from / 8) * 8) + (to % 8)] = 0;
+    }
+    next[to] = promotion_type ? get_code(*promotion_type) : next[from];
+    next[from] = 0;
+    // A piece that cannot move without leaving its king in check
+    // is not mentioned in the hint
+    if (is_in_check(next, color)) continue;
+    if (m) return {};
+    m = position_move{
+      static_cast<std::int16_t>(from),
+      static_cast<std::int16_t>(to),
+      board[to]
+    };
+    after = next;
+  }
+  if (m) board = after;
+  return m;
+}
+
+bool is_in_check(
+  const std::vector<std::int8_t>& board,
+  const chess_color color
+)
+{
+  assert(board.size() == 64);
+  const int sign{color == chess_color::white ? 1 : -1};
+  const auto king{
+    std::find(std::begin(board), std::end(board), sign * (static_cast<int>(piece_type::king) + 1))
+  };
+  if (king == std::end(board)) return false;
+  const int to{static_cast<int>(std::distance(std::begin(board), king))};
+  for (int from{0}; from != 64; ++from)
+  {
+    if (board[from] * sign < 0 && can_do_standard_chess_move(board, from, to)) return true;
+  }
+  return false;
+}
+
+void read_pgn_games(
+  std::istream& is,
+  const pgn_game_callback& f,
+  const int max_n_plies
+)
+{
+  assert(max_n_plies >= 0);
+
+  // The moves and result of the game being read
+  std::vector<std::string> moves;
+  std::string result;
+
+  const auto add_game{
+    [&]()
+    {
+      f(moves, result);
+      moves.clear();
+      result.clear();
+    }
+  };
+
+  // Comments, between braces, and variations, between parentheses,
+  // may span multiple lines
+  bool is_in_comment{false};
+  int variation_depth{0};
+  const auto add_token{
+    [&](std::string token)
+    {
+      if (token.empty() || variation_depth != 0) return;
+      if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*")
+      {
+        if (result.empty()) result = token;
+        add_game();
+        return;
+      }
+      // Remove the move number, e.g. '12.' or '12...'
+      const auto dot{token.find_last_of('.')};
+      if (dot != std::string::npos) token.erase(0, dot + 1);
+      if (token.empty() || token[0] == '$') return;
+      if (static_cast<int>(moves.size()) < max_n_plies) moves.push_back(token);
+    }
+  };
+
+  std::string line;
+  while (std::getline(is, line))
+  {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!is_in_comment && variation_depth == 0 && !line.empty() && (line[0] == '[' || line[0] == '%'))
+    {
+      // A tag starts a new game, also if the last one has no result
+      if (!moves.empty()) add_game();
+      if (line.compare(0, 9, "[Result \"") == 0)
+      {
+        result = line.substr(9, line.find('"', 9) - 9);
+      }
+      continue;
+    }
+    std::string token;
+    for (const char c: line)
+    {
+      if (is_in_comment)
+      {
+        if (c == '}') is_in_comment = false;
+        continue;
+      }
+      if (c == '{' || c == '(' || c == ')' || c == ';' || c == ' ' || c == '\t')
+      {
+        add_token(token);
+        token.clear();
+        if (c == ';') break;
+        if (c == '{') is_in_comment = true;
+        if (c == '(') ++variation_depth;
+        if (c == ')' && variation_depth > 0) --variation_depth;
+        continue;
+      }
+      token += c;
+    }
+    add_token(token);
+  }
+  if (!moves.empty()) add_game();
+
+}
+
+void test_pgn()
+{
+#ifndef NDEBUG
+  const auto start{create_chess_position(starting_position_type::standard)};
+  const auto get_index{[](const std::string& s) { return ((s[1] - '1') * 8) + (s[0] - 'a'); }};
+  // can_do_standard_chess_move
+  {
+    const auto& board{start.get_board()};
+    assert(can_do_standard_chess_move(board, get_index("e2"), get_index("e4")));
+    assert(can_do_standard_chess_move(board, get_index("g1"), get_index("f3")));
+    assert(can_do_standard_chess_move(board, get_index("e7"), get_index("e5")));
+    assert(!can_do_standard_chess_move(board, get_index("e2"), get_index("e5")));
+    assert(!can_do_standard_chess_move(board, get_index("c1"), get_index("e3")));
+    assert(!can_do_standard_chess_move(board, get_index("d1"), get_index("d2")));
+    assert(!can_do_standard_chess_move(board, get_index("e4"), get_index("e5")));
+  }
+  // do_pgn_move, a full game
+  {
+    auto board{start.get_board()};
+    chess_color color{chess_color::white};
+    for (const std::string s: { "e4", "e5", "Qh5", "Nc6", "Bc4", "Nf6??", "Qxf7#" })
+    {
+      assert(do_pgn_move(board, color, s));
+      color = get_other_color(color);
+    }
+    assert(board[get_index("f7")] == static_cast<int>(piece_type::queen) + 1);
+    assert(is_in_check(board, chess_color::black));
+    assert(!is_in_check(board, chess_color::white));
+  }
+  // do_pgn_move, the file of the piece is needed
+  {
+    auto board{start.get_board()};
+    chess_color color{chess_color::white};
+    for (const std::string s: { "d4", "d5", "Nf3", "Nf6" })
+    {
+      assert(do_pgn_move(board, color, s));
+      color = get_other_color(color);
+    }
+    const auto before{board};
+    assert(!do_pgn_move(board, color, "Nd2"));
+    assert(board == before);
+    const auto m{do_pgn_move(board, color, "Nbd2")};
+    assert(m);
+    assert(m->m_from == get_index("b1"));
+    assert(m->m_to == get_index("d2"));
+  }
+  // do_pgn_move, a pinned piece is not mentioned
+  {
+    std::vector<std::int8_t> board(64, 0);
+    const std::int8_t knight{static_cast<int>(piece_type::knight) + 1};
+    const std::int8_t king{static_cast<int>(piece_type::king) + 1};
+    const std::int8_t bishop{static_cast<int>(piece_type::bishop) + 1};
+    board[get_index("e1")] = king;
+    board[get_index("c3")] = knight;
+    board[get_index("g3")] = knight;
+    board[get_index("a5")] = -bishop;
+    board[get_index("h8")] = -king;
+    const auto m{do_pgn_move(board, chess_color::white, "Ne4")};
+    assert(m);
+    assert(m->m_from == get_index("g3"));
+  }
+  // do_pgn_move, en passant, castling and promotion
+  {
+    auto board{start.get_board()};
+    chess_color color{chess_color::white};
+    for (const std::string s: { "e4", "a6", "e5", "d5", "exd6", "Nf6", "Nf3", "Ne4", "Bc4", "Nxf2", "O-O" })
+    {
+      assert(do_pgn_move(board, color, s));
+      color = get_other_color(color);
+    }
+    assert(board[get_index("d5")] == 0);
+    assert(board[get_index("d6")] == static_cast<int>(piece_type::pawn) + 1);
+    assert(board[get_index("g1")] == static_cast<int>(piece_type::king) + 1);
+    assert(board[get_index("f1")] == static_cast<int>(piece_type::rook) + 1);
+    assert(board[get_index("e1")] == 0);
+    assert(board[get_index("h1")] == 0);
+    assert(!do_pgn_move(board, color, "O-O-O"));
+    assert(!do_pgn_move(board, color, "Nh4"));
+    assert(!do_pgn_move(board, color, "Zz9"));
+
+    std::vector<std::int8_t> promotion(64, 0);
+    promotion[get_index("a7")] = static_cast<int>(piece_type::pawn) + 1;
+    assert(do_pgn_move(promotion, chess_color::white, "a8=N+"));
+    assert(promotion[get_index("a8")] == static_cast<int>(piece_type::knight) + 1);
+    assert(promotion[get_index("a7")] == 0);
+  }
+  // read_pgn_games
+  {
+    std::istringstream s(
+      "[Event \"A\"]\n"
+      "[Result \"1-0\"]\n"
+      "\n"
+      "1. e4 e5 2. Nf3 {A comment, with 1. d4} Nc6 (2... d6 3. d4) 3. Bc4 $1 1-0\n"
+      "\n"
+      "[Event \"B\"]\n"
+      "[Result \"0-1\"]\n"
+      "\n"
+      "1. e4 { [%clk 0:03:00]\n"
+      "} 1... c5 ; A comment till the end of the line 2. d4\n"
+      "0-1\n"
+      "\n"
+      "[Event \"C\"]\n"
+      "[Result \"1/2-1/2\"]\n"
+      "\n"
+      "1.d4 d5\n"
+      "\n"
+      "[Event \"D\"]\n"
+      "\n"
+      "1. c4 *\n"
+    );
+    std::vector<std::vector<std::string>> games;
+    std::vector<std::string> results;
+    read_pgn_games(
+      s,
+      [&](const std::vector<std::string>& moves, const std::string& result)
+      {
+        games.push_back(moves);
+        results.push_back(result);
+      },
+      4
+    );
+    assert(games.size() == 4);
+    assert(games[0] == std::vector<std::string>({ "e4", "e5", "Nf3", "Nc6" }));
+    assert(results[0] == "1-0");
+    assert(games[1] == std::vector<std::string>({ "e4", "c5" }));
+    assert(results[1] == "0-1");
+    // A game without a result is ended by the next one
+    assert(games[2] == std::vector<std::string>({ "d4", "d5" }));
+    assert(results[2] == "1/2-1/2");
+    assert(games[3] == std::vector<std::string>({ "c4" }));
+    assert(results[3] == "*");
+  }
+#endif // NDEBUG
+}
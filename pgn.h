@@ -0,0 +1,63 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include "chess_color.h"
+#include "chess_position.h"
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// A function that is called with the moves of a game in PGN notation,
+/// e.g. { "e4", "e5", "Nf3" }, and its result, e.g. '1-0',
+/// '0-1', '1/2-1/2', or '*' or empty if it is unknown
+using pgn_game_callback = std::function<
+  void(const std::vector<std::string>&, const std::string&)
+>;
+
+/// Is a move possible in standard chess, apart from castling,
+/// ignoring if the king of the player is in check afterwards?
+/// A pawn capture to an empty square, passing an enemy pawn,
+/// is taken to be en passant, as games in PGN notation have legal moves only
+bool can_do_standard_chess_move(
+  const std::vector<std::int8_t>& board,
+  const int from,
+  const int to
+);
+
+/// Do a move in standard chess, as in PGN notation, e.g. 'Nbxd7+',
+/// on an 8x8 board with pieces as by 'chess_position::get_at'
+/// @return the squares moved from and to, which, when castling,
+///   are the squares of the king, or nothing if the move cannot be done,
+///   in which case the board is unchanged
+std::optional<position_move> do_pgn_move(
+  std::vector<std::int8_t>& board,
+  const chess_color color,
+  const std::string& pgn_str
+);
+
+/// Is the king of a player attacked, as in standard chess?
+bool is_in_check(
+  const std::vector<std::int8_t>& board,
+  const chess_color color
+);
+
+/// Read games in PGN notation, such as the ones downloaded by
+/// 'scripts/download_chess_games.sh', calling a function per game.
+/// The games are read one line at a time, so a file of any size can be read.
+/// Comments, variations and annotations are skipped
+/// @param max_n_plies the number of moves per game that are kept
+void read_pgn_games(
+  std::istream& is,
+  const pgn_game_callback& f,
+  const int max_n_plies = std::numeric_limits<int>::max()
+);
+
+/// Test the free functions
+void test_pgn();
+
+#endif // PGN_H
@@ -1,5 +1,6 @@
 #include "piece.h"
 
+#include "collision_grid.h"
 #include "helper.h"
 #include "piece_type.h"
 #include "square.h"
@@ -107,6 +108,34 @@ void piece::add_message(const message_type& message)
   m_messages.push_back(message);
 }
 
+void add_route(
+  piece& p,
+  const square& from,
+  const std::vector<square>& route
+)
+{
+  assert(!route.empty());
+  // Only the first leg says the piece starts moving
+  p.add_action(
+    piece_action(p.get_player(), p.get_type(), piece_action_type::move, from, route[0])
+  );
+  const int n_legs{static_cast<int>(route.size())};
+  for (int i{1}; i != n_legs; ++i)
+  {
+    assert(can_move(p.get_type(), route[i - 1], route[i], p.get_player()));
+    const auto atomic_actions{
+      to_atomic(
+        piece_action(p.get_player(), p.get_type(), piece_action_type::move, route[i - 1], route[i])
+      )
+    };
+    std::copy(
+      std::begin(atomic_actions),
+      std::end(atomic_actions),
+      std::back_inserter(p.get_actions())
+    );
+  }
+}
+
 bool can_attack(
   const piece_type& type,
   const square& from,
@@ -194,6 +223,8 @@ bool can_move(
 void clear_actions(piece& p)
 {
   p.get_actions().clear();
+  // The progress was of the first action
+  p.set_current_action_time(delta_t(0.0));
   assert(count_piece_actions(p) == 0);
 }
 
@@ -225,23 +256,23 @@ std::string describe_actions(const piece& p)
   return t;
 }
 
-/*
 game_coordinat piece::get_coordinat() const noexcept
 {
   if (m_actions.empty()) return to_coordinat(m_current_square);
-  const auto first_action{m_actions[0]};
+  const auto& first_action{m_actions[0]};
   if (first_action.get_action_type() == piece_action_type::attack)
   {
     return to_coordinat(m_current_square);
   }
   assert(first_action.get_action_type() == piece_action_type::move);
-  const auto from{to_coordinat(m_current_square)};
+  // Use the start of the move, as the current square changes halfway
+  const auto from{to_coordinat(first_action.get_from())};
   const auto to{to_coordinat(first_action.get_to())};
   const auto full_delta{to - from};
-  const auto delta{full_delta * get_current_action_time().get()};
+  const double f{std::min(1.0, get_current_action_time().get())};
+  const auto delta{full_delta * f};
   return from + delta;
 }
-*/
 
 double get_f_health(const piece& p) noexcept
 {
@@ -254,10 +285,13 @@ square get_occupied_square(const piece& p) noexcept
   return p.get_current_square();
 }
 
-piece get_rotated_piece(const piece& p) noexcept
+piece get_rotated_piece(
+  const piece& p,
+  const int board_size
+) noexcept
 {
   piece q = p;
-  q.set_current_square(get_rotated_square(p.get_current_square()));
+  q.set_current_square(get_rotated_square(p.get_current_square(), board_size));
   //q.set_coordinat(get_rotated_coordinat(p.get_coordinat()));
   return q;
 }
@@ -304,6 +338,13 @@ void piece::receive_damage(const double damage)
   m_health -= damage;
 }
 
+void piece::set_max_health(const double max_health) noexcept
+{
+  assert(max_health > 0.0);
+  m_max_health = max_health;
+  m_health = max_health;
+}
+
 void select(piece& p) noexcept
 {
   p.set_selected(true);
@@ -389,6 +430,14 @@ void test_piece()
     const auto health_after{piece.get_health()};
     assert(health_after < health_before);
   }
+  // piece::set_max_health
+  {
+    auto piece{get_test_white_knight()};
+    piece.receive_damage(0.1);
+    piece.set_max_health(3.0);
+    assert(piece.get_max_health() == 3.0);
+    assert(piece.get_health() == 3.0);
+  }
   ////////////////////////////////////////////////////////////////////////////
   // Free functions
   ////////////////////////////////////////////////////////////////////////////
@@ -751,6 +800,7 @@ void test_piece()
     {
       white_queen.tick(delta_t(0.1), g);
       black_queen.tick(delta_t(0.1), g);
+      g.update_occupancy();
     }
     // Black queen is shot, but survives
     assert(get_f_health(black_queen) < 1.0);
@@ -792,11 +842,14 @@ void piece::tick(
 {
   if (m_actions.empty()) return;
   const auto action_type{m_actions[0].get_action_type()};
-  std::clog << get_color() << " " << get_type() << " going to " << action_type << '\n';
 
   switch(action_type)
   {
     case piece_action_type::move:
+      if (g.get_options().do_free_movement() && m_type != piece_type::knight)
+      {
+        return tick_move_freely(*this, dt, g);
+      }
       return tick_move(*this, dt, g);
     case piece_action_type::attack:
     default:
@@ -854,7 +907,8 @@ void tick_move(
   assert(first_action.get_action_type() == piece_action_type::move);
 
   // Increase the progress of the action
-  p.set_current_action_time(p.get_current_action_time() + dt);
+  const delta_t move_dt{dt * delta_t(g.get_options().get_movement_speed())};
+  p.set_current_action_time(p.get_current_action_time() + move_dt);
   const double f_too_much{p.get_current_action_time().get()};
   assert(f_too_much >= 0.0);
 
@@ -876,8 +930,7 @@ void tick_move(
   assert(f >= 0.0);
   assert(f <= 1.0);
 
-  const auto occupied_squares{get_occupied_squares(g)};
-  const bool is_target_occupied{is_occupied(first_action.get_to(), occupied_squares)};
+  const bool is_target_occupied{is_piece_at(g, first_action.get_to())};
   const bool is_focal_piece_at_target{p.get_current_square() == first_action.get_to()};
 
   if (is_target_occupied)
@@ -886,43 +939,131 @@ void tick_move(
     {
       // Moving the last half
       assert(f > 0.5);
-      std::clog << "Piece over halfway (" << f << "), already occupies " << p.get_current_square() << '\n';
     }
     else
     {
       // Too bad, need to go back
-      p.get_actions().clear();
-      p.add_action(
-        piece_action(
-          get_piece_at(g, first_action.get_from()).get_player(),
-          get_piece_at(g, first_action.get_from()).get_type(),
-          piece_action_type::move,
-          first_action.get_to(), // Reverse
-          first_action.get_from()
-        )
+      const piece_action go_back(
+        p.get_player(),
+        p.get_type(),
+        piece_action_type::move,
+        first_action.get_to(), // Reverse
+        first_action.get_from()
       );
+      // Maybe there is another way to where the piece is heading
+      const square from{first_action.get_from()};
+      const auto& last_action{p.get_actions().back()};
+      const square destination{last_action.get_to()};
+      std::vector<square> route;
+      if (last_action.get_action_type() == piece_action_type::move
+        && !is_piece_at(g, destination)
+      )
+      {
+        route = get_route(g, p.get_type(), from, destination);
+      }
+      p.get_actions().clear();
+      p.add_action(go_back);
       p.set_current_action_time(delta_t(1.0) - p.get_current_action_time()); // Keep progress
+      // A pawn cannot go back, so stays where it is
+      if (p.get_actions().empty()) p.set_current_action_time(delta_t(0.0));
+      if (!route.empty()) add_route(p, from, route);
       p.add_message(message_type::cannot);
-      std::clog << "I cannot" << '\n';
       return;
     }
   }
   else
   {
-    std::clog << "Piece not yet halfway (" << f << "), still occupied " << p.get_current_square() << '\n';
     assert(!is_target_occupied);
     if (f >= 0.5)
     {
       // If over halfway, occupy target
-      assert(!is_occupied(first_action.get_to(), get_occupied_squares(g)));
       p.set_current_square(first_action.get_to());
-      std::clog << "Piece over halfway (" << f << "), now occupies " << p.get_current_square() << '\n';
-      // Maybe cannot check, as p is not fully updated in game?
-      // assert(is_occupied(first_action.get_to(), get_occupied_squares(g)));
     }
   }
 }
 
+void stop_moving_freely(piece& p)
+{
+  assert(!p.get_actions().empty());
+  const auto& first_action{p.get_actions()[0]};
+  assert(first_action.get_action_type() == piece_action_type::move);
+
+  // A pawn cannot go back, so it stops at the square it occupies
+  if (!can_move(p.get_type(), first_action.get_to(), first_action.get_from(), p.get_player()))
+  {
+    p.get_actions().clear();
+    p.set_current_action_time(delta_t(0.0));
+    p.add_message(message_type::cannot);
+    return;
+  }
+  // Too bad, need to go back
+  const piece_action go_back(
+    p.get_player(),
+    p.get_type(),
+    piece_action_type::move,
+    first_action.get_to(), // Reverse
+    first_action.get_from()
+  );
+  p.get_actions().clear();
+  p.add_action(go_back);
+  p.set_current_action_time(delta_t(1.0) - p.get_current_action_time()); // Keep progress
+  p.add_message(message_type::cannot);
+}
+
+void tick_move_freely(
+  piece& p,
+  const delta_t& dt,
+  game& g
+)
+{
+  assert(!p.get_actions().empty());
+  const auto& first_action{p.get_actions()[0]};
+  assert(first_action.get_action_type() == piece_action_type::move);
+  assert(p.get_type() != piece_type::knight);
+
+  // Increase the progress of the action
+  const auto before{p.get_coordinat()};
+  const delta_t t_before{p.get_current_action_time()};
+  p.set_current_action_time(t_before + (dt * delta_t(g.get_options().get_movement_speed())));
+  const double f_too_much{p.get_current_action_time().get()};
+  assert(f_too_much >= 0.0);
+
+  // Are we done with the action?
+  if (f_too_much >= 1.0)
+  {
+    // The whole goal of the operation
+    assert(p.get_current_square() == first_action.get_to());
+    p.set_current_action_time(delta_t(0.0));
+    remove_first(p.get_actions());
+    if (p.get_actions().empty())
+    {
+      p.add_message(message_type::done);
+    }
+    return;
+  }
+
+  // Bumping into another piece
+  if (is_blocked(g.get_bodies(), g.get_pieces(), p, before, p.get_coordinat()))
+  {
+    p.set_current_action_time(t_before);
+    return stop_moving_freely(p);
+  }
+
+  // If over halfway, occupy target
+  if (f_too_much >= 0.5 && p.get_current_square() != first_action.get_to())
+  {
+    if (is_piece_at(g, first_action.get_to()))
+    {
+      p.set_current_action_time(t_before);
+      // Wait for a piece that is leaving,
+      // yet do not wait for a piece that stays
+      if (has_actions(get_piece_at(g, first_action.get_to()))) return;
+      return stop_moving_freely(p);
+    }
+    p.set_current_square(first_action.get_to());
+  }
+}
+
 void toggle_select(piece& p) noexcept
 {
   p.set_selected(!p.is_selected());
@@ -54,7 +54,7 @@ public:
   /// this coordinat may be around d3 or d4.
   /// Use 'get_current_square'/'get_occupied_square'
   /// for the square the piece is formally on
-  //game_coordinat get_coordinat() const noexcept;
+  game_coordinat get_coordinat() const noexcept;
 
   const auto& get_current_action_time() const noexcept { return m_current_action_time; }
 
@@ -91,6 +91,10 @@ public:
   /// @param damage a positive value
   void receive_damage(const double damage);
 
+  /// Set the maximum health, after which the piece is at full health
+  /// @param max_health a positive value
+  void set_max_health(const double max_health) noexcept;
+
   /// Set the current time an action has passed
   void set_current_action_time(const delta_t& t) noexcept;
 
@@ -154,6 +158,14 @@ private:
   piece_type m_type;
 };
 
+/// Let a piece follow a route, as planned by the 'route_planner',
+/// from a square along the squares of the route
+void add_route(
+  piece& p,
+  const square& from,
+  const std::vector<square>& route
+);
+
 /// Can a piece attack from 'from' to 'to'?
 /// This function assumes the board is empty
 bool can_attack(
@@ -181,7 +193,7 @@ bool can_move(
   const side player
 );
 
-/// Clear all the actions
+/// Clear all the actions, and the progress of the current action
 void clear_actions(piece& p);
 
 /// Count the number of actions a piece has
@@ -198,7 +210,10 @@ square get_occupied_square(const piece& p) noexcept;
 
 /// Rotate the coordinator of the piece,
 /// i.e. turn the board 180 degrees
-piece get_rotated_piece(const piece& piece) noexcept;
+piece get_rotated_piece(
+  const piece& piece,
+  const int board_size = get_default_board_size()
+) noexcept;
 
 /// Create a piece to be used in testing: a white king on e1
 piece get_test_white_king() noexcept;
@@ -218,6 +233,11 @@ bool is_idle(const piece& p) noexcept;
 /// Select the piece
 void select(piece& p) noexcept;
 
+/// Stop the current move of a piece that moves freely,
+/// by going back to the square it came from.
+/// A pawn cannot go back, so it stops at the square it occupies
+void stop_moving_freely(piece& p);
+
 /// Test this class and its free functions
 void test_piece();
 
@@ -235,6 +255,18 @@ void tick_move(
   game& g
 );
 
+/// Process a tick, when the current action is a move
+/// and the pieces move freely.
+/// The piece moves towards its target as with 'tick_move',
+/// yet is sent back when bumping into the body of another piece,
+/// and waits when its target square has not been left yet.
+/// Knights jump and use 'tick_move'
+void tick_move_freely(
+  piece& p,
+  const delta_t& dt,
+  game& g
+);
+
 /// Select the piece
 void toggle_select(piece& p) noexcept;
 
@@ -4,6 +4,22 @@
 #include <iostream>
 #include <sstream>
 
+int get_material_value(const piece_type type) noexcept
+{
+  switch (type)
+  {
+    case piece_type::bishop: return 3;
+    case piece_type::king: return 100;
+    case piece_type::knight: return 3;
+    case piece_type::pawn: return 1;
+    case piece_type::queen: return 9;
+    default:
+    case piece_type::rook:
+      assert(type == piece_type::rook);
+      return 5;
+  }
+}
+
 double get_max_health(const piece_type type)
 {
   switch (type)
@@ -52,6 +68,18 @@ void test_piece_type()
       assert(!to_str(t).empty());
     }
   }
+  // get_material_value
+  {
+    assert(get_material_value(piece_type::pawn) == 1);
+    assert(get_material_value(piece_type::knight) == get_material_value(piece_type::bishop));
+    assert(get_material_value(piece_type::queen) > get_material_value(piece_type::rook));
+    int sum{0};
+    for (const auto t: get_all_piece_types())
+    {
+      if (t != piece_type::king) sum += get_material_value(t);
+    }
+    assert(get_material_value(piece_type::king) > sum);
+  }
   // get_max_health
   {
     assert(get_max_health(piece_type::king) > 0.0);
@@ -17,6 +17,10 @@ enum class piece_type
 /// Get all the piece types
 std::vector<piece_type> get_all_piece_types() noexcept;
 
+/// Get the value of a piece in classic chess, in pawns,
+/// where the king is worth more than all other pieces together
+int get_material_value(const piece_type type) noexcept;
+
 /// Get the maximum health for a piece
 double get_max_health(const piece_type type);
 
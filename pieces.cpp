@@ -90,6 +90,77 @@ int count_selected_units(
   );
 }
 
+std::vector<piece> get_large_army_starting_pieces(
+  const chess_color left_player_color,
+  const int board_size
+) noexcept
+{
+  assert(board_size % get_default_board_size() == 0);
+  assert(board_size <= get_max_board_size());
+  const side white_side{
+    left_player_color == chess_color::white
+    ? side::lhs
+    : side::rhs
+  };
+  const side black_side{get_other_side(white_side)};
+  const std::vector<piece_type> officers{
+    piece_type::rook,
+    piece_type::knight,
+    piece_type::bishop,
+    piece_type::queen,
+    piece_type::king,
+    piece_type::bishop,
+    piece_type::knight,
+    piece_type::rook
+  };
+  // The number of ranks of officers, as well as of pawns, per player
+  const int n_ranks{board_size / get_default_board_size()};
+  const auto get_officer_type{
+    [officers](const int rank, const int y)
+    {
+      const auto t{officers[y % officers.size()]};
+      // Only the king on the e-file of the first rank remains a king
+      if (t == piece_type::king && (rank != 0 || y != 4)) return piece_type::queen;
+      return t;
+    }
+  };
+  std::vector<piece> pieces;
+  pieces.reserve(4 * n_ranks * board_size);
+  for (const auto color: { chess_color::white, chess_color::black })
+  {
+    const side player{color == chess_color::white ? white_side : black_side};
+    const auto get_x{
+      [color, board_size](const int x)
+      {
+        return color == chess_color::white ? x : board_size - 1 - x;
+      }
+    };
+    for (int rank{0}; rank != n_ranks; ++rank)
+    {
+      for (int y{0}; y != board_size; ++y)
+      {
+        pieces.push_back(
+          piece(color, get_officer_type(rank, y), square(get_x(rank), y), player)
+        );
+      }
+    }
+    for (int rank{0}; rank != n_ranks; ++rank)
+    {
+      for (int y{0}; y != board_size; ++y)
+      {
+        pieces.push_back(
+          piece(color, piece_type::pawn, square(get_x(n_ranks + rank), y), player)
+        );
+      }
+    }
+  }
+  if (left_player_color == chess_color::black)
+  {
+    pieces = get_rotated_pieces(pieces, board_size);
+  }
+  return pieces;
+}
+
 std::vector<piece> get_kings_only_starting_pieces(
   const chess_color left_player_color
 ) noexcept
@@ -178,6 +249,7 @@ piece get_piece_with_id(
 
 std::vector<square> get_possible_bishop_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 )
 {
@@ -186,6 +258,7 @@ std::vector<square> get_possible_bishop_moves(
   assert(focal_piece.get_type() == piece_type::bishop);
   const int x{focal_piece.get_current_square().get_x()};
   const int y{focal_piece.get_current_square().get_y()};
+  const int board_size{grid.get_board_size()};
 
   std::vector<square> moves;
   std::vector<std::pair<int, int>> delta_pairs{
@@ -196,19 +269,19 @@ std::vector<square> get_possible_bishop_moves(
   };
   for (const auto delta_pair: delta_pairs)
   {
-    for (int distance{1}; distance != 8; ++distance)
+    for (int distance{1}; distance != board_size; ++distance)
     {
       const int new_x{x + (delta_pair.first * distance)};
       const int new_y{y + (delta_pair.second * distance)};
-      if (!is_valid_square_xy(new_x, new_y)) break;
-      const square there(new_x, new_y);
-      if (is_piece_at(pieces, there)
-        && get_piece_at(pieces, there).get_color() == focal_piece.get_color()
+      if (!is_valid_square_xy(new_x, new_y, board_size)) break;
+      const int index{grid.get_index(new_x, new_y)};
+      if (index != -1
+        && pieces[index].get_color() == focal_piece.get_color()
       )
       {
         break;
       }
-      moves.push_back(there);
+      moves.push_back(square(new_x, new_y));
     }
   }
   return moves;
@@ -216,6 +289,7 @@ std::vector<square> get_possible_bishop_moves(
 
 std::vector<square> get_possible_king_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 )
 {
@@ -224,35 +298,37 @@ std::vector<square> get_possible_king_moves(
   assert(focal_piece.get_type() == piece_type::king);
   const int x{focal_piece.get_current_square().get_x()};
   const int y{focal_piece.get_current_square().get_y()};
-  const auto enemy_color{get_other_color(focal_piece.get_color())};
-  std::vector<std::pair<int, int>> xys{
-    std::make_pair(x + 0, y - 1),
-    std::make_pair(x + 1, y - 1),
-    std::make_pair(x + 1, y - 0),
-    std::make_pair(x + 1, y + 1),
-    std::make_pair(x - 0, y + 1),
-    std::make_pair(x - 1, y + 1),
-    std::make_pair(x - 1, y + 0),
-    std::make_pair(x - 1, y - 1)
-  };
-  const auto squares_on_board{to_squares(xys)};
+  const int board_size{grid.get_board_size()};
   std::vector<square> squares;
-  std::copy_if(
-    std::begin(squares_on_board),
-    std::end(squares_on_board),
-    std::back_inserter(squares),
-    [pieces, enemy_color](const auto& square)
+  const std::vector<std::pair<int, int>> delta_pairs{
+    std::make_pair( 0, -1),
+    std::make_pair( 1, -1),
+    std::make_pair( 1,  0),
+    std::make_pair( 1,  1),
+    std::make_pair( 0,  1),
+    std::make_pair(-1,  1),
+    std::make_pair(-1,  0),
+    std::make_pair(-1, -1)
+  };
+  for (const auto& delta_pair: delta_pairs)
+  {
+    const int new_x{x + delta_pair.first};
+    const int new_y{y + delta_pair.second};
+    if (!is_valid_square_xy(new_x, new_y, board_size)) continue;
+    const int index{grid.get_index(new_x, new_y)};
+    if (index == -1
+      || pieces[index].get_color() != focal_piece.get_color()
+    )
     {
-      return !is_piece_at(pieces, square)
-        || get_piece_at(pieces, square).get_color() == enemy_color
-      ;
+      squares.push_back(square(new_x, new_y));
     }
-  );
+  }
   return squares;
 }
 
 std::vector<square> get_possible_knight_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 )
 {
@@ -261,6 +337,7 @@ std::vector<square> get_possible_knight_moves(
   assert(focal_piece.get_type() == piece_type::knight);
   const int x{focal_piece.get_current_square().get_x()};
   const int y{focal_piece.get_current_square().get_y()};
+  const int board_size{grid.get_board_size()};
   std::vector<square> moves;
   std::vector<std::pair<int, int>> delta_pairs{
     std::make_pair( 1, -2), // 1 o'clock
@@ -278,15 +355,15 @@ std::vector<square> get_possible_knight_moves(
     {
       const int new_x{x + (delta_pair.first * distance)};
       const int new_y{y + (delta_pair.second * distance)};
-      if (!is_valid_square_xy(new_x, new_y)) break;
-      const square there(new_x, new_y);
-      if (is_piece_at(pieces, there)
-        && get_piece_at(pieces, there).get_color() == focal_piece.get_color()
+      if (!is_valid_square_xy(new_x, new_y, board_size)) break;
+      const int index{grid.get_index(new_x, new_y)};
+      if (index != -1
+        && pieces[index].get_color() == focal_piece.get_color()
       )
       {
         break;
       }
-      moves.push_back(there);
+      moves.push_back(square(new_x, new_y));
     }
   }
   return moves;
@@ -294,6 +371,18 @@ std::vector<square> get_possible_knight_moves(
 
 std::vector<square> get_possible_moves(
   const std::vector<piece>& pieces,
+  const piece& focal_piece,
+  const int board_size
+)
+{
+  occupancy_grid grid(board_size);
+  grid.update(pieces);
+  return get_possible_moves(pieces, grid, focal_piece);
+}
+
+std::vector<square> get_possible_moves(
+  const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 )
 {
@@ -301,20 +390,21 @@ std::vector<square> get_possible_moves(
   assert(has_piece_with_id(pieces, focal_piece.get_id()));
   switch (focal_piece.get_type())
   {
-    case piece_type::king: return get_possible_king_moves(pieces, focal_piece);
-    case piece_type::pawn: return get_possible_pawn_moves(pieces, focal_piece);
-    case piece_type::rook: return get_possible_rook_moves(pieces, focal_piece);
-    case piece_type::queen: return get_possible_queen_moves(pieces, focal_piece);
-    case piece_type::bishop: return get_possible_bishop_moves(pieces, focal_piece);
+    case piece_type::king: return get_possible_king_moves(pieces, grid, focal_piece);
+    case piece_type::pawn: return get_possible_pawn_moves(pieces, grid, focal_piece);
+    case piece_type::rook: return get_possible_rook_moves(pieces, grid, focal_piece);
+    case piece_type::queen: return get_possible_queen_moves(pieces, grid, focal_piece);
+    case piece_type::bishop: return get_possible_bishop_moves(pieces, grid, focal_piece);
     default:
     case piece_type::knight:
       assert(focal_piece.get_type() == piece_type::knight);
-      return get_possible_knight_moves(pieces, focal_piece);
+      return get_possible_knight_moves(pieces, grid, focal_piece);
   }
 }
 
 std::vector<square> get_possible_pawn_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 )
 {
@@ -323,43 +413,32 @@ std::vector<square> get_possible_pawn_moves(
   assert(focal_piece.get_type() == piece_type::pawn);
   const int x{focal_piece.get_current_square().get_x()};
   const int y{focal_piece.get_current_square().get_y()};
+  const int board_size{grid.get_board_size()};
 
   // Can attack to where?
   const int dx{focal_piece.get_player() == side::lhs ? 1 : -1};
-  const std::vector<std::pair<int, int>> attack_xys{
-    std::make_pair(x + dx, y - 1),
-    std::make_pair(x + dx, y + 1)
-  };
-  const auto attack_squares{to_squares(attack_xys)};
   std::vector<square> valid_attack_squares;
-  std::copy_if(
-    std::begin(attack_squares),
-    std::end(attack_squares),
-    std::back_inserter(valid_attack_squares),
-    [pieces, focal_piece](const auto& square)
+  for (const int dy: {-1, 1})
+  {
+    if (!is_valid_square_xy(x + dx, y + dy, board_size)) continue;
+    const int index{grid.get_index(x + dx, y + dy)};
+    if (index != -1
+      && pieces[index].get_color() != focal_piece.get_color()
+    )
     {
-      return is_piece_at(pieces, square)
-        && get_piece_at(pieces, square).get_color() != focal_piece.get_color();
+      valid_attack_squares.push_back(square(x + dx, y + dy));
     }
-  );
+  }
 
   // Move forward
-  const std::vector<std::pair<int, int>> move_xys{
-    std::make_pair(x + (1 * dx), y),
-    std::make_pair(x + (2 * dx), y),
-    std::make_pair(x + (3 * dx), y),
-    std::make_pair(x + (4 * dx), y),
-    std::make_pair(x + (5 * dx), y),
-    std::make_pair(x + (6 * dx), y),
-    std::make_pair(x + (7 * dx), y)
-  };
-  const auto move_squares{to_squares(move_xys)};
   std::vector<square> valid_move_squares;
-  for (const auto s: move_squares)
+  for (int distance{1}; distance != board_size; ++distance)
   {
+    const int new_x{x + (distance * dx)};
+    if (!is_valid_square_xy(new_x, y, board_size)) break;
     // Move until a piece
-    if (is_piece_at(pieces, s)) break;
-    valid_move_squares.push_back(s) ;
+    if (grid.get_index(new_x, y) != -1) break;
+    valid_move_squares.push_back(square(new_x, y));
   }
 
   // Concatenate the vectors
@@ -368,6 +447,7 @@ std::vector<square> get_possible_pawn_moves(
 
 std::vector<square> get_possible_queen_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 )
 {
@@ -376,6 +456,7 @@ std::vector<square> get_possible_queen_moves(
   assert(focal_piece.get_type() == piece_type::queen);
   const int x{focal_piece.get_current_square().get_x()};
   const int y{focal_piece.get_current_square().get_y()};
+  const int board_size{grid.get_board_size()};
 
   std::vector<square> moves;
   std::vector<std::pair<int, int>> delta_pairs{
@@ -390,19 +471,19 @@ std::vector<square> get_possible_queen_moves(
   };
   for (const auto delta_pair: delta_pairs)
   {
-    for (int distance{1}; distance != 8; ++distance)
+    for (int distance{1}; distance != board_size; ++distance)
     {
       const int new_x{x + (delta_pair.first * distance)};
       const int new_y{y + (delta_pair.second * distance)};
-      if (!is_valid_square_xy(new_x, new_y)) break;
-      const square there(new_x, new_y);
-      if (is_piece_at(pieces, there)
-        && get_piece_at(pieces, there).get_color() == focal_piece.get_color()
+      if (!is_valid_square_xy(new_x, new_y, board_size)) break;
+      const int index{grid.get_index(new_x, new_y)};
+      if (index != -1
+        && pieces[index].get_color() == focal_piece.get_color()
       )
       {
         break;
       }
-      moves.push_back(there);
+      moves.push_back(square(new_x, new_y));
     }
   }
   return moves;
@@ -411,6 +492,7 @@ std::vector<square> get_possible_queen_moves(
 
 std::vector<square> get_possible_rook_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 )
 {
@@ -419,6 +501,7 @@ std::vector<square> get_possible_rook_moves(
   assert(focal_piece.get_type() == piece_type::rook);
   const int x{focal_piece.get_current_square().get_x()};
   const int y{focal_piece.get_current_square().get_y()};
+  const int board_size{grid.get_board_size()};
 
   std::vector<square> moves;
   std::vector<std::pair<int, int>> delta_pairs{
@@ -429,19 +512,19 @@ std::vector<square> get_possible_rook_moves(
   };
   for (const auto delta_pair: delta_pairs)
   {
-    for (int distance{1}; distance != 8; ++distance)
+    for (int distance{1}; distance != board_size; ++distance)
     {
       const int new_x{x + (delta_pair.first * distance)};
       const int new_y{y + (delta_pair.second * distance)};
-      if (!is_valid_square_xy(new_x, new_y)) break;
-      const square there(new_x, new_y);
-      if (is_piece_at(pieces, there)
-        && get_piece_at(pieces, there).get_color() == focal_piece.get_color()
+      if (!is_valid_square_xy(new_x, new_y, board_size)) break;
+      const int index{grid.get_index(new_x, new_y)};
+      if (index != -1
+        && pieces[index].get_color() == focal_piece.get_color()
       )
       {
         break;
       }
-      moves.push_back(there);
+      moves.push_back(square(new_x, new_y));
     }
   }
   return moves;
@@ -619,7 +702,10 @@ std::vector<piece> get_pieces_queen_endgame(
   return pieces;
 }
 
-std::vector<piece> get_rotated_pieces(const std::vector<piece>& pieces) noexcept
+std::vector<piece> get_rotated_pieces(
+  const std::vector<piece>& pieces,
+  const int board_size
+) noexcept
 {
   std::vector<piece> rps;
   rps.reserve(pieces.size());
@@ -627,18 +713,23 @@ std::vector<piece> get_rotated_pieces(const std::vector<piece>& pieces) noexcept
     std::begin(pieces),
     std::end(pieces),
     std::back_inserter(rps),
-    [](const auto& p)
+    [board_size](const auto& p)
     {
-      return get_rotated_piece(p);
+      return get_rotated_piece(p, board_size);
     }
   );
   return rps;
 }
 
 std::vector<piece> get_standard_starting_pieces(
-  const chess_color left_player_color
+  const chess_color left_player_color,
+  const int board_size
 ) noexcept
 {
+  if (board_size != get_default_board_size())
+  {
+    return get_large_army_starting_pieces(left_player_color, board_size);
+  }
   const side white_side{
     left_player_color == chess_color::white
     ? side::lhs
@@ -688,12 +779,14 @@ std::vector<piece> get_standard_starting_pieces(
 
 std::vector<piece> get_starting_pieces(
   const starting_position_type t,
-  const chess_color left_player_color
+  const chess_color left_player_color,
+  const int board_size
 ) noexcept
 {
   switch (t)
   {
-    case starting_position_type::standard: return get_standard_starting_pieces(left_player_color);
+    case starting_position_type::standard:
+      return get_standard_starting_pieces(left_player_color, board_size);
     case starting_position_type::kings_only: return get_kings_only_starting_pieces(left_player_color);
     case starting_position_type::before_scholars_mate: return get_pieces_before_scholars_mate(left_player_color);
     case starting_position_type::queen_end_game: return get_pieces_queen_endgame(left_player_color);
@@ -770,6 +863,41 @@ void test_pieces()
       assert(count_dead_pieces(pieces) == 1);
     }
   }
+  // get_large_army_starting_pieces
+  {
+    const auto pieces{get_large_army_starting_pieces(chess_color::white, 16)};
+    assert(pieces.size() == 128);
+    assert(
+      std::count_if(
+        std::begin(pieces),
+        std::end(pieces),
+        [](const auto& p) { return p.get_type() == piece_type::king; }
+      ) == 2
+    );
+    assert(get_piece_at(pieces, square("e1")).get_type() == piece_type::king);
+    assert(get_piece_at(pieces, square("m1")).get_type() == piece_type::queen);
+    assert(get_piece_at(pieces, square("e2")).get_type() == piece_type::queen);
+    assert(get_piece_at(pieces, square("e4")).get_type() == piece_type::pawn);
+    assert(get_piece_at(pieces, square("e16")).get_type() == piece_type::king);
+    assert(get_piece_at(pieces, square("e16")).get_color() == chess_color::black);
+    assert(!is_piece_at(pieces, square("e5")));
+    const auto rotated{get_large_army_starting_pieces(chess_color::black, 16)};
+    assert(get_piece_at(rotated, square("l1")).get_color() == chess_color::black);
+    assert(get_piece_at(rotated, square("l1")).get_type() == piece_type::king);
+  }
+  // get_large_army_starting_pieces, 32x32 has hundreds of pieces
+  {
+    const auto pieces{get_standard_starting_pieces(chess_color::white, 32)};
+    assert(pieces.size() == 512);
+    occupancy_grid grid(32);
+    grid.update(pieces);
+    // The knights are boxed in by their own officers
+    const auto& knight{get_piece_at(pieces, square("b1"))};
+    assert(get_possible_moves(pieces, grid, knight).empty());
+    const auto& pawn{get_piece_at(pieces, square("b8"))};
+    assert(get_possible_moves(pieces, grid, pawn).size() == 16);
+    assert(get_possible_moves(pieces, pawn, 32).size() == 16);
+  }
   // get_piece_at, const
   {
     const auto pieces{get_standard_starting_pieces()};
@@ -2,6 +2,7 @@
 #define PIECES_H
 
 /// Functions to work on collections of pieces
+#include "occupancy_grid.h"
 #include "piece.h"
 
 
@@ -33,6 +34,16 @@ int count_selected_units(
   const chess_color player
 );
 
+/// Get the starting position of a large-army match,
+/// on a board larger than 8x8.
+/// Each player has one rank of officers and one rank of pawns
+/// for every 8 squares of board size.
+/// There is only one king per player, the other kings are queens
+std::vector<piece> get_large_army_starting_pieces(
+  const chess_color left_player_color,
+  const int board_size
+) noexcept;
+
 /// Get a king-versus-king starting position
 std::vector<piece> get_kings_only_starting_pieces(
   const chess_color left_player_color = chess_color::white
@@ -66,6 +77,7 @@ piece get_piece_with_id(
 /// This can both be a move or an attack
 std::vector<square> get_possible_bishop_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 );
 
@@ -73,6 +85,7 @@ std::vector<square> get_possible_bishop_moves(
 /// This can both be a move or an attack
 std::vector<square> get_possible_king_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 );
 
@@ -80,6 +93,7 @@ std::vector<square> get_possible_king_moves(
 /// This can both be a move or an attack
 std::vector<square> get_possible_knight_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 );
 
@@ -87,6 +101,16 @@ std::vector<square> get_possible_knight_moves(
 /// This can both be a move or an attack
 std::vector<square> get_possible_moves(
   const std::vector<piece>& pieces,
+  const piece& focal_piece,
+  const int board_size = get_default_board_size()
+);
+
+/// Get the possible moves for a focal piece,
+/// where the grid is used to find the pieces in the way.
+/// This can both be a move or an attack
+std::vector<square> get_possible_moves(
+  const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 );
 
@@ -94,6 +118,7 @@ std::vector<square> get_possible_moves(
 /// This can both be a move or an attack
 std::vector<square> get_possible_pawn_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 );
 
@@ -101,6 +126,7 @@ std::vector<square> get_possible_pawn_moves(
 /// This can both be a move or an attack
 std::vector<square> get_possible_queen_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 );
 
@@ -108,13 +134,17 @@ std::vector<square> get_possible_queen_moves(
 /// This can both be a move or an attack
 std::vector<square> get_possible_rook_moves(
   const std::vector<piece>& pieces,
+  const occupancy_grid& grid,
   const piece& focal_piece
 );
 
 
 /// Rotate the coordinator of the pieces,
 /// i.e. turn the board 180 degrees
-std::vector<piece> get_rotated_pieces(const std::vector<piece>& piece) noexcept;
+std::vector<piece> get_rotated_pieces(
+  const std::vector<piece>& piece,
+  const int board_size = get_default_board_size()
+) noexcept;
 
 /// Get all the selected pieces
 /// @param player the color of the player, which is white for player 1
@@ -124,9 +154,11 @@ std::vector<piece> get_selected_pieces(
   const chess_color player
 );
 
-/// Get all the pieces in the starting position
+/// Get all the pieces in the starting position.
+/// On a board larger than 8x8, this is a large-army starting position
 std::vector<piece> get_standard_starting_pieces(
-  const chess_color left_player_color = chess_color::white
+  const chess_color left_player_color = chess_color::white,
+  const int board_size = get_default_board_size()
 ) noexcept;
 
 /// Get the pieces before a scholar's mate
@@ -155,10 +187,13 @@ std::vector<piece> get_pieces_pawn_all_out_assault(
 ) noexcept;
 
 
-/// Get all the pieces in the starting position type
+/// Get all the pieces in the starting position type.
+/// On a board larger than 8x8, only the standard starting position
+/// uses the whole board
 std::vector<piece> get_starting_pieces(
   const starting_position_type t,
-  const chess_color left_player_color = chess_color::white
+  const chess_color left_player_color = chess_color::white,
+  const int board_size = get_default_board_size()
 ) noexcept;
 
 /// Is there a piece with the ID among the pieces?
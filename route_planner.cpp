@@ -0,0 +1,97 @@
+#include "route_planner.h"
+
+#include "occupancy_grid.h"
+
+#include <cassert>
+
+route_planner::route_planner()
+  : m_n_calculated{0},
+    m_occupancy_version{-1}
+{
+
+}
+
+flow_field& route_planner::get_flow_field(
+  const piece_type type,
+  const square& target,
+  const occupancy_grid& occupancy
+)
+{
+  if (occupancy.get_version() != m_occupancy_version)
+  {
+    m_flow_fields.clear();
+    m_occupancy_version = occupancy.get_version();
+  }
+  const int n_squares{get_max_board_size() * get_max_board_size()};
+  const int key{
+    (static_cast<int>(type) * n_squares)
+    + (target.get_x() * get_max_board_size())
+    + target.get_y()
+  };
+  const auto there{m_flow_fields.find(key)};
+  if (there != std::end(m_flow_fields)) return there->second;
+  ++m_n_calculated;
+  return m_flow_fields.emplace(key, flow_field(type, target, occupancy)).first->second;
+}
+
+std::vector<square> get_route(
+  route_planner& planner,
+  const piece_type type,
+  const square& from,
+  const square& to,
+  const occupancy_grid& occupancy
+)
+{
+  if (type == piece_type::pawn) return {};
+  auto& f{planner.get_flow_field(type, to, occupancy)};
+  f.expand_to(from, occupancy);
+  return get_route(f, from);
+}
+
+void test_route_planner()
+{
+#ifndef NDEBUG
+  // Pieces of the same type sent to the same square share a flow field
+  {
+    occupancy_grid g;
+    g.set(square("b1"), 0);
+    g.set(square("g1"), 1);
+    route_planner p;
+    const auto route_1{get_route(p, piece_type::knight, square("b1"), square("e4"), g)};
+    const auto route_2{get_route(p, piece_type::knight, square("g1"), square("e4"), g)};
+    assert(p.get_n_calculated() == 1);
+    assert(route_1.size() == 2);
+    assert(route_2.size() == 2);
+    assert(route_1.back() == square("e4"));
+    assert(route_2.back() == square("e4"));
+  }
+  // Another type or target needs another flow field
+  {
+    const occupancy_grid g;
+    route_planner p;
+    get_route(p, piece_type::knight, square("b1"), square("e4"), g);
+    get_route(p, piece_type::king, square("b1"), square("e4"), g);
+    get_route(p, piece_type::king, square("b1"), square("e5"), g);
+    assert(p.get_n_calculated() == 3);
+    get_route(p, piece_type::king, square("a1"), square("e5"), g);
+    assert(p.get_n_calculated() == 3);
+  }
+  // The flow fields are calculated again when a square is entered
+  {
+    occupancy_grid g;
+    g.set(square("a1"), 0);
+    route_planner p;
+    assert(get_route(p, piece_type::rook, square("a1"), square("a3"), g).size() == 1);
+    g.set(square("a2"), 1);
+    assert(get_route(p, piece_type::rook, square("a1"), square("a3"), g).size() == 3);
+    assert(p.get_n_calculated() == 2);
+  }
+  // A pawn has no route
+  {
+    const occupancy_grid g;
+    route_planner p;
+    assert(get_route(p, piece_type::pawn, square("e2"), square("e4"), g).empty());
+    assert(p.get_n_calculated() == 0);
+  }
+#endif // NDEBUG
+}
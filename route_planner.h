@@ -0,0 +1,63 @@
+#ifndef ROUTE_PLANNER_H
+#define ROUTE_PLANNER_H
+
+#include "ccfwd.h"
+#include "flow_field.h"
+#include "piece_type.h"
+#include "square.h"
+
+#include <map>
+#include <vector>
+
+/// Plans the routes of the pieces around the pieces in the way.
+/// Keeps the flow fields per piece type and target,
+/// so that pieces of the same type that are sent to the same square
+/// share one flow field.
+/// The flow fields are thrown away when squares are entered or left,
+/// as these may block or open up routes
+class route_planner
+{
+public:
+  route_planner();
+
+  /// Get the flow field for a type of piece towards a target,
+  /// which is only started if it is not known yet
+  /// for the occupied squares of the grid
+  flow_field& get_flow_field(
+    const piece_type type,
+    const square& target,
+    const occupancy_grid& occupancy
+  );
+
+  /// Get the number of flow fields started so far
+  int get_n_calculated() const noexcept { return m_n_calculated; }
+
+private:
+
+  /// The flow fields, for the occupancy version below,
+  /// where the key is made from the piece type and the target
+  std::map<int, flow_field> m_flow_fields;
+
+  /// The number of flow fields started so far
+  int m_n_calculated;
+
+  /// The version of the occupied squares the flow fields are for
+  int m_occupancy_version;
+};
+
+/// Get the route of a piece from a square to a target,
+/// as the squares to move to, ending at the target.
+/// The route is empty if there is none, or for a pawn,
+/// as a pawn cannot move around the pieces in its way
+std::vector<square> get_route(
+  route_planner& planner,
+  const piece_type type,
+  const square& from,
+  const square& to,
+  const occupancy_grid& occupancy
+);
+
+/// Test this class and its free functions
+void test_route_planner();
+
+#endif // ROUTE_PLANNER_H
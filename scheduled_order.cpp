@@ -0,0 +1,62 @@
+#include "scheduled_order.h"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+scheduled_order::scheduled_order(
+  const id& piece_id,
+  const piece_action_type type,
+  const square& to
+) : m_action_type{type},
+    m_piece_id{piece_id},
+    m_to{to}
+{
+
+}
+
+void test_scheduled_order()
+{
+#ifndef NDEBUG
+  // Constructor
+  {
+    const id i{create_new_id()};
+    const scheduled_order o(i, piece_action_type::attack, square("e5"));
+    assert(o.get_action_type() == piece_action_type::attack);
+    assert(o.get_piece_id() == i);
+    assert(o.get_to() == square("e5"));
+  }
+  // operator==
+  {
+    const id i{create_new_id()};
+    const scheduled_order a(i, piece_action_type::move, square("e4"));
+    const scheduled_order b(i, piece_action_type::move, square("e4"));
+    const scheduled_order c(i, piece_action_type::move, square("e3"));
+    assert(a == b);
+    assert(!(a == c));
+  }
+  // operator<<
+  {
+    const scheduled_order o(create_new_id(), piece_action_type::move, square("e4"));
+    std::stringstream s;
+    s << o;
+    assert(!s.str().empty());
+  }
+#endif // NDEBUG
+}
+
+bool operator==(const scheduled_order& lhs, const scheduled_order& rhs) noexcept
+{
+  return lhs.get_action_type() == rhs.get_action_type()
+    && lhs.get_piece_id() == rhs.get_piece_id()
+    && lhs.get_to() == rhs.get_to()
+  ;
+}
+
+std::ostream& operator<<(std::ostream& os, const scheduled_order& o) noexcept
+{
+  os << "piece with ID " << o.get_piece_id() << ": "
+    << o.get_action_type() << " to " << o.get_to()
+  ;
+  return os;
+}
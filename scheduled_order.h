@@ -0,0 +1,43 @@
+#ifndef SCHEDULED_ORDER_H
+#define SCHEDULED_ORDER_H
+
+#include "ccfwd.h"
+#include "id.h"
+#include "piece_action_type.h"
+#include "square.h"
+
+#include <iosfwd>
+
+/// An order for a piece, to be given later,
+/// for example 'the piece with ID 3 attacks e5'.
+/// The order is given as if the player did so at that time:
+/// the piece stops what it was doing and starts on the order.
+/// An order for a piece that is gone by then is ignored
+class scheduled_order
+{
+public:
+  explicit scheduled_order(
+    const id& piece_id,
+    const piece_action_type type,
+    const square& to
+  );
+
+  auto get_action_type() const noexcept { return m_action_type; }
+  const auto& get_piece_id() const noexcept { return m_piece_id; }
+  const auto& get_to() const noexcept { return m_to; }
+
+private:
+
+  piece_action_type m_action_type;
+  id m_piece_id;
+  square m_to;
+};
+
+/// Test this class and its free functions
+void test_scheduled_order();
+
+bool operator==(const scheduled_order& lhs, const scheduled_order& rhs) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const scheduled_order& o) noexcept;
+
+#endif // SCHEDULED_ORDER_H
@@ -7,3 +7,6 @@ wget https://database.lichess.org/standard/lichess_db_standard_rated_2013-01.pgn
 
 # From https://fedingo.com/how-to-extract-bz2-file-in-linux/
 bzip2 -d lichess_db_standard_rated_2013-01.pgn.bz2
+
+# Compile an opening book from these games, for the bots to use
+# ./game --opening-book lichess_db_standard_rated_2013-01.pgn opening_book.ccob
@@ -0,0 +1,190 @@
+#include "selection.h"
+
+#include "piece.h"
+#include "pieces.h"
+
+#include <bitset>
+#include <cassert>
+
+selection::selection()
+  : m_black{},
+    m_black_groups{},
+    m_white{},
+    m_white_groups{}
+{
+
+}
+
+void selection::assign_group(
+  const int group,
+  const chess_color player,
+  const std::vector<piece>& pieces
+)
+{
+  assert(group >= 0);
+  assert(group < get_n_control_groups());
+  auto& ids{
+    player == chess_color::white ? m_white_groups[group] : m_black_groups[group]
+  };
+  ids.clear();
+  for (const int index: get_indices(player))
+  {
+    assert(index < static_cast<int>(pieces.size()));
+    ids.push_back(pieces[index].get_id());
+  }
+}
+
+int selection::count(const chess_color player) const noexcept
+{
+  int n{0};
+  for (const auto word: get_bits(player))
+  {
+    n += static_cast<int>(std::bitset<64>(word).count());
+  }
+  return n;
+}
+
+selection::bits& selection::get_bits(const chess_color player) noexcept
+{
+  if (player == chess_color::white) return m_white;
+  assert(player == chess_color::black);
+  return m_black;
+}
+
+const selection::bits& selection::get_bits(const chess_color player) const noexcept
+{
+  if (player == chess_color::white) return m_white;
+  assert(player == chess_color::black);
+  return m_black;
+}
+
+const std::vector<id>& selection::get_group(
+  const int group,
+  const chess_color player
+) const noexcept
+{
+  assert(group >= 0);
+  assert(group < get_n_control_groups());
+  if (player == chess_color::white) return m_white_groups[group];
+  return m_black_groups[group];
+}
+
+std::vector<int> selection::get_indices(const chess_color player) const
+{
+  std::vector<int> indices;
+  const auto& b{get_bits(player)};
+  const int n_words{static_cast<int>(b.size())};
+  for (int i{0}; i != n_words; ++i)
+  {
+    // Most words are empty
+    if (b[i] == 0) continue;
+    for (int j{0}; j != 64; ++j)
+    {
+      if (b[i] & (std::uint64_t{1} << j)) indices.push_back((i * 64) + j);
+    }
+  }
+  return indices;
+}
+
+bool selection::is_selected(const int index, const chess_color player) const noexcept
+{
+  assert(index >= 0);
+  assert(index < get_max_board_size() * get_max_board_size());
+  return get_bits(player)[index / 64] & (std::uint64_t{1} << (index % 64));
+}
+
+void selection::select(const int index, const chess_color player) noexcept
+{
+  assert(index >= 0);
+  assert(index < get_max_board_size() * get_max_board_size());
+  get_bits(player)[index / 64] |= (std::uint64_t{1} << (index % 64));
+}
+
+void selection::unselect(const int index, const chess_color player) noexcept
+{
+  assert(index >= 0);
+  assert(index < get_max_board_size() * get_max_board_size());
+  get_bits(player)[index / 64] &= ~(std::uint64_t{1} << (index % 64));
+}
+
+void selection::unselect_all(const chess_color player) noexcept
+{
+  get_bits(player).fill(0);
+}
+
+void selection::update(const std::vector<piece>& pieces)
+{
+  m_black.fill(0);
+  m_white.fill(0);
+  const int n_pieces{static_cast<int>(pieces.size())};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    if (pieces[i].is_selected()) select(i, pieces[i].get_color());
+  }
+}
+
+void test_selection()
+{
+#ifndef NDEBUG
+  // An empty selection
+  {
+    const selection s;
+    assert(s.count(chess_color::white) == 0);
+    assert(s.count(chess_color::black) == 0);
+    assert(s.get_indices(chess_color::white).empty());
+    assert(s.get_group(0, chess_color::white).empty());
+  }
+  // selection::select and selection::unselect
+  {
+    selection s;
+    s.select(3, chess_color::white);
+    s.select(64, chess_color::white);
+    s.select(1023, chess_color::white);
+    s.select(5, chess_color::black);
+    assert(s.count(chess_color::white) == 3);
+    assert(s.count(chess_color::black) == 1);
+    assert(s.is_selected(64, chess_color::white));
+    assert(!s.is_selected(64, chess_color::black));
+    const std::vector<int> expected{3, 64, 1023};
+    assert(s.get_indices(chess_color::white) == expected);
+    s.unselect(64, chess_color::white);
+    assert(!s.is_selected(64, chess_color::white));
+    assert(s.count(chess_color::white) == 2);
+  }
+  // selection::unselect_all only concerns one player
+  {
+    selection s;
+    s.select(3, chess_color::white);
+    s.select(5, chess_color::black);
+    s.unselect_all(chess_color::white);
+    assert(s.count(chess_color::white) == 0);
+    assert(s.count(chess_color::black) == 1);
+  }
+  // selection::update follows the pieces
+  {
+    auto pieces{get_standard_starting_pieces()};
+    pieces[0].set_selected(true);
+    pieces[31].set_selected(true);
+    selection s;
+    s.update(pieces);
+    assert(s.count(pieces[0].get_color()) + s.count(pieces[31].get_color()) == 2);
+    assert(s.is_selected(0, pieces[0].get_color()));
+    assert(s.is_selected(31, pieces[31].get_color()));
+  }
+  // selection::assign_group stores the IDs of the selected pieces
+  {
+    const auto pieces{get_standard_starting_pieces()};
+    selection s;
+    const auto color{pieces[2].get_color()};
+    s.select(2, color);
+    s.assign_group(1, color, pieces);
+    assert(s.get_group(1, color).size() == 1);
+    assert(s.get_group(1, color)[0] == pieces[2].get_id());
+    assert(s.get_group(2, color).empty());
+    // Assigning again replaces the group
+    s.unselect_all(color);
+    s.assign_group(1, color, pieces);
+    assert(s.get_group(1, color).empty());
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,90 @@
+#ifndef SELECTION_H
+#define SELECTION_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "id.h"
+#include "square.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/// The number of control groups a player can store
+constexpr int get_n_control_groups() { return 10; }
+
+/// Which pieces are selected, per player,
+/// so that an order to all selected pieces only visits those,
+/// instead of searching all pieces.
+/// The pieces are denoted by their index in the collection of pieces,
+/// of which there are never more than squares on the largest board.
+/// Also keeps the control groups, i.e. the selections a player stored
+/// to select these again later
+class selection
+{
+public:
+  selection();
+
+  /// Store the selected pieces of a player as a control group,
+  /// replacing the pieces that were in that group
+  void assign_group(
+    const int group,
+    const chess_color player,
+    const std::vector<piece>& pieces
+  );
+
+  /// Count the number of pieces a player has selected
+  int count(const chess_color player) const noexcept;
+
+  /// Get the IDs of the pieces in a control group,
+  /// which may include pieces that are gone by now
+  const std::vector<id>& get_group(const int group, const chess_color player) const noexcept;
+
+  /// Get the indices of the pieces a player has selected, in increasing order
+  std::vector<int> get_indices(const chess_color player) const;
+
+  /// Is the piece with the index selected by the player?
+  bool is_selected(const int index, const chess_color player) const noexcept;
+
+  /// Add the piece with the index to the selection of the player
+  void select(const int index, const chess_color player) noexcept;
+
+  /// Remove the piece with the index from the selection of the player
+  void unselect(const int index, const chess_color player) noexcept;
+
+  /// Remove all pieces from the selection of the player, in one go
+  void unselect_all(const chess_color player) noexcept;
+
+  /// Rebuild the selections from the pieces,
+  /// which is needed after pieces have been removed
+  /// or (un)selected outside of a tick
+  void update(const std::vector<piece>& pieces);
+
+private:
+
+  /// One bit per piece index, 64 indices per word
+  using bits = std::array<
+    std::uint64_t,
+    (get_max_board_size() * get_max_board_size()) / 64
+  >;
+
+  /// The pieces black has selected
+  bits m_black;
+
+  /// The control groups of black
+  std::array<std::vector<id>, get_n_control_groups()> m_black_groups;
+
+  /// The pieces white has selected
+  bits m_white;
+
+  /// The control groups of white
+  std::array<std::vector<id>, get_n_control_groups()> m_white_groups;
+
+  bits& get_bits(const chess_color player) noexcept;
+  const bits& get_bits(const chess_color player) const noexcept;
+};
+
+/// Test this class and its free functions
+void test_selection();
+
+#endif // SELECTION_H
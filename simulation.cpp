@@ -0,0 +1,374 @@
+#include "simulation.h"
+
+#include "batch_scheduler.h"
+#include "simulation_job.h"
+
+#ifndef _WIN32
+#include "distributed_simulation.h"
+#include "tcp_listener.h"
+#endif // _WIN32
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+simulation_options get_default_simulation_options() noexcept
+{
+  return simulation_options{
+    get_default_board_size(),
+    256,
+    delta_t(1.0 / 60.0),
+    get_default_game_speed(),
+    delta_t(600.0),
+    1,
+    1,
+    0,
+    42,
+    get_default_starting_position()
+  };
+}
+
+std::string get_simulation_usage() noexcept
+{
+  std::stringstream s;
+  s << "Usage: --simulate [option]...\n"
+    << "Play games between two bots, without a window or audio\n"
+    << "\n"
+    << "Options:\n"
+    << "  --board-size N   number of squares along one side of the board\n"
+    << "  --chunk N        number of ticks a game is advanced by at a time\n"
+    << "  --games N        number of games\n"
+    << "  --max-time T     in-game time after which a game is a draw\n"
+    << "  --position NAME  starting position, one of:";
+  for (const auto t: get_all_starting_position_types()) s << ' ' << to_str(t);
+  s << "\n"
+    << "  --port N         hand out the games to worker processes\n"
+    << "                   that connect at this port\n"
+    << "  --seed S         seed of the first game\n"
+    << "  --threads N      number of threads, 0 for one per core\n"
+    << "  --speed NAME     game speed, one of:";
+  game_speed speed{game_speed::slowest};
+  do
+  {
+    s << ' ' << to_str(speed);
+    speed = get_next(speed);
+  }
+  while (speed != game_speed::slowest);
+  s << '\n'
+    << "\n"
+    << "Usage: --worker HOST PORT\n"
+    << "Play the games handed out by a simulation at another process,\n"
+    << "that was started with '--simulate --port PORT'\n";
+  return s.str();
+}
+
+simulation_options parse_simulation_args(const std::vector<std::string>& args)
+{
+  auto options{get_default_simulation_options()};
+  const int n_args{static_cast<int>(args.size())};
+  for (int i{1}; i < n_args; ++i)
+  {
+    const auto& arg{args[i]};
+    if (arg == "--simulate") continue;
+    if (i + 1 == n_args)
+    {
+      throw std::runtime_error("Missing value for argument '" + arg + "'");
+    }
+    const auto& value{args[++i]};
+    try
+    {
+      if (arg == "--board-size") options.m_board_size = std::stoi(value);
+      else if (arg == "--chunk") options.m_chunk_size = std::stoi(value);
+      else if (arg == "--games") options.m_n_games = std::stoi(value);
+      else if (arg == "--max-time") options.m_max_game_time = delta_t(std::stod(value));
+      else if (arg == "--port") options.m_port = std::stoi(value);
+      else if (arg == "--position") options.m_starting_position = to_starting_position_type(value);
+      else if (arg == "--seed") options.m_seed = static_cast<unsigned int>(std::stoul(value));
+      else if (arg == "--speed") options.m_game_speed = to_game_speed(value);
+      else if (arg == "--threads") options.m_n_threads = std::stoi(value);
+      else throw std::runtime_error("Unknown argument '" + arg + "'");
+    }
+    catch (const std::logic_error&)
+    {
+      // Thrown by std::stoi and friends
+      throw std::runtime_error("Invalid value '" + value + "' for argument '" + arg + "'");
+    }
+  }
+  if (options.m_board_size < get_default_board_size()
+    || options.m_board_size > get_max_board_size())
+  {
+    throw std::runtime_error("Invalid board size");
+  }
+  if (options.m_chunk_size < 1) throw std::runtime_error("Invalid chunk size");
+  if (options.m_n_games < 1) throw std::runtime_error("Invalid number of games");
+  if (options.m_n_threads < 0) throw std::runtime_error("Invalid number of threads");
+  if (options.m_port < 0 || options.m_port > 65535) throw std::runtime_error("Invalid port");
+  if (!(options.m_max_game_time > delta_t(0.0))) throw std::runtime_error("Invalid maximum time");
+  return options;
+}
+
+game_options get_game_options(const simulation_options& options)
+{
+  auto game_options{get_default_game_options()};
+  game_options.set_board_size(options.m_board_size);
+  game_options.set_game_speed(options.m_game_speed);
+  game_options.set_max_game_time(options.m_max_game_time);
+  game_options.set_starting_position(options.m_starting_position);
+  return game_options;
+}
+
+simulation::simulation(
+  const simulation_options& options,
+  const unsigned int seed
+) : simulation(get_game_options(options), options.m_frame_time, seed)
+{
+
+}
+
+simulation::simulation(
+  const game_options& options,
+  const delta_t& frame_time,
+  const unsigned int seed,
+  const bot_version& white_bot,
+  const bot_version& black_bot
+) : m_black(chess_color::black, (2 * seed) + 1, black_bot),
+    m_dt{frame_time * to_delta_t(options.get_game_speed())},
+    m_game(options),
+    m_n_ticks{0},
+    m_result{game_result::undecided},
+    m_white(chess_color::white, 2 * seed, white_bot)
+{
+  // Each bot has its own random numbers, that differ per game
+}
+
+simulation_result simulation::get_result() const
+{
+  return simulation_result{m_result, m_n_ticks, m_game.get_time()};
+}
+
+bool simulation::run(const int max_n_ticks)
+{
+  assert(max_n_ticks > 0);
+  for (int i{0}; i != max_n_ticks && !is_over(); ++i)
+  {
+    m_white.play(m_game);
+    m_black.play(m_game);
+    m_result = m_game.tick(m_dt);
+    // Nobody listens to the sounds
+    clear_piece_messages(m_game);
+    ++m_n_ticks;
+  }
+  return is_over();
+}
+
+simulation_result run_simulation(
+  const simulation_options& options,
+  const unsigned int seed
+)
+{
+  simulation s(options, seed);
+  while (!s.run(options.m_chunk_size)) {}
+  return s.get_result();
+}
+
+void run_simulations(const simulation_options& options, std::ostream& os)
+{
+  assert(options.m_n_games > 0);
+  #ifndef _WIN32
+  if (options.m_port != 0)
+  {
+    tcp_listener listener(options.m_port);
+    std::clog << "Waiting for workers at port " << listener.get_port() << '\n';
+    const auto r{run_coordinator(create_simulation_jobs(options), listener)};
+    show_simulation_results(options, r.m_results, os);
+    os << r;
+    return;
+  }
+  #endif // _WIN32
+  const auto batch{run_batch(options)};
+  show_simulation_results(options, batch.m_results, os);
+  os << batch;
+}
+
+void show_simulation_results(
+  const simulation_options& options,
+  const std::vector<simulation_result>& results,
+  std::ostream& os
+)
+{
+  assert(static_cast<int>(results.size()) == options.m_n_games);
+  os << "game\tseed\tresult\tn_ticks\ttime\n";
+  int n_white_wins{0};
+  int n_black_wins{0};
+  int n_draws{0};
+  for (int i{0}; i != options.m_n_games; ++i)
+  {
+    const unsigned int seed{options.m_seed + i};
+    const auto& r{results[i]};
+    os << i << '\t' << seed << '\t' << r.m_result << '\t'
+      << r.m_n_ticks << '\t' << r.m_time << '\n'
+    ;
+    switch (r.m_result)
+    {
+      case game_result::white_wins: ++n_white_wins; break;
+      case game_result::black_wins: ++n_black_wins; break;
+      default:
+        assert(r.m_result == game_result::draw);
+        ++n_draws;
+        break;
+    }
+  }
+  os << "white_wins: " << n_white_wins << '\n'
+    << "black_wins: " << n_black_wins << '\n'
+    << "draws: " << n_draws << '\n'
+  ;
+}
+
+game_result to_game_result(const std::string& s)
+{
+  for (const auto r: get_all_game_results())
+  {
+    if (to_str(r) == s) return r;
+  }
+  throw std::runtime_error("Unknown game result '" + s + "'");
+}
+
+game_speed to_game_speed(const std::string& s)
+{
+  game_speed speed{game_speed::slowest};
+  do
+  {
+    if (to_str(speed) == s) return speed;
+    speed = get_next(speed);
+  }
+  while (speed != game_speed::slowest);
+  throw std::runtime_error("Unknown game speed '" + s + "'");
+}
+
+starting_position_type to_starting_position_type(const std::string& s)
+{
+  for (const auto t: get_all_starting_position_types())
+  {
+    if (to_str(t) == s) return t;
+  }
+  throw std::runtime_error("Unknown starting position '" + s + "'");
+}
+
+void test_simulation()
+{
+#ifndef NDEBUG
+  // to_game_speed
+  {
+    assert(to_game_speed(to_str(game_speed::fast)) == game_speed::fast);
+    bool has_thrown{false};
+    try { to_game_speed("nonsense"); } catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+  // to_game_result
+  {
+    for (const auto r: get_all_game_results())
+    {
+      assert(to_game_result(to_str(r)) == r);
+    }
+  }
+  // to_starting_position_type
+  {
+    for (const auto t: get_all_starting_position_types())
+    {
+      assert(to_starting_position_type(to_str(t)) == t);
+    }
+  }
+  // parse_simulation_args, defaults
+  {
+    const auto options{parse_simulation_args({"game", "--simulate"})};
+    assert(options.m_n_games == get_default_simulation_options().m_n_games);
+  }
+  // parse_simulation_args
+  {
+    const auto options{
+      parse_simulation_args(
+        {
+          "game", "--simulate", "--games", "3", "--seed", "7",
+          "--position", to_str(starting_position_type::kings_only),
+          "--speed", to_str(game_speed::fastest),
+          "--max-time", "12.5", "--board-size", "16",
+          "--threads", "4", "--chunk", "32"
+        }
+      )
+    };
+    assert(options.m_n_games == 3);
+    assert(options.m_seed == 7);
+    assert(options.m_starting_position == starting_position_type::kings_only);
+    assert(options.m_game_speed == game_speed::fastest);
+    assert(options.m_max_game_time == delta_t(12.5));
+    assert(options.m_board_size == 16);
+    assert(options.m_n_threads == 4);
+    assert(options.m_chunk_size == 32);
+  }
+  // parse_simulation_args, invalid arguments
+  {
+    const std::vector<std::vector<std::string>> invalids{
+      {"game", "--simulate", "--games"},
+      {"game", "--simulate", "--games", "many"},
+      {"game", "--simulate", "--games", "0"},
+      {"game", "--simulate", "--nonsense", "1"},
+      {"game", "--simulate", "--board-size", "7"},
+      {"game", "--simulate", "--chunk", "0"},
+      {"game", "--simulate", "--threads", "-1"},
+      {"game", "--simulate", "--port", "65536"}
+    };
+    for (const auto& args: invalids)
+    {
+      bool has_thrown{false};
+      try { parse_simulation_args(args); } catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // get_simulation_usage
+  {
+    assert(get_simulation_usage().find("--games") != std::string::npos);
+  }
+  // run_simulation ends at the latest at the maximum time
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(5.0);
+    const auto r{run_simulation(options, 1)};
+    assert(is_over(r.m_result));
+    assert(r.m_n_ticks > 0);
+    assert(!(delta_t(5.0 + 1.0) < r.m_time));
+  }
+  // A simulation can be played a chunk of ticks at a time
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(5.0);
+    simulation s(options, 1);
+    assert(!s.is_over());
+    assert(s.get_result().m_result == game_result::undecided);
+    assert(!s.run(10));
+    assert(s.get_n_ticks() == 10);
+    while (!s.run(7)) {}
+    const auto r{run_simulation(options, 1)};
+    assert(s.get_result().m_result == r.m_result);
+    assert(s.get_n_ticks() == r.m_n_ticks);
+  }
+  // run_simulation is reproducible
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(5.0);
+    const auto a{run_simulation(options, 3)};
+    const auto b{run_simulation(options, 3)};
+    assert(a.m_result == b.m_result);
+    assert(a.m_n_ticks == b.m_n_ticks);
+  }
+  // run_simulations shows a summary
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(2.0);
+    options.m_n_games = 2;
+    std::stringstream s;
+    run_simulations(options, s);
+    assert(s.str().find("ticks_per_sec") != std::string::npos);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,172 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "bot.h"
+#include "ccfwd.h"
+#include "delta_t.h"
+#include "game.h"
+#include "game_result.h"
+#include "game_speed.h"
+#include "starting_position_type.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// The settings of a run of games between two bots,
+/// without a window or audio
+struct simulation_options
+{
+  /// The number of squares along one side of the board
+  int m_board_size;
+
+  /// The number of ticks a game is advanced by at a time,
+  /// after which another thread can take over the game
+  int m_chunk_size;
+
+  /// The in-game time a frame takes,
+  /// before multiplying by the game speed
+  delta_t m_frame_time;
+
+  /// The game speed
+  game_speed m_game_speed;
+
+  /// The in-game time after which a game is a draw
+  delta_t m_max_game_time;
+
+  /// The number of games
+  int m_n_games;
+
+  /// The number of threads to play the games on,
+  /// where zero denotes one thread per core
+  int m_n_threads;
+
+  /// The port at which to hand out the games to worker processes,
+  /// where zero denotes to play all games in this process
+  int m_port;
+
+  /// The seed of the first game.
+  /// Each next game uses the next seed
+  unsigned int m_seed;
+
+  starting_position_type m_starting_position;
+};
+
+/// Get the options of the games played in a simulation
+game_options get_game_options(const simulation_options& options);
+
+/// Get the simulation options used when not specified otherwise
+simulation_options get_default_simulation_options() noexcept;
+
+/// The result of one game between two bots
+struct simulation_result
+{
+  game_result m_result;
+
+  /// The number of ticks done
+  int m_n_ticks;
+
+  /// The in-game time at the end
+  delta_t m_time;
+};
+
+/// A game between two bots,
+/// which can be advanced some ticks at a time
+class simulation
+{
+public:
+  /// Set up a game
+  /// @param seed the seed of the game, which determines what the bots do
+  explicit simulation(
+    const simulation_options& options,
+    const unsigned int seed
+  );
+
+  /// Set up a game
+  /// @param frame_time the in-game time a frame takes,
+  ///   before multiplying by the game speed
+  /// @param seed the seed of the game, which determines what the bots do
+  /// @param white_bot the version of the bot that plays white
+  /// @param black_bot the version of the bot that plays black
+  explicit simulation(
+    const game_options& options,
+    const delta_t& frame_time,
+    const unsigned int seed,
+    const bot_version& white_bot = get_default_bot_version(),
+    const bot_version& black_bot = get_default_bot_version()
+  );
+
+  /// Get the number of ticks done
+  auto get_n_ticks() const noexcept { return m_n_ticks; }
+
+  /// Get the result so far,
+  /// which is 'undecided' while the game is on
+  simulation_result get_result() const;
+
+  /// Is the game over?
+  bool is_over() const noexcept { return ::is_over(m_result); }
+
+  /// Advance the game by at most a number of ticks,
+  /// stopping early if the game is over
+  /// @return true if the game is over
+  bool run(const int max_n_ticks);
+
+private:
+
+  bot m_black;
+
+  /// The in-game time of a tick
+  delta_t m_dt;
+
+  game m_game;
+
+  int m_n_ticks;
+
+  game_result m_result;
+
+  bot m_white;
+};
+
+/// Play a game between two bots, as fast as possible
+simulation_result run_simulation(
+  const simulation_options& options,
+  const unsigned int seed
+);
+
+/// Play all games between two bots, as fast as possible,
+/// on all threads asked for, or by the worker processes that connect,
+/// showing the result of each game and a summary with the ticks
+/// and games per second, and how busy each thread was
+void run_simulations(const simulation_options& options, std::ostream& os);
+
+/// Get the simulation options from the command-line arguments,
+/// e.g. '--simulate --games 10 --seed 42 --position kings_only --speed fast'
+/// @param args the command-line arguments, the first being the program name
+simulation_options parse_simulation_args(const std::vector<std::string>& args);
+
+/// Get the help text of the command-line arguments of a simulation
+std::string get_simulation_usage() noexcept;
+
+/// Show the result of each game and how many games each player won
+void show_simulation_results(
+  const simulation_options& options,
+  const std::vector<simulation_result>& results,
+  std::ostream& os
+);
+
+/// Get the game result from its name, as shown by 'to_str'.
+/// Will throw if there is no such game result
+game_result to_game_result(const std::string& s);
+
+/// Get the game speed from its name, as shown by 'to_str'.
+/// Will throw if there is no such game speed
+game_speed to_game_speed(const std::string& s);
+
+/// Get the starting position type from its name, as shown by 'to_str'.
+/// Will throw if there is no such starting position type
+starting_position_type to_starting_position_type(const std::string& s);
+
+/// Test this class and its free functions
+void test_simulation();
+
+#endif // SIMULATION_H
@@ -0,0 +1,221 @@
+#include "simulation_job.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<simulation_job> create_simulation_jobs(const simulation_options& options)
+{
+  assert(options.m_n_games > 0);
+  const auto game_options{get_game_options(options)};
+  std::vector<simulation_job> jobs;
+  jobs.reserve(options.m_n_games);
+  for (int i{0}; i != options.m_n_games; ++i)
+  {
+    jobs.push_back(
+      simulation_job{
+        game_options,
+        options.m_frame_time,
+        i,
+        options.m_seed + i,
+        get_default_bot_version(),
+        get_default_bot_version()
+      }
+    );
+  }
+  return jobs;
+}
+
+simulation_result play(const simulation_job& job)
+{
+  simulation s(
+    job.m_game_options,
+    job.m_frame_time,
+    job.m_seed,
+    job.m_white_bot,
+    job.m_black_bot
+  );
+  while (!s.run(256)) {}
+  return s.get_result();
+}
+
+std::string to_exact_str(const double d)
+{
+  std::stringstream s;
+  s << std::setprecision(std::numeric_limits<double>::max_digits10) << d;
+  return s.str();
+}
+
+simulation_job to_simulation_job(const std::string& s)
+{
+  std::stringstream stream(s);
+  std::string word;
+  int index{0};
+  unsigned int seed{0};
+  int board_size{0};
+  std::string starting_position;
+  std::string speed;
+  std::string max_game_time;
+  std::string frame_time;
+  double damage{0.0};
+  double movement_speed{0.0};
+  stream >> word >> index >> seed >> board_size
+    >> starting_position >> speed >> max_game_time >> frame_time
+    >> damage >> movement_speed
+  ;
+  std::map<piece_type, double> max_healths;
+  for (const auto t: get_all_piece_types()) stream >> max_healths[t];
+  std::string white_bot;
+  std::string black_bot;
+  stream >> white_bot >> black_bot;
+  const bool is_positive{
+    damage > 0.0 && movement_speed > 0.0
+    && std::all_of(
+      std::begin(max_healths),
+      std::end(max_healths),
+      [](const auto& p) { return p.second > 0.0; }
+    )
+  };
+  if (!stream || word != "job" || board_size < get_default_board_size() || !is_positive)
+  {
+    throw std::runtime_error("Invalid job '" + s + "'");
+  }
+  auto options{get_default_game_options()};
+  options.set_board_size(board_size);
+  options.set_damage_per_chess_move(damage);
+  options.set_game_speed(to_game_speed(speed));
+  options.set_max_game_time(delta_t(std::stod(max_game_time)));
+  for (const auto& p: max_healths) options.set_max_health(p.first, p.second);
+  options.set_movement_speed(movement_speed);
+  options.set_starting_position(to_starting_position_type(starting_position));
+  return simulation_job{
+    options,
+    delta_t(std::stod(frame_time)),
+    index,
+    seed,
+    to_bot_version(white_bot),
+    to_bot_version(black_bot)
+  };
+}
+
+std::string to_str(const simulation_job& job)
+{
+  std::stringstream s;
+  s << "job " << job.m_index << ' ' << job.m_seed << ' '
+    << job.m_game_options.get_board_size() << ' '
+    << to_str(job.m_game_options.get_starting_position()) << ' '
+    << to_str(job.m_game_options.get_game_speed()) << ' '
+    << to_exact_str(job.m_game_options.get_max_game_time().get()) << ' '
+    << to_exact_str(job.m_frame_time.get()) << ' '
+    << to_exact_str(job.m_game_options.get_damage_per_chess_move()) << ' '
+    << to_exact_str(job.m_game_options.get_movement_speed())
+  ;
+  for (const auto t: get_all_piece_types())
+  {
+    s << ' ' << to_exact_str(job.m_game_options.get_max_health(t));
+  }
+  s << ' ' << job.m_white_bot << ' ' << job.m_black_bot;
+  return s.str();
+}
+
+void test_simulation_job()
+{
+#ifndef NDEBUG
+  // create_simulation_jobs
+  {
+    auto options{get_default_simulation_options()};
+    options.m_n_games = 3;
+    options.m_seed = 10;
+    options.m_starting_position = starting_position_type::kings_only;
+    const auto jobs{create_simulation_jobs(options)};
+    assert(jobs.size() == 3);
+    assert(jobs[2].m_index == 2);
+    assert(jobs[2].m_seed == 12);
+    assert(jobs[2].m_game_options.get_starting_position() == starting_position_type::kings_only);
+  }
+  // A job survives being sent as text
+  {
+    auto options{get_default_simulation_options()};
+    options.m_board_size = 12;
+    options.m_game_speed = game_speed::fastest;
+    options.m_max_game_time = delta_t(0.1 + 0.2);
+    options.m_frame_time = delta_t(1.0 / 3.0);
+    options.m_starting_position = starting_position_type::queen_end_game;
+    options.m_n_games = 2;
+    auto job{create_simulation_jobs(options).back()};
+    job.m_game_options.set_damage_per_chess_move(1.5);
+    job.m_game_options.set_max_health(piece_type::rook, 0.1 + 0.2);
+    job.m_game_options.set_movement_speed(0.75);
+    job.m_black_bot = bot_version{bot_type::greedy, delta_t(0.25)};
+    const auto text{to_str(job)};
+    assert(text.find('\n') == std::string::npos);
+    assert(to_simulation_job(text) == job);
+  }
+  // Invalid jobs
+  {
+    const std::vector<std::string> invalids{
+      "",
+      "job",
+      "job 1 2",
+      "nonsense 1 2 8 standard normal 1 1 1 1 1 1 1 1 1 1 random:1 random:1",
+      "job 1 2 8 standard normal 1 1 0 1 1 1 1 1 1 1 random:1 random:1",
+      "job 1 2 8 standard normal 1 1 1 1 1 1 1 1 1 1 random:1",
+      "job 1 2 8 standard normal 1 1 1 1 1 1 1 1 1 1 random:1 nonsense:1"
+    };
+    for (const auto& s: invalids)
+    {
+      bool has_thrown{false};
+      try { to_simulation_job(s); } catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // play gives the same result as run_simulation
+  {
+    auto options{get_default_simulation_options()};
+    options.m_max_game_time = delta_t(2.0);
+    const auto job{create_simulation_jobs(options).front()};
+    const auto a{play(job)};
+    const auto b{run_simulation(options, options.m_seed)};
+    assert(a.m_result == b.m_result);
+    assert(a.m_n_ticks == b.m_n_ticks);
+    assert(a.m_time == b.m_time);
+  }
+  // to_exact_str
+  {
+    const double d{0.1 + 0.2};
+    assert(std::stod(to_exact_str(d)) == d);
+  }
+#endif // NDEBUG
+}
+
+bool is_same_max_healths(const game_options& lhs, const game_options& rhs)
+{
+  const auto types{get_all_piece_types()};
+  return std::all_of(
+    std::begin(types),
+    std::end(types),
+    [&lhs, &rhs](const auto t) { return lhs.get_max_health(t) == rhs.get_max_health(t); }
+  );
+}
+
+bool operator==(const simulation_job& lhs, const simulation_job& rhs) noexcept
+{
+  const auto& a{lhs.m_game_options};
+  const auto& b{rhs.m_game_options};
+  return lhs.m_index == rhs.m_index
+    && lhs.m_seed == rhs.m_seed
+    && lhs.m_frame_time == rhs.m_frame_time
+    && a.get_board_size() == b.get_board_size()
+    && a.get_damage_per_chess_move() == b.get_damage_per_chess_move()
+    && a.get_movement_speed() == b.get_movement_speed()
+    && is_same_max_healths(a, b)
+    && lhs.m_white_bot == rhs.m_white_bot
+    && lhs.m_black_bot == rhs.m_black_bot
+    && a.get_game_speed() == b.get_game_speed()
+    && a.get_max_game_time() == b.get_max_game_time()
+    && a.get_starting_position() == b.get_starting_position()
+  ;
+}
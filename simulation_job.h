@@ -0,0 +1,68 @@
+#ifndef SIMULATION_JOB_H
+#define SIMULATION_JOB_H
+
+#include "bot_version.h"
+#include "ccfwd.h"
+#include "delta_t.h"
+#include "game_options.h"
+#include "simulation.h"
+
+#include <string>
+#include <vector>
+
+/// One game of a simulation between two bots,
+/// that can be sent to another process to be played there
+struct simulation_job
+{
+  /// The options of the game
+  game_options m_game_options;
+
+  /// The in-game time a frame takes,
+  /// before multiplying by the game speed
+  delta_t m_frame_time;
+
+  /// The index of the game in the simulation
+  int m_index;
+
+  /// The seed of the game, which determines what the bots do
+  unsigned int m_seed;
+
+  /// The version of the bot that plays white
+  bot_version m_white_bot;
+
+  /// The version of the bot that plays black
+  bot_version m_black_bot;
+};
+
+/// Get the jobs of all games of a simulation,
+/// in the order of the games
+std::vector<simulation_job> create_simulation_jobs(const simulation_options& options);
+
+/// Do two game options give the pieces the same maximum health?
+bool is_same_max_healths(const game_options& lhs, const game_options& rhs);
+
+/// Play the game of a job, as fast as possible
+simulation_result play(const simulation_job& job);
+
+/// Test this class and its free functions
+void test_simulation_job();
+
+/// Get a double as text, from which 'std::stod' gives the exact same double
+std::string to_exact_str(const double d);
+
+/// Get the job from its line of text, as shown by 'to_str'.
+/// Will throw if the line is not a job
+simulation_job to_simulation_job(const std::string& s);
+
+/// Get the job as one line of text, e.g.
+/// 'job 3 45 8 standard normal 600 0.016666666666666666 1 1 1 1 1 1 1 1
+/// aggressive:0.5 greedy:0.25',
+/// being the index, seed, board size, starting position,
+/// game speed, maximum game time, frame time, damage per chess move,
+/// movement speed, the maximum health per piece type
+/// and the versions of the white and black bot
+std::string to_str(const simulation_job& job);
+
+bool operator==(const simulation_job& lhs, const simulation_job& rhs) noexcept;
+
+#endif // SIMULATION_JOB_H
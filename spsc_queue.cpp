@@ -0,0 +1,111 @@
+#include "spsc_queue.h"
+
+#include <thread>
+
+void test_spsc_queue()
+{
+#ifndef NDEBUG
+  // An empty queue
+  {
+    spsc_queue<int> q(4);
+    assert(q.get_capacity() == 4);
+    assert(q.get_size() == 0);
+    assert(!q.try_pop());
+  }
+  // Items come out in the order they were put in
+  {
+    spsc_queue<int> q(4);
+    assert(q.try_push(1));
+    assert(q.try_push(2));
+    assert(q.get_size() == 2);
+    assert(q.try_pop().value() == 1);
+    assert(q.try_pop().value() == 2);
+    assert(!q.try_pop());
+  }
+  // A full queue refuses items
+  {
+    spsc_queue<int> q(2);
+    assert(q.try_push(1));
+    assert(q.try_push(2));
+    assert(!q.try_push(3));
+    assert(q.try_pop().value() == 1);
+    assert(q.try_push(3));
+  }
+  // The ring buffer wraps around
+  {
+    spsc_queue<int> q(4);
+    for (int i{0}; i != 10; ++i)
+    {
+      assert(q.try_push(i));
+      assert(q.try_pop().value() == i);
+    }
+  }
+  // drain takes out all items
+  {
+    spsc_queue<int> q(4);
+    q.try_push(1);
+    q.try_push(2);
+    q.try_push(3);
+    int sum{0};
+    assert(q.drain([&sum](const int i) { sum += i; }) == 3);
+    assert(sum == 6);
+    assert(q.get_size() == 0);
+  }
+  // A copy has the same items
+  {
+    spsc_queue<int> q(4);
+    q.try_push(42);
+    const spsc_queue<int> copy{q};
+    assert(copy.get_size() == 1);
+  }
+  // An assigned queue has the same items, also when wrapped around
+  {
+    spsc_queue<int> q(4);
+    for (int i{0}; i != 3; ++i) q.try_push(i);
+    q.drain([](const int) {});
+    q.try_push(3);
+    q.try_push(4);
+    spsc_queue<int> other(4);
+    other.try_push(42);
+    other = q;
+    assert(other.get_size() == 2);
+    assert(other.try_pop() == 3);
+    assert(other.try_pop() == 4);
+    assert(!other.try_pop());
+    spsc_queue<int> larger(8);
+    larger = q;
+    assert(larger.get_capacity() == 4);
+    assert(larger.get_size() == 2);
+  }
+  // One thread puts items in while another takes them out
+  {
+    spsc_queue<int> q(64);
+    const int n{100000};
+    std::thread producer(
+      [&q, n]()
+      {
+        for (int i{0}; i != n; ++i)
+        {
+          while (!q.try_push(i)) std::this_thread::yield();
+        }
+      }
+    );
+    int expected{0};
+    while (expected != n)
+    {
+      const auto n_drained{
+        q.drain(
+          [&expected](const int i)
+          {
+            assert(i == expected);
+            ++expected;
+          }
+        )
+      };
+      if (n_drained == 0) std::this_thread::yield();
+    }
+    producer.join();
+    assert(q.get_size() == 0);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,166 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+/// A wait-free queue with a fixed capacity,
+/// for one thread to put items in (the producer)
+/// and one other thread to take items out (the consumer).
+/// Neither thread ever waits for the other:
+/// when the queue is full, adding an item fails instead.
+///
+/// The items are kept in a ring buffer,
+/// of which the producer only moves the tail
+/// and the consumer only moves the head.
+/// The head and tail only ever increase,
+/// so that the number of items is 'tail - head'.
+template <class T>
+class spsc_queue
+{
+public:
+  /// Create an empty queue
+  /// @param capacity the maximum number of items in the queue,
+  ///   must be a power of two
+  explicit spsc_queue(const std::size_t capacity = 1024)
+    : m_head{0},
+      m_tail{0},
+      m_mask{capacity - 1},
+      m_slots(capacity)
+  {
+    assert(capacity > 0);
+    assert((capacity & m_mask) == 0);
+  }
+
+  /// Copy the queue.
+  /// This is not thread-safe:
+  /// no thread may use either queue while copying
+  spsc_queue(const spsc_queue& other)
+    : m_head{other.m_head.load()},
+      m_tail{other.m_tail.load()},
+      m_mask{other.m_mask},
+      m_slots(other.m_slots.size())
+  {
+    copy_items(other);
+  }
+
+  /// Copy the queue.
+  /// Only the items in the queue are copied,
+  /// so that assigning a mostly empty queue to a queue
+  /// of the same capacity is cheap.
+  /// This is not thread-safe:
+  /// no thread may use either queue while copying
+  spsc_queue& operator=(const spsc_queue& other)
+  {
+    if (this == &other) return *this;
+    if (m_slots.size() == other.m_slots.size())
+    {
+      drain([](const T&) {});
+    }
+    else
+    {
+      m_slots = std::vector<std::optional<T>>(other.m_slots.size());
+    }
+    m_head.store(other.m_head.load());
+    m_tail.store(other.m_tail.load());
+    m_mask = other.m_mask;
+    copy_items(other);
+    return *this;
+  }
+
+  /// Take all items out of the queue, in the order they were put in,
+  /// passing each to a function.
+  /// Items put in while draining are left for the next time.
+  /// Only to be called by the consumer
+  /// @return the number of items taken out
+  template <class Function>
+  std::size_t drain(Function f)
+  {
+    const std::size_t head{m_head.load(std::memory_order_relaxed)};
+    const std::size_t tail{m_tail.load(std::memory_order_acquire)};
+    for (std::size_t i{head}; i != tail; ++i)
+    {
+      auto& slot{m_slots[i & m_mask]};
+      f(*slot);
+      slot.reset();
+    }
+    m_head.store(tail, std::memory_order_release);
+    return tail - head;
+  }
+
+  /// The maximum number of items in the queue
+  std::size_t get_capacity() const noexcept { return m_slots.size(); }
+
+  /// The number of items in the queue.
+  /// When called while the other thread uses the queue,
+  /// this is a snapshot that may be outdated directly
+  std::size_t get_size() const noexcept
+  {
+    return m_tail.load(std::memory_order_acquire)
+      - m_head.load(std::memory_order_acquire)
+    ;
+  }
+
+  /// Take the first item out of the queue,
+  /// if there is one.
+  /// Only to be called by the consumer
+  std::optional<T> try_pop()
+  {
+    const std::size_t head{m_head.load(std::memory_order_relaxed)};
+    if (head == m_tail.load(std::memory_order_acquire)) return {};
+    auto& slot{m_slots[head & m_mask]};
+    std::optional<T> item{std::move(slot)};
+    slot.reset();
+    m_head.store(head + 1, std::memory_order_release);
+    return item;
+  }
+
+  /// Put an item at the end of the queue,
+  /// which fails if the queue is full.
+  /// Only to be called by the producer
+  /// @return true if the item was put in the queue
+  bool try_push(const T& item)
+  {
+    const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+    if (tail - m_head.load(std::memory_order_acquire) == m_slots.size())
+    {
+      return false;
+    }
+    m_slots[tail & m_mask] = item;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+
+  /// Copy the items of another queue, that has the same head, tail and capacity,
+  /// into the empty slots of this queue
+  void copy_items(const spsc_queue& other)
+  {
+    const std::size_t tail{m_tail.load()};
+    for (std::size_t i{m_head.load()}; i != tail; ++i)
+    {
+      m_slots[i & m_mask] = other.m_slots[i & m_mask];
+    }
+  }
+
+  /// The index of the first item, only moved by the consumer.
+  /// On its own cache line, so that the threads
+  /// do not slow each other down
+  alignas(64) std::atomic<std::size_t> m_head;
+
+  /// The index after the last item, only moved by the producer
+  alignas(64) std::atomic<std::size_t> m_tail;
+
+  alignas(64) std::size_t m_mask;
+
+  std::vector<std::optional<T>> m_slots;
+};
+
+/// Test this class and its free functions
+void test_spsc_queue();
+
+#endif // SPSC_QUEUE_H
@@ -7,29 +7,38 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <iterator>
 #include <regex>
 #include <sstream>
 
 square::square(const std::string& pos)
+  : m_x{0}, m_y{0}
 {
-  assert(pos.size() == 2);
-  assert(std::regex_match(pos, std::regex("^[a-h][1-8]$")));
-  m_y = pos[0] - 'a';
-  m_x = pos[1] - '1';
-  assert(is_valid_square_xy(m_x, m_y));
+  assert(pos.size() >= 2);
+  assert(std::regex_match(pos, std::regex("^[a-z]+[1-9][0-9]*$")));
+  // The file, in spreadsheet-column style: a, b, ..., z, aa, ab, ...
+  auto iter{std::begin(pos)};
+  int file{0};
+  for (; *iter >= 'a' && *iter <= 'z'; ++iter)
+  {
+    file = (file * 26) + (*iter - 'a' + 1);
+  }
+  m_y = file - 1;
+  m_x = std::stoi(std::string(iter, std::end(pos))) - 1;
+  assert(is_valid_square_xy(m_x, m_y, get_max_board_size()));
 }
 
 square::square(const game_coordinat& g)
   : m_x{static_cast<int>(std::trunc(g.get_x()))},
     m_y{static_cast<int>(std::trunc(g.get_y()))}
 {
-  assert(is_valid_square_xy(m_x, m_y));
+  assert(is_valid_square_xy(m_x, m_y, get_max_board_size()));
 }
 
 square::square(const int x, const int y)
   : m_x{x}, m_y{y}
 {
-  assert(is_valid_square_xy(m_x, m_y));
+  assert(is_valid_square_xy(m_x, m_y, get_max_board_size()));
 }
 
 bool are_adjacent(const square& a, const square& b) noexcept
@@ -178,11 +187,15 @@ std::vector<square> get_intermediate_squares(
   return squares;
 }
 
-square get_rotated_square(const square& position) noexcept
+square get_rotated_square(
+  const square& position,
+  const int board_size
+) noexcept
 {
+  assert(is_valid_square_xy(position.get_x(), position.get_y(), board_size));
   return square(
-    7 - position.get_x(),
-    7 - position.get_y()
+    board_size - 1 - position.get_x(),
+    board_size - 1 - position.get_y()
   );
 }
 
@@ -198,17 +211,25 @@ bool is_occupied(
   ) != std::end(occupied_squares);
 }
 
-bool is_valid_square_xy(const int x, const int y) noexcept
+bool is_valid_square_xy(
+  const int x,
+  const int y,
+  const int board_size
+) noexcept
 {
-  return x >= 0 && x < 8 && y >= 0 && y < 8;
+  return x >= 0 && x < board_size && y >= 0 && y < board_size;
 }
 
-bool is_invalid_square_xy(const int x, const int y) noexcept
+bool is_invalid_square_xy(
+  const int x,
+  const int y,
+  const int board_size
+) noexcept
 {
   return x < 0
-    || x > 7
+    || x >= board_size
     || y < 0
-    || y > 7
+    || y >= board_size
   ;
 }
 
@@ -315,6 +336,22 @@ void test_square()
     assert(get_rotated_square(square("h8")) == square("a1"));
     assert(get_rotated_square(square("h1")) == square("a8"));
   }
+  // get_rotated_square, on a larger board
+  {
+    assert(get_rotated_square(square("a1"), 16) == square("p16"));
+    assert(get_rotated_square(square("h8"), 16) == square("i9"));
+    assert(get_rotated_square(square("a1"), 32) == square("af32"));
+  }
+  // is_valid_square_xy
+  {
+    assert(is_valid_square_xy(7, 7));
+    assert(!is_valid_square_xy(8, 7));
+    assert(is_valid_square_xy(8, 7, 16));
+    assert(is_valid_square_xy(31, 31, 32));
+    assert(!is_valid_square_xy(32, 0, 32));
+    assert(is_invalid_square_xy(8, 0));
+    assert(!is_invalid_square_xy(8, 0, 16));
+  }
   // to_color
   {
     assert(to_color(square("a1")) == chess_color::black);
@@ -346,6 +383,24 @@ void test_square()
     const square s(pos);
     assert(to_str(s) == pos);
   }
+  // to_str, on a larger board
+  {
+    assert(to_str(square(9, 0)) == "a10");
+    assert(to_str(square(0, 25)) == "z1");
+    assert(to_str(square(0, 26)) == "aa1");
+    assert(to_str(square(31, 31)) == "af32");
+    assert(square("af32") == square(31, 31));
+    assert(square("z1") == square(0, 25));
+    assert(square("a10").get_x() == 9);
+    for (int x{0}; x != get_max_board_size(); ++x)
+    {
+      for (int y{0}; y != get_max_board_size(); ++y)
+      {
+        const square s(x, y);
+        assert(square(to_str(s)) == s);
+      }
+    }
+  }
   // to_str, std::vector<square>
   {
     const std::vector<square> squares{square("a1"), square("b2")};
@@ -447,12 +502,15 @@ std::vector<square> to_squares(std::vector<std::pair<int, int>> xys)
 
 std::string to_str(const square& s) noexcept
 {
+  // The file, in spreadsheet-column style: a, b, ..., z, aa, ab, ...
+  std::string file;
+  for (int n{s.get_y() + 1}; n > 0; n = (n - 1) / 26)
+  {
+    file.insert(std::begin(file), static_cast<char>('a' + ((n - 1) % 26)));
+  }
   std::stringstream st;
-  const char c1 = 'a' + s.get_y();
-  const char c2 = '1' + static_cast<char>(s.get_x());
-  st << c1 << c2;
+  st << file << (s.get_x() + 1);
   return st.str();
-
 }
 
 std::string to_str(const std::vector<square>& squares) noexcept
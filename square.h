@@ -7,7 +7,17 @@
 #include "ccfwd.h"
 #include "chess_color.h"
 
-/// A chess square, e.g. e4
+/// Get the number of squares along one side of a regular chess board
+constexpr int get_default_board_size() { return 8; }
+
+/// Get the maximum number of squares along one side of a board,
+/// as used in large-army matches
+constexpr int get_max_board_size() { return 32; }
+
+/// A chess square, e.g. e4.
+/// On boards larger than 8x8, the files continue
+/// after 'z' with 'aa', 'ab', etc., and the ranks continue after 8,
+/// e.g. 'af32' is the top-right square on a 32x32 board
 class square
 {
 public:
@@ -79,7 +89,10 @@ std::vector<square> get_intermediate_squares(
 
 /// Rotate the (coordinator of the) square,
 /// i.e. turn the board 180 degrees
-square get_rotated_square(const square& position) noexcept;
+square get_rotated_square(
+  const square& position,
+  const int board_size = get_default_board_size()
+) noexcept;
 
 /// Is the square 's' occupied?
 bool is_occupied(
@@ -87,11 +100,21 @@ bool is_occupied(
   const std::vector<square>& occupied_squares
 ) noexcept;
 
-/// Can the x and y be used to create a valid square?
-bool is_valid_square_xy(const int x, const int y) noexcept;
+/// Can the x and y be used to create a valid square
+/// on a board of the given size?
+bool is_valid_square_xy(
+  const int x,
+  const int y,
+  const int board_size = get_default_board_size()
+) noexcept;
 
-/// Can the x and y not be used to create a valid square?
-bool is_invalid_square_xy(const int x, const int y) noexcept;
+/// Can the x and y not be used to create a valid square
+/// on a board of the given size?
+bool is_invalid_square_xy(
+  const int x,
+  const int y,
+  const int board_size = get_default_board_size()
+) noexcept;
 
 /// Test this class and its free functions
 void test_square();
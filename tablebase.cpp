@@ -0,0 +1,750 @@
+#include "tablebase.h"
+
+#include "alpha_beta.h"
+#include "game.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+/// The bytes before the values in a tablebase file:
+/// 'CCTB', the version, the board size, the number of pieces,
+/// a zero and the pieces, padded with zeroes
+constexpr int get_tablebase_header_size() noexcept { return 16; }
+
+/// The most pieces a tablebase file can have
+constexpr int get_tablebase_max_n_pieces() noexcept { return 8; }
+
+/// The most positions a tablebase is created for
+constexpr std::int64_t get_max_tablebase_size() noexcept { return std::int64_t{1} << 30; }
+
+/// The value stored for a position that cannot exist
+constexpr std::uint8_t get_tablebase_invalid_value() noexcept { return 255; }
+
+tablebase::tablebase(const std::string& filename)
+  : m_board_size{0},
+    m_file(filename),
+    m_material{},
+    m_size{0}
+{
+  const auto data{m_file.get_data()};
+  if (m_file.get_size() < static_cast<std::size_t>(get_tablebase_header_size())
+    || std::memcmp(data, "CCTB", 4) != 0
+    || data[4] != 1
+    || data[6] < 2
+    || data[6] > get_tablebase_max_n_pieces()
+    || data[7] != 0
+  )
+  {
+    throw std::runtime_error("File '" + filename + "' is no tablebase");
+  }
+  m_board_size = data[5];
+  const int n_pieces{data[6]};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    m_material.push_back(static_cast<std::int8_t>(data[8 + i]));
+  }
+  m_size = get_tablebase_size(n_pieces, m_board_size);
+  if (m_board_size < 1
+    || m_board_size > get_max_board_size()
+    || static_cast<std::int64_t>(m_file.get_size()) != get_tablebase_header_size() + m_size
+  )
+  {
+    throw std::runtime_error("Tablebase '" + filename + "' has the wrong size");
+  }
+}
+
+std::vector<std::uint8_t> create_tablebase(
+  const std::string& material,
+  const int n_threads,
+  const int board_size
+)
+{
+  std::map<std::vector<std::int8_t>, std::vector<std::uint8_t>> tablebases;
+  return create_tablebase(
+    parse_tablebase_material(material),
+    n_threads,
+    board_size,
+    tablebases
+  );
+}
+
+const std::vector<std::uint8_t>& create_tablebase(
+  const std::vector<std::int8_t>& material,
+  const int n_threads,
+  const int board_size,
+  std::map<std::vector<std::int8_t>, std::vector<std::uint8_t>>& tablebases
+)
+{
+  assert(n_threads > 0);
+  assert(board_size > 0);
+  assert(static_cast<int>(material.size()) <= get_tablebase_max_n_pieces());
+  if (const auto there{tablebases.find(material)}; there != std::end(tablebases))
+  {
+    return there->second;
+  }
+
+  // The tablebases after capturing a piece that is not a king,
+  // per piece as stored on the board
+  std::map<int, std::pair<std::vector<std::int8_t>, const std::vector<std::uint8_t>*>> after_capture;
+  for (std::size_t i{0}; i != material.size(); ++i)
+  {
+    const int code{material[i]};
+    if (get_piece_type(code) == piece_type::king || after_capture.count(code)) continue;
+    auto fewer{material};
+    fewer.erase(std::begin(fewer) + i);
+    const auto& values{create_tablebase(fewer, n_threads, board_size, tablebases)};
+    after_capture[code] = std::make_pair(fewer, &values);
+  }
+
+  if (get_max_tablebase_size() / get_tablebase_size(material.size() - 1, board_size) < board_size * board_size)
+  {
+    throw std::runtime_error(
+      "Pieces '" + to_tablebase_material_str(material) + "' give a tablebase that is too big"
+    );
+  }
+  const std::int64_t size{get_tablebase_size(material.size(), board_size)};
+  const int n_squares{board_size * board_size};
+  const std::uint8_t invalid{get_tablebase_invalid_value()};
+  const int max_distance{invalid - 1};
+
+  // The value so far, where zero denotes undecided
+  std::vector<std::atomic<std::uint8_t>> values(size);
+  // The number of moves that stay in this tablebase
+  // and do not lead to a win of the other player (yet)
+  std::vector<std::atomic<std::uint8_t>> n_moves_left(size);
+  // The longest win of the other player after a capture,
+  // where 'invalid' denotes that a capture leads to no such win
+  std::vector<std::uint8_t> capture_distances(size, 0);
+  // Per distance, the positions decided at that distance
+  std::vector<std::vector<std::int64_t>> decided(max_distance + 1);
+  // Per distance, the positions that are a win at that distance,
+  // unless a faster win is found
+  std::vector<std::vector<std::int64_t>> win_candidates(max_distance + 1);
+
+  // Split the work over the threads, merging the positions decided per distance
+  const auto run_on_threads{
+    [n_threads, max_distance](
+      const std::int64_t n,
+      const auto& work,
+      std::vector<std::vector<std::int64_t>>& to_decided,
+      std::vector<std::vector<std::int64_t>>& to_candidates
+    )
+    {
+      const int n_used{static_cast<int>(std::min<std::int64_t>(n_threads, 1 + (n / 4096)))};
+      std::vector<std::vector<std::vector<std::int64_t>>> thread_decided(
+        n_used, std::vector<std::vector<std::int64_t>>(max_distance + 1)
+      );
+      std::vector<std::vector<std::vector<std::int64_t>>> thread_candidates(
+        n_used, std::vector<std::vector<std::int64_t>>(max_distance + 1)
+      );
+      std::vector<std::thread> threads;
+      for (int t{1}; t < n_used; ++t)
+      {
+        threads.emplace_back(
+          [&, t]() { work((n * t) / n_used, (n * (t + 1)) / n_used, thread_decided[t], thread_candidates[t]); }
+        );
+      }
+      work(0, n / n_used, thread_decided[0], thread_candidates[0]);
+      for (auto& thread: threads) thread.join();
+      for (int t{0}; t != n_used; ++t)
+      {
+        for (int d{0}; d <= max_distance; ++d)
+        {
+          auto& from{thread_decided[t][d]};
+          to_decided[d].insert(std::end(to_decided[d]), std::begin(from), std::end(from));
+          auto& candidates{thread_candidates[t][d]};
+          to_candidates[d].insert(std::end(to_candidates[d]), std::begin(candidates), std::end(candidates));
+        }
+      }
+    }
+  };
+
+  // Visit all positions once
+  run_on_threads(
+    size,
+    [&](
+      const std::int64_t begin,
+      const std::int64_t end,
+      std::vector<std::vector<std::int64_t>>& to_decided,
+      std::vector<std::vector<std::int64_t>>& to_candidates
+    )
+    {
+      std::vector<std::int8_t> board(n_squares, 0);
+      std::vector<position_move> moves;
+      for (std::int64_t index{begin}; index != end; ++index)
+      {
+        chess_color color_to_move;
+        if (!decode_tablebase_index(material, index, board_size, board, color_to_move))
+        {
+          values[index].store(invalid, std::memory_order_relaxed);
+          continue;
+        }
+        moves.clear();
+        chess_position(board, color_to_move, board_size).get_moves(moves);
+        int n_moves{0};
+        bool can_capture_king{false};
+        bool can_lose{true};
+        int longest_loss{0};
+        int fastest_win{invalid};
+        for (const auto& m: moves)
+        {
+          if (m.m_captured == 0)
+          {
+            ++n_moves;
+            continue;
+          }
+          if (get_piece_type(m.m_captured) == piece_type::king)
+          {
+            can_capture_king = true;
+            continue;
+          }
+          const auto& [fewer, fewer_values]{after_capture.at(m.m_captured)};
+          board[m.m_to] = board[m.m_from];
+          board[m.m_from] = 0;
+          const std::int64_t after_index{
+            get_tablebase_index(fewer, board.data(), board_size, get_other_color(color_to_move))
+          };
+          assert(after_index != -1);
+          const int after{(*fewer_values)[after_index]};
+          board[m.m_from] = board[m.m_to];
+          board[m.m_to] = m.m_captured;
+          if (after == 0)
+          {
+            can_lose = false;
+          }
+          else if (after % 2 == 0)
+          {
+            can_lose = false;
+            fastest_win = std::min(fastest_win, after + 1);
+          }
+          else
+          {
+            longest_loss = std::max(longest_loss, after);
+          }
+        }
+        assert(n_moves < 256);
+        n_moves_left[index].store(static_cast<std::uint8_t>(n_moves), std::memory_order_relaxed);
+        capture_distances[index] = can_lose ? longest_loss : invalid;
+        if (can_capture_king)
+        {
+          values[index].store(1, std::memory_order_relaxed);
+          to_decided[1].push_back(index);
+        }
+        else if (fastest_win != invalid)
+        {
+          assert(fastest_win <= max_distance);
+          to_candidates[fastest_win].push_back(index);
+        }
+        else if (n_moves == 0 && can_lose && longest_loss != 0)
+        {
+          // All moves are captures that lose
+          assert(longest_loss + 1 <= max_distance);
+          values[index].store(static_cast<std::uint8_t>(longest_loss + 1), std::memory_order_relaxed);
+          to_decided[longest_loss + 1].push_back(index);
+        }
+      }
+    },
+    decided,
+    win_candidates
+  );
+
+  // Follow the moves backwards, in order of distance
+  for (int distance{1}; distance <= max_distance; ++distance)
+  {
+    for (const auto index: win_candidates[distance])
+    {
+      std::uint8_t expected{0};
+      if (values[index].compare_exchange_strong(expected, static_cast<std::uint8_t>(distance)))
+      {
+        decided[distance].push_back(index);
+      }
+    }
+    const auto positions{std::move(decided[distance])};
+    run_on_threads(
+      positions.size(),
+      [&](
+        const std::int64_t begin,
+        const std::int64_t end,
+        std::vector<std::vector<std::int64_t>>& to_decided,
+        std::vector<std::vector<std::int64_t>>&
+      )
+      {
+        std::vector<std::int8_t> board(n_squares, 0);
+        std::vector<position_move> moves;
+        for (std::int64_t i{begin}; i != end; ++i)
+        {
+          chess_color color_to_move;
+          [[maybe_unused]] const bool is_valid{decode_tablebase_index(material, positions[i], board_size, board, color_to_move)};
+          assert(is_valid);
+          // The moves of the other player, that moved last, undone
+          const chess_color color_moved{get_other_color(color_to_move)};
+          moves.clear();
+          chess_position(board, color_moved, board_size).get_moves(moves);
+          for (const auto& m: moves)
+          {
+            if (m.m_captured != 0) continue;
+            board[m.m_to] = board[m.m_from];
+            board[m.m_from] = 0;
+            const std::int64_t before{
+              get_tablebase_index(material, board.data(), board_size, color_moved)
+            };
+            board[m.m_from] = board[m.m_to];
+            board[m.m_to] = 0;
+            assert(before != -1);
+            if (distance % 2 == 0)
+            {
+              assert(distance + 1 <= max_distance);
+              // The player to move loses, so the move leading here wins
+              std::uint8_t expected{0};
+              if (values[before].compare_exchange_strong(expected, static_cast<std::uint8_t>(distance + 1)))
+              {
+                to_decided[distance + 1].push_back(before);
+              }
+              continue;
+            }
+            // The player to move wins, so the move leading here loses
+            if (n_moves_left[before].fetch_sub(1) != 1) continue;
+            if (capture_distances[before] == invalid) continue;
+            if (values[before].load() != 0) continue;
+            const int loss{std::max(distance, static_cast<int>(capture_distances[before])) + 1};
+            assert(loss <= max_distance);
+            values[before].store(static_cast<std::uint8_t>(loss));
+            to_decided[loss].push_back(before);
+          }
+        }
+      },
+      decided,
+      win_candidates
+    );
+  }
+
+  std::vector<std::uint8_t> result(size);
+  for (std::int64_t i{0}; i != size; ++i) result[i] = values[i].load();
+  return tablebases[material] = std::move(result);
+}
+
+bool decode_tablebase_index(
+  const std::vector<std::int8_t>& material,
+  const std::int64_t index,
+  const int board_size,
+  std::vector<std::int8_t>& board,
+  chess_color& color_to_move
+)
+{
+  const int n_squares{board_size * board_size};
+  const int n_pieces{static_cast<int>(material.size())};
+  assert(index >= 0);
+  assert(index < get_tablebase_size(n_pieces, board_size));
+  assert(static_cast<int>(board.size()) == n_squares);
+  std::fill(std::begin(board), std::end(board), 0);
+  std::int64_t rest{index};
+  std::array<int, get_tablebase_max_n_pieces()> squares;
+  for (int i{n_pieces - 1}; i >= 0; --i)
+  {
+    squares[i] = static_cast<int>(rest % n_squares);
+    rest /= n_squares;
+  }
+  color_to_move = rest == 0 ? chess_color::white : chess_color::black;
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    if (board[squares[i]] != 0) return false;
+    // Pieces of the same type and color are in the order of their squares
+    if (i > 0 && material[i] == material[i - 1] && squares[i] < squares[i - 1]) return false;
+    board[squares[i]] = material[i];
+  }
+  return true;
+}
+
+void generate_tablebase(
+  const std::string& material,
+  const std::string& filename,
+  const int n_threads,
+  const int board_size
+)
+{
+  save_tablebase(
+    parse_tablebase_material(material),
+    create_tablebase(material, n_threads, board_size),
+    board_size,
+    filename
+  );
+}
+
+std::int64_t get_tablebase_index(
+  const std::vector<std::int8_t>& material,
+  const std::int8_t* const board,
+  const int board_size,
+  const chess_color color_to_move,
+  const bool is_mirrored
+)
+{
+  const int n_pieces{static_cast<int>(material.size())};
+  const int n_squares{board_size * board_size};
+  const int sign{is_mirrored ? -1 : 1};
+  std::array<int, get_tablebase_max_n_pieces()> squares;
+  std::fill(std::begin(squares), std::end(squares), -1);
+  for (int i{0}; i != n_squares; ++i)
+  {
+    const int code{board[i] * sign};
+    if (code == 0) continue;
+    // The first piece of this type and color without a square
+    int piece_index{0};
+    while (piece_index != n_pieces
+      && (material[piece_index] != code || squares[piece_index] != -1)
+    )
+    {
+      ++piece_index;
+    }
+    if (piece_index == n_pieces) return -1;
+    squares[piece_index] = i;
+  }
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    if (squares[i] == -1) return -1;
+  }
+  const bool is_white_to_move{(color_to_move == chess_color::white) != is_mirrored};
+  std::int64_t index{is_white_to_move ? 0 : 1};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    index = (index * n_squares) + squares[i];
+  }
+  return index;
+}
+
+std::int64_t get_tablebase_size(const int n_pieces, const int board_size)
+{
+  assert(n_pieces >= 0);
+  std::int64_t size{2};
+  for (int i{0}; i != n_pieces; ++i) size *= board_size * board_size;
+  return size;
+}
+
+std::vector<std::int8_t> parse_tablebase_material(const std::string& s)
+{
+  const auto v{s.find('v')};
+  if (v == std::string::npos || s.find('v', v + 1) != std::string::npos)
+  {
+    throw std::runtime_error("Pieces '" + s + "' are not of the form 'KQvK'");
+  }
+  const std::string order{"KQRBN"};
+  std::vector<std::int8_t> material;
+  for (const auto& [side, sign]: { std::make_pair(s.substr(0, v), 1), std::make_pair(s.substr(v + 1), -1) })
+  {
+    std::string sorted{side};
+    for (const char c: sorted)
+    {
+      if (c == 'P')
+      {
+        throw std::runtime_error("Pieces '" + s + "' have pawns, which cannot move back");
+      }
+      if (order.find(c) == std::string::npos)
+      {
+        throw std::runtime_error("Pieces '" + s + "' have unknown piece '" + std::string(1, c) + "'");
+      }
+    }
+    if (std::count(std::begin(side), std::end(side), 'K') != 1)
+    {
+      throw std::runtime_error("Pieces '" + s + "' must have one king per player");
+    }
+    std::sort(
+      std::begin(sorted),
+      std::end(sorted),
+      [&order](const char lhs, const char rhs) { return order.find(lhs) < order.find(rhs); }
+    );
+    for (const char c: sorted)
+    {
+      material.push_back(static_cast<std::int8_t>(sign * (static_cast<int>(to_piece_type(c)) + 1)));
+    }
+  }
+  if (static_cast<int>(material.size()) > get_tablebase_max_n_pieces())
+  {
+    throw std::runtime_error("Pieces '" + s + "' are too many for a tablebase");
+  }
+  return material;
+}
+
+std::optional<tablebase_entry> tablebase::probe(const chess_position& p) const noexcept
+{
+  if (p.get_board_size() != m_board_size) return {};
+  // The board is stored contiguously, starting at square index zero
+  const std::int8_t* const board{p.get_board().data()};
+  for (const bool is_mirrored: { false, true })
+  {
+    const std::int64_t index{
+      get_tablebase_index(m_material, board, m_board_size, p.get_color_to_move(), is_mirrored)
+    };
+    if (index != -1) return to_tablebase_entry(m_file.get_data()[get_tablebase_header_size() + index]);
+  }
+  return {};
+}
+
+std::optional<tablebase_entry> probe_tablebases(
+  const std::vector<tablebase>& tablebases,
+  const chess_position& p
+) noexcept
+{
+  for (const auto& t: tablebases)
+  {
+    if (const auto e{t.probe(p)}) return e;
+  }
+  return {};
+}
+
+void save_tablebase(
+  const std::vector<std::int8_t>& material,
+  const std::vector<std::uint8_t>& values,
+  const int board_size,
+  const std::string& filename
+)
+{
+  assert(static_cast<int>(material.size()) <= get_tablebase_max_n_pieces());
+  assert(static_cast<std::int64_t>(values.size()) == get_tablebase_size(material.size(), board_size));
+  std::array<std::uint8_t, get_tablebase_header_size()> header;
+  std::fill(std::begin(header), std::end(header), 0);
+  std::memcpy(header.data(), "CCTB", 4);
+  header[4] = 1;
+  header[5] = static_cast<std::uint8_t>(board_size);
+  header[6] = static_cast<std::uint8_t>(material.size());
+  for (std::size_t i{0}; i != material.size(); ++i)
+  {
+    header[8 + i] = static_cast<std::uint8_t>(material[i]);
+  }
+  std::ofstream f(filename, std::ios::binary);
+  f.write(reinterpret_cast<const char*>(header.data()), header.size());
+  f.write(reinterpret_cast<const char*>(values.data()), values.size());
+  if (!f)
+  {
+    throw std::runtime_error("Cannot write tablebase to '" + filename + "'");
+  }
+}
+
+void test_tablebase()
+{
+#ifndef NDEBUG
+  // parse_tablebase_material
+  {
+    const auto material{parse_tablebase_material("KNBvK")};
+    assert(material.size() == 4);
+    assert(material[0] == static_cast<int>(piece_type::king) + 1);
+    assert(material[1] == static_cast<int>(piece_type::bishop) + 1);
+    assert(material[2] == static_cast<int>(piece_type::knight) + 1);
+    assert(material[3] == -(static_cast<int>(piece_type::king) + 1));
+    assert(to_tablebase_material_str(material) == "KBNvK");
+    assert(to_tablebase_material_str(parse_tablebase_material("KvKQ")) == "KvKQ");
+    for (const std::string s: { "KQK", "KPvK", "KQvQ", "KKvK", "KXvK", "KQRBNvKQRBN" })
+    {
+      bool has_thrown{false};
+      try { parse_tablebase_material(s); }
+      catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // get_tablebase_index and decode_tablebase_index are each other's inverse
+  {
+    const auto material{parse_tablebase_material("KNNvK")};
+    const int board_size{4};
+    std::vector<std::int8_t> board(board_size * board_size, 0);
+    int n_valid{0};
+    for (std::int64_t i{0}; i != get_tablebase_size(material.size(), board_size); ++i)
+    {
+      chess_color c;
+      if (!decode_tablebase_index(material, i, board_size, board, c)) continue;
+      ++n_valid;
+      assert(get_tablebase_index(material, board.data(), board_size, c) == i);
+    }
+    // Four pieces on different squares, of which the two knights are alike
+    assert(n_valid == 2 * 16 * 15 * 14 * 13 / 2);
+  }
+  // Two kings: the one to move wins if the kings are next to each other
+  {
+    const auto material{parse_tablebase_material("KvK")};
+    const auto values{create_tablebase("KvK", 1)};
+    std::vector<std::int8_t> board(64, 0);
+    for (std::int64_t i{0}; i != static_cast<std::int64_t>(values.size()); ++i)
+    {
+      chess_color c;
+      if (!decode_tablebase_index(material, i, 8, board, c))
+      {
+        assert(values[i] == get_tablebase_invalid_value());
+        continue;
+      }
+      const int white{static_cast<int>(std::find(std::begin(board), std::end(board), material[0]) - std::begin(board))};
+      const int black{static_cast<int>(std::find(std::begin(board), std::end(board), material[1]) - std::begin(board))};
+      const bool is_next{
+        std::abs((white / 8) - (black / 8)) <= 1 && std::abs((white % 8) - (black % 8)) <= 1
+      };
+      assert(values[i] == (is_next ? 1 : 0));
+    }
+  }
+  // Each value follows from the values after each move,
+  // on a small board, so that all positions are checked quickly
+  {
+    const std::string material_str{"KRvK"};
+    const int board_size{5};
+    const auto material{parse_tablebase_material(material_str)};
+    std::map<std::vector<std::int8_t>, std::vector<std::uint8_t>> tablebases;
+    const auto& values{create_tablebase(material, 2, board_size, tablebases)};
+    assert(tablebases.size() == 2);
+    const auto& lone_kings{tablebases.at(parse_tablebase_material("KvK"))};
+    std::vector<std::int8_t> board(board_size * board_size, 0);
+    std::vector<position_move> moves;
+    int n_wins{0};
+    int max_distance{0};
+    for (std::int64_t i{0}; i != static_cast<std::int64_t>(values.size()); ++i)
+    {
+      chess_color c;
+      if (!decode_tablebase_index(material, i, board_size, board, c)) continue;
+      chess_position p(board, c, board_size);
+      moves.clear();
+      p.get_moves(moves);
+      int best{0}; // 0: no move, 1: loses, 2: draws, 3: wins
+      int fastest_win{1000};
+      int longest_loss{0};
+      for (const auto& m: moves)
+      {
+        p.do_move(m);
+        int after{0};
+        if (get_result(p) != game_result::undecided) after = -1; // King captured
+        else if (m.m_captured != 0) after = lone_kings[get_tablebase_index(parse_tablebase_material("KvK"), p.get_board().data(), board_size, p.get_color_to_move())];
+        else after = values[get_tablebase_index(material, p.get_board().data(), board_size, p.get_color_to_move())];
+        p.undo_move(m);
+        if (after == -1 || (after != 0 && after % 2 == 0))
+        {
+          best = 3;
+          fastest_win = std::min(fastest_win, after + 1 + (after == -1 ? 1 : 0));
+        }
+        else if (after == 0) best = std::max(best, 2);
+        else
+        {
+          best = std::max(best, 1);
+          longest_loss = std::max(longest_loss, after + 1);
+        }
+      }
+      const int value{values[i]};
+      if (best == 3) assert(value == fastest_win);
+      if (best == 2 || best == 0) assert(value == 0);
+      if (best == 1) assert(value == longest_loss);
+      if (value % 2 == 1) ++n_wins;
+      max_distance = std::max(max_distance, value);
+    }
+    // A rook and king win against a lone king, mostly
+    assert(n_wins > 0);
+    assert(max_distance > 10);
+    // Using more threads gives the same tablebase
+    assert(create_tablebase(material_str, 1, board_size) == values);
+  }
+  // Saving and probing a tablebase
+  {
+    const std::string filename{"test_tablebase_kqvk.cctb"};
+    std::remove(filename.c_str());
+    generate_tablebase("KQvK", filename, 2);
+    std::vector<tablebase> tablebases;
+    tablebases.emplace_back(filename);
+    const auto& t{tablebases.back()};
+    assert(t.get_board_size() == 8);
+    assert(to_tablebase_material_str(t.get_material()) == "KQvK");
+    assert(t.get_size() == 2 * 64 * 64 * 64);
+
+    // queen_end_game: 0 is the white queen at d1, 1 the white king at e1,
+    // 2 the black queen at d8, 3 the black king at e8
+    auto g{get_game_with_starting_position(starting_position_type::queen_end_game)};
+    assert(!t.probe(create_chess_position(g, chess_color::white)));
+    g.get_pieces().erase(std::begin(g.get_pieces()) + 2);
+    // The white queen can capture the black king
+    g.get_pieces()[2].set_current_square(square("d5"));
+    const auto white_wins{probe_tablebases(tablebases, create_chess_position(g, chess_color::white))};
+    assert(white_wins);
+    assert(white_wins->m_wdl == 1);
+    assert(white_wins->m_dtm == 1);
+    // The black king cannot capture the white queen, yet avoids it
+    const auto black_to_move{t.probe(create_chess_position(g, chess_color::black))};
+    assert(black_to_move);
+    assert(black_to_move->m_wdl == -1);
+    assert(black_to_move->m_dtm > 1);
+
+    // A search with the tablebase agrees with a search without it
+    const auto p{create_chess_position(g, chess_color::black)};
+    auto options{get_default_alpha_beta_options()};
+    options.m_max_depth = 4;
+    const auto without{search_position(p, options)};
+    options.m_tablebases = &tablebases;
+    const auto with{search_position(p, options)};
+    assert(with.m_n_tablebase_hits > 0);
+    assert(without.m_n_tablebase_hits == 0);
+    assert(with.m_score < 0);
+    assert(with.m_score == -get_mate_score() + black_to_move->m_dtm);
+    assert(with.m_n_nodes < without.m_n_nodes);
+
+    // The same, with the colors swapped
+    for (auto& piece: g.get_pieces())
+    {
+      piece = ::piece(
+        get_other_color(piece.get_color()),
+        piece.get_type(),
+        piece.get_current_square(),
+        piece.get_player()
+      );
+    }
+    const auto black_wins{t.probe(create_chess_position(g, chess_color::black))};
+    assert(black_wins);
+    assert(black_wins->m_wdl == 1);
+    assert(black_wins->m_dtm == 1);
+    std::remove(filename.c_str());
+  }
+  // A file that is no tablebase
+  {
+    const std::string filename{"test_tablebase_invalid.cctb"};
+    {
+      std::ofstream f(filename);
+      f << "This is no tablebase, yet is long enough to have a header";
+    }
+    bool has_thrown{false};
+    try { tablebase t(filename); }
+    catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+    std::remove(filename.c_str());
+    has_thrown = false;
+    try { tablebase t(filename); }
+    catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+  // to_tablebase_entry
+  {
+    assert(to_tablebase_entry(0).m_wdl == 0);
+    assert(to_tablebase_entry(1).m_wdl == 1);
+    assert(to_tablebase_entry(2).m_wdl == -1);
+    assert(to_tablebase_entry(2).m_dtm == 2);
+  }
+#endif // NDEBUG
+}
+
+tablebase_entry to_tablebase_entry(const std::uint8_t value) noexcept
+{
+  assert(value != get_tablebase_invalid_value());
+  if (value == 0) return tablebase_entry{0, 0};
+  return tablebase_entry{value % 2 == 1 ? 1 : -1, value};
+}
+
+std::string to_tablebase_material_str(const std::vector<std::int8_t>& material)
+{
+  std::string s;
+  bool is_white{true};
+  for (const int code: material)
+  {
+    if (is_white && code < 0)
+    {
+      s += 'v';
+      is_white = false;
+    }
+    s += "BKNPQR"[static_cast<int>(get_piece_type(code))];
+  }
+  return s;
+}
@@ -0,0 +1,174 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "chess_position.h"
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// The value of a position in a tablebase, for the player to move
+struct tablebase_entry
+{
+  /// 1 if the player to move wins, 0 if it is a draw, -1 if it loses
+  int m_wdl;
+
+  /// The number of plies until a king is captured, where zero is a draw.
+  /// This is odd for a win and even for a loss
+  int m_dtm;
+};
+
+/// An endgame tablebase of one set of pieces, e.g. 'KBNvK',
+/// as written by 'generate_tablebase', that is memory-mapped,
+/// so that a probe reads only the one byte of the position asked for.
+///
+/// A tablebase also answers for the positions with the colors swapped,
+/// e.g. the tablebase of 'KQvK' also knows the positions of 'KvKQ'
+class tablebase
+{
+public:
+  /// Map a tablebase file into memory.
+  /// Throws if the file cannot be read or is no tablebase
+  explicit tablebase(const std::string& filename);
+
+  auto get_board_size() const noexcept { return m_board_size; }
+
+  /// Get the set of pieces as stored, e.g. { 2, 1, 3, -2 } for 'KBNvK'
+  const auto& get_material() const noexcept { return m_material; }
+
+  /// Get the number of positions, including the impossible ones
+  auto get_size() const noexcept { return m_size; }
+
+  /// Get the value of a position, if it has the pieces of this tablebase.
+  /// Takes one pass over the board, regardless of the size of the tablebase
+  std::optional<tablebase_entry> probe(const chess_position& p) const noexcept;
+
+private:
+
+  int m_board_size;
+
+  /// The file, of which a probe reads one byte
+  mapped_file m_file;
+
+  std::vector<std::int8_t> m_material;
+
+  std::int64_t m_size;
+};
+
+/// Create the values of all positions of a set of pieces,
+/// by retrograde analysis, on multiple threads.
+///
+/// First, all positions are visited once, counting their moves
+/// and finding the ones in which a king can be captured right away.
+/// Captures of other pieces lead to smaller sets of pieces,
+/// of which the tablebases are created first.
+/// Then, from the positions decided so far, in order of distance
+/// to the capture of a king, the moves are followed backwards:
+/// a position in which the player to move loses makes the positions
+/// leading to it a win, and a position in which the player to move wins
+/// makes the positions leading to it a loss, once all other moves
+/// of these positions lead to a win of the other player as well.
+/// The positions not decided in the end are draws.
+///
+/// Only pieces that can move back the way these came are supported,
+/// so no pawns. The rules are those of 'chess_position',
+/// in which the game is won by capturing the king.
+///
+/// @param material the pieces, e.g. 'KBNvK',
+///   of which each side has exactly one king
+/// @param n_threads the number of threads used
+/// @return per position, as indexed by 'get_tablebase_index',
+///   the value as encoded by 'to_tablebase_entry'
+std::vector<std::uint8_t> create_tablebase(
+  const std::string& material,
+  const int n_threads,
+  const int board_size = get_default_board_size()
+);
+
+/// Create the values of all positions of a set of pieces,
+/// reusing and adding to the tablebases of the sets of pieces created earlier
+const std::vector<std::uint8_t>& create_tablebase(
+  const std::vector<std::int8_t>& material,
+  const int n_threads,
+  const int board_size,
+  std::map<std::vector<std::int8_t>, std::vector<std::uint8_t>>& tablebases
+);
+
+/// Find the board and player to move of a position in a tablebase.
+/// @return false if there is no such position,
+///   because pieces share a square, or because pieces of the same type
+///   and color are not in the order 'get_tablebase_index' puts them in
+bool decode_tablebase_index(
+  const std::vector<std::int8_t>& material,
+  const std::int64_t index,
+  const int board_size,
+  std::vector<std::int8_t>& board,
+  chess_color& color_to_move
+);
+
+/// Create the tablebase of a set of pieces and save it to file.
+/// Throws if the set of pieces is not supported,
+/// or the file cannot be written
+void generate_tablebase(
+  const std::string& material,
+  const std::string& filename,
+  const int n_threads,
+  const int board_size = get_default_board_size()
+);
+
+/// Get the index of a position in a tablebase:
+/// the color to move, followed by the square index of each piece,
+/// in the order of the pieces of the tablebase.
+/// Pieces of the same type and color are ordered by square index.
+/// @param board the piece per square index, as returned by 'chess_position::get_at'
+/// @param is_mirrored if true, the colors of the board and player are swapped
+/// @return the index, or -1 if the pieces are not those of the tablebase
+std::int64_t get_tablebase_index(
+  const std::vector<std::int8_t>& material,
+  const std::int8_t* const board,
+  const int board_size,
+  const chess_color color_to_move,
+  const bool is_mirrored = false
+);
+
+/// Get the number of positions in a tablebase with a number of pieces,
+/// including the impossible ones
+std::int64_t get_tablebase_size(const int n_pieces, const int board_size);
+
+/// Parse a set of pieces, e.g. 'KBNvK' for a white king, bishop and knight
+/// against a black king, to the pieces as stored on a board,
+/// white first, ordered king, queen, rook, bishop, knight.
+/// Throws if it is no set of pieces a tablebase can be created for
+std::vector<std::int8_t> parse_tablebase_material(const std::string& s);
+
+/// Get the value of a position in the tablebases, if any of these has it
+std::optional<tablebase_entry> probe_tablebases(
+  const std::vector<tablebase>& tablebases,
+  const chess_position& p
+) noexcept;
+
+/// Save the values of a tablebase to a file.
+/// Throws if the file cannot be written
+void save_tablebase(
+  const std::vector<std::int8_t>& material,
+  const std::vector<std::uint8_t>& values,
+  const int board_size,
+  const std::string& filename
+);
+
+/// Test this class and its free functions
+void test_tablebase();
+
+/// Get a value as stored in a tablebase, which is
+/// the number of plies until a king is captured, or zero for a draw
+tablebase_entry to_tablebase_entry(const std::uint8_t value) noexcept;
+
+/// Get a set of pieces as text, e.g. 'KBNvK'
+std::string to_tablebase_material_str(const std::vector<std::int8_t>& material);
+
+#endif // TABLEBASE_H
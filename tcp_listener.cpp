@@ -0,0 +1,77 @@
+#include "tcp_listener.h"
+
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+tcp_listener::tcp_listener(const int port)
+  : m_fd{::socket(AF_INET, SOCK_STREAM, 0)},
+    m_port{port}
+{
+  assert(port >= 0);
+  if (m_fd == -1) throw std::runtime_error("Cannot create a socket");
+  // Allow using the port directly after an earlier run
+  const int yes{1};
+  setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(static_cast<std::uint16_t>(port));
+  if (::bind(m_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1
+    || ::listen(m_fd, SOMAXCONN) == -1
+  )
+  {
+    ::close(m_fd);
+    throw std::runtime_error("Cannot listen at port " + std::to_string(port));
+  }
+  socklen_t size{sizeof(address)};
+  getsockname(m_fd, reinterpret_cast<sockaddr *>(&address), &size);
+  m_port = ntohs(address.sin_port);
+}
+
+tcp_listener::~tcp_listener()
+{
+  ::close(m_fd);
+}
+
+tcp_socket tcp_listener::accept()
+{
+  const int fd{::accept(m_fd, nullptr, nullptr)};
+  if (fd == -1) throw std::runtime_error("Cannot accept a connection");
+  return tcp_socket(fd);
+}
+
+void test_tcp_listener()
+{
+#ifndef NDEBUG
+  // The operating system picks a free port
+  {
+    const tcp_listener listener(0);
+    assert(listener.get_port() > 0);
+    assert(listener.get_fd() != -1);
+  }
+  // Two listeners cannot use the same port
+  {
+    const tcp_listener listener(0);
+    bool has_thrown{false};
+    try { tcp_listener other(listener.get_port()); } catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+  // Processes that connect are accepted in order
+  {
+    tcp_listener listener(0);
+    tcp_socket a("localhost", listener.get_port());
+    tcp_socket b("localhost", listener.get_port());
+    assert(a.send_line("a"));
+    assert(b.send_line("b"));
+    assert(listener.accept().read_line().value() == "a");
+    assert(listener.accept().read_line().value() == "b");
+  }
+#endif // NDEBUG
+}
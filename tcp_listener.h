@@ -0,0 +1,45 @@
+#ifndef TCP_LISTENER_H
+#define TCP_LISTENER_H
+
+#include "ccfwd.h"
+#include "tcp_socket.h"
+
+/// Waits for other processes to connect at a port,
+/// on all network interfaces.
+/// Stops listening when destroyed.
+/// Uses POSIX sockets, hence is not available on Windows
+class tcp_listener
+{
+public:
+  /// Start listening at a port.
+  /// Will throw if the port cannot be used
+  /// @param port the port, where zero lets the operating system pick a free one
+  explicit tcp_listener(const int port);
+
+  tcp_listener(const tcp_listener&) = delete;
+  tcp_listener& operator=(const tcp_listener&) = delete;
+  ~tcp_listener();
+
+  /// Take the next process that connected,
+  /// waiting for one to connect if needed.
+  /// Will throw if this fails
+  tcp_socket accept();
+
+  /// The file descriptor of the listening socket,
+  /// to wait for a process to connect using 'poll'
+  int get_fd() const noexcept { return m_fd; }
+
+  /// The port listened at
+  int get_port() const noexcept { return m_port; }
+
+private:
+
+  int m_fd;
+
+  int m_port;
+};
+
+/// Test this class and its free functions
+void test_tcp_listener();
+
+#endif // TCP_LISTENER_H
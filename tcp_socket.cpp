@@ -0,0 +1,194 @@
+#include "tcp_socket.h"
+
+#include "tcp_listener.h"
+
+#include <cassert>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+tcp_socket::tcp_socket(const std::string& host, const int port)
+  : m_fd{-1}
+{
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo * addresses{nullptr};
+  if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0)
+  {
+    throw std::runtime_error("Unknown host '" + host + "'");
+  }
+  for (addrinfo * a{addresses}; a != nullptr && m_fd == -1; a = a->ai_next)
+  {
+    m_fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (m_fd == -1) continue;
+    if (::connect(m_fd, a->ai_addr, a->ai_addrlen) == -1)
+    {
+      ::close(m_fd);
+      m_fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+  if (m_fd == -1)
+  {
+    throw std::runtime_error(
+      "Cannot connect to '" + host + "' at port " + std::to_string(port)
+    );
+  }
+  // Send the short lines directly, instead of waiting for more to send
+  const int yes{1};
+  setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+}
+
+tcp_socket::tcp_socket(const int fd) noexcept
+  : m_fd{fd}
+{
+  assert(m_fd != -1);
+  const int yes{1};
+  setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+}
+
+tcp_socket::tcp_socket(tcp_socket&& other) noexcept
+  : m_buffer{std::move(other.m_buffer)},
+    m_fd{std::exchange(other.m_fd, -1)}
+{
+
+}
+
+tcp_socket& tcp_socket::operator=(tcp_socket&& other) noexcept
+{
+  if (this != &other)
+  {
+    close();
+    m_buffer = std::move(other.m_buffer);
+    m_fd = std::exchange(other.m_fd, -1);
+  }
+  return *this;
+}
+
+tcp_socket::~tcp_socket()
+{
+  close();
+}
+
+void tcp_socket::close() noexcept
+{
+  if (m_fd == -1) return;
+  ::close(m_fd);
+  m_fd = -1;
+}
+
+std::optional<std::string> tcp_socket::pop_line()
+{
+  const auto end{m_buffer.find('\n')};
+  if (end == std::string::npos) return {};
+  std::string line{m_buffer.substr(0, end)};
+  m_buffer.erase(0, end + 1);
+  return line;
+}
+
+std::optional<std::string> tcp_socket::read_line()
+{
+  while (true)
+  {
+    auto line{pop_line()};
+    if (line) return line;
+    if (!receive()) return {};
+  }
+}
+
+bool tcp_socket::receive()
+{
+  if (m_fd == -1) return false;
+  char buffer[4096];
+  const auto n{::recv(m_fd, buffer, sizeof(buffer), 0)};
+  if (n <= 0)
+  {
+    close();
+    return false;
+  }
+  m_buffer.append(buffer, n);
+  return true;
+}
+
+bool tcp_socket::send_line(const std::string& line)
+{
+  assert(line.find('\n') == std::string::npos);
+  if (m_fd == -1) return false;
+  const std::string text{line + '\n'};
+  std::size_t n_sent{0};
+  while (n_sent != text.size())
+  {
+    #ifdef MSG_NOSIGNAL
+    // Do not let the process be killed when the other side is gone
+    const int flags{MSG_NOSIGNAL};
+    #else
+    const int flags{0};
+    #endif
+    const auto n{::send(m_fd, text.data() + n_sent, text.size() - n_sent, flags)};
+    if (n <= 0)
+    {
+      close();
+      return false;
+    }
+    n_sent += n;
+  }
+  return true;
+}
+
+void test_tcp_socket()
+{
+#ifndef NDEBUG
+  // Lines are sent and received in both directions
+  {
+    tcp_listener listener(0);
+    std::thread other(
+      [port = listener.get_port()]()
+      {
+        tcp_socket s("localhost", port);
+        assert(s.is_open());
+        assert(s.send_line("hello"));
+        assert(s.send_line("world"));
+        assert(s.read_line().value() == "bye");
+      }
+    );
+    tcp_socket s{listener.accept()};
+    assert(s.read_line().value() == "hello");
+    assert(s.read_line().value() == "world");
+    assert(!s.pop_line());
+    assert(s.send_line("bye"));
+    other.join();
+    // The other side is gone
+    assert(!s.read_line());
+    assert(!s.is_open());
+    assert(!s.send_line("anyone?"));
+  }
+  // A socket can be moved
+  {
+    tcp_listener listener(0);
+    tcp_socket a("localhost", listener.get_port());
+    const int fd{a.get_fd()};
+    tcp_socket b{std::move(a)};
+    assert(b.get_fd() == fd);
+    assert(!a.is_open());
+  }
+  // Connecting to nobody fails
+  {
+    int port{0};
+    {
+      const tcp_listener listener(0);
+      port = listener.get_port();
+    }
+    bool has_thrown{false};
+    try { tcp_socket s("localhost", port); } catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+#endif // NDEBUG
+}
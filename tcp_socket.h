@@ -0,0 +1,70 @@
+#ifndef TCP_SOCKET_H
+#define TCP_SOCKET_H
+
+#include "ccfwd.h"
+
+#include <optional>
+#include <string>
+
+/// A connection to another process, possibly on another computer,
+/// over which lines of text are sent and received.
+/// The connection is closed when the socket is destroyed.
+/// Uses POSIX sockets, hence is not available on Windows
+class tcp_socket
+{
+public:
+  /// Connect to a process that listens at a port.
+  /// Will throw if the connection cannot be made
+  explicit tcp_socket(const std::string& host, const int port);
+
+  tcp_socket(const tcp_socket&) = delete;
+  tcp_socket& operator=(const tcp_socket&) = delete;
+  tcp_socket(tcp_socket&& other) noexcept;
+  tcp_socket& operator=(tcp_socket&& other) noexcept;
+  ~tcp_socket();
+
+  /// Close the connection, after which nothing can be sent or received
+  void close() noexcept;
+
+  /// The file descriptor of the socket,
+  /// to wait for the socket using 'poll'.
+  /// Is -1 if the connection is closed
+  int get_fd() const noexcept { return m_fd; }
+
+  /// Is the connection open?
+  bool is_open() const noexcept { return m_fd != -1; }
+
+  /// Take the first complete line out of the received text,
+  /// without waiting for more text to arrive
+  std::optional<std::string> pop_line();
+
+  /// Take the first complete line out of the received text,
+  /// waiting for it to arrive if needed.
+  /// Returns nothing if the connection is lost first
+  std::optional<std::string> read_line();
+
+  /// Wait until text arrives, and add all text that arrived to the received text.
+  /// @return false if the connection is lost, after which it is closed
+  bool receive();
+
+  /// Send a line of text, that must not contain a newline.
+  /// @return false if the connection is lost, after which it is closed
+  bool send_line(const std::string& line);
+
+private:
+
+  /// An accepted connection
+  explicit tcp_socket(const int fd) noexcept;
+
+  /// The text received, that is not taken out yet
+  std::string m_buffer;
+
+  int m_fd;
+
+  friend class tcp_listener;
+};
+
+/// Test this class and its free functions
+void test_tcp_socket();
+
+#endif // TCP_SOCKET_H
@@ -3,6 +3,7 @@
 #include "id.h"
 #include "test_game.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -40,6 +41,86 @@ void test_game_class()
     const auto g{get_kings_only_game()};
     assert(g.get_time() == delta_t(0.0));
   }
+  // game::get_result
+  {
+    const auto g{get_kings_only_game()};
+    assert(g.get_result() == game_result::undecided);
+    assert(get_result(g) == game_result::undecided);
+    assert(!is_over(g));
+  }
+  // game::tick results
+  {
+    // When the black king is killed, white wins
+    {
+      game_options options{get_default_game_options()};
+      options.set_starting_position(starting_position_type::bishop_and_knight_end_game);
+      game g(options);
+      // Let the white knight at c4 attack the black king at d2
+      do_select_and_start_attack_keyboard_player_piece(
+        g,
+        square("c4"),
+        square("d2")
+      );
+      int cnt{0};
+      while (g.tick(delta_t(0.1)) == game_result::undecided)
+      {
+        ++cnt;
+        assert(cnt < 1000);
+      }
+      assert(get_result(g) == game_result::white_wins);
+      assert(find_pieces(g, piece_type::king, chess_color::black).empty());
+      // Once decided, the result stays the same
+      assert(g.tick(delta_t(0.1)) == game_result::white_wins);
+    }
+    // When nothing happens for too long, it is a draw
+    {
+      game_options options{get_default_game_options()};
+      options.set_starting_position(starting_position_type::kings_only);
+      options.set_max_idle_time(delta_t(2.0));
+      game g(options);
+      assert(g.tick(delta_t(1.0)) == game_result::undecided);
+      assert(g.tick(delta_t(1.0)) == game_result::draw);
+    }
+    // A moving piece is progress
+    {
+      game_options options{get_default_game_options()};
+      options.set_starting_position(starting_position_type::kings_only);
+      options.set_max_idle_time(delta_t(2.0));
+      game g(options);
+      get_piece_at(g, square("e1")).add_action(
+        piece_action(
+          side::lhs,
+          piece_type::king,
+          piece_action_type::move,
+          square("e1"),
+          square("e2")
+        )
+      );
+      assert(g.tick(delta_t(0.5)) == game_result::undecided);
+      assert(g.tick(delta_t(0.5)) == game_result::undecided);
+      // The king is idle from now on
+      assert(g.tick(delta_t(1.0)) == game_result::undecided);
+      assert(g.tick(delta_t(1.0)) == game_result::draw);
+    }
+    // When the game takes too long, it is a draw
+    {
+      game_options options{get_default_game_options()};
+      options.set_starting_position(starting_position_type::kings_only);
+      options.set_max_game_time(delta_t(1.5));
+      game g(options);
+      assert(g.tick(delta_t(1.0)) == game_result::undecided);
+      assert(g.tick(delta_t(1.0)) == game_result::draw);
+    }
+  }
+  // game::update_occupancy picks up a piece moved outside of a tick
+  {
+    game g;
+    get_piece_at(g, square("e2")).set_current_square(square("e4"));
+    g.update_occupancy();
+    assert(!is_piece_at(g, square("e2")));
+    assert(is_piece_at(g, square("e4")));
+    assert(get_piece_at(g, square("e4")).get_type() == piece_type::pawn);
+  }
   // game::tick
   {
     // A piece under attack must have decreasing health
@@ -97,6 +178,222 @@ void test_game_class()
       // Must be captured
       assert(get_piece_at(g, square("f7")).get_color() == chess_color::white);
     }
+    // On a large board, a pawn can move far forward
+    {
+      game_options options{get_default_game_options()};
+      options.set_board_size(32);
+      game g(options);
+      assert(g.get_pieces().size() == 512);
+      assert(get_player_pos(g, side::rhs).get_x() == 31.5);
+      do_select_and_move_keyboard_player_piece(g, square("ab8"), square("ab12"));
+      tick_until_idle(g);
+      assert(is_piece_at(g, square("ab12")));
+      assert(!is_piece_at(g, square("ab8")));
+      assert(get_piece_at(g, square("ab12")).get_type() == piece_type::pawn);
+    }
+    // A knight finds its way to a square it cannot jump to directly
+    {
+      game g;
+      do_select_and_move_keyboard_player_piece(g, square("b1"), square("b3"));
+      tick_until_idle(g);
+      assert(is_piece_at(g, square("b3")));
+      assert(get_piece_at(g, square("b3")).get_type() == piece_type::knight);
+    }
+    // Pieces of the same type sent to the same square share their route planning
+    {
+      game g;
+      const int n_before{g.get_route_planner().get_n_calculated()};
+      assert(!get_route(g, piece_type::knight, square("b1"), square("e4")).empty());
+      assert(!get_route(g, piece_type::knight, square("g1"), square("e4")).empty());
+      assert(g.get_route_planner().get_n_calculated() == n_before + 1);
+    }
+    // A piece that finds its way blocked moves around
+    {
+      game g;
+      piece& white_rook{get_piece_at(g, square("a1"))};
+      white_rook.set_current_square(square("e4"));
+      white_rook.add_action(
+        piece_action(side::lhs, piece_type::rook, piece_action_type::move, square("e4"), square("e6"))
+      );
+      g.update_occupancy();
+      get_piece_at(g, square("d1")).set_current_square(square("e5"));
+      tick_until_idle(g);
+      assert(is_piece_at(g, square("e6")));
+      assert(get_piece_at(g, square("e6")).get_type() == piece_type::rook);
+    }
+    // When moving freely, a piece is in between squares while moving
+    {
+      game_options options{get_default_game_options()};
+      options.set_free_movement(true);
+      game g(options);
+      do_select_and_move_keyboard_player_piece(g, square("e2"), square("e3"));
+      g.tick(delta_t(0.25));
+      const auto& pawn{get_piece_at(g, square("e2"))};
+      assert(pawn.get_coordinat().get_x() > 1.5);
+      assert(pawn.get_coordinat().get_x() < 2.0);
+      tick_until_idle(g);
+      assert(is_piece_at(g, square("e3")));
+      assert(get_piece_at(g, square("e3")).get_coordinat() == to_coordinat(square("e3")));
+    }
+    // When moving freely, pieces whose paths cross bump into each other
+    {
+      game_options options{get_default_game_options()};
+      options.set_free_movement(true);
+      game g(options);
+      piece& white_rook{get_piece_at(g, square("a1"))};
+      white_rook.set_current_square(square("e4"));
+      white_rook.add_action(
+        piece_action(side::lhs, piece_type::rook, piece_action_type::move, square("e4"), square("e6"))
+      );
+      const id white_id{white_rook.get_id()};
+      g.update_occupancy();
+      piece& black_rook{get_piece_at(g, square("a8"))};
+      black_rook.set_current_square(square("d5"));
+      black_rook.add_action(
+        piece_action(side::rhs, piece_type::rook, piece_action_type::move, square("d5"), square("f5"))
+      );
+      const id black_id{black_rook.get_id()};
+      double min_distance{1000.0};
+      int cnt{0};
+      while (has_actions(get_piece_with_id(g, white_id)) || has_actions(get_piece_with_id(g, black_id)))
+      {
+        g.tick(delta_t(0.1));
+        min_distance = std::min(
+          min_distance,
+          calc_distance(
+            get_piece_with_id(g, white_id).get_coordinat(),
+            get_piece_with_id(g, black_id).get_coordinat()
+          )
+        );
+        ++cnt;
+        assert(cnt < 1000);
+      }
+      assert(min_distance >= get_body_separation() - 0.001);
+      // The one that was sent back is where it started
+      assert(
+        piece_with_id_is_at(g, white_id, square("e4"))
+        || piece_with_id_is_at(g, black_id, square("d5"))
+      );
+      // The free movement keeps the grid up to date
+      assert(count_bodies(g.get_bodies()) == static_cast<int>(g.get_pieces().size()));
+    }
+    // The latency of user input is measured when enabled
+    {
+      game_options options{get_default_game_options()};
+      options.set_measure_latency(true);
+      game g(options);
+      do_select_and_move_keyboard_player_piece(g, square("e2"), square("e4"));
+      const auto& latency{g.get_latency()};
+      assert(latency.get_histogram(control_action_type::press_select, latency_stage::processed).get_n() == 1);
+      assert(latency.get_histogram(control_action_type::press_move, latency_stage::processed).get_n() == 1);
+      assert(latency.get_histogram(control_action_type::press_move, latency_stage::piece_action).get_n() == 1);
+      assert(latency.get_histogram(control_action_type::press_select, latency_stage::piece_action).get_n() == 0);
+      g.get_latency().on_display();
+      assert(latency.get_histogram(control_action_type::press_move, latency_stage::displayed).get_n() == 1);
+    }
+    // The latency is not measured by default
+    {
+      game g;
+      do_select_and_move_keyboard_player_piece(g, square("e2"), square("e4"));
+      assert(g.get_latency().get_histogram(control_action_type::press_move, latency_stage::processed).get_n() == 0);
+    }
+    // A pawn that finds its way blocked stays where it is, as it cannot go back
+    {
+      game g;
+      const id pawn_id{get_id(g, square("e2"))};
+      do_select_and_move_keyboard_player_piece(g, square("e2"), square("e3"));
+      g.tick(delta_t(0.1));
+      get_piece_at(g, square("e7")).set_current_square(square("e3"));
+      g.tick(delta_t(0.1));
+      const auto pawn{get_piece_with_id(g, pawn_id)};
+      assert(!has_actions(pawn));
+      assert(pawn.get_current_square() == square("e2"));
+      assert(pawn.get_current_action_time() == delta_t(0.0));
+    }
+    // A scheduled order is given when its time has come
+    {
+      game g;
+      const id pawn_id{get_id(g, square("e2"))};
+      g.schedule_order(delta_t(1.0), scheduled_order(pawn_id, piece_action_type::move, square("e4")));
+      assert(count_scheduled_orders(g) == 1);
+      for (int i{0}; i != 10; ++i) g.tick(delta_t(0.1));
+      assert(!has_actions(get_piece_with_id(g, pawn_id)));
+      g.tick(delta_t(0.1));
+      assert(count_scheduled_orders(g) == 0);
+      assert(has_actions(get_piece_with_id(g, pawn_id)));
+      tick_until_idle(g);
+      assert(piece_with_id_is_at(g, pawn_id, square("e4")));
+    }
+    // Orders can be given one after the other, when the piece becomes idle
+    {
+      game g;
+      const id pawn_id{get_id(g, square("e2"))};
+      g.schedule_order_when_idle(scheduled_order(pawn_id, piece_action_type::move, square("e3")));
+      assert(count_scheduled_orders(g) == 1);
+      g.tick(delta_t(0.1)); // The pawn is idle already, so starts directly
+      g.schedule_order_when_idle(scheduled_order(pawn_id, piece_action_type::move, square("e4")));
+      assert(count_scheduled_orders(g) == 1);
+      assert(has_actions(get_piece_with_id(g, pawn_id)));
+      int cnt{0};
+      while (get_piece_with_id(g, pawn_id).get_current_square() != square("e4"))
+      {
+        g.tick(delta_t(0.1));
+        ++cnt;
+        assert(cnt < 100);
+      }
+      assert(count_scheduled_orders(g) == 0);
+    }
+    // Orders given when the piece is busy are given one after the other
+    {
+      game g;
+      const id pawn_id{get_id(g, square("e2"))};
+      g.schedule_order(delta_t(0.0), scheduled_order(pawn_id, piece_action_type::move, square("e3")));
+      g.tick(delta_t(0.1));
+      assert(has_actions(get_piece_with_id(g, pawn_id)));
+      g.schedule_order_when_idle(scheduled_order(pawn_id, piece_action_type::move, square("e4")));
+      g.schedule_order_when_idle(scheduled_order(pawn_id, piece_action_type::move, square("e5")));
+      assert(count_scheduled_orders(g) == 2);
+      bool has_been_at_e4{false};
+      int cnt{0};
+      while (get_piece_with_id(g, pawn_id).get_current_square() != square("e5"))
+      {
+        g.tick(delta_t(0.1));
+        if (get_piece_with_id(g, pawn_id).get_current_square() == square("e4")) has_been_at_e4 = true;
+        ++cnt;
+        assert(cnt < 200);
+      }
+      assert(has_been_at_e4);
+      assert(count_scheduled_orders(g) == 0);
+    }
+    // Orders given when the piece is idle are given one after the other
+    {
+      game g;
+      const id pawn_id{get_id(g, square("e2"))};
+      g.schedule_order_when_idle(scheduled_order(pawn_id, piece_action_type::move, square("e3")));
+      g.schedule_order_when_idle(scheduled_order(pawn_id, piece_action_type::move, square("e4")));
+      bool has_been_at_e3{false};
+      int cnt{0};
+      while (get_piece_with_id(g, pawn_id).get_current_square() != square("e4"))
+      {
+        g.tick(delta_t(0.1));
+        if (get_piece_with_id(g, pawn_id).get_current_square() == square("e3")) has_been_at_e3 = true;
+        ++cnt;
+        assert(cnt < 200);
+      }
+      assert(has_been_at_e3);
+      assert(count_scheduled_orders(g) == 0);
+    }
+    // A scheduled order of a piece that is gone is ignored
+    {
+      game g;
+      const id pawn_id{get_id(g, square("e2"))};
+      g.schedule_order(delta_t(0.1), scheduled_order(pawn_id, piece_action_type::move, square("e4")));
+      g.get_pieces().erase(std::begin(g.get_pieces()) + get_index_of_piece_with_id(g, pawn_id));
+      assert(get_index_of_piece_with_id(g, pawn_id) == -1);
+      g.tick(delta_t(0.1));
+      g.tick(delta_t(0.1));
+      assert(count_scheduled_orders(g) == 0);
+    }
   }
 #endif // NDEBUG // no tests in release
 }
@@ -336,18 +633,78 @@ void test_game_functions()
       piece.set_selected(true);
       assert(get_possible_moves(g, side::lhs).size() == 4);
     }
+    // Two selected pawns, each square is given once
+    {
+      game g;
+      get_piece_at(g, square("d2")).set_selected(true);
+      get_piece_at(g, square("e2")).set_selected(true);
+      auto moves{get_possible_moves(g, side::lhs)};
+      assert(moves.size() > 4);
+      std::sort(std::begin(moves), std::end(moves));
+      assert(std::adjacent_find(std::begin(moves), std::end(moves)) == std::end(moves));
+    }
   }
   // is_idle
   {
     game g;
     assert(is_idle(g));
   }
+  // get_index_of_closest_piece_to
+  {
+    const game g;
+    const int i{get_index_of_closest_piece_to(g, game_coordinat(2.4, 4.4))};
+    assert(g.get_pieces()[i].get_current_square() == square("e2"));
+    const int j{get_index_of_closest_piece_to(g, game_coordinat(4.0, 4.5))};
+    assert(g.get_pieces()[j].get_current_square() == square("e2"));
+    const int k{get_index_of_closest_piece_to(g, game_coordinat(-3.0, 0.1))};
+    assert(g.get_pieces()[k].get_current_square() == square("a1"));
+  }
+  // get_index_of_closest_piece_to, on a large board
+  {
+    game_options options{get_default_game_options()};
+    options.set_board_size(16);
+    const game g(options);
+    const int i{get_index_of_closest_piece_to(g, game_coordinat(8.0, 8.0))};
+    assert(g.get_pieces()[i].get_type() == piece_type::pawn);
+  }
   // is_piece_at
   {
     const game g;
     assert(is_piece_at(g, square("e1")));
     assert(!is_piece_at(g, square("e4")));
   }
+  // is_piece_at, for a coordinat
+  {
+    const game g;
+    assert(is_piece_at(g, game_coordinat(0.5, 4.5)));
+    assert(is_piece_at(g, game_coordinat(0.8, 4.2)));
+    assert(!is_piece_at(g, game_coordinat(3.5, 4.5)));
+    assert(is_piece_at(g, game_coordinat(3.5, 4.5), 2.1));
+    assert(!is_piece_at(g, game_coordinat(-3.5, 4.5)));
+  }
+  // is_visible
+  {
+    // Without fog-of-war, all is visible
+    {
+      const game g;
+      assert(is_visible(g, square("e8"), chess_color::white));
+      assert(is_visible(g, square("e1"), chess_color::black));
+    }
+    // With fog-of-war, only what one's pieces can see is visible
+    {
+      game_options options{get_default_game_options()};
+      options.set_starting_position(starting_position_type::kings_only);
+      options.set_fog_of_war(true);
+      game g(options);
+      assert(is_visible(g, square("e2"), chess_color::white));
+      assert(!is_visible(g, square("e8"), chess_color::white));
+      assert(!is_visible(g, square("e1"), chess_color::black));
+      do_select_and_move_keyboard_player_piece(g, square("e1"), square("e2"));
+      tick_until_idle(g);
+      assert(is_visible(g, square("e3"), chess_color::white));
+      assert(!is_visible(g, square("e8"), chess_color::white));
+    }
+  }
   // get_pieces
   {
     const game g;
@@ -361,6 +718,24 @@ void test_game_functions()
     const auto t{get_time(g)};
     assert(t.get() == 0.0);
   }
+  // get_visible_pieces
+  {
+    // Without fog-of-war, all pieces are visible
+    {
+      const game g;
+      assert(get_visible_pieces(g, chess_color::white).size() == g.get_pieces().size());
+    }
+    // With fog-of-war, the enemy pieces far away are not
+    {
+      game_options options{get_default_game_options()};
+      options.set_starting_position(starting_position_type::kings_only);
+      options.set_fog_of_war(true);
+      const game g(options);
+      const auto pieces{get_visible_pieces(g, chess_color::white)};
+      assert(pieces.size() == 1);
+      for (const auto& p: pieces) assert(p.get_color() == chess_color::white);
+    }
+  }
   // get_mouse_player_pos
   {
     game g;
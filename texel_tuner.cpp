@@ -0,0 +1,449 @@
+#include "texel_tuner.h"
+
+#include "evaluation_weights.h"
+#include "pgn.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+void add_tuning_positions(
+  std::istream& pgn,
+  const int n_skipped_plies,
+  tuning_positions& positions
+)
+{
+  assert(n_skipped_plies >= 0);
+  const auto start{create_chess_position(starting_position_type::standard).get_board()};
+  assert(start.size() == 64);
+  read_pgn_games(
+    pgn,
+    [&](const std::vector<std::string>& moves, const std::string& result)
+    {
+      std::uint8_t points{0};
+      if (result == "1-0") points = 2;
+      else if (result == "1/2-1/2") points = 1;
+      else if (result != "0-1") return;
+
+      auto board{start};
+      chess_color color{chess_color::white};
+      const auto count_pieces{
+        [](const auto& b) { return std::count_if(std::begin(b), std::end(b), [](const int c) { return c != 0; }); }
+      };
+      // Was the move before a capture or promotion?
+      bool was_noisy{false};
+      const int n_plies{static_cast<int>(moves.size())};
+      for (int i{0}; i != n_plies; ++i)
+      {
+        const auto before{board};
+        const auto m{do_pgn_move(board, color, moves[i])};
+        if (!m) break;
+        const bool is_noisy{
+          count_pieces(board) != count_pieces(before)
+          || board[m->m_to] != before[m->m_from]
+        };
+        if (i >= n_skipped_plies && !was_noisy && !is_noisy && !is_in_check(before, color))
+        {
+          for (const int f: get_evaluation_features(before, 8))
+          {
+            assert(f >= -128 && f <= 127);
+            positions.m_features.push_back(static_cast<std::int8_t>(f));
+          }
+          positions.m_results.push_back(points);
+        }
+        was_noisy = is_noisy;
+        color = get_other_color(color);
+      }
+    }
+  );
+  assert(positions.m_features.size() == 12 * positions.m_results.size());
+}
+
+double fit_tuning_scale(
+  const tuning_positions& positions,
+  const evaluation_weights& w,
+  const int n_threads
+)
+{
+  const auto weights{to_tuning_weights(w)};
+  // The error is least at one scale, so it is found by ternary search
+  double low{0.01};
+  double high{10.0};
+  for (int i{0}; i != 50; ++i)
+  {
+    const double a{low + ((high - low) / 3.0)};
+    const double b{high - ((high - low) / 3.0)};
+    if (get_tuning_error(positions, weights, a, n_threads)
+      < get_tuning_error(positions, weights, b, n_threads)
+    )
+    {
+      high = b;
+    }
+    else
+    {
+      low = a;
+    }
+  }
+  return (low + high) / 2.0;
+}
+
+tuning_options get_default_tuning_options() noexcept
+{
+  return tuning_options{
+    1.0,
+    1000,
+    8,
+    std::max(1, static_cast<int>(std::thread::hardware_concurrency()))
+  };
+}
+
+int get_n_tuning_positions(const tuning_positions& positions) noexcept
+{
+  return static_cast<int>(positions.m_results.size());
+}
+
+double get_tuning_error(
+  const tuning_positions& positions,
+  const std::array<double, 12>& weights,
+  const double scale,
+  const int n_threads,
+  std::array<double, 12>* gradient
+)
+{
+  assert(n_threads > 0);
+  const int n{get_n_tuning_positions(positions)};
+  const int n_features{static_cast<int>(weights.size())};
+  assert(positions.m_features.size() == static_cast<std::size_t>(n) * n_features);
+  // The predicted result is 1 / (1 + 10^(-scale * evaluation / 400))
+  const double c{scale * std::log(10.0) / 400.0};
+  std::vector<tuning_error_sums> sums(n_threads);
+  const auto sum_errors{
+    [&](const int thread_index)
+    {
+      const int first{static_cast<int>((static_cast<long long>(n) * thread_index) / n_threads)};
+      const int last{static_cast<int>((static_cast<long long>(n) * (thread_index + 1)) / n_threads)};
+      auto& s{sums[thread_index]};
+      constexpr int batch_size{1024};
+      std::array<double, batch_size> evaluations;
+      for (int batch{first}; batch < last; batch += batch_size)
+      {
+        const int batch_end{std::min(last, batch + batch_size)};
+        // First the evaluations, then the errors,
+        // so that the compiler can vectorize the evaluations
+        const std::int8_t* f{positions.m_features.data() + (static_cast<std::size_t>(batch) * n_features)};
+        for (int i{batch}; i != batch_end; ++i, f += n_features)
+        {
+          double e{0.0};
+          for (int j{0}; j != n_features; ++j) e += weights[j] * f[j];
+          evaluations[i - batch] = e;
+        }
+        f = positions.m_features.data() + (static_cast<std::size_t>(batch) * n_features);
+        for (int i{batch}; i != batch_end; ++i, f += n_features)
+        {
+          const double predicted{1.0 / (1.0 + std::exp(-c * evaluations[i - batch]))};
+          const double error{(0.5 * positions.m_results[i]) - predicted};
+          s.m_error += error * error;
+          if (!gradient) continue;
+          const double d{-2.0 * error * predicted * (1.0 - predicted) * c};
+          for (int j{0}; j != n_features; ++j) s.m_gradient[j] += d * f[j];
+        }
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i{1}; i < n_threads; ++i) threads.emplace_back(sum_errors, i);
+  sum_errors(0);
+  for (auto& t: threads) t.join();
+
+  double error{0.0};
+  if (gradient) gradient->fill(0.0);
+  for (const auto& s: sums)
+  {
+    error += s.m_error;
+    if (!gradient) continue;
+    for (int j{0}; j != n_features; ++j) (*gradient)[j] += s.m_gradient[j];
+  }
+  if (n == 0) return 0.0;
+  if (gradient)
+  {
+    for (auto& g: *gradient) g /= n;
+  }
+  return error / n;
+}
+
+void save_evaluation_weights(
+  const evaluation_weights& w,
+  const std::string& filename
+)
+{
+  const auto join{
+    [](const std::array<int, 6>& values)
+    {
+      std::stringstream s;
+      for (std::size_t i{0}; i != values.size(); ++i)
+      {
+        s << (i == 0 ? "" : ", ") << values[i];
+      }
+      return s.str();
+    }
+  };
+  std::stringstream types;
+  for (const auto t: get_all_piece_types())
+  {
+    types << (t == piece_type::bishop ? "" : ", ") << to_str(t);
+  }
+  std::ofstream f(filename);
+  f << "#ifndef EVALUATION_WEIGHTS_H\n"
+    << "#define EVALUATION_WEIGHTS_H\n"
+    << "\n"
+    << "// Written by 'save_evaluation_weights', e.g. by running the game\n"
+    << "// with '--tune', after which a rebuild of the game uses these\n"
+    << "\n"
+    << "#include \"alpha_beta.h\"\n"
+    << "\n"
+    << "/// Get the weights 'evaluate' uses, in hundredths of a pawn,\n"
+    << "/// per piece type: " << types.str() << "\n"
+    << "constexpr evaluation_weights get_tuned_evaluation_weights() noexcept\n"
+    << "{\n"
+    << "  return evaluation_weights{\n"
+    << "    {{ " << join(w.m_material) << " }},\n"
+    << "    {{ " << join(w.m_centrality) << " }}\n"
+    << "  };\n"
+    << "}\n"
+    << "\n"
+    << "#endif // EVALUATION_WEIGHTS_H\n"
+  ;
+  if (!f)
+  {
+    throw std::runtime_error("Cannot write evaluation weights to '" + filename + "'");
+  }
+}
+
+void test_texel_tuner()
+{
+#ifndef NDEBUG
+  // add_tuning_positions
+  {
+    std::stringstream s(
+      "[Result \"1-0\"]\n"
+      "\n"
+      "1. e4 e5 2. Nf3 Nc6 3. Bb5 a6 4. Bxc6 dxc6 5. O-O f6 1-0\n"
+      "\n"
+      "[Result \"*\"]\n"
+      "\n"
+      "1. d4 d5 2. c4 *\n"
+    );
+    tuning_positions positions;
+    add_tuning_positions(s, 2, positions);
+    // Skipped are the first two plies, the two captures,
+    // and castling after a capture
+    assert(get_n_tuning_positions(positions) == 5);
+    assert(positions.m_features.size() == 5 * 12);
+    assert(std::all_of(std::begin(positions.m_results), std::end(positions.m_results), [](const int r) { return r == 2; }));
+    // The first position is after 1. e4 e5, so it is even in material
+    for (int i{0}; i != 6; ++i) assert(positions.m_features[i] == 0);
+  }
+  // The same as the features times the weights
+  {
+    tuning_positions positions;
+    const std::array<std::int8_t, 12> features{ 1, 0, -1, 2, 0, 1, 3, 0, -2, 4, 0, 1 };
+    positions.m_features.assign(std::begin(features), std::end(features));
+    positions.m_results.push_back(2);
+    const evaluation_weights w{{{ 300, 0, 300, 100, 900, 500 }}, {{ 2, 0, 2, 2, 2, 2 }}};
+    double e{0.0};
+    for (int i{0}; i != 12; ++i) e += features[i] * to_tuning_weights(w)[i];
+    assert(e == 300 - 300 + 200 + 500 + 6 - 4 + 8 + 2);
+    const double predicted{1.0 / (1.0 + std::pow(10.0, -e / 400.0))};
+    const double error{get_tuning_error(positions, to_tuning_weights(w), 1.0, 1)};
+    assert(std::abs(error - ((1.0 - predicted) * (1.0 - predicted))) < 1.0e-12);
+  }
+
+  // Positions in which being a pawn ahead wins, and a pawn behind loses,
+  // more often than not
+  tuning_positions positions;
+  for (int i{0}; i != 3000; ++i)
+  {
+    std::array<std::int8_t, 12> features{};
+    const int pawns{(i % 3) - 1};
+    features[static_cast<int>(piece_type::pawn)] = static_cast<std::int8_t>(pawns);
+    features[static_cast<int>(piece_type::knight)] = static_cast<std::int8_t>((i % 5) - 2);
+    positions.m_features.insert(std::end(positions.m_features), std::begin(features), std::end(features));
+    const int points{(i % 4 == 0) ? 1 : pawns + 1};
+    positions.m_results.push_back(static_cast<std::uint8_t>(points));
+  }
+  // get_tuning_error, the gradient is the slope of the error
+  {
+    const evaluation_weights w{{{ 300, 0, 250, 80, 900, 500 }}, {{ 2, 0, 2, 2, 2, 2 }}};
+    const auto weights{to_tuning_weights(w)};
+    std::array<double, 12> gradient;
+    const double error{get_tuning_error(positions, weights, 1.0, 1, &gradient)};
+    for (const auto t: { piece_type::knight, piece_type::pawn })
+    {
+      auto more{weights};
+      more[static_cast<int>(t)] += 0.01;
+      auto less{weights};
+      less[static_cast<int>(t)] -= 0.01;
+      const double slope{
+        (get_tuning_error(positions, more, 1.0, 1) - get_tuning_error(positions, less, 1.0, 1)) / 0.02
+      };
+      assert(std::abs(slope - gradient[static_cast<int>(t)]) <= (1.0e-4 * std::abs(slope)) + 1.0e-12);
+    }
+    assert(gradient[static_cast<int>(piece_type::king)] == 0.0);
+    // The same on multiple threads
+    std::array<double, 12> gradient_3;
+    assert(std::abs(get_tuning_error(positions, weights, 1.0, 3, &gradient_3) - error) < 1.0e-12);
+    for (int i{0}; i != 12; ++i) assert(std::abs(gradient_3[i] - gradient[i]) < 1.0e-12);
+  }
+  // fit_tuning_scale finds the scale with the least error
+  {
+    const evaluation_weights w{{{ 300, 0, 300, 100, 900, 500 }}, {{ 2, 0, 2, 2, 2, 2 }}};
+    const double scale{fit_tuning_scale(positions, w, 2)};
+    assert(scale > 0.01);
+    assert(scale < 10.0);
+    const auto weights{to_tuning_weights(w)};
+    const double error{get_tuning_error(positions, weights, scale, 1)};
+    assert(error <= get_tuning_error(positions, weights, scale * 1.1, 1));
+    assert(error <= get_tuning_error(positions, weights, scale * 0.9, 1));
+  }
+  // tune_evaluation_weights, the pawn gets its value from the results,
+  // whereas the knight, that does not matter, loses it
+  {
+    const evaluation_weights initial{{{ 300, 0, 300, 0, 900, 500 }}, {{ 2, 0, 2, 2, 2, 2 }}};
+    auto options{get_default_tuning_options()};
+    options.m_learning_rate = 10.0;
+    options.m_n_epochs = 200;
+    options.m_n_threads = 2;
+    std::stringstream log;
+    const auto w{tune_evaluation_weights(positions, initial, 1.0, options, log)};
+    assert(!log.str().empty());
+    assert(w.m_material[static_cast<int>(piece_type::pawn)] > 100);
+    assert(w.m_material[static_cast<int>(piece_type::knight)] < 100);
+    assert(w.m_material[static_cast<int>(piece_type::queen)] == 900);
+    assert(
+      get_tuning_error(positions, to_tuning_weights(w), 1.0, 1)
+      < get_tuning_error(positions, to_tuning_weights(initial), 1.0, 1)
+    );
+  }
+  // save_evaluation_weights
+  {
+    const std::string filename{"test_evaluation_weights.h"};
+    const evaluation_weights w{{{ 310, 0, 290, 95, 920, 480 }}, {{ 3, -1, 4, 1, 2, 0 }}};
+    save_evaluation_weights(w, filename);
+    std::ifstream f(filename);
+    const std::string text{std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()};
+    assert(text.find("{{ 310, 0, 290, 95, 920, 480 }}") != std::string::npos);
+    assert(text.find("{{ 3, -1, 4, 1, 2, 0 }}") != std::string::npos);
+    assert(text.find("per piece type: bishop, king, knight, pawn, queen, rook") != std::string::npos);
+    std::remove(filename.c_str());
+  }
+  // tune_evaluation, a PGN file that does not exist
+  {
+    bool has_thrown{false};
+    std::stringstream log;
+    try
+    {
+      tune_evaluation("test_texel_tuner_absent.pgn", "test_texel_tuner_absent.h", get_default_tuning_options(), log);
+    }
+    catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+#endif // NDEBUG
+}
+
+std::array<double, 12> to_tuning_weights(const evaluation_weights& w) noexcept
+{
+  std::array<double, 12> weights;
+  for (int i{0}; i != 6; ++i)
+  {
+    weights[i] = w.m_material[i];
+    weights[6 + i] = w.m_centrality[i];
+  }
+  return weights;
+}
+
+void tune_evaluation(
+  const std::string& pgn_filename,
+  const std::string& filename,
+  const tuning_options& options,
+  std::ostream& os
+)
+{
+  std::ifstream f(pgn_filename);
+  if (!f)
+  {
+    throw std::runtime_error("Cannot open '" + pgn_filename + "'");
+  }
+  tuning_positions positions;
+  add_tuning_positions(f, options.m_n_skipped_plies, positions);
+  const int n{get_n_tuning_positions(positions)};
+  if (n == 0)
+  {
+    throw std::runtime_error("There are no positions to tune on in '" + pgn_filename + "'");
+  }
+  os << "positions: " << n << '\n';
+  const auto initial_weights{get_tuned_evaluation_weights()};
+  const double scale{fit_tuning_scale(positions, initial_weights, options.m_n_threads)};
+  os << "scale: " << scale << '\n';
+  const auto start{std::chrono::steady_clock::now()};
+  const auto w{tune_evaluation_weights(positions, initial_weights, scale, options, os)};
+  const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+  if (elapsed.count() > 0.0)
+  {
+    os << "positions per second: "
+      << static_cast<double>(n) * options.m_n_epochs / elapsed.count() << '\n';
+  }
+  save_evaluation_weights(w, filename);
+}
+
+evaluation_weights tune_evaluation_weights(
+  const tuning_positions& positions,
+  const evaluation_weights& initial_weights,
+  const double scale,
+  const tuning_options& options,
+  std::ostream& os
+)
+{
+  assert(options.m_learning_rate > 0.0);
+  assert(options.m_n_epochs >= 0);
+  auto weights{to_tuning_weights(initial_weights)};
+  const double beta_1{0.9};
+  const double beta_2{0.999};
+  const double epsilon{1.0e-12};
+  double beta_1_power{1.0};
+  double beta_2_power{1.0};
+  std::array<double, 12> m{};
+  std::array<double, 12> v{};
+  std::array<double, 12> gradient{};
+  const int log_interval{std::max(1, options.m_n_epochs / 10)};
+  for (int epoch{0}; epoch != options.m_n_epochs; ++epoch)
+  {
+    const double error{get_tuning_error(positions, weights, scale, options.m_n_threads, &gradient)};
+    if (epoch % log_interval == 0) os << "epoch " << epoch << ", error: " << error << '\n';
+    beta_1_power *= beta_1;
+    beta_2_power *= beta_2;
+    for (std::size_t i{0}; i != weights.size(); ++i)
+    {
+      m[i] = (beta_1 * m[i]) + ((1.0 - beta_1) * gradient[i]);
+      v[i] = (beta_2 * v[i]) + ((1.0 - beta_2) * gradient[i] * gradient[i]);
+      const double m_hat{m[i] / (1.0 - beta_1_power)};
+      const double v_hat{v[i] / (1.0 - beta_2_power)};
+      weights[i] -= options.m_learning_rate * m_hat / (std::sqrt(v_hat) + epsilon);
+    }
+  }
+  os << "error: " << get_tuning_error(positions, weights, scale, options.m_n_threads) << '\n';
+  evaluation_weights w;
+  for (int i{0}; i != 6; ++i)
+  {
+    w.m_material[i] = static_cast<int>(std::lround(weights[i]));
+    w.m_centrality[i] = static_cast<int>(std::lround(weights[6 + i]));
+  }
+  return w;
+}
@@ -0,0 +1,139 @@
+#ifndef TEXEL_TUNER_H
+#define TEXEL_TUNER_H
+
+#include "alpha_beta.h"
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// The positions to fit the weights of 'evaluate' on,
+/// with the result of the game each is from.
+/// A position takes 13 bytes, so tens of millions fit in memory
+struct tuning_positions
+{
+  /// Per position, the features as by 'get_evaluation_features',
+  /// one position after the other
+  std::vector<std::int8_t> m_features;
+
+  /// Per position, the points white got in its game, in halves:
+  /// 0 for a loss, 1 for a draw and 2 for a win
+  std::vector<std::uint8_t> m_results;
+};
+
+/// How to fit the weights of 'evaluate'
+struct tuning_options
+{
+  /// The step size of the gradient descent, in hundredths of a pawn
+  double m_learning_rate;
+
+  /// The number of passes over all positions,
+  /// each followed by one step of the gradient descent
+  int m_n_epochs;
+
+  /// The number of plies at the start of each game that are skipped,
+  /// as these are played from memory, instead of by evaluation
+  int m_n_skipped_plies;
+
+  /// The number of threads the error is computed on
+  int m_n_threads;
+};
+
+/// The error of the predictions of 'evaluate' of a part of the positions,
+/// as summed by one thread.
+/// Each thread only writes to its own sums, which are on their own
+/// cache line, so that the threads do not slow each other down
+struct alignas(64) tuning_error_sums
+{
+  /// The sum of the squared errors
+  double m_error{0.0};
+
+  /// The sum of the gradients of the squared errors
+  std::array<double, 12> m_gradient{};
+};
+
+/// Add the quiet positions of games in PGN notation, such as the ones
+/// downloaded by 'scripts/download_chess_games.sh'.
+/// A position is quiet if the player to move is not in check,
+/// and both the move before and the move played are no capture
+/// nor promotion, so that its evaluation needs no search.
+/// Games without a result are skipped
+void add_tuning_positions(
+  std::istream& pgn,
+  const int n_skipped_plies,
+  tuning_positions& positions
+);
+
+/// Find the scale of the evaluation, at which the error is least,
+/// as the first step of Texel's tuning method.
+/// A scale of one means that being a pawn ahead
+/// is worth about a 64 percent chance of winning
+double fit_tuning_scale(
+  const tuning_positions& positions,
+  const evaluation_weights& w,
+  const int n_threads
+);
+
+/// Get the options to fit the weights with, when not specified otherwise
+tuning_options get_default_tuning_options() noexcept;
+
+/// Get the number of positions
+int get_n_tuning_positions(const tuning_positions& positions) noexcept;
+
+/// Get the mean squared error of the predicted results of the positions,
+/// which is the sigmoid of the evaluation, and, if asked for, its gradient.
+///
+/// The positions are split over the threads, each of which
+/// computes the evaluations of a batch of positions at a time,
+/// then the errors of these.
+/// @param weights the weights, in the order of 'get_evaluation_features'
+/// @param scale the scale of the evaluation, as by 'fit_tuning_scale'
+/// @param gradient if not nullptr, the gradient per weight is written here
+double get_tuning_error(
+  const tuning_positions& positions,
+  const std::array<double, 12>& weights,
+  const double scale,
+  const int n_threads,
+  std::array<double, 12>* gradient = nullptr
+);
+
+/// Save the weights of 'evaluate' as a C++ header, as 'evaluation_weights.h'.
+/// Throws if the file cannot be written
+void save_evaluation_weights(
+  const evaluation_weights& w,
+  const std::string& filename
+);
+
+/// Test the free functions
+void test_texel_tuner();
+
+/// Get the weights of 'evaluate' in the order of 'get_evaluation_features'
+std::array<double, 12> to_tuning_weights(const evaluation_weights& w) noexcept;
+
+/// Fit the weights of 'evaluate' to the positions of games
+/// in PGN notation and save these as a C++ header.
+/// Throws if a file cannot be read or written, or has no positions
+void tune_evaluation(
+  const std::string& pgn_filename,
+  const std::string& filename,
+  const tuning_options& options,
+  std::ostream& os
+);
+
+/// Fit the weights of 'evaluate' to the positions, by Texel's method:
+/// minimize the mean squared error between the result of the game
+/// and the result predicted from the evaluation of the position,
+/// by gradient descent, with the step size per weight adapted (Adam).
+/// The weights are fitted as real numbers and rounded in the end
+/// @param os the error after each tenth of the epochs is shown here
+evaluation_weights tune_evaluation_weights(
+  const tuning_positions& positions,
+  const evaluation_weights& initial_weights,
+  const double scale,
+  const tuning_options& options,
+  std::ostream& os
+);
+
+#endif // TEXEL_TUNER_H
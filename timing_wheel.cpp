@@ -0,0 +1,206 @@
+#include "timing_wheel.h"
+
+#include <cassert>
+#include <cmath>
+
+/// The number of ticks of a slot at each level is a power of two,
+/// of which this is the power at level 1
+constexpr int get_timing_wheel_bits_per_level() { return 6; }
+
+static_assert(
+  get_timing_wheel_n_slots() == (1 << get_timing_wheel_bits_per_level()),
+  "Each level must have 2^bits slots"
+);
+
+timing_wheel::timing_wheel(const delta_t& resolution)
+  : m_far_away{},
+    m_levels{},
+    m_n_orders{0},
+    m_now{-1},
+    m_resolution{resolution}
+{
+  assert(m_resolution.get() > 0.0);
+}
+
+void timing_wheel::add(const delta_t& when, const scheduled_order& order)
+{
+  // Round up, so an order is never given too early.
+  // The small margin keeps rounding errors in the time
+  // from postponing an order by a whole tick
+  const std::int64_t tick{
+    static_cast<std::int64_t>(std::ceil((when.get() / m_resolution.get()) - 1e-6))
+  };
+  insert(entry{std::max(tick, m_now + 1), order});
+  ++m_n_orders;
+}
+
+void timing_wheel::advance(const delta_t& t, std::vector<scheduled_order>& due)
+{
+  const std::int64_t to{
+    static_cast<std::int64_t>(std::floor((t.get() / m_resolution.get()) + 1e-6))
+  };
+  assert(to >= m_now);
+  const int bits{get_timing_wheel_bits_per_level()};
+  const std::int64_t mask{get_timing_wheel_n_slots() - 1};
+  while (m_now != to)
+  {
+    // Nothing to wait for, so skip to the end directly
+    if (m_n_orders == 0)
+    {
+      m_now = to;
+      return;
+    }
+    ++m_now;
+
+    // Spread the slots of the higher levels that are reached,
+    // highest level first, as these spread into the lower levels
+    if ((m_now & ((std::int64_t{1} << (bits * get_timing_wheel_n_levels())) - 1)) == 0)
+    {
+      spread(m_far_away);
+    }
+    for (int level{get_timing_wheel_n_levels() - 1}; level != 0; --level)
+    {
+      if ((m_now & ((std::int64_t{1} << (bits * level)) - 1)) != 0) continue;
+      spread(m_levels[level][(m_now >> (bits * level)) & mask]);
+    }
+
+    // Give the orders due now
+    auto& s{m_levels[0][m_now & mask]};
+    for (const auto& e: s)
+    {
+      assert(e.m_tick == m_now);
+      due.push_back(e.m_order);
+    }
+    m_n_orders -= static_cast<int>(s.size());
+    s.clear();
+  }
+}
+
+void timing_wheel::insert(const entry& e)
+{
+  assert(e.m_tick >= m_now);
+  const int bits{get_timing_wheel_bits_per_level()};
+  const std::int64_t mask{get_timing_wheel_n_slots() - 1};
+  const std::int64_t distance{e.m_tick - m_now};
+  for (int level{0}; level != get_timing_wheel_n_levels(); ++level)
+  {
+    if (distance < (std::int64_t{1} << (bits * (level + 1))))
+    {
+      m_levels[level][(e.m_tick >> (bits * level)) & mask].push_back(e);
+      return;
+    }
+  }
+  m_far_away.push_back(e);
+}
+
+void timing_wheel::spread(slot& s)
+{
+  // Swap out first, as orders can end up in the same slot again
+  slot orders;
+  orders.swap(s);
+  for (const auto& e: orders) insert(e);
+}
+
+void test_timing_wheel()
+{
+#ifndef NDEBUG
+  const auto order_for = [](const square& s)
+  {
+    return scheduled_order(create_new_id(), piece_action_type::move, s);
+  };
+  // An empty wheel
+  {
+    const timing_wheel w;
+    assert(w.get_n_orders() == 0);
+    assert(w.get_current_tick() == -1);
+    assert(w.get_resolution() == delta_t(0.01));
+  }
+  // An empty wheel moves forward directly
+  {
+    timing_wheel w;
+    std::vector<scheduled_order> due;
+    w.advance(delta_t(1000.0), due);
+    assert(due.empty());
+    assert(w.get_current_tick() == 100000);
+  }
+  // An order is given when its time has come, not earlier
+  {
+    timing_wheel w;
+    const auto order{order_for(square("e4"))};
+    w.add(delta_t(0.5), order);
+    assert(w.get_n_orders() == 1);
+    std::vector<scheduled_order> due;
+    w.advance(delta_t(0.49), due);
+    assert(due.empty());
+    w.advance(delta_t(0.5), due);
+    assert(due.size() == 1);
+    assert(due[0] == order);
+    assert(w.get_n_orders() == 0);
+  }
+  // Rounding errors in the time do not postpone an order
+  {
+    timing_wheel w;
+    w.add(delta_t(1.0), order_for(square("e4")));
+    delta_t t(0.0);
+    for (int i{0}; i != 10; ++i) t += delta_t(0.1);
+    std::vector<scheduled_order> due;
+    w.advance(t, due);
+    assert(due.size() == 1);
+  }
+  // An order in the past is given at the next advance
+  {
+    timing_wheel w;
+    std::vector<scheduled_order> due;
+    w.advance(delta_t(1.0), due);
+    w.add(delta_t(0.5), order_for(square("e4")));
+    w.advance(delta_t(1.0), due);
+    assert(due.empty());
+    w.advance(delta_t(1.01), due);
+    assert(due.size() == 1);
+  }
+  // Orders far away go through all levels, and are given in order
+  {
+    timing_wheel w;
+    const std::vector<double> times{
+      0.01, 0.63, 0.64, 0.65, 40.95, 40.96, 41.0, 2621.44, 2700.0, 200000.0
+    };
+    std::vector<square> squares;
+    for (int i{0}; i != static_cast<int>(times.size()); ++i)
+    {
+      squares.push_back(square(i % 8, i / 8));
+    }
+    // Add in reverse order, to see if these are given in the order they are due
+    for (int i{static_cast<int>(times.size()) - 1}; i != -1; --i)
+    {
+      w.add(delta_t(times[i]), order_for(squares[i]));
+    }
+    assert(w.get_n_orders() == static_cast<int>(times.size()));
+    std::vector<scheduled_order> due;
+    for (int i{0}; i != static_cast<int>(times.size()); ++i)
+    {
+      w.advance(delta_t(times[i] - 0.005), due);
+      assert(static_cast<int>(due.size()) == i);
+      w.advance(delta_t(times[i]), due);
+      assert(static_cast<int>(due.size()) == i + 1);
+      assert(due.back().get_to() == squares[i]);
+    }
+    assert(w.get_n_orders() == 0);
+  }
+  // Many orders at many times, advancing in big steps
+  {
+    timing_wheel w(delta_t(0.1));
+    const int n{1000};
+    for (int i{0}; i != n; ++i)
+    {
+      w.add(delta_t(0.1 * ((i * 7919) % 5000)), order_for(square("a1")));
+    }
+    std::vector<scheduled_order> due;
+    for (int i{1}; i <= 50; ++i)
+    {
+      w.advance(delta_t(10.0 * i), due);
+    }
+    assert(static_cast<int>(due.size()) == n);
+    assert(w.get_n_orders() == 0);
+  }
+#endif // NDEBUG
+}
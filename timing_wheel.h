@@ -0,0 +1,96 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include "ccfwd.h"
+#include "delta_t.h"
+#include "scheduled_order.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/// The number of slots in each level of a timing wheel
+constexpr int get_timing_wheel_n_slots() { return 64; }
+
+/// The number of levels of a timing wheel
+constexpr int get_timing_wheel_n_levels() { return 4; }
+
+/// Keeps the orders to be given at a later time,
+/// such that moving forward in time costs the same
+/// no matter how many orders are waiting.
+///
+/// Time is divided in ticks of a fixed resolution.
+/// The wheel has levels of 64 slots each,
+/// where a slot of level 0 holds the orders of one tick,
+/// a slot of level 1 holds the orders of 64 ticks,
+/// a slot of level 2 the orders of 64 * 64 ticks, etc.
+/// An order is put in the lowest level that reaches far enough.
+/// When the time gets to a slot of a higher level,
+/// its orders are spread over the lower levels.
+/// Orders even further away are kept aside,
+/// to be spread when the highest level goes round.
+class timing_wheel
+{
+public:
+  /// Create an empty wheel
+  /// @param resolution the length of a tick,
+  ///   orders due within the same tick are given at the same time
+  explicit timing_wheel(const delta_t& resolution = delta_t(0.01));
+
+  /// Add an order to be given at a time.
+  /// An order due at or before the current time
+  /// is given at the next call to 'advance'
+  void add(const delta_t& when, const scheduled_order& order);
+
+  /// Move forward to a time, collecting the orders that are due
+  /// @param t the time to move to, which cannot be before the current time
+  /// @param due the orders that are due are added to this,
+  ///   in the order they are due in
+  void advance(const delta_t& t, std::vector<scheduled_order>& due);
+
+  /// Get the number of the current tick
+  auto get_current_tick() const noexcept { return m_now; }
+
+  /// Get the number of orders waiting
+  int get_n_orders() const noexcept { return m_n_orders; }
+
+  /// Get the length of a tick
+  const auto& get_resolution() const noexcept { return m_resolution; }
+
+private:
+
+  /// An order and the tick it is due at
+  struct entry
+  {
+    std::int64_t m_tick;
+    scheduled_order m_order;
+  };
+
+  using slot = std::vector<entry>;
+
+  /// The orders too far away for the highest level
+  slot m_far_away;
+
+  /// The slots per level
+  std::array<std::array<slot, get_timing_wheel_n_slots()>, get_timing_wheel_n_levels()> m_levels;
+
+  int m_n_orders;
+
+  /// The current tick, all orders up to and including this tick are given.
+  /// Starts before tick zero, so orders for time zero can be given
+  std::int64_t m_now;
+
+  delta_t m_resolution;
+
+  /// Put an order in the slot of its tick,
+  /// which is at or after the current tick
+  void insert(const entry& e);
+
+  /// Spread the orders of a slot over the lower levels
+  void spread(slot& s);
+};
+
+/// Test this class and its free functions
+void test_timing_wheel();
+
+#endif // TIMING_WHEEL_H
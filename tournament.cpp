@@ -0,0 +1,575 @@
+#include "tournament.h"
+
+#include "batch_scheduler.h"
+#include "simulation_job.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+std::vector<elo_rating> calc_tournament_ratings(
+  const tournament_options& options,
+  const std::vector<tournament_result>& results
+)
+{
+  std::vector<rated_game> games;
+  games.reserve(results.size());
+  for (const auto& r: results)
+  {
+    double white_score{0.5};
+    if (r.m_result.m_result == game_result::white_wins) white_score = 1.0;
+    if (r.m_result.m_result == game_result::black_wins) white_score = 0.0;
+    assert(is_over(r.m_result.m_result));
+    games.push_back(rated_game{r.m_game.m_white, r.m_game.m_black, white_score});
+  }
+  return calc_elo_ratings(
+    static_cast<int>(options.m_bots.size()),
+    games,
+    200,
+    options.m_simulation.m_seed
+  );
+}
+
+std::vector<tournament_game> create_tournament_games(const tournament_options& options)
+{
+  const int n_bots{static_cast<int>(options.m_bots.size())};
+  std::vector<tournament_game> games;
+  for (int i{0}; i != n_bots; ++i)
+  {
+    for (int j{i + 1}; j != n_bots; ++j)
+    {
+      for (const auto position: options.m_starting_positions)
+      {
+        for (int k{0}; k != options.m_simulation.m_n_games; ++k)
+        {
+          const unsigned int seed{options.m_simulation.m_seed + k};
+          games.push_back(tournament_game{i, j, position, seed});
+          games.push_back(tournament_game{j, i, position, seed});
+        }
+      }
+    }
+  }
+  return games;
+}
+
+tournament_options get_default_tournament_options()
+{
+  std::vector<bot_version> bots;
+  for (const auto t: get_all_bot_types())
+  {
+    bots.push_back(bot_version{t, get_default_bot_version().m_think_interval});
+  }
+  return tournament_options{
+    bots,
+    "",
+    get_default_simulation_options(),
+    get_all_starting_position_types()
+  };
+}
+
+std::string get_tournament_settings(const tournament_options& options)
+{
+  const auto& simulation{options.m_simulation};
+  std::stringstream s;
+  s << "# board_size " << simulation.m_board_size
+    << " frame_time " << simulation.m_frame_time
+    << " game_speed " << to_str(simulation.m_game_speed)
+    << " max_game_time " << simulation.m_max_game_time
+  ;
+  return s.str();
+}
+
+std::string get_tournament_usage() noexcept
+{
+  std::stringstream s;
+  s << "Usage: --tournament [option]...\n"
+    << "Play games between each pair of bots, from each starting position\n"
+    << "with both colors, showing the Elo rating of each bot\n"
+    << "\n"
+    << "Options:\n"
+    << "  --bot TYPE:INTERVAL    a bot that plays, e.g. 'greedy:0.5',\n"
+    << "                         default one per type, being one of:";
+  for (const auto t: get_all_bot_types()) s << ' ' << t;
+  s << "\n"
+    << "  --positions A,B        the starting positions to play from, default all\n"
+    << "  --results FILE         the file to append each result to,\n"
+    << "                         from which a stopped tournament is resumed\n"
+    << "\n"
+    << "The number of games is per pair of bots, starting position and color.\n"
+    << "All options of '--simulate' can be used as well:\n"
+    << get_simulation_usage()
+  ;
+  return s.str();
+}
+
+tournament_options parse_tournament_args(const std::vector<std::string>& args)
+{
+  auto options{get_default_tournament_options()};
+  std::vector<bot_version> bots;
+  std::vector<std::string> simulation_args;
+  if (!args.empty()) simulation_args.push_back(args[0]);
+  const int n_args{static_cast<int>(args.size())};
+  for (int i{1}; i < n_args; ++i)
+  {
+    const auto& arg{args[i]};
+    if (arg == "--tournament") continue;
+    if (arg != "--bot" && arg != "--positions" && arg != "--results")
+    {
+      simulation_args.push_back(arg);
+      continue;
+    }
+    if (i + 1 == n_args)
+    {
+      throw std::runtime_error("Missing value for argument '" + arg + "'");
+    }
+    const auto& value{args[++i]};
+    if (arg == "--bot")
+    {
+      const auto bot{to_bot_version(value)};
+      if (std::find(std::begin(bots), std::end(bots), bot) != std::end(bots))
+      {
+        throw std::runtime_error("Bot '" + value + "' is given twice");
+      }
+      bots.push_back(bot);
+    }
+    else if (arg == "--results")
+    {
+      options.m_results_filename = value;
+    }
+    else
+    {
+      assert(arg == "--positions");
+      options.m_starting_positions.clear();
+      std::stringstream s(value);
+      std::string name;
+      while (std::getline(s, name, ','))
+      {
+        options.m_starting_positions.push_back(to_starting_position_type(name));
+      }
+      if (options.m_starting_positions.empty())
+      {
+        throw std::runtime_error("Invalid starting positions '" + value + "'");
+      }
+    }
+  }
+  if (!bots.empty()) options.m_bots = bots;
+  if (options.m_bots.size() < 2)
+  {
+    throw std::runtime_error("A tournament needs at least two bots");
+  }
+  options.m_simulation = parse_simulation_args(simulation_args);
+  return options;
+}
+
+std::vector<tournament_result> read_tournament_results(const tournament_options& options)
+{
+  std::vector<tournament_result> results;
+  if (options.m_results_filename.empty()) return results;
+  std::ifstream f(options.m_results_filename);
+  std::string line;
+  if (!std::getline(f, line)) return results;
+  if (line != get_tournament_settings(options))
+  {
+    throw std::runtime_error(
+      "Results file '" + options.m_results_filename + "' is of games with other settings. "
+      "Expected '" + get_tournament_settings(options) + "', found '" + line + "'"
+    );
+  }
+  while (std::getline(f, line))
+  {
+    try
+    {
+      results.push_back(to_tournament_result(line, options.m_bots));
+    }
+    catch (const std::runtime_error&)
+    {
+      // A result of other bots, or a line that was only partly written
+    }
+  }
+  return results;
+}
+
+std::vector<tournament_result> run_tournament(const tournament_options& options)
+{
+  assert(options.m_bots.size() >= 2);
+  const auto& simulation{options.m_simulation};
+
+  // The games that already have a result are not played again
+  const auto key{
+    [](const tournament_game& g)
+    {
+      return std::make_tuple(g.m_white, g.m_black, g.m_starting_position, g.m_seed);
+    }
+  };
+  std::map<std::tuple<int, int, starting_position_type, unsigned int>, tournament_result> results;
+  for (const auto& r: read_tournament_results(options))
+  {
+    results.emplace(key(r.m_game), r);
+  }
+  std::vector<tournament_game> games;
+  for (const auto& g: create_tournament_games(options))
+  {
+    if (results.count(key(g)) == 0) games.push_back(g);
+  }
+
+  std::vector<simulation_job> jobs;
+  jobs.reserve(games.size());
+  for (const auto& g: games)
+  {
+    auto game_options{get_game_options(simulation)};
+    game_options.set_starting_position(g.m_starting_position);
+    jobs.push_back(
+      simulation_job{
+        game_options,
+        simulation.m_frame_time,
+        static_cast<int>(jobs.size()),
+        g.m_seed,
+        options.m_bots[g.m_white],
+        options.m_bots[g.m_black]
+      }
+    );
+  }
+
+  // Each result is saved as soon as it is known,
+  // so that a tournament that is stopped loses only the games being played
+  std::ofstream f;
+  if (!options.m_results_filename.empty())
+  {
+    // A line that was only partly written is ended first,
+    // so that it is not glued to the next result
+    bool is_empty{true};
+    bool is_line_ended{true};
+    {
+      std::ifstream g(options.m_results_filename, std::ios::binary | std::ios::ate);
+      if (g && g.tellg() > 0)
+      {
+        is_empty = false;
+        g.seekg(-1, std::ios::end);
+        is_line_ended = g.get() == '\n';
+      }
+    }
+    f.open(options.m_results_filename, std::ios::app);
+    if (f && !is_line_ended) f << '\n';
+    if (f && is_empty) f << get_tournament_settings(options) << std::endl;
+    if (!f)
+    {
+      throw std::runtime_error("Cannot write results to '" + options.m_results_filename + "'");
+    }
+  }
+  std::mutex mutex;
+  const auto batch{
+    run_batch(
+      jobs,
+      get_n_batch_threads(simulation),
+      simulation.m_chunk_size,
+      [&](const int index, const simulation_result& result)
+      {
+        if (!f.is_open()) return;
+        const auto line{to_str(tournament_result{games[index], result}, options.m_bots)};
+        std::lock_guard<std::mutex> lock(mutex);
+        f << line << std::endl;
+      }
+    )
+  };
+  assert(batch.m_results.size() == games.size());
+  for (std::size_t i{0}; i != games.size(); ++i)
+  {
+    results.emplace(key(games[i]), tournament_result{games[i], batch.m_results[i]});
+  }
+
+  std::vector<tournament_result> all_results;
+  all_results.reserve(results.size());
+  for (const auto& g: create_tournament_games(options))
+  {
+    all_results.push_back(results.at(key(g)));
+  }
+  return all_results;
+}
+
+void show_tournament_results(
+  const tournament_options& options,
+  const std::vector<tournament_result>& results,
+  std::ostream& os
+)
+{
+  const int n_bots{static_cast<int>(options.m_bots.size())};
+  const auto ratings{calc_tournament_ratings(options, results)};
+  std::vector<int> n_games(n_bots, 0);
+  std::vector<double> scores(n_bots, 0.0);
+  for (const auto& r: results)
+  {
+    ++n_games[r.m_game.m_white];
+    ++n_games[r.m_game.m_black];
+    const auto result{r.m_result.m_result};
+    if (result == game_result::white_wins) scores[r.m_game.m_white] += 1.0;
+    else if (result == game_result::black_wins) scores[r.m_game.m_black] += 1.0;
+    else
+    {
+      scores[r.m_game.m_white] += 0.5;
+      scores[r.m_game.m_black] += 0.5;
+    }
+  }
+  std::vector<int> order(n_bots);
+  for (int i{0}; i != n_bots; ++i) order[i] = i;
+  std::stable_sort(
+    std::begin(order),
+    std::end(order),
+    [&ratings](const int lhs, const int rhs) { return ratings[lhs].m_elo > ratings[rhs].m_elo; }
+  );
+  os << "bot\tgames\tscore\telo\telo_low\telo_high\n";
+  for (const int i: order)
+  {
+    os << options.m_bots[i] << '\t'
+      << n_games[i] << '\t'
+      << scores[i] << '\t'
+      << ratings[i].m_elo << '\t'
+      << ratings[i].m_low << '\t'
+      << ratings[i].m_high << '\n'
+    ;
+  }
+}
+
+void test_tournament()
+{
+#ifndef NDEBUG
+  // create_tournament_games
+  {
+    auto options{get_default_tournament_options()};
+    assert(options.m_bots.size() == get_all_bot_types().size());
+    options.m_starting_positions = {starting_position_type::standard, starting_position_type::kings_only};
+    options.m_simulation.m_n_games = 2;
+    const auto games{create_tournament_games(options)};
+    // 6 pairs, 2 positions, 2 seeds, 2 colors
+    assert(games.size() == 48);
+    // Both colors play the same seed
+    assert(games[0].m_white == games[1].m_black);
+    assert(games[0].m_black == games[1].m_white);
+    assert(games[0].m_seed == games[1].m_seed);
+    for (const auto& g: games) assert(g.m_white != g.m_black);
+  }
+  // to_str and to_tournament_result
+  {
+    const auto bots{get_default_tournament_options().m_bots};
+    const tournament_result r{
+      tournament_game{2, 0, starting_position_type::kings_only, 45},
+      simulation_result{game_result::black_wins, 123, delta_t(4.5)}
+    };
+    const auto s{to_str(r, bots)};
+    assert(s == "mcts:0.5 aggressive:0.5 kings_only 45 black_wins 123 4.5");
+    const auto q{to_tournament_result(s, bots)};
+    assert(q.m_game.m_white == 2);
+    assert(q.m_game.m_black == 0);
+    assert(q.m_game.m_starting_position == starting_position_type::kings_only);
+    assert(q.m_game.m_seed == 45);
+    assert(q.m_result.m_result == game_result::black_wins);
+    assert(q.m_result.m_n_ticks == 123);
+    assert(q.m_result.m_time == delta_t(4.5));
+  }
+  // to_tournament_result, invalid
+  {
+    const auto bots{get_default_tournament_options().m_bots};
+    const std::vector<std::string> invalids{
+      "",
+      "random:0.5 aggressive:0.5 kings_only 45 black_wins",
+      "random:0.5 greedy:0.25 kings_only 45 black_wins 123 4.5",
+      "random:0.5 random:0.5 kings_only 45 black_wins 123 4.5",
+      "random:0.5 aggressive:0.5 kings_only 45 undecided 123 4.5"
+    };
+    for (const auto& s: invalids)
+    {
+      bool has_thrown{false};
+      try { to_tournament_result(s, bots); } catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // parse_tournament_args
+  {
+    const auto options{
+      parse_tournament_args(
+        {
+          "game", "--tournament", "--bot", "greedy:0.5", "--bot", "random:0.25",
+          "--positions", "kings_only", "--results", "r.txt", "--games", "3"
+        }
+      )
+    };
+    assert(options.m_bots.size() == 2);
+    assert(options.m_bots[1] == bot_version({bot_type::random, delta_t(0.25)}));
+    assert(options.m_starting_positions.size() == 1);
+    assert(options.m_results_filename == "r.txt");
+    assert(options.m_simulation.m_n_games == 3);
+  }
+  // parse_tournament_args, invalid
+  {
+    const std::vector<std::vector<std::string>> invalids{
+      {"game", "--tournament", "--bot"},
+      {"game", "--tournament", "--bot", "greedy:0.5"},
+      {"game", "--tournament", "--bot", "greedy:0.5", "--bot", "greedy:0.5"},
+      {"game", "--tournament", "--bot", "nonsense:0.5", "--bot", "greedy:0.5"},
+      {"game", "--tournament", "--positions", "nonsense"}
+    };
+    for (const auto& args: invalids)
+    {
+      bool has_thrown{false};
+      try { parse_tournament_args(args); } catch (const std::runtime_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+  }
+  // get_tournament_usage
+  {
+    assert(get_tournament_usage().find("--bot") != std::string::npos);
+  }
+  // run_tournament, resumed after a stop
+  {
+    const std::string filename{"test_tournament_results.txt"};
+    std::remove(filename.c_str());
+    auto options{get_default_tournament_options()};
+    options.m_bots = {
+      bot_version{bot_type::greedy, delta_t(0.5)},
+      bot_version{bot_type::random, delta_t(0.5)}
+    };
+    options.m_starting_positions = {starting_position_type::queen_end_game};
+    options.m_simulation.m_max_game_time = delta_t(2.0);
+    options.m_simulation.m_n_games = 2;
+    options.m_simulation.m_n_threads = 2;
+    options.m_results_filename = filename;
+    assert(read_tournament_results(options).empty());
+    const auto results{run_tournament(options)};
+    assert(results.size() == 4);
+    assert(read_tournament_results(options).size() == 4);
+
+    // The results file starts with the settings
+    {
+      std::ifstream f(filename);
+      std::string line;
+      std::getline(f, line);
+      assert(line == get_tournament_settings(options));
+    }
+
+    // Stop after the first result, leaving a partly written line
+    {
+      std::ofstream f(filename);
+      f << get_tournament_settings(options) << '\n'
+        << to_str(results[0], options.m_bots) << '\n' << "greedy:0.5 rand";
+    }
+    const auto resumed{run_tournament(options)};
+    assert(resumed.size() == 4);
+    // The games are deterministic, so the replayed games give the same results
+    for (std::size_t i{0}; i != results.size(); ++i)
+    {
+      assert(resumed[i].m_result.m_result == results[i].m_result.m_result);
+      assert(resumed[i].m_result.m_n_ticks == results[i].m_result.m_n_ticks);
+    }
+    assert(read_tournament_results(options).size() == 4);
+
+    // Nothing is left to play
+    const auto finished{run_tournament(options)};
+    assert(finished.size() == 4);
+    assert(read_tournament_results(options).size() == 4);
+
+    std::stringstream s;
+    show_tournament_results(options, finished, s);
+    assert(s.str().find("bot\tgames\tscore\telo") != std::string::npos);
+    assert(s.str().find("greedy:0.5\t4\t") != std::string::npos);
+
+    // Games with other settings are not resumed
+    auto other_options{options};
+    other_options.m_simulation.m_max_game_time = delta_t(3.0);
+    assert(get_tournament_settings(other_options) != get_tournament_settings(options));
+    bool has_thrown{false};
+    try { run_tournament(other_options); } catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+    assert(read_tournament_results(options).size() == 4);
+    std::remove(filename.c_str());
+  }
+  // get_tournament_settings
+  {
+    const auto options{get_default_tournament_options()};
+    const auto s{get_tournament_settings(options)};
+    assert(s.substr(0, 2) == "# ");
+    assert(s.find("max_game_time") != std::string::npos);
+    bool has_thrown{false};
+    try { to_tournament_result(s, options.m_bots); } catch (const std::runtime_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+  // calc_tournament_ratings, the bot that wins more is rated higher
+  {
+    auto options{get_default_tournament_options()};
+    options.m_bots = {options.m_bots[0], options.m_bots[1]};
+    const std::vector<tournament_result> results{
+      {{0, 1, starting_position_type::standard, 1}, {game_result::white_wins, 1, delta_t(1.0)}},
+      {{1, 0, starting_position_type::standard, 1}, {game_result::black_wins, 1, delta_t(1.0)}},
+      {{0, 1, starting_position_type::standard, 2}, {game_result::draw, 1, delta_t(1.0)}}
+    };
+    const auto ratings{calc_tournament_ratings(options, results)};
+    assert(ratings.size() == 2);
+    assert(ratings[0].m_elo > ratings[1].m_elo);
+  }
+#endif // NDEBUG
+}
+
+tournament_result to_tournament_result(
+  const std::string& s,
+  const std::vector<bot_version>& bots
+)
+{
+  std::stringstream stream(s);
+  std::string white_name;
+  std::string black_name;
+  std::string position_name;
+  unsigned int seed{0};
+  std::string result_name;
+  int n_ticks{0};
+  double time{0.0};
+  stream >> white_name >> black_name >> position_name >> seed >> result_name >> n_ticks >> time;
+  if (!stream) throw std::runtime_error("Invalid tournament result '" + s + "'");
+  const auto index{
+    [&bots, &s](const std::string& name)
+    {
+      const auto bot{to_bot_version(name)};
+      const auto there{std::find(std::begin(bots), std::end(bots), bot)};
+      if (there == std::end(bots))
+      {
+        throw std::runtime_error("Tournament result '" + s + "' is of another bot");
+      }
+      return static_cast<int>(std::distance(std::begin(bots), there));
+    }
+  };
+  const tournament_result r{
+    tournament_game{
+      index(white_name),
+      index(black_name),
+      to_starting_position_type(position_name),
+      seed
+    },
+    simulation_result{to_game_result(result_name), n_ticks, delta_t(time)}
+  };
+  if (r.m_game.m_white == r.m_game.m_black || !is_over(r.m_result.m_result))
+  {
+    throw std::runtime_error("Invalid tournament result '" + s + "'");
+  }
+  return r;
+}
+
+std::string to_str(
+  const tournament_result& r,
+  const std::vector<bot_version>& bots
+)
+{
+  std::stringstream s;
+  s << bots[r.m_game.m_white] << ' '
+    << bots[r.m_game.m_black] << ' '
+    << to_str(r.m_game.m_starting_position) << ' '
+    << r.m_game.m_seed << ' '
+    << r.m_result.m_result << ' '
+    << r.m_result.m_n_ticks << ' '
+    << to_exact_str(r.m_result.m_time.get())
+  ;
+  return s.str();
+}
@@ -0,0 +1,136 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "bot_version.h"
+#include "ccfwd.h"
+#include "elo_rating.h"
+#include "simulation.h"
+#include "starting_position_type.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// The settings of a round-robin tournament between bots,
+/// in which each bot plays each other bot
+/// from each starting position, with both colors
+struct tournament_options
+{
+  /// The bots that play, of which no two are the same
+  std::vector<bot_version> m_bots;
+
+  /// The file the result of each game is appended to as soon as it is known,
+  /// where empty denotes not to save the results.
+  /// Its first line has the settings of the games,
+  /// as by 'get_tournament_settings'.
+  /// When the file already has results, these games are not played again,
+  /// so that a tournament that was stopped can be resumed
+  std::string m_results_filename;
+
+  /// The settings of the games, where the number of games is
+  /// per pair of bots, starting position and color.
+  /// Its starting position is ignored
+  simulation_options m_simulation;
+
+  /// The starting positions to play from
+  std::vector<starting_position_type> m_starting_positions;
+};
+
+/// One game of a tournament
+struct tournament_game
+{
+  /// The index of the bot that plays white
+  int m_white;
+
+  /// The index of the bot that plays black
+  int m_black;
+
+  starting_position_type m_starting_position;
+
+  /// The seed of the game, which determines what the bots do
+  unsigned int m_seed;
+};
+
+/// The result of one game of a tournament
+struct tournament_result
+{
+  tournament_game m_game;
+  simulation_result m_result;
+};
+
+/// Calculate the Elo rating of each bot, in the order of the bots,
+/// from the results of the games played
+std::vector<elo_rating> calc_tournament_ratings(
+  const tournament_options& options,
+  const std::vector<tournament_result>& results
+);
+
+/// Get all games of a tournament.
+/// Each pair of bots plays the same seeds with both colors,
+/// so that differences are due to the bots, not to chance
+std::vector<tournament_game> create_tournament_games(const tournament_options& options);
+
+/// Get the tournament options used when not specified otherwise,
+/// in which one bot of each type plays from all starting positions
+tournament_options get_default_tournament_options();
+
+/// Get the settings of the games that are not in each result,
+/// as written on the first line of the results file, e.g.
+/// '# board_size 8 frame_time 0.1 game_speed normal max_game_time 120'.
+/// The bot versions, the starting position and the seed
+/// are in each result instead
+std::string get_tournament_settings(const tournament_options& options);
+
+/// Get the help text of the command-line arguments of a tournament
+std::string get_tournament_usage() noexcept;
+
+/// Get the tournament options from the command-line arguments,
+/// e.g. '--tournament --bot greedy:0.5 --bot random:0.5 --results r.txt'.
+/// All arguments of '--simulate' can be used as well.
+/// Will throw if the arguments are invalid
+/// @param args the command-line arguments, the first being the program name
+tournament_options parse_tournament_args(const std::vector<std::string>& args);
+
+/// Read the results of the games of a tournament saved so far.
+/// Results of other bots are ignored,
+/// as is a last line that was only partly written.
+/// Will throw if the file has results of games with other settings,
+/// as the same bots and seeds give other results then
+/// @return the results, empty if there is no such file
+std::vector<tournament_result> read_tournament_results(const tournament_options& options);
+
+/// Play all games of a tournament that have no result yet,
+/// spread over worker threads,
+/// appending the result of each game to the results file
+/// @return the results of all games, including those played before
+std::vector<tournament_result> run_tournament(const tournament_options& options);
+
+/// Show the rating of each bot, from high to low,
+/// as a tab-separated table
+void show_tournament_results(
+  const tournament_options& options,
+  const std::vector<tournament_result>& results,
+  std::ostream& os
+);
+
+/// Test this class and its free functions
+void test_tournament();
+
+/// Get the result of a game from its line of text, as shown by 'to_str'.
+/// Will throw if the line is not a result of one of the bots
+tournament_result to_tournament_result(
+  const std::string& s,
+  const std::vector<bot_version>& bots
+);
+
+/// Get the result of a game as one line of text, e.g.
+/// 'greedy:0.5 random:0.5 standard 42 white_wins 1234 20.5',
+/// being the bot that plays white, the bot that plays black,
+/// the starting position, the seed, the result,
+/// the number of ticks and the in-game time at the end
+std::string to_str(
+  const tournament_result& r,
+  const std::vector<bot_version>& bots
+);
+
+#endif // TOURNAMENT_H
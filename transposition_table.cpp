@@ -0,0 +1,151 @@
+#include "transposition_table.h"
+
+#include <cassert>
+#include <thread>
+#include <vector>
+
+transposition_table::transposition_table(const int n_slots_log2)
+  : m_mask{(std::uint64_t{1} << n_slots_log2) - 1},
+    m_words(new std::atomic<std::uint64_t>[2 * ((std::uint64_t{1} << n_slots_log2))])
+{
+  assert(n_slots_log2 > 0);
+  assert(n_slots_log2 < 32);
+  clear();
+}
+
+void transposition_table::clear() noexcept
+{
+  for (std::uint64_t i{0}; i != 2 * get_n_slots(); ++i)
+  {
+    m_words[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+std::uint64_t pack(const transposition_entry& e) noexcept
+{
+  // 10 bits per square, 4 for the piece captured, 8 for the depth,
+  // 2 for the bound and 30 for the score
+  assert(e.m_move.m_from >= 0 && e.m_move.m_from < 1024);
+  assert(e.m_move.m_to >= 0 && e.m_move.m_to < 1024);
+  assert(e.m_depth >= 0 && e.m_depth < 256);
+  assert(e.m_score > -(1 << 29) && e.m_score < (1 << 29));
+  return static_cast<std::uint64_t>(e.m_move.m_from)
+    | (static_cast<std::uint64_t>(e.m_move.m_to) << 10)
+    | (static_cast<std::uint64_t>(e.m_move.m_captured + 6) << 20)
+    | (static_cast<std::uint64_t>(e.m_depth) << 24)
+    | (static_cast<std::uint64_t>(e.m_bound) << 32)
+    | (static_cast<std::uint64_t>(e.m_score + (1 << 29)) << 34)
+  ;
+}
+
+std::optional<transposition_entry> transposition_table::probe(const std::uint64_t hash) const noexcept
+{
+  const std::uint64_t slot{hash & m_mask};
+  const std::uint64_t check{m_words[2 * slot].load(std::memory_order_relaxed)};
+  const std::uint64_t data{m_words[(2 * slot) + 1].load(std::memory_order_relaxed)};
+  // An empty slot has both words zero, which only matches the hash zero
+  if ((check ^ data) != hash || data == 0) return {};
+  return unpack(data);
+}
+
+void transposition_table::store(const std::uint64_t hash, const transposition_entry& e) noexcept
+{
+  const std::uint64_t slot{hash & m_mask};
+  const auto there{probe(hash)};
+  if (there && there->m_depth > e.m_depth) return;
+  const std::uint64_t data{pack(e)};
+  m_words[2 * slot].store(hash ^ data, std::memory_order_relaxed);
+  m_words[(2 * slot) + 1].store(data, std::memory_order_relaxed);
+}
+
+void test_transposition_table()
+{
+#ifndef NDEBUG
+  const transposition_entry e{position_move{12, 1023, -5}, 7, -12345, score_bound::lower};
+  // pack and unpack
+  {
+    assert(unpack(pack(e)) == e);
+    const transposition_entry f{position_move{0, 0, 6}, 255, 99999, score_bound::upper};
+    assert(unpack(pack(f)) == f);
+  }
+  // An empty table has no positions
+  {
+    const transposition_table t(4);
+    assert(t.get_n_slots() == 16);
+    assert(!t.probe(12345));
+  }
+  // A position stored is found back
+  {
+    transposition_table t(4);
+    t.store(12345, e);
+    assert(t.probe(12345));
+    assert(*t.probe(12345) == e);
+    // Another position in the same slot is not found
+    assert(!t.probe(12345 + 16));
+    t.clear();
+    assert(!t.probe(12345));
+  }
+  // An entry of the same position is replaced only if searched deeper
+  {
+    transposition_table t(4);
+    t.store(1, e);
+    auto shallower{e};
+    shallower.m_depth = 3;
+    t.store(1, shallower);
+    assert(t.probe(1)->m_depth == 7);
+    auto deeper{e};
+    deeper.m_depth = 9;
+    t.store(1, deeper);
+    assert(t.probe(1)->m_depth == 9);
+    // Another position replaces it
+    t.store(1 + 16, shallower);
+    assert(!t.probe(1));
+    assert(t.probe(1 + 16)->m_depth == 3);
+  }
+  // Threads writing at the same time never give a torn entry
+  {
+    transposition_table t(2);
+    std::vector<std::thread> threads;
+    for (int i{0}; i != 4; ++i)
+    {
+      threads.emplace_back(
+        [&t, i]()
+        {
+          for (int j{0}; j != 10000; ++j)
+          {
+            const std::uint64_t hash{static_cast<std::uint64_t>(j % 8) * 0x9E3779B97F4A7C15ULL};
+            const int score{static_cast<int>((hash >> 40) % 1000)};
+            t.store(hash, transposition_entry{position_move{1, 2, 0}, i, score, score_bound::exact});
+            const auto there{t.probe(hash)};
+            if (there) assert(there->m_score == score);
+          }
+        }
+      );
+    }
+    for (auto& thread: threads) thread.join();
+  }
+#endif // NDEBUG
+}
+
+transposition_entry unpack(const std::uint64_t data) noexcept
+{
+  return transposition_entry{
+    position_move{
+      static_cast<std::int16_t>(data & 1023),
+      static_cast<std::int16_t>((data >> 10) & 1023),
+      static_cast<std::int8_t>(static_cast<int>((data >> 20) & 15) - 6)
+    },
+    static_cast<int>((data >> 24) & 255),
+    static_cast<int>(data >> 34) - (1 << 29),
+    static_cast<score_bound>((data >> 32) & 3)
+  };
+}
+
+bool operator==(const transposition_entry& lhs, const transposition_entry& rhs) noexcept
+{
+  return lhs.m_move == rhs.m_move
+    && lhs.m_depth == rhs.m_depth
+    && lhs.m_score == rhs.m_score
+    && lhs.m_bound == rhs.m_bound
+  ;
+}
@@ -0,0 +1,89 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "ccfwd.h"
+#include "chess_position.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+/// What a score stored in the transposition table is
+enum class score_bound
+{
+  /// The score is exact
+  exact,
+
+  /// The score is at least this
+  lower,
+
+  /// The score is at most this
+  upper
+};
+
+/// What the transposition table knows about a position
+struct transposition_entry
+{
+  /// The best move found, where a move from and to the same square
+  /// denotes none
+  position_move m_move;
+
+  /// The depth the position was searched to
+  int m_depth;
+
+  int m_score;
+
+  score_bound m_bound;
+};
+
+/// A hash table of the positions searched,
+/// that is shared by all threads of a search without locks.
+///
+/// Each slot holds the entry and the hash of the position xor-ed
+/// with the entry. A slot that is torn by two threads writing at the
+/// same time does not match its hash anymore, and is ignored,
+/// as described by Hyatt and Mann, 'A lockless transposition table
+/// implementation for parallel search', 2002
+class transposition_table
+{
+public:
+  /// @param n_slots_log2 the two-log of the number of slots,
+  ///   e.g. 20 for one million slots, taking 16 MB
+  explicit transposition_table(const int n_slots_log2 = 20);
+
+  /// Forget all positions
+  void clear() noexcept;
+
+  /// Get the number of slots
+  auto get_n_slots() const noexcept { return m_mask + 1; }
+
+  /// Get the entry of a position, if it is there
+  std::optional<transposition_entry> probe(const std::uint64_t hash) const noexcept;
+
+  /// Store the entry of a position.
+  /// An entry of another position is replaced,
+  /// an entry of the same position only if searched less deep
+  void store(const std::uint64_t hash, const transposition_entry& e) noexcept;
+
+private:
+
+  /// The index of the slot of a hash
+  std::uint64_t m_mask;
+
+  /// Two words per slot: the hash xor-ed with the data, and the data
+  std::unique_ptr<std::atomic<std::uint64_t>[]> m_words;
+};
+
+/// Pack an entry in one word
+std::uint64_t pack(const transposition_entry& e) noexcept;
+
+/// Test this class and its free functions
+void test_transposition_table();
+
+/// Unpack an entry from one word, as packed by 'pack'
+transposition_entry unpack(const std::uint64_t data) noexcept;
+
+bool operator==(const transposition_entry& lhs, const transposition_entry& rhs) noexcept;
+
+#endif // TRANSPOSITION_TABLE_H
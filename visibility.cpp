@@ -0,0 +1,320 @@
+#include "visibility.h"
+
+#include "piece.h"
+#include "pieces.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <utility>
+
+visibility::visibility(const int board_size)
+  : m_board_size{board_size},
+    m_n_recalculated{0}
+{
+  assert(m_board_size > 0);
+  assert(m_board_size <= get_max_board_size());
+
+}
+
+bitboard get_reach(
+  const piece& p,
+  const bitboard& occupied,
+  const int board_size
+)
+{
+  // The directions a piece can look into,
+  // with the maximum number of steps in that direction,
+  // where a piece that slides looks until the edge of the board
+  struct ray
+  {
+    int m_dx;
+    int m_dy;
+    int m_max_distance;
+  };
+  constexpr int far{get_max_board_size()};
+  static const std::array<ray, 4> bishop_rays{
+    { {1, -1, far}, {1, 1, far}, {-1, 1, far}, {-1, -1, far} }
+  };
+  static const std::array<ray, 8> king_rays{
+    {
+      {0, -1, 1}, {1, -1, 1}, {1, 0, 1}, {1, 1, 1},
+      {0, 1, 1}, {-1, 1, 1}, {-1, 0, 1}, {-1, -1, 1}
+    }
+  };
+  static const std::array<ray, 8> knight_rays{
+    {
+      {1, -2, 3}, {2, -1, 3}, {2, 1, 3}, {1, 2, 3},
+      {-1, 2, 3}, {-2, 1, 3}, {-2, -1, 3}, {-1, -2, 3}
+    }
+  };
+  // A pawn looks forward, which depends on the side of its player
+  static const std::array<ray, 3> lhs_pawn_rays{
+    { {1, 0, far}, {1, -1, 1}, {1, 1, 1} }
+  };
+  static const std::array<ray, 3> rhs_pawn_rays{
+    { {-1, 0, far}, {-1, -1, 1}, {-1, 1, 1} }
+  };
+  static const std::array<ray, 8> queen_rays{
+    {
+      {0, -1, far}, {1, -1, far}, {1, 0, far}, {1, 1, far},
+      {0, 1, far}, {-1, 1, far}, {-1, 0, far}, {-1, -1, far}
+    }
+  };
+  static const std::array<ray, 4> rook_rays{
+    { {0, -1, far}, {1, 0, far}, {0, 1, far}, {-1, 0, far} }
+  };
+  const ray* rays_begin{nullptr};
+  const ray* rays_end{nullptr};
+  const auto use_rays{
+    [&rays_begin, &rays_end](const auto& rays)
+    {
+      rays_begin = rays.data();
+      rays_end = rays.data() + rays.size();
+    }
+  };
+  switch (p.get_type())
+  {
+    case piece_type::bishop:
+      use_rays(bishop_rays);
+      break;
+    case piece_type::king:
+      use_rays(king_rays);
+      break;
+    case piece_type::knight:
+      use_rays(knight_rays);
+      break;
+    case piece_type::pawn:
+      if (p.get_player() == side::lhs) use_rays(lhs_pawn_rays);
+      else use_rays(rhs_pawn_rays);
+      break;
+    case piece_type::queen:
+      use_rays(queen_rays);
+      break;
+    default:
+    case piece_type::rook:
+      assert(p.get_type() == piece_type::rook);
+      use_rays(rook_rays);
+      break;
+  }
+  const int x{p.get_current_square().get_x()};
+  const int y{p.get_current_square().get_y()};
+  bitboard reach;
+  reach.set(p.get_current_square());
+  for (auto r{rays_begin}; r != rays_end; ++r)
+  {
+    for (int distance{1}; distance <= r->m_max_distance; ++distance)
+    {
+      const int new_x{x + (r->m_dx * distance)};
+      const int new_y{y + (r->m_dy * distance)};
+      if (!is_valid_square_xy(new_x, new_y, board_size)) break;
+      const square there(new_x, new_y);
+      reach.set(there);
+      // The first piece in the way is seen, the squares behind it are not
+      if (occupied.is_set(there)) break;
+    }
+  }
+  return reach;
+}
+
+const bitboard& visibility::get_visible_squares(const chess_color player) const noexcept
+{
+  if (player == chess_color::white) return m_visible_by_white;
+  assert(player == chess_color::black);
+  return m_visible_by_black;
+}
+
+void visibility::update(const std::vector<piece>& pieces)
+{
+  bitboard occupied;
+  for (const auto& p: pieces) occupied.set(p.get_current_square());
+
+  // The squares that were entered or left since the last update
+  bitboard changed;
+
+  // Match the pieces with the reaches of the last update.
+  // As pieces are only ever removed, both are in the same order
+  std::vector<piece_reach> reaches;
+  reaches.reserve(pieces.size());
+  std::vector<bool> must_recalculate;
+  must_recalculate.reserve(pieces.size());
+  const int n_reaches{static_cast<int>(m_reaches.size())};
+  int j{0};
+  for (const auto& p: pieces)
+  {
+    while (j != n_reaches && m_reaches[j].m_id != p.get_id())
+    {
+      // This piece is gone
+      changed.set(m_reaches[j].m_square);
+      ++j;
+    }
+    if (j == n_reaches)
+    {
+      // A piece not seen before
+      changed.set(p.get_current_square());
+      reaches.push_back(
+        piece_reach{p.get_id(), p.get_color(), p.get_current_square(), bitboard()}
+      );
+      must_recalculate.push_back(true);
+      continue;
+    }
+    const auto& before{m_reaches[j]};
+    if (before.m_square != p.get_current_square())
+    {
+      changed.set(before.m_square);
+      changed.set(p.get_current_square());
+      reaches.push_back(
+        piece_reach{p.get_id(), p.get_color(), p.get_current_square(), bitboard()}
+      );
+      must_recalculate.push_back(true);
+    }
+    else
+    {
+      reaches.push_back(before);
+      must_recalculate.push_back(false);
+    }
+    ++j;
+  }
+  for (; j != n_reaches; ++j) changed.set(m_reaches[j].m_square);
+
+  // Only a piece that can see a changed square has a different reach now
+  m_n_recalculated = 0;
+  m_visible_by_black = bitboard();
+  m_visible_by_white = bitboard();
+  const int n_pieces{static_cast<int>(pieces.size())};
+  for (int i{0}; i != n_pieces; ++i)
+  {
+    auto& r{reaches[i]};
+    if (must_recalculate[i] || have_common_squares(r.m_reach, changed))
+    {
+      r.m_reach = get_reach(pieces[i], occupied, m_board_size);
+      ++m_n_recalculated;
+    }
+    if (r.m_color == chess_color::white) m_visible_by_white |= r.m_reach;
+    else m_visible_by_black |= r.m_reach;
+  }
+  m_reaches = std::move(reaches);
+}
+
+void test_visibility()
+{
+#ifndef NDEBUG
+  // get_reach, a king sees its neighbours
+  {
+    const auto pieces{get_kings_only_starting_pieces(chess_color::white)};
+    bitboard occupied;
+    for (const auto& p: pieces) occupied.set(p.get_current_square());
+    const auto& white_king{get_piece_at(pieces, square("e1"))};
+    const auto reach{get_reach(white_king, occupied)};
+    assert(reach.is_set(square("e1")));
+    assert(reach.is_set(square("d2")));
+    assert(reach.is_set(square("f1")));
+    assert(!reach.is_set(square("e3")));
+    assert(count_squares(reach) == 6);
+  }
+  // get_reach, a rook sees up to and including the first piece in its way
+  {
+    const auto pieces{get_standard_starting_pieces(chess_color::white)};
+    bitboard occupied;
+    for (const auto& p: pieces) occupied.set(p.get_current_square());
+    const auto& white_rook{get_piece_at(pieces, square("a1"))};
+    const auto reach{get_reach(white_rook, occupied)};
+    assert(reach.is_set(square("a1")));
+    assert(reach.is_set(square("a2")));
+    assert(reach.is_set(square("b1")));
+    assert(!reach.is_set(square("a3")));
+    assert(count_squares(reach) == 3);
+  }
+  // get_reach, a pawn sees forward and diagonally forward
+  {
+    const auto pieces{get_standard_starting_pieces(chess_color::white)};
+    bitboard occupied;
+    for (const auto& p: pieces) occupied.set(p.get_current_square());
+    const auto& white_pawn{get_piece_at(pieces, square("e2"))};
+    const auto reach{get_reach(white_pawn, occupied)};
+    assert(reach.is_set(square("e6")));
+    assert(reach.is_set(square("e7")));
+    assert(!reach.is_set(square("e8")));
+    assert(reach.is_set(square("d3")));
+    assert(reach.is_set(square("f3")));
+    assert(!reach.is_set(square("e1")));
+  }
+  // visibility::update, at the start
+  {
+    const auto pieces{get_standard_starting_pieces(chess_color::white)};
+    visibility v;
+    v.update(pieces);
+    assert(v.get_n_recalculated() == 32);
+    const auto& white_sees{v.get_visible_squares(chess_color::white)};
+    const auto& black_sees{v.get_visible_squares(chess_color::black)};
+    assert(white_sees.is_set(square("e1")));
+    assert(white_sees.is_set(square("e4")));
+    assert(white_sees.is_set(square("e7"))); // the pawn sees the other pawn
+    assert(!white_sees.is_set(square("e8")));
+    assert(black_sees.is_set(square("e8")));
+    assert(black_sees.is_set(square("e2")));
+    assert(!black_sees.is_set(square("e1")));
+  }
+  // visibility::update, without moves nothing is recalculated
+  {
+    const auto pieces{get_standard_starting_pieces(chess_color::white)};
+    visibility v;
+    v.update(pieces);
+    const auto white_sees_before{v.get_visible_squares(chess_color::white)};
+    v.update(pieces);
+    assert(v.get_n_recalculated() == 0);
+    assert(v.get_visible_squares(chess_color::white) == white_sees_before);
+  }
+  // visibility::update, after a move, only the pieces involved are recalculated
+  {
+    auto pieces{get_standard_starting_pieces(chess_color::white)};
+    visibility v;
+    v.update(pieces);
+    get_piece_at(pieces, square("e2")).set_current_square(square("e4"));
+    v.update(pieces);
+    // The pawn, the queen, the bishop, the king, the black e7 pawn
+    // and the black pawns next to it
+    assert(v.get_n_recalculated() < 32);
+    assert(v.get_n_recalculated() > 1);
+    // The bishop on f1 and the queen on d1 can look further now
+    assert(v.get_visible_squares(chess_color::white).is_set(square("a6")));
+    assert(v.get_visible_squares(chess_color::white).is_set(square("h5")));
+    // Recalculating everything gives the same result
+    visibility w;
+    w.update(pieces);
+    assert(v.get_visible_squares(chess_color::white) == w.get_visible_squares(chess_color::white));
+    assert(v.get_visible_squares(chess_color::black) == w.get_visible_squares(chess_color::black));
+  }
+  // visibility::update, on a large board
+  {
+    const auto pieces{get_standard_starting_pieces(chess_color::white, 16)};
+    visibility v(16);
+    v.update(pieces);
+    // A pawn sees all the way to the pawns of the other player
+    assert(v.get_visible_squares(chess_color::white).is_set(square("a13")));
+    assert(!v.get_visible_squares(chess_color::white).is_set(square("a14")));
+  }
+  // visibility::update, after a piece is removed
+  {
+    auto pieces{get_standard_starting_pieces(chess_color::white)};
+    visibility v;
+    v.update(pieces);
+    assert(!v.get_visible_squares(chess_color::black).is_set(square("a1")));
+    pieces.erase(
+      std::remove_if(
+        std::begin(pieces),
+        std::end(pieces),
+        [](const auto& p) { return p.get_current_square() == square("a2"); }
+      ),
+      std::end(pieces)
+    );
+    v.update(pieces);
+    // The black pawn on a7 can see the white rook on a1 now
+    assert(v.get_visible_squares(chess_color::black).is_set(square("a1")));
+    visibility w;
+    w.update(pieces);
+    assert(v.get_visible_squares(chess_color::white) == w.get_visible_squares(chess_color::white));
+    assert(v.get_visible_squares(chess_color::black) == w.get_visible_squares(chess_color::black));
+  }
+#endif // NDEBUG
+}
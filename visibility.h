@@ -0,0 +1,72 @@
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+
+#include "ccfwd.h"
+#include "bitboard.h"
+#include "chess_color.h"
+#include "id.h"
+#include "square.h"
+
+#include <vector>
+
+/// What the players can see when playing with fog-of-war.
+/// A player sees the squares its pieces are on,
+/// and the squares its pieces can move to or attack.
+/// Upon an update, only the reach of the pieces that moved,
+/// or that can see a square that was entered or left,
+/// is recalculated.
+class visibility
+{
+public:
+  explicit visibility(const int board_size = get_default_board_size());
+
+  /// Get the squares a player can see
+  const bitboard& get_visible_squares(const chess_color player) const noexcept;
+
+  /// Get the number of reaches recalculated at the last update
+  int get_n_recalculated() const noexcept { return m_n_recalculated; }
+
+  /// Update what the players can see, after pieces have moved
+  void update(const std::vector<piece>& pieces);
+
+private:
+
+  /// The number of squares along one side of the board
+  int m_board_size;
+
+  /// The reach of a piece, as it was at the last update
+  struct piece_reach
+  {
+    id m_id;
+    chess_color m_color;
+    square m_square;
+    bitboard m_reach;
+  };
+
+  /// The number of reaches recalculated at the last update
+  int m_n_recalculated;
+
+  /// The reaches of the pieces,
+  /// in the same order as the pieces at the last update
+  std::vector<piece_reach> m_reaches;
+
+  /// The squares black can see
+  bitboard m_visible_by_black;
+
+  /// The squares white can see
+  bitboard m_visible_by_white;
+};
+
+/// Get the squares a piece can see:
+/// the squares it can move to or attack,
+/// including the first piece in its way
+bitboard get_reach(
+  const piece& p,
+  const bitboard& occupied,
+  const int board_size = get_default_board_size()
+);
+
+/// Test this class and its free functions
+void test_visibility();
+
+#endif // VISIBILITY_H
@@ -0,0 +1,72 @@
+#include "work_stealing_queue.h"
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <thread>
+#include <vector>
+
+void test_work_stealing_queue()
+{
+#ifndef NDEBUG
+  // An empty queue
+  {
+    work_stealing_queue<int> q;
+    assert(q.empty());
+    assert(q.get_size() == 0);
+    assert(!q.pop_bottom());
+    assert(!q.steal_top());
+  }
+  // The owner takes the task put in last
+  {
+    work_stealing_queue<int> q;
+    q.push_bottom(1);
+    q.push_bottom(2);
+    assert(q.get_size() == 2);
+    assert(q.pop_bottom().value() == 2);
+    assert(q.pop_bottom().value() == 1);
+    assert(q.empty());
+  }
+  // A thief takes the oldest task
+  {
+    work_stealing_queue<int> q;
+    q.push_bottom(1);
+    q.push_bottom(2);
+    q.push_bottom(3);
+    assert(q.steal_top().value() == 1);
+    assert(q.pop_bottom().value() == 3);
+    assert(q.steal_top().value() == 2);
+    assert(!q.steal_top());
+  }
+  // Tasks that can only be moved
+  {
+    work_stealing_queue<std::unique_ptr<int>> q;
+    q.push_bottom(std::make_unique<int>(42));
+    assert(*q.steal_top().value() == 42);
+  }
+  // Thieves and the owner take every task exactly once
+  {
+    work_stealing_queue<int> q;
+    const int n{10000};
+    for (int i{0}; i != n; ++i) q.push_bottom(i);
+    std::vector<std::atomic<int>> n_taken(n);
+    const auto take{
+      [&q, &n_taken](const bool is_owner)
+      {
+        while (true)
+        {
+          const auto task{is_owner ? q.pop_bottom() : q.steal_top()};
+          if (!task) return;
+          ++n_taken[*task];
+        }
+      }
+    };
+    std::thread thief_1(take, false);
+    std::thread thief_2(take, false);
+    take(true);
+    thief_1.join();
+    thief_2.join();
+    for (const auto& i: n_taken) assert(i == 1);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,83 @@
+#ifndef WORK_STEALING_QUEUE_H
+#define WORK_STEALING_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/// A queue of tasks owned by one worker thread,
+/// from which other worker threads can steal when they run out of work.
+/// The owner puts tasks in and takes them out at the bottom,
+/// so it works on the tasks it touched last, of which the data
+/// is most likely still in its cache.
+/// Thieves take tasks from the top, i.e. the oldest tasks,
+/// so that owner and thief rarely want the same task.
+///
+/// Each queue has its own lock, so that workers only wait
+/// for each other when one steals from the other.
+/// As a task is a chunk of many game ticks,
+/// the queue is used too rarely for a lock-free deque to pay off
+template <class T>
+class work_stealing_queue
+{
+public:
+  /// Is the queue empty?
+  /// When called while other threads use the queue,
+  /// this is a snapshot that may be outdated directly
+  bool empty() const
+  {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tasks.empty();
+  }
+
+  /// The number of tasks in the queue.
+  /// When called while other threads use the queue,
+  /// this is a snapshot that may be outdated directly
+  auto get_size() const
+  {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tasks.size();
+  }
+
+  /// Take the task put in last, if there is one.
+  /// Only to be called by the owner
+  std::optional<T> pop_bottom()
+  {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_tasks.empty()) return {};
+    std::optional<T> task{std::move(m_tasks.back())};
+    m_tasks.pop_back();
+    return task;
+  }
+
+  /// Put a task at the bottom.
+  /// Only to be called by the owner
+  void push_bottom(T task)
+  {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+  }
+
+  /// Take the oldest task, if there is one.
+  /// To be called by any thread but the owner
+  std::optional<T> steal_top()
+  {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_tasks.empty()) return {};
+    std::optional<T> task{std::move(m_tasks.front())};
+    m_tasks.pop_front();
+    return task;
+  }
+
+private:
+
+  mutable std::mutex m_mutex;
+
+  /// The tasks, where the front is the top
+  std::deque<T> m_tasks;
+};
+
+/// Test this class and its free functions
+void test_work_stealing_queue();
+
+#endif // WORK_STEALING_QUEUE_H